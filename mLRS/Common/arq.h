@@ -0,0 +1,127 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// ARQ for Serial Data
+//*******************************************************
+// Stop-and-wait ARQ, using the seq_no and ack fields of the frame status.
+//
+// The link alternates strictly between Tx and Rx frames, so a frame is always answered
+// in the very next slot. A window of one payload hence is sufficient, and one ack bit
+// does the job. A larger window would need more ack bits, but not give more throughput.
+//
+// The transmitting end increments seq_no for each new non-empty payload. A payload is
+// resent with the same seq_no until it is acknowledged, or the connection is lost.
+// The receiving end acks each valid frame, and drops payloads with repeated seq_no.
+//*******************************************************
+#ifndef ARQ_H
+#define ARQ_H
+#pragma once
+
+
+#include <inttypes.h>
+#include <string.h>
+#include "frame_types.h"
+
+
+class tArq
+{
+  public:
+    void Init(void)
+    {
+        enabled = false;
+        Clear();
+    }
+
+    void Clear(void) // called then not connected
+    {
+        tx_pending = false;
+        tx_sent_last = false;
+        tx_payload_len = 0;
+        tx_cnt = 0;
+        tx_delivery_cnt = 0;
+
+        rx_valid = false;
+        rx_seq_no = UINT8_MAX;
+    }
+
+    void SetEnabled(bool _enabled)
+    {
+        if (_enabled == enabled) return;
+        enabled = _enabled;
+        Clear();
+    }
+
+    bool IsEnabled(void) { return enabled; }
+
+    //-- transmitting end
+
+    // to be called before a frame is transmitted, with the ack of the last received frame
+    void HandleAck(uint8_t received_ack)
+    {
+        if (tx_pending && tx_sent_last && received_ack) {
+            tx_pending = false; // has been delivered
+            tx_delivery_cnt = tx_cnt;
+        }
+        tx_sent_last = false;
+    }
+
+    bool Pending(void) { return (enabled && tx_pending); }
+
+    void PutPayload(uint8_t* payload, uint8_t len)
+    {
+        if (!enabled || !len) return; // nothing to keep
+        memcpy(tx_payload, payload, len);
+        tx_payload_len = len;
+        tx_pending = true;
+        tx_sent_last = true;
+        tx_cnt = 1;
+    }
+
+    uint8_t GetPayload(uint8_t* payload)
+    {
+        memcpy(payload, tx_payload, tx_payload_len);
+        tx_sent_last = true;
+        if (tx_cnt < UINT8_MAX) tx_cnt++;
+        return tx_payload_len;
+    }
+
+    // number of retransmissions the last delivered payload needed
+    uint8_t RetransmitCnt(void) { return (tx_delivery_cnt) ? tx_delivery_cnt - 1 : 0; }
+
+    //-- receiving end
+
+    // to be called for each receive slot, valid = frame passed full crc check
+    void SetReceived(bool valid) { rx_valid = valid; }
+
+    // ack to put into the next transmitted frame
+    // it is set also if not enabled, the Rx's MavlinkX delta coding relies on it
+    uint8_t Ack(void) { return (rx_valid) ? 1 : 0; }
+
+    // to be called for each valid non-cmd frame with payload
+    bool IsDuplicate(uint8_t seq_no)
+    {
+        if (!enabled) return false;
+        if (seq_no == rx_seq_no) return true;
+        rx_seq_no = seq_no;
+        return false;
+    }
+
+  private:
+    bool enabled;
+
+    bool tx_pending; // a payload has been sent but not yet acknowledged
+    bool tx_sent_last; // the pending payload was in the last transmitted frame
+    uint8_t tx_payload[FRAME_TX_RX_LEN];
+    uint8_t tx_payload_len;
+    uint8_t tx_cnt;
+    uint8_t tx_delivery_cnt;
+
+    bool rx_valid;
+    uint8_t rx_seq_no;
+};
+
+
+#endif // ARQ_H
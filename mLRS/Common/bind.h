@@ -101,7 +101,10 @@ void BindBase::Init(void)
 void BindBase::ConfigForBind(void)
 {
     // switch to 19 Mode, select lowest possible power
+    // bind frames are always full length, the Rx doesn't know yet about short frames
     configure_mode(MODE_19HZ);
+    Config.UseShortFrames = false;
+    Config.Sx.LoraHeaderExplicit = false;
 
     sx.SetToIdle();
     sx2.SetToIdle();
@@ -212,8 +215,12 @@ void BindBase::do_transmit(uint8_t antenna)
     // TODO txBindFrame.FrequencyBand = Setup.Common[Config.ConfigId].FrequencyBand;
     txBindFrame.Mode = Setup.Common[Config.ConfigId].Mode;
     txBindFrame.Ortho = Setup.Common[Config.ConfigId].Ortho;
+    txBindFrame.Fec = Setup.Common[Config.ConfigId].Fec;
+    txBindFrame.RateAdapt = Setup.Common[Config.ConfigId].RateAdapt;
+    txBindFrame.ShortFrames = Setup.Common[Config.ConfigId].ShortFrames;
+    txBindFrame.RcCoding = Setup.Common[Config.ConfigId].RcCoding;
 
-    txBindFrame.crc = fmav_crc_calculate((uint8_t*)&txBindFrame, FRAME_TX_RX_LEN - 2);
+    txBindFrame.crc = frame_crc_calculate((uint8_t*)&txBindFrame, FRAME_TX_RX_LEN - 2);
     sxSendFrame(antenna, &txBindFrame, FRAME_TX_RX_LEN, SEND_FRAME_TMO_MS);
 }
 
@@ -224,7 +231,7 @@ uint8_t BindBase::do_receive(uint8_t antenna, bool do_clock_reset)
 
     bool ok = (rxBindFrame.bind_signature == RxSignature);
     if (ok) {
-        uint16_t crc = fmav_crc_calculate((uint8_t*)&rxBindFrame, FRAME_TX_RX_LEN - 2);
+        uint16_t crc = frame_crc_calculate((uint8_t*)&rxBindFrame, FRAME_TX_RX_LEN - 2);
         ok = (crc == rxBindFrame.crc);
     }
 
@@ -247,6 +254,10 @@ void BindBase::handle_receive(uint8_t antenna, uint8_t rx_status)
     // TODO Setup.Common[0].FrequencyBand = txBindFrame.FrequencyBand;
     Setup.Common[0].Mode = txBindFrame.Mode;
     Setup.Common[0].Ortho = txBindFrame.Ortho;
+    Setup.Common[0].Fec = txBindFrame.Fec;
+    Setup.Common[0].RateAdapt = txBindFrame.RateAdapt;
+    Setup.Common[0].ShortFrames = txBindFrame.ShortFrames;
+    Setup.Common[0].RcCoding = txBindFrame.RcCoding;
 
     if (txBindFrame.connected) {
         task = BIND_TASK_RX_STORE_PARAMS;
@@ -264,7 +275,7 @@ void BindBase::do_transmit(uint8_t antenna)
     rxBindFrame.firmware_version = VERSION;
     strbufstrcpy(rxBindFrame.device_name_20, DEVICE_NAME, 20);
 
-    rxBindFrame.crc = fmav_crc_calculate((uint8_t*)&rxBindFrame, FRAME_TX_RX_LEN - 2);
+    rxBindFrame.crc = frame_crc_calculate((uint8_t*)&rxBindFrame, FRAME_TX_RX_LEN - 2);
     sxSendFrame(antenna, &rxBindFrame, FRAME_TX_RX_LEN, SEND_FRAME_TMO_MS);
 }
 
@@ -275,7 +286,7 @@ uint8_t BindBase::do_receive(uint8_t antenna, bool do_clock_reset)
 
     bool ok = (txBindFrame.bind_signature == TxSignature);
     if (ok) {
-        uint16_t crc = fmav_crc_calculate((uint8_t*)&txBindFrame, FRAME_TX_RX_LEN - 2);
+        uint16_t crc = frame_crc_calculate((uint8_t*)&txBindFrame, FRAME_TX_RX_LEN - 2);
         ok = (crc == txBindFrame.crc);
     }
 
@@ -19,6 +19,10 @@
 #include "frame_types.h"
 #include "link_types.h"
 #include "common_stats.h"
+#include "arq.h"
+#include "rate_adapt.h"
+#include "slot_schedule.h"
+#include "link_connect.h"
 #include "bind.h"
 #include "fail.h"
 #include "buzzer.h"
@@ -189,8 +193,20 @@ SX2_DRIVER sx2;
 
 Stats stats;
 
+tArq arq;
+
+tRcCoding rc_coding;
+
+tLatencyTrace latency_trace;
+
+tRateAdapt rate_adapt;
+
+tSlotSchedule slot_schedule;
+
 tFhss fhss;
 
+tLinkConnect link_connect;
+
 BindBase bind;
 
 tBuzzer buzzer;
@@ -223,6 +239,15 @@ void sxSendFrame(uint8_t antenna, void* data, uint8_t len, uint16_t tmo_ms)
 }
 
 
+void sxSetLoraConfigurationByIndex(uint8_t index)
+{
+    sx.SetToIdle(); // must be in standby
+    sx2.SetToIdle();
+    sx.SetLoraConfigurationByIndex(index);
+    sx2.SetLoraConfigurationByIndex(index);
+}
+
+
 void sxGetPacketStatus(uint8_t antenna, Stats* stats)
 {
     if (antenna == ANTENNA_1) {
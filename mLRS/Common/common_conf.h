@@ -63,6 +63,7 @@
 
 #define SETUP_TX_BUZZER                 0 // 0: off, 1: LP, 2: rxLQ
 #define SETUP_TX_CLI_LINE_END           0 // 0: CR, 1: LF, 2: CRLF
+#define SETUP_TX_FHSS_ADAPT             0 // 0: off, 1: on
 
 
 #define SETUP_RX_CHANNEL_ORDER          CHANNEL_ORDER_AETR
@@ -79,8 +80,11 @@
 
 #define SETUP_RX_SERIAL_LINK_MODE       1 // 0: transparent, 1: mavlink
 
-#define SETUP_RX_SEND_RADIO_STATUS      1 // 0: off, 1: ardu_1, 2: px4 aka "brad"
+#define SETUP_RX_SEND_RADIO_STATUS      1 // 0: off, 1: ardu_1, 2: px4 aka "brad", 3: model
 #define SETUP_RX_SEND_RC_CHANNELS       0 // 0: off, 1: RC_CHANNEL_OVERRIDE, 2: RC_CHANNELS
+#define SETUP_RX_SERIAL_ARQ             0 // 0: off, 1: on
+#define SETUP_RX_OUT_RATE               0 // 0: link, 1: 150 Hz, 2: 250 Hz
+#define SETUP_RX_OUT_SMOOTHING          0 // 0: hold, 1: interp, 2: extrap
 
 #define SETUP_RX_OUT_RSSI_CHANNEL       0 // 0: off, 5: CH5, 16: CH16
 #define SETUP_RX_OUT_LQ_CHANNEL         0 // 0: off, 5: CH5, 16: CH16
@@ -102,6 +106,14 @@
 
 #define SETUP_RF_ORTHO                   0 // 0: off, 1: 1/3, 2: 2/3, 3: 3/3
 
+#define SETUP_RF_FEC                     0 // 0: off, 1: on, only for FLRC, FSK
+
+#define SETUP_RATE_ADAPT                 0 // 0: off, 1: on, only for 50 Hz, 31 Hz, 19 Hz
+
+#define SETUP_SHORT_FRAMES               0 // 0: off, 1: on, only for 50 Hz, 31 Hz, 19 Hz
+
+#define SETUP_RC_CODING                  0 // 0: std, 1: delta
+
 
 //-------------------------------------------------------
 // System Configs
@@ -27,12 +27,27 @@ class Stats
     StatsLQ valid_crc1_received; // received frames which passed crc1 check, but not crc
 #endif
     StatsLQ valid_frames_received; // received frames which also passed crc check
+    StatsLQ frames_combined; // frames recovered by combining the corrupted frames of both antennas
+    StatsLQ frames_fec_corrected; // frames recovered by fec
 
     StatsLQ serial_data_transmitted; // frames with serial data transmitted, retransmissions are not counted
     StatsLQ serial_data_received; // frames with serial data received, retransmissions are not counted
+    StatsLQ serial_data_retransmitted; // frames with serial data retransmitted by ARQ
+    StatsLQ serial_data_duplicates_received; // frames with serial data received twice, and dropped by ARQ
+
+    StatsLQ uplink_slots; // number of Tx frame slots, counts_per_sec is the slot usage
+    StatsLQ downlink_slots; // number of Rx frame slots, is larger than uplink_slots with downlink slots
 
     StatsBytes bytes_transmitted; // retransmissions are not counted
     StatsBytes bytes_received; // retransmissions are not counted
+#ifdef DEVICE_IS_RECEIVER
+    StatsBytes filter_bytes_forwarded; // MAVLink messages which passed the filter
+    StatsBytes filter_bytes_dropped; // MAVLink messages which were dropped by the filter
+    StatsBytes filter_msgs_dropped; // counts messages, not bytes
+#endif
+
+    StatsLatency mavlink_latency[3]; // time MAVLink messages wait in the link out queue, per priority class high, telemetry, bulk
+    StatsTiming rcdata_age; // age of the rc data when it goes out, Tx: since the channels frame was received from the radio, Rx: since the frame was received
 
     // statistics for our device
     int8_t last_rssi1;
@@ -48,12 +63,13 @@ class Stats
     uint8_t received_LQ_serial_data;
     uint8_t received_antenna;
     uint8_t received_transmit_antenna;
+    uint8_t received_valid; // the other end got our frame of this slot
 
     // transmission/retransmission handling
     uint8_t received_seq_no;
     uint8_t received_ack;
     uint8_t transmit_seq_no; // seq no in the last transmitted frame
-    uint8_t retransmit_cnt;
+    uint8_t retransmit_cnt; // retransmissions needed for the last delivered payload, is the ARQ latency in frames
 
     void Init(void)
     {
@@ -62,10 +78,23 @@ class Stats
         valid_crc1_received.Init();
 #endif
         valid_frames_received.Init();
+        frames_combined.Init();
+        frames_fec_corrected.Init();
         serial_data_transmitted.Init();
         serial_data_received.Init();
+        serial_data_retransmitted.Init();
+        serial_data_duplicates_received.Init();
+        uplink_slots.Init();
+        downlink_slots.Init();
         bytes_transmitted.Init();
         bytes_received.Init();
+#ifdef DEVICE_IS_RECEIVER
+        filter_bytes_forwarded.Init();
+        filter_bytes_dropped.Init();
+        filter_msgs_dropped.Init();
+#endif
+        for (uint8_t n = 0; n < 3; n++) mavlink_latency[n].Init();
+        rcdata_age.Init();
 
         Clear();
     }
@@ -83,6 +112,7 @@ class Stats
         received_LQ = 0; //UINT8_MAX;
         received_antenna = UINT8_MAX;
         received_transmit_antenna = UINT8_MAX;
+        received_valid = 1;
 
         received_seq_no = UINT8_MAX;
         received_ack = 0;
@@ -97,10 +127,23 @@ class Stats
         valid_crc1_received.Update1Hz();
 #endif
         valid_frames_received.Update1Hz();
+        frames_combined.Update1Hz();
+        frames_fec_corrected.Update1Hz();
         serial_data_transmitted.Update1Hz();
         serial_data_received.Update1Hz();
+        serial_data_retransmitted.Update1Hz();
+        serial_data_duplicates_received.Update1Hz();
+        uplink_slots.Update1Hz();
+        downlink_slots.Update1Hz();
         bytes_transmitted.Update1Hz();
         bytes_received.Update1Hz();
+#ifdef DEVICE_IS_RECEIVER
+        filter_bytes_forwarded.Update1Hz();
+        filter_bytes_dropped.Update1Hz();
+        filter_msgs_dropped.Update1Hz();
+#endif
+        for (uint8_t n = 0; n < 3; n++) mavlink_latency[n].Update1Hz();
+        rcdata_age.Update1Hz();
     }
 
     uint8_t GetTransmitBandwidthUsage(void)
@@ -71,6 +71,12 @@ class tSerialBase
     virtual uint16_t bytes_available(void) { return 0; }
 
     void putbuf(void* buf, uint16_t len) { for (uint16_t i = 0; i < len; i++) putc(((char*)buf)[i]); }
+    virtual uint16_t getbuf(void* buf, uint16_t len)
+    {
+        uint16_t n = 0;
+        while (n < len && available()) { ((char*)buf)[n] = getc(); n++; }
+        return n;
+    }
     void puts(const char* s) { while (*s) { putc(*s); s++; }; }
 };
 
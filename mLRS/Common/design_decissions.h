@@ -719,6 +719,20 @@ method C:
   we could speed up adaption by increasing radio_status rate by two when +60ms or -40ms
   but it works very well for me as is
 
+method D, "model":
+  methods B and C compare with the theoretical rate and use fixed buffer thresholds
+  this ignores lost frames, and frames which carry less than a full payload, and the
+  buffer thresholds mean a different delay in each mode
+  instead we keep a small model of the link, updated at 10 Hz:
+  - arrival rate = bytes taken out of the queue + change of the queue filling, filtered
+  - capacity = theoretical rate * LQ of our frames as reported by the Tx, or, if the queue
+    didn't run empty, the bytes which were actually taken out, filtered
+  - queue delay = queue filling / capacity
+  txbuf is chosen such as to keep the arrival rate at 65%..85% of the capacity, and the
+  queue delay below 100 ms, with a hard slow down above 250 ms
+  RADIO_STATUS is send at 1 Hz, and at 5 Hz while the delay is above 100 ms, since the
+  autopilot adapts the rates in steps for each RADIO_STATUS
+
 
 -------------------------------------------------------
 some experimental results
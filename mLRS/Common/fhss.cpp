@@ -8,6 +8,7 @@
 //*******************************************************
 
 #include <stdint.h>
+#include <string.h>
 #include "fhss.h"
 
 
@@ -63,11 +64,7 @@ void tFhssBase::generate(uint32_t seed)
         }
 
         // do not pick a bind channel
-        bool is_bind_channel = false;
-        for (uint8_t bi = 0; bi < BIND_CHANNEL_LIST_LEN; bi++) {
-            if (ch == fhss_bind_channel_list[bi]) is_bind_channel = true;
-        }
-        if (is_bind_channel) continue;
+        if (is_bind_channel(ch)) continue;
 
         // ensure it is not too close to the previous
         // do only if we have plenty of channels at our disposal
@@ -144,35 +141,10 @@ void tFhssBase::generate_ortho_except(uint32_t seed, uint8_t ortho, uint8_t exce
         uint8_t ch = ch_eff * ch_inc + ch_ofs; // that's the true channel
 
         // do not pick a bind channel
-        bool is_bind_channel = false;
-        for (uint8_t bi = 0; bi < BIND_CHANNEL_LIST_LEN; bi++) {
-            if (ch == fhss_bind_channel_list[bi]) is_bind_channel = true;
-        }
-        if (is_bind_channel) continue;
+        if (is_bind_channel(ch)) continue;
 
         // do not pick a channel in an excepted wifi band
-        // https://en.wikipedia.org/wiki/List_of_WLAN_channels
-#ifdef FHSS_HAS_CONFIG_2P4_GHZ
-        uint32_t freq = fhss_freq_list[ch];
-        switch (_except) {
-        case FHSS_EXCEPT_2P4_GHZ_WIFIBAND_1:
-            // #1, 2.412 GHz +- 11 MHz = ]0 , 17[
-            if (SX1280_FREQ_GHZ_TO_REG(2.401) <= freq && freq <= SX1280_FREQ_GHZ_TO_REG(2.423)) continue;
-            break;
-        case FHSS_EXCEPT_2P4_GHZ_WIFIBAND_6:
-            // #6, 2.437 GHz +- 11 MHz = ]20 , 42[
-            if (SX1280_FREQ_GHZ_TO_REG(2.426) <= freq && freq <= SX1280_FREQ_GHZ_TO_REG(2.448)) continue;
-            break;
-        case FHSS_EXCEPT_2P4_GHZ_WIFIBAND_11:
-            // #11, 2.462 GHz +- 11 MHz = ]45 , 67[
-            if (SX1280_FREQ_GHZ_TO_REG(2.451) <= freq && freq <= SX1280_FREQ_GHZ_TO_REG(2.473)) continue;
-            break;
-        case FHSS_EXCEPT_2P4_GHZ_WIFIBAND_13:
-            // #13, 2.472 GHz +- 11 MHz = ]55, 67[
-            if (SX1280_FREQ_GHZ_TO_REG(2.461) <= freq && freq <= SX1280_FREQ_GHZ_TO_REG(2.483)) continue;
-            break;
-        }
-#endif
+        if (is_except_channel(ch)) continue;
 
         // ensure it is not too close to the previous
         bool is_too_close = false;
@@ -207,3 +179,171 @@ void tFhssBase::generate_ortho_except(uint32_t seed, uint8_t ortho, uint8_t exce
     }
 }
 
+
+
+bool tFhssBase::is_bind_channel(uint8_t ch)
+{
+    for (uint8_t bi = 0; bi < BIND_CHANNEL_LIST_LEN; bi++) {
+        if (ch == fhss_bind_channel_list[bi]) return true;
+    }
+    return false;
+}
+
+
+// https://en.wikipedia.org/wiki/List_of_WLAN_channels
+bool tFhssBase::is_except_channel(uint8_t ch)
+{
+#ifdef FHSS_HAS_CONFIG_2P4_GHZ
+    uint32_t freq = fhss_freq_list[ch];
+    switch (_except) {
+    case FHSS_EXCEPT_2P4_GHZ_WIFIBAND_1:
+        // #1, 2.412 GHz +- 11 MHz = ]0 , 17[
+        if (SX1280_FREQ_GHZ_TO_REG(2.401) <= freq && freq <= SX1280_FREQ_GHZ_TO_REG(2.423)) return true;
+        break;
+    case FHSS_EXCEPT_2P4_GHZ_WIFIBAND_6:
+        // #6, 2.437 GHz +- 11 MHz = ]20 , 42[
+        if (SX1280_FREQ_GHZ_TO_REG(2.426) <= freq && freq <= SX1280_FREQ_GHZ_TO_REG(2.448)) return true;
+        break;
+    case FHSS_EXCEPT_2P4_GHZ_WIFIBAND_11:
+        // #11, 2.462 GHz +- 11 MHz = ]45 , 67[
+        if (SX1280_FREQ_GHZ_TO_REG(2.451) <= freq && freq <= SX1280_FREQ_GHZ_TO_REG(2.473)) return true;
+        break;
+    case FHSS_EXCEPT_2P4_GHZ_WIFIBAND_13:
+        // #13, 2.472 GHz +- 11 MHz = ]55, 67[
+        if (SX1280_FREQ_GHZ_TO_REG(2.461) <= freq && freq <= SX1280_FREQ_GHZ_TO_REG(2.483)) return true;
+        break;
+    }
+#endif
+    return false;
+}
+
+
+//-------------------------------------------------------
+// Channel statistics
+//-------------------------------------------------------
+
+void tFhssBase::channel_stats_clear(void)
+{
+    memset(ch_stats, 0, sizeof(ch_stats));
+    for (uint8_t k = 0; k < FHSS_MAX_NUM; k++) {
+        ch_stats[k].rssi = INT8_MIN;
+        ch_stats[k].snr = INT8_MIN;
+    }
+    memset(ch_blacklist, 0, sizeof(ch_blacklist));
+    is_modified = false;
+    swap_cnt = 0;
+}
+
+
+void tFhssBase::ChannelStatsUpdate(bool received, bool valid, bool other_valid, int8_t rssi, int8_t snr)
+{
+    if (is_in_binding || curr_i >= cnt) return;
+
+    tFhssChannelStats* s = &(ch_stats[curr_i]);
+
+    s->visits++;
+    if (!received) {
+        s->missed++;
+    } else
+    if (!valid) {
+        s->crc_errors++;
+    } else {
+        if (!other_valid) s->other_missed++;
+        // running average, with weight 1/4 for the new value
+        s->rssi = (s->rssi == INT8_MIN) ? rssi : (int8_t)(((int16_t)3 * s->rssi + rssi) / 4);
+        s->snr = (s->snr == INT8_MIN) ? snr : (int8_t)(((int16_t)3 * s->snr + snr) / 4);
+        fhss_last_rssi[curr_i] = rssi;
+    }
+
+    if (s->visits < FHSS_STATS_WINDOW) return;
+
+    // window completed, evaluate
+
+    s->errors_last = s->missed + s->crc_errors + s->other_missed;
+    s->visits = 0;
+    s->missed = 0;
+    s->crc_errors = 0;
+    s->other_missed = 0;
+
+    // compare to the other channels, if all are bad it is not the channel's fault
+    uint16_t errors_sum = 0;
+    for (uint8_t k = 0; k < cnt; k++) {
+        if (k != curr_i) errors_sum += ch_stats[k].errors_last;
+    }
+    uint8_t errors_avg = (cnt > 1) ? errors_sum / (cnt - 1) : 0;
+
+    if (s->errors_last >= FHSS_STATS_BAD_ERRORS && s->errors_last >= 2 * errors_avg + 2) {
+        if (s->bad_windows < UINT8_MAX) s->bad_windows++;
+    } else {
+        s->bad_windows = 0;
+    }
+}
+
+
+uint8_t tFhssBase::FindBadChannel(void)
+{
+    uint8_t i_bad = UINT8_MAX;
+
+    for (uint8_t k = 0; k < cnt; k++) {
+        if (ch_stats[k].bad_windows < FHSS_STATS_BAD_WINDOWS) continue;
+        if (i_bad == UINT8_MAX || ch_stats[k].errors_last > ch_stats[i_bad].errors_last) i_bad = k;
+    }
+
+    return i_bad;
+}
+
+
+uint8_t tFhssBase::FindSpareChannel(uint8_t i)
+{
+    if (i >= cnt) return UINT8_MAX;
+
+    // with ortho we must stay in the same third of channels
+    uint8_t ch_inc = (_ortho >= FHSS_ORTHO_1_3 && _ortho <= FHSS_ORTHO_3_3) ? 3 : 1;
+    uint8_t freq_len = (FREQ_LIST_LEN / ch_inc) * ch_inc;
+
+    uint8_t ch_prev = ch_list[(i > 0) ? i - 1 : cnt - 1];
+    uint8_t ch_next = ch_list[(i < cnt - 1) ? i + 1 : 0];
+
+    // start half the band away, a disturbance is likely to also affect the neighbors
+    uint8_t ch = (ch_list[i] + (freq_len / 2 / ch_inc) * ch_inc) % freq_len;
+
+    for (uint8_t n = 0; n < freq_len / ch_inc; n++) {
+        bool ok = true;
+
+        if (ch_blacklist[ch / 8] & (1 << (ch % 8))) ok = false;
+        if (is_bind_channel(ch) || is_except_channel(ch)) ok = false;
+        for (uint8_t k = 0; k < cnt; k++) {
+            if (ch_list[k] == ch) ok = false;
+        }
+        // ensure it is not too close to the neighbors
+        if (ch + ch_inc >= ch_prev && ch <= ch_prev + ch_inc) ok = false;
+        if (ch + ch_inc >= ch_next && ch <= ch_next + ch_inc) ok = false;
+
+        if (ok) return ch;
+
+        ch += ch_inc;
+        if (ch >= freq_len) ch -= freq_len;
+    }
+
+    return UINT8_MAX;
+}
+
+
+bool tFhssBase::ReplaceChannel(uint8_t i, uint8_t ch)
+{
+    if (i >= cnt || ch >= FREQ_LIST_LEN) return false; // play it safe
+    if (is_bind_channel(ch)) return false;
+
+    ch_blacklist[ch_list[i] / 8] |= (1 << (ch_list[i] % 8));
+
+    ch_list[i] = ch;
+    fhss_list[i] = fhss_freq_list[ch];
+
+    memset(&(ch_stats[i]), 0, sizeof(tFhssChannelStats));
+    ch_stats[i].rssi = INT8_MIN;
+    ch_stats[i].snr = INT8_MIN;
+    fhss_last_rssi[i] = INT8_MIN;
+
+    is_modified = true;
+    return true;
+}
@@ -421,6 +421,33 @@ const tFhssConfig fhss_config[] = {
 };
 
 
+//-------------------------------------------------------
+// Channel statistics
+//-------------------------------------------------------
+// The statistics are kept per index of the hop list. An index is evaluated each time it
+// has been visited FHSS_STATS_WINDOW times. It is bad if it had clearly more errors than
+// the average of the other indices, and it needs to be bad for FHSS_STATS_BAD_WINDOWS
+// windows in a row before its channel is replaced by a spare channel.
+
+#define FHSS_STATS_WINDOW         16 // number of visits after which an index is evaluated
+#define FHSS_STATS_BAD_ERRORS     6 // minimum number of errors in a window to be bad
+#define FHSS_STATS_BAD_WINDOWS    2 // number of bad windows in a row to get replaced
+#define FHSS_SWAP_CNT             8 // number of frames a swap is announced in advance
+
+
+typedef struct
+{
+    uint8_t visits;
+    uint8_t missed; // no frame received
+    uint8_t crc_errors; // frame received, but not valid
+    uint8_t other_missed; // the other side reported that it didn't get our frame
+    uint8_t errors_last; // errors in the last completed window
+    uint8_t bad_windows; // number of bad windows in a row
+    int8_t rssi; // average rssi of valid frames
+    int8_t snr; // average snr of valid frames
+} tFhssChannelStats;
+
+
 class tFhssBase
 {
   public:
@@ -514,6 +541,8 @@ class tFhssBase
         is_in_binding = false;
 
         curr_i = 0;
+
+        channel_stats_clear();
     }
 
     void Start(void)
@@ -592,6 +621,50 @@ class tFhssBase
         return 0;
     }
 
+    //-- channel statistics and replacement
+
+    // to be called once per frame when connected, for the current index
+    // other_valid tells if the other side got our frame in this slot, should be true if not known
+    void ChannelStatsUpdate(bool received, bool valid, bool other_valid, int8_t rssi, int8_t snr);
+
+    const tFhssChannelStats* ChannelStats(uint8_t i) { return &(ch_stats[i]); }
+
+    // returns the index of the worst bad channel, or UINT8_MAX if there is none
+    uint8_t FindBadChannel(void);
+
+    // returns a spare channel for index i, or UINT8_MAX if there is none
+    uint8_t FindSpareChannel(uint8_t i);
+
+    bool ReplaceChannel(uint8_t i, uint8_t ch);
+
+    // the hop list differs from what Init() generated
+    bool IsModified(void) { return is_modified; }
+
+    // a swap is agreed on by counting down the frames until it is done
+    void ScheduleSwap(uint8_t i, uint8_t ch, uint8_t frame_cnt)
+    {
+        if (!frame_cnt || i >= cnt) return; // not a valid request
+        swap_i = i;
+        swap_ch = ch;
+        swap_cnt = frame_cnt;
+    }
+
+    void CancelSwap(void) { swap_cnt = 0; }
+    bool SwapPending(void) { return (swap_cnt > 0); }
+    uint8_t SwapI(void) { return swap_i; }
+    uint8_t SwapCh(void) { return swap_ch; }
+    uint8_t SwapCnt(void) { return swap_cnt; }
+
+    // to be called once per frame before hopping, returns true when the swap was due
+    bool TickSwap(void)
+    {
+        if (!swap_cnt) return false;
+        swap_cnt--;
+        if (swap_cnt) return false;
+        ReplaceChannel(swap_i, swap_ch);
+        return true;
+    }
+
     uint32_t bestX(void)
     {
         uint8_t i_best = 0;
@@ -621,6 +694,14 @@ class tFhssBase
 
     int8_t fhss_last_rssi[FHSS_MAX_NUM];
 
+    tFhssChannelStats ch_stats[FHSS_MAX_NUM];
+    uint8_t ch_blacklist[(FHSS_FREQ_LIST_MAX_LEN + 7) / 8]; // channels which were replaced
+    bool is_modified;
+
+    uint8_t swap_i;
+    uint8_t swap_ch;
+    uint8_t swap_cnt;
+
     bool is_in_binding;
     uint8_t curr_bind_config_i;
     uint16_t bind_listen_cnt;
@@ -629,6 +710,9 @@ class tFhssBase
     uint16_t prng(void);
     void generate(uint32_t seed);
     void generate_ortho_except(uint32_t seed, uint8_t ortho, uint8_t except);
+    bool is_bind_channel(uint8_t ch);
+    bool is_except_channel(uint8_t ch);
+    void channel_stats_clear(void);
 };
 
 
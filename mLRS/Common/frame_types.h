@@ -43,6 +43,8 @@ typedef struct
     uint8_t LQ_serial_data;
     uint8_t antenna;
     uint8_t transmit_antenna;
+    uint8_t valid_received;
+    uint8_t downlink;
 } tFrameStats;
 
 
@@ -64,7 +66,8 @@ typedef struct
     uint32_t LQ : 7; // only Rx->Tx frame, not Tx->Rx
     uint32_t LQ_serial_data : 7;
     uint32_t transmit_antenna : 1;
-    uint32_t spare : 2;
+    uint32_t valid_received : 1; // only Rx->Tx frame, the Tx frame of this slot was received
+    uint32_t downlink : 1; // Tx->Rx frame: the next slot is a downlink slot, Rx->Tx frame: downlink slots are requested
     uint32_t payload_len : 7;
 }) tFrameStatus;
 
@@ -144,9 +147,12 @@ typedef struct
     uint8_t FrequencyBand_XXX : 4; // TODO
     uint8_t Mode : 4;
     uint8_t Ortho : 4;
-
+    uint8_t Fec : 4;
+    uint8_t RateAdapt : 4;
+    uint8_t ShortFrames : 4;
+    uint8_t RcCoding : 4;
     uint8_t spare1 : 4;
-    uint8_t spare2[71];
+    uint8_t spare2[69];
 
     uint16_t crc; // 2 bytes
 }) tTxBindFrame; // 91 bytes
@@ -188,6 +194,10 @@ typedef enum {
     FRAME_CMD_SET_RX_PARAMS,            // tx -> rx, set parameters -> response with RX_SETUPDATA
     FRAME_CMD_STORE_RX_PARAMS,          // tx -> rx, store parameters, reboots
     FRAME_CMD_GET_RX_SETUPDATA_WRELOAD, // tx -> rx, reload parameters -> response with RX_SETUPDATA
+    FRAME_CMD_SWITCH_MODE,              // tx -> rx, switch to another mode after cnt frames, no response
+    FRAME_CMD_FHSS_SWAP,                // tx -> rx, replace the channel of a fhss index after cnt frames, no response
+    FRAME_CMD_GET_RX_TRACE,             // tx -> rx, ask for a latency histogram -> response with RX_TRACE
+    FRAME_CMD_RX_TRACE,                 // rx -> tx, return the latency histogram
 } FRAME_CMD_ENUM;
 
 
@@ -209,9 +219,11 @@ typedef struct
     uint8_t SendRcChannels : 4;
     uint8_t __RadioStatusMethod : 4; // deprecated
     uint8_t OutLqChannelMode : 4;
+    uint8_t SerialArq : 4;
+    uint8_t OutRate : 4;
+    uint8_t OutSmoothing : 4;
 
-    uint8_t spare : 4;
-    uint8_t spare2[4];
+    uint8_t spare2[3];
 
     int8_t FailsafeOutChannelValues_Ch1_Ch12[12]; // -120 .. +120
     uint8_t FailsafeOutChannelValue_Ch13 : 2;
@@ -266,9 +278,11 @@ typedef struct
     uint8_t FrequencyBand : 4;
     uint8_t Mode : 4;
     uint8_t Ortho : 4;
-
+    uint8_t Fec : 4;
+    uint8_t RateAdapt : 4;
+    uint8_t ShortFrames : 4;
+    uint8_t RcCoding : 4;
     uint8_t spare1 : 4;
-    uint8_t spare2[2];
 
     tCmdFrameRxParameters RxParams; // 24 bytes
 
@@ -276,6 +290,52 @@ typedef struct
 }) tTxCmdFrameRxParams; // 64 bytes
 
 
+// send from Tx to do SWITCH_MODE
+// is repeated in each frame until the switch, with cnt counting down
+PACKED(
+typedef struct
+{
+    uint8_t cmd;
+    uint8_t mode;
+    uint8_t cnt; // number of frames after this frame at which the new mode is used
+}) tTxCmdFrameSwitchMode; // 3 bytes
+
+
+// send from Tx to do FHSS_SWAP
+// is repeated in each frame until the swap, with cnt counting down
+PACKED(
+typedef struct
+{
+    uint8_t cmd;
+    uint8_t i; // index in the hop list
+    uint8_t ch; // new channel
+    uint8_t cnt; // number of frames after this frame at which the new channel is used
+}) tTxCmdFrameFhssSwap; // 4 bytes
+
+
+// send from Tx to do GET_RX_TRACE
+PACKED(
+typedef struct
+{
+    uint8_t cmd;
+    uint8_t mode;
+    uint8_t path; // LATENCY_TRACE_RC, LATENCY_TRACE_SERIAL
+}) tTxCmdFrameGetRxTrace; // 3 bytes
+
+
+// send from Rx as response to GET_RX_TRACE
+PACKED(
+typedef struct
+{
+    uint8_t cmd;
+    uint8_t mode;
+    uint8_t path;
+    uint32_t bin_us; // 0 if the Rx has no histogram for this mode
+    uint16_t cnt[16]; // = LATENCY_TRACE_BIN_NUM
+    uint8_t frac[16];
+}) tRxCmdFrameRxTrace; // 55 bytes
+
+
 // for type casting to get the header
 PACKED(
 typedef struct
@@ -12,16 +12,51 @@
 
 
 #include "frame_types.h"
+#include "frame_crc.h"
+#include "fec.h"
+#include "rc_coding.h"
+#include "latency_trace.h"
 
 
 extern SX_DRIVER sx;
 extern SX2_DRIVER sx2;
+extern tRcCoding rc_coding;
+extern tLatencyTrace latency_trace;
 
 
 //-------------------------------------------------------
 // Tx, Rx Frames
 //-------------------------------------------------------
 
+// with fec the parity takes the tail of the payload
+#define FRAME_TX_PAYLOAD_LEN_USABLE  ((Config.UseFec) ? FRAME_TX_PAYLOAD_LEN - FEC_PARITY_LEN : FRAME_TX_PAYLOAD_LEN)
+#define FRAME_RX_PAYLOAD_LEN_USABLE  ((Config.UseFec) ? FRAME_RX_PAYLOAD_LEN - FEC_PARITY_LEN : FRAME_RX_PAYLOAD_LEN)
+
+// with short frames the frame ends right after the payload, and the crc is moved to there
+// the frame length thus follows from the payload_len field, which is covered by crc1 for Tx frames
+// for full length frames this is the normal frame layout
+#define FRAME_TX_LEN_MIN  (FRAME_TX_RX_LEN - FRAME_TX_PAYLOAD_LEN) // 27 bytes
+#define FRAME_RX_LEN_MIN  (FRAME_TX_RX_LEN - FRAME_RX_PAYLOAD_LEN) // 9 bytes
+
+// with fec the parity is added after the crc is calculated, so the crc must not cover it
+// cmd frames carry no parity
+#define FRAME_CRC_SKIP_PARITY(type)  ((Config.UseFec && (type) != FRAME_TYPE_TX_RX_CMD) ? FEC_PARITY_LEN : 0)
+
+
+uint8_t txframe_len(tTxFrame* frame)
+{
+    if (!Config.UseShortFrames || frame->status.payload_len > FRAME_TX_PAYLOAD_LEN) return FRAME_TX_RX_LEN;
+    return FRAME_TX_LEN_MIN + frame->status.payload_len;
+}
+
+
+uint8_t rxframe_len(tRxFrame* frame)
+{
+    if (!Config.UseShortFrames || frame->status.payload_len > FRAME_RX_PAYLOAD_LEN) return FRAME_TX_RX_LEN;
+    return FRAME_RX_LEN_MIN + frame->status.payload_len;
+}
+
+
 typedef enum {
     CHECK_OK = 0,
     CHECK_ERROR_SYNCWORD, // 1
@@ -37,7 +72,9 @@ uint16_t crc;
 
     if (payload_len > FRAME_TX_PAYLOAD_LEN) payload_len = FRAME_TX_PAYLOAD_LEN; // should never occur, but play it safe
 
-    memset(frame, 0, sizeof(tTxFrame));
+    // the payload may already be in place, so we only clear what comes before and after it
+    memset(frame, 0, frame->payload - (uint8_t*)frame);
+    memset(frame->payload + payload_len, 0, FRAME_TX_PAYLOAD_LEN - payload_len);
 
     // generate header
     frame->sync_word = Config.FrameSyncWord;
@@ -49,55 +86,65 @@ uint16_t crc;
     frame->status.rssi_u7 = rssi_u7_from_i8(frame_stats->rssi);
     frame->status.LQ = frame_stats->LQ;
     frame->status.LQ_serial_data = frame_stats->LQ_serial_data;
+    frame->status.valid_received = frame_stats->valid_received;
+    frame->status.downlink = frame_stats->downlink;
     frame->status.payload_len = payload_len;
 
     // pack rc data
     // rcData: 0 .. 1024 .. 2047, 11 bits
-    frame->rc1.ch0  = rc->ch[0]; // 0 .. 1024 .. 2047, 11 bits
-    frame->rc1.ch1  = rc->ch[1];
-    frame->rc1.ch2  = rc->ch[2];
-    frame->rc1.ch3  = rc->ch[3];
-
-    frame->rc2.ch4  = rc->ch[4]; // 0 .. 1024 .. 2047, 11 bits
-    frame->rc2.ch5  = rc->ch[5];
-    frame->rc2.ch6  = rc->ch[6];
-    frame->rc2.ch7  = rc->ch[7];
-
-    frame->rc2.ch8  = rc->ch[8] / 8; // 0 .. 128 .. 255, 8 bits
-    frame->rc2.ch9  = rc->ch[9] / 8;
-    frame->rc2.ch10 = rc->ch[10] / 8;
-    frame->rc2.ch11 = rc->ch[11] / 8;
-
-    frame->rc1.ch12 = (rc->ch[12] >= 1536) ? 2 : ((rc->ch[12] <= 512) ? 0 : 1); // 0 .. 1 .. 2, bits, 3-way
-    frame->rc1.ch13 = (rc->ch[13] >= 1536) ? 2 : ((rc->ch[13] <= 512) ? 0 : 1);
-    frame->rc2.ch14 = (rc->ch[14] >= 1536) ? 2 : ((rc->ch[14] <= 512) ? 0 : 1);
-    frame->rc2.ch15 = (rc->ch[15] >= 1536) ? 2 : ((rc->ch[15] <= 512) ? 0 : 1);
-
-    // pack the payload
-    for (uint8_t i = 0; i < payload_len; i++) {
-        frame->payload[i] = payload[i];
+    if (Config.UseRcDelta) {
+        rc_coding.Encode(frame, rc);
+    } else {
+        frame->rc1.ch0  = rc->ch[0]; // 0 .. 1024 .. 2047, 11 bits
+        frame->rc1.ch1  = rc->ch[1];
+        frame->rc1.ch2  = rc->ch[2];
+        frame->rc1.ch3  = rc->ch[3];
+
+        frame->rc2.ch4  = rc->ch[4]; // 0 .. 1024 .. 2047, 11 bits
+        frame->rc2.ch5  = rc->ch[5];
+        frame->rc2.ch6  = rc->ch[6];
+        frame->rc2.ch7  = rc->ch[7];
+
+        frame->rc2.ch8  = rc->ch[8] / 8; // 0 .. 128 .. 255, 8 bits
+        frame->rc2.ch9  = rc->ch[9] / 8;
+        frame->rc2.ch10 = rc->ch[10] / 8;
+        frame->rc2.ch11 = rc->ch[11] / 8;
+
+        frame->rc1.ch12 = (rc->ch[12] >= 1536) ? 2 : ((rc->ch[12] <= 512) ? 0 : 1); // 0 .. 1 .. 2, bits, 3-way
+        frame->rc1.ch13 = (rc->ch[13] >= 1536) ? 2 : ((rc->ch[13] <= 512) ? 0 : 1);
+        frame->rc2.ch14 = (rc->ch[14] >= 1536) ? 2 : ((rc->ch[14] <= 512) ? 0 : 1);
+        frame->rc2.ch15 = (rc->ch[15] >= 1536) ? 2 : ((rc->ch[15] <= 512) ? 0 : 1);
     }
 
+    // pack the payload, nothing to do if it was read in place
+    if (payload != frame->payload) memcpy(frame->payload, payload, payload_len);
+
     // finalize, crc
-    fmav_crc_init(&crc);
-    fmav_crc_accumulate_buf(&crc, (uint8_t*)frame, FRAME_TX_RX_HEADER_LEN + FRAME_TX_RCDATA1_LEN);
+    frame_crc_init(&crc);
+    frame_crc_accumulate_buf(&crc, (uint8_t*)frame, FRAME_TX_RX_HEADER_LEN + FRAME_TX_RCDATA1_LEN);
     frame->crc1 = crc;
 
-    fmav_crc_accumulate_buf(&crc, (uint8_t*)frame + FRAME_TX_RX_HEADER_LEN + FRAME_TX_RCDATA1_LEN, FRAME_TX_RX_LEN - FRAME_TX_RX_HEADER_LEN - FRAME_TX_RCDATA1_LEN - 2);
-    frame->crc = crc;
+    uint8_t len = txframe_len(frame);
+    uint8_t crc_len = len - 2 - FRAME_CRC_SKIP_PARITY(type);
+    frame_crc_accumulate_buf(&crc, (uint8_t*)frame + FRAME_TX_RX_HEADER_LEN + FRAME_TX_RCDATA1_LEN, crc_len - FRAME_TX_RX_HEADER_LEN - FRAME_TX_RCDATA1_LEN);
+    memcpy((uint8_t*)frame + len - 2, &crc, 2); // is frame->crc for full length frames
 }
 
 
 void pack_txframe(tTxFrame* frame, tFrameStats* frame_stats, tRcData* rc, uint8_t* payload, uint8_t payload_len)
 {
+    if (payload_len > FRAME_TX_PAYLOAD_LEN_USABLE) payload_len = FRAME_TX_PAYLOAD_LEN_USABLE; // should never occur, but play it safe
+
     _pack_txframe_w_type(frame, FRAME_TYPE_TX, frame_stats, rc, payload, payload_len);
+
+    if (Config.UseFec) fec_encode_frame((uint8_t*)frame);
 }
 
 
 // returns 0 if OK !!
 uint8_t check_txframe(tTxFrame* frame)
 {
-uint16_t crc;
+uint16_t crc, frame_crc;
 
     if (frame->sync_word != Config.FrameSyncWord) return CHECK_ERROR_SYNCWORD;
 
@@ -107,12 +154,15 @@ uint16_t crc;
 
     if (frame->status.payload_len > FRAME_TX_PAYLOAD_LEN) return CHECK_ERROR_HEADER;
 
-    fmav_crc_init(&crc);
-    fmav_crc_accumulate_buf(&crc, (uint8_t*)frame, FRAME_TX_RX_HEADER_LEN + FRAME_TX_RCDATA1_LEN);
+    frame_crc_init(&crc);
+    frame_crc_accumulate_buf(&crc, (uint8_t*)frame, FRAME_TX_RX_HEADER_LEN + FRAME_TX_RCDATA1_LEN);
     if (crc != frame->crc1) return CHECK_ERROR_CRC1;
 
-    fmav_crc_accumulate_buf(&crc, (uint8_t*)frame + FRAME_TX_RX_HEADER_LEN + FRAME_TX_RCDATA1_LEN, FRAME_TX_RX_LEN - FRAME_TX_RX_HEADER_LEN - FRAME_TX_RCDATA1_LEN - 2);
-    if (crc != frame->crc) return CHECK_ERROR_CRC;
+    uint8_t len = txframe_len(frame);
+    uint8_t crc_len = len - 2 - FRAME_CRC_SKIP_PARITY(frame->status.frame_type);
+    frame_crc_accumulate_buf(&crc, (uint8_t*)frame + FRAME_TX_RX_HEADER_LEN + FRAME_TX_RCDATA1_LEN, crc_len - FRAME_TX_RX_HEADER_LEN - FRAME_TX_RCDATA1_LEN);
+    memcpy(&frame_crc, (uint8_t*)frame + len - 2, 2);
+    if (crc != frame_crc) return CHECK_ERROR_CRC;
 
     return CHECK_OK;
 }
@@ -120,6 +170,11 @@ uint16_t crc;
 
 void rcdata_rc1_from_txframe(tRcData* rc, tTxFrame* frame)
 {
+    if (Config.UseRcDelta) { // only channels 1-4
+        rc_coding.DecodeRc1(rc, frame);
+        return;
+    }
+
     rc->ch[0] = frame->rc1.ch0;
     rc->ch[1] = frame->rc1.ch1;
     rc->ch[2] = frame->rc1.ch2;
@@ -132,6 +187,13 @@ void rcdata_rc1_from_txframe(tRcData* rc, tTxFrame* frame)
 
 void rcdata_from_txframe(tRcData* rc, tTxFrame* frame)
 {
+    if (Config.UseRcDelta) {
+        rc_coding.Decode(rc, frame);
+        rc->ch[16] = 1024;
+        rc->ch[17] = 1024;
+        return;
+    }
+
     rc->ch[0] = frame->rc1.ch0;
     rc->ch[1] = frame->rc1.ch1;
     rc->ch[2] = frame->rc1.ch2;
@@ -163,7 +225,8 @@ uint16_t crc;
 
     if (payload_len > FRAME_RX_PAYLOAD_LEN) payload_len = FRAME_RX_PAYLOAD_LEN; // should never occur, but play it safe
 
-    memset(frame, 0, sizeof(tRxFrame));
+    memset(frame, 0, frame->payload - (uint8_t*)frame);
+    memset(frame->payload + payload_len, 0, FRAME_RX_PAYLOAD_LEN - payload_len);
 
     frame->sync_word = Config.FrameSyncWord;
     frame->status.seq_no = frame_stats->seq_no;
@@ -174,27 +237,32 @@ uint16_t crc;
     frame->status.rssi_u7 = rssi_u7_from_i8(frame_stats->rssi);
     frame->status.LQ = frame_stats->LQ;
     frame->status.LQ_serial_data = frame_stats->LQ_serial_data;
+    frame->status.valid_received = frame_stats->valid_received;
+    frame->status.downlink = frame_stats->downlink;
     frame->status.payload_len = payload_len;
 
-    for (uint8_t i = 0; i < payload_len; i++) {
-        frame->payload[i] = payload[i];
-    }
+    if (payload != frame->payload) memcpy(frame->payload, payload, payload_len);
 
-    fmav_crc_init(&crc);
-    fmav_crc_accumulate_buf(&crc, (uint8_t*)frame, FRAME_TX_RX_LEN - 2);
-    frame->crc = crc;
+    uint8_t len = rxframe_len(frame);
+    frame_crc_init(&crc);
+    frame_crc_accumulate_buf(&crc, (uint8_t*)frame, len - 2 - FRAME_CRC_SKIP_PARITY(type));
+    memcpy((uint8_t*)frame + len - 2, &crc, 2); // is frame->crc for full length frames
 }
 
 
 void pack_rxframe(tRxFrame* frame, tFrameStats* frame_stats, uint8_t* payload, uint8_t payload_len)
 {
+    if (payload_len > FRAME_RX_PAYLOAD_LEN_USABLE) payload_len = FRAME_RX_PAYLOAD_LEN_USABLE; // should never occur, but play it safe
+
     _pack_rxframe_w_type(frame, FRAME_TYPE_RX, frame_stats, payload, payload_len);
+
+    if (Config.UseFec) fec_encode_frame((uint8_t*)frame);
 }
 
 // returns 0 if OK !!
 uint8_t check_rxframe(tRxFrame* frame)
 {
-uint16_t crc;
+uint16_t crc, frame_crc;
 
     if (frame->sync_word != Config.FrameSyncWord) return CHECK_ERROR_SYNCWORD;
 
@@ -204,14 +272,92 @@ uint16_t crc;
 
     if (frame->status.payload_len > FRAME_RX_PAYLOAD_LEN) return CHECK_ERROR_HEADER;
 
-    fmav_crc_init(&crc);
-    fmav_crc_accumulate_buf(&crc, (uint8_t*)frame, FRAME_TX_RX_LEN - 2);
-    if (crc != frame->crc) return CHECK_ERROR_CRC;
+    uint8_t len = rxframe_len(frame);
+    frame_crc_init(&crc);
+    frame_crc_accumulate_buf(&crc, (uint8_t*)frame, len - 2 - FRAME_CRC_SKIP_PARITY(frame->status.frame_type));
+    memcpy(&frame_crc, (uint8_t*)frame + len - 2, 2);
+    if (crc != frame_crc) return CHECK_ERROR_CRC;
 
     return CHECK_OK;
 }
 
 
+//-------------------------------------------------------
+// Frame Combining
+//-------------------------------------------------------
+// When both antennas got a corrupted frame, the errors are usually at different positions.
+// The bytes in which the two copies differ are grouped into runs, and all mixes of the runs
+// are checked against the crc. The number of runs is limited, to bound the number of checks.
+// Only for diversity, as it needs the two copies.
+// Each check can pass wrongly with 2^-16, so up to 14 checks make a wrong frame much more likely
+// than for a normal frame. The receiver therefore does not take the rc data from a combined frame.
+
+#define FRAME_COMBINE_RUNS_MAX    4 // gives 14 checks at most
+#define FRAME_COMBINE_RUNS_GAP    2 // runs separated by less identical bytes are merged
+
+// returns true if a valid frame was found, it is then in frame
+bool _combine_frames(uint8_t* frame, uint8_t* frame2, bool is_txframe)
+{
+uint8_t run_start[FRAME_COMBINE_RUNS_MAX];
+uint8_t run_end[FRAME_COMBINE_RUNS_MAX];
+uint8_t runs_num = 0;
+uint8_t buf[FRAME_TX_RX_LEN];
+uint8_t len, len2;
+
+    // with short frames the bytes after the end are stale, so we don't look at them
+    if (is_txframe) {
+        len = txframe_len((tTxFrame*)frame);
+        len2 = txframe_len((tTxFrame*)frame2);
+    } else {
+        len = rxframe_len((tRxFrame*)frame);
+        len2 = rxframe_len((tRxFrame*)frame2);
+    }
+    if (len2 > len) len = len2;
+
+    for (uint8_t n = 0; n < len; n++) {
+        if (frame[n] == frame2[n]) continue;
+        if (runs_num && (n - run_end[runs_num - 1]) <= FRAME_COMBINE_RUNS_GAP) {
+            run_end[runs_num - 1] = n; // extend the current run
+            continue;
+        }
+        if (runs_num >= FRAME_COMBINE_RUNS_MAX) return false; // too many, give up
+        run_start[runs_num] = run_end[runs_num] = n;
+        runs_num++;
+    }
+
+    if (runs_num < 2) return false; // nothing to mix, a single run is either frame or frame2
+
+    // mask = 0 and mask = all are the original frames, so skip them
+    uint8_t mask_all = (1 << runs_num) - 1;
+    for (uint8_t mask = 1; mask < mask_all; mask++) {
+        memcpy(buf, frame, FRAME_TX_RX_LEN);
+        for (uint8_t r = 0; r < runs_num; r++) {
+            if (!(mask & (1 << r))) continue;
+            memcpy(&(buf[run_start[r]]), &(frame2[run_start[r]]), run_end[r] - run_start[r] + 1);
+        }
+
+        uint8_t res = (is_txframe) ? check_txframe((tTxFrame*)buf) : check_rxframe((tRxFrame*)buf);
+        if (res == CHECK_OK) {
+            memcpy(frame, buf, FRAME_TX_RX_LEN);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool combine_txframes(tTxFrame* frame, tTxFrame* frame2)
+{
+    return _combine_frames((uint8_t*)frame, (uint8_t*)frame2, true);
+}
+
+
+bool combine_rxframes(tRxFrame* frame, tRxFrame* frame2)
+{
+    return _combine_frames((uint8_t*)frame, (uint8_t*)frame2, false);
+}
+
 
 //-------------------------------------------------------
 // Tx/Rx Cmd Frames
@@ -231,6 +377,9 @@ void cmdframerxparameters_rxparams_from_rxsetup(tCmdFrameRxParameters* rx_params
     rx_params->SendRadioStatus = Setup.Rx.SendRadioStatus;
     rx_params->Buzzer = Setup.Rx.Buzzer;
     rx_params->SendRcChannels = Setup.Rx.SendRcChannels;
+    rx_params->SerialArq = Setup.Rx.SerialArq;
+    rx_params->OutRate = Setup.Rx.OutRate;
+    rx_params->OutSmoothing = Setup.Rx.OutSmoothing;
     // deprecated rx_params->RadioStatusMethod = Setup.Rx.RadioStatusMethod;
 
     for (uint8_t i = 0; i < 12; i++) {
@@ -257,6 +406,9 @@ void cmdframerxparameters_rxparams_to_rxsetup(tCmdFrameRxParameters* rx_params)
     Setup.Rx.SendRadioStatus = rx_params->SendRadioStatus;
     Setup.Rx.Buzzer = rx_params->Buzzer;
     Setup.Rx.SendRcChannels = rx_params->SendRcChannels;
+    Setup.Rx.SerialArq = rx_params->SerialArq;
+    Setup.Rx.OutRate = rx_params->OutRate;
+    Setup.Rx.OutSmoothing = rx_params->OutSmoothing;
     // deprecated Setup.Rx.RadioStatusMethod = rx_params->RadioStatusMethod;
 
     for (uint8_t i = 0; i < 12; i++) {
@@ -324,12 +476,74 @@ tTxCmdFrameRxParams rx_params = {};
     rx_params.FrequencyBand = Setup.Common[Config.ConfigId].FrequencyBand;
     rx_params.Mode = Setup.Common[Config.ConfigId].Mode;
     rx_params.Ortho = Setup.Common[Config.ConfigId].Ortho;
+    rx_params.Fec = Setup.Common[Config.ConfigId].Fec;
+    rx_params.RateAdapt = Setup.Common[Config.ConfigId].RateAdapt;
+    rx_params.ShortFrames = Setup.Common[Config.ConfigId].ShortFrames;
+    rx_params.RcCoding = Setup.Common[Config.ConfigId].RcCoding;
 
     cmdframerxparameters_rxparams_from_rxsetup(&(rx_params.RxParams));
 
     _pack_txframe_w_type(frame, FRAME_TYPE_TX_RX_CMD, frame_stats, rc, (uint8_t*)&rx_params, sizeof(rx_params));
 }
 
+
+// Tx: send FRAME_CMD_SWITCH_MODE to Rx
+void pack_txcmdframe_switchmode(tTxFrame* frame, tFrameStats* frame_stats, tRcData* rc, uint8_t mode, uint8_t cnt)
+{
+tTxCmdFrameSwitchMode switch_mode = {};
+
+    switch_mode.cmd = FRAME_CMD_SWITCH_MODE;
+    switch_mode.mode = mode;
+    switch_mode.cnt = cnt;
+
+    _pack_txframe_w_type(frame, FRAME_TYPE_TX_RX_CMD, frame_stats, rc, (uint8_t*)&switch_mode, sizeof(switch_mode));
+}
+
+
+// Tx: send FRAME_CMD_FHSS_SWAP to Rx
+void pack_txcmdframe_fhssswap(tTxFrame* frame, tFrameStats* frame_stats, tRcData* rc, uint8_t i, uint8_t ch, uint8_t cnt)
+{
+tTxCmdFrameFhssSwap fhss_swap = {};
+
+    fhss_swap.cmd = FRAME_CMD_FHSS_SWAP;
+    fhss_swap.i = i;
+    fhss_swap.ch = ch;
+    fhss_swap.cnt = cnt;
+
+    _pack_txframe_w_type(frame, FRAME_TYPE_TX_RX_CMD, frame_stats, rc, (uint8_t*)&fhss_swap, sizeof(fhss_swap));
+}
+
+
+// Tx: send FRAME_CMD_GET_RX_TRACE to Rx
+void pack_txcmdframe_getrxtrace(tTxFrame* frame, tFrameStats* frame_stats, tRcData* rc, uint8_t mode, uint8_t path)
+{
+tTxCmdFrameGetRxTrace get_rx_trace = {};
+
+    get_rx_trace.cmd = FRAME_CMD_GET_RX_TRACE;
+    get_rx_trace.mode = mode;
+    get_rx_trace.path = path;
+
+    _pack_txframe_w_type(frame, FRAME_TYPE_TX_RX_CMD, frame_stats, rc, (uint8_t*)&get_rx_trace, sizeof(get_rx_trace));
+}
+
+
+// Tx: handle FRAME_CMD_RX_TRACE from Rx
+void unpack_rxcmdframe_rxtrace(tRxFrame* frame)
+{
+tRxCmdFrameRxTrace* rx_trace = (tRxCmdFrameRxTrace*)frame->payload;
+
+    if (rx_trace->mode >= MODE_NUM || rx_trace->path >= LATENCY_TRACE_NUM) return;
+
+    latency_trace.rx_hist_mode = rx_trace->mode;
+    latency_trace.rx_hist_path = rx_trace->path;
+    latency_trace.rx_hist.bin_us = rx_trace->bin_us;
+    for (uint8_t i = 0; i < LATENCY_TRACE_BIN_NUM; i++) {
+        latency_trace.rx_hist.cnt[i] = rx_trace->cnt[i]; // to avoid unaligned warning
+        latency_trace.rx_hist.frac[i] = rx_trace->frac[i];
+    }
+    latency_trace.rx_hist_available = true;
+}
+
 #endif
 #ifdef DEVICE_IS_RECEIVER
 
@@ -386,9 +600,66 @@ tTxCmdFrameRxParams* rx_params = (tTxCmdFrameRxParams*)frame->payload;
     Setup.Common[0].FrequencyBand = rx_params->FrequencyBand;
     Setup.Common[0].Mode = rx_params->Mode;
     Setup.Common[0].Ortho = rx_params->Ortho;
+    Setup.Common[0].Fec = rx_params->Fec;
+    Setup.Common[0].RateAdapt = rx_params->RateAdapt;
+    Setup.Common[0].ShortFrames = rx_params->ShortFrames;
+    Setup.Common[0].RcCoding = rx_params->RcCoding;
 
     cmdframerxparameters_rxparams_to_rxsetup(&(rx_params->RxParams));
 }
+
+
+// Rx: handle FRAME_CMD_SWITCH_MODE from Tx
+void unpack_txcmdframe_switchmode(tTxFrame* frame, uint8_t* mode, uint8_t* cnt)
+{
+tTxCmdFrameSwitchMode* switch_mode = (tTxCmdFrameSwitchMode*)frame->payload;
+
+    *mode = switch_mode->mode;
+    *cnt = switch_mode->cnt;
+}
+
+
+// Rx: handle FRAME_CMD_FHSS_SWAP from Tx
+void unpack_txcmdframe_fhssswap(tTxFrame* frame, uint8_t* i, uint8_t* ch, uint8_t* cnt)
+{
+tTxCmdFrameFhssSwap* fhss_swap = (tTxCmdFrameFhssSwap*)frame->payload;
+
+    *i = fhss_swap->i;
+    *ch = fhss_swap->ch;
+    *cnt = fhss_swap->cnt;
+}
+
+
+// Rx: handle FRAME_CMD_GET_RX_TRACE from Tx
+void unpack_txcmdframe_getrxtrace(tTxFrame* frame, uint8_t* mode, uint8_t* path)
+{
+tTxCmdFrameGetRxTrace* get_rx_trace = (tTxCmdFrameGetRxTrace*)frame->payload;
+
+    *mode = get_rx_trace->mode;
+    *path = get_rx_trace->path;
+}
+
+
+// Rx: send FRAME_CMD_RX_TRACE to Tx
+void pack_rxcmdframe_rxtrace(tRxFrame* frame, tFrameStats* frame_stats, uint8_t mode, uint8_t path)
+{
+tRxCmdFrameRxTrace rx_trace = {};
+
+    rx_trace.cmd = FRAME_CMD_RX_TRACE;
+    rx_trace.mode = mode;
+    rx_trace.path = path;
+
+    if (mode < MODE_NUM && path < LATENCY_TRACE_NUM) {
+        tLatencyHistogram* hist = latency_trace.Get(mode, path);
+        rx_trace.bin_us = hist->bin_us;
+        for (uint8_t i = 0; i < LATENCY_TRACE_BIN_NUM; i++) {
+            rx_trace.cnt[i] = hist->cnt[i];
+            rx_trace.frac[i] = hist->frac[i];
+        }
+    }
+
+    _pack_rxframe_w_type(frame, FRAME_TYPE_TX_RX_CMD, frame_stats, (uint8_t*)&rx_trace, sizeof(rx_trace));
+}
 #endif
 
 
@@ -331,7 +331,29 @@ The default selection of frequency bands can be overruled by feature defines.
 #endif
 
 
+#define USE_FEATURE_MAVLINK_FILTER // needs USE_FEATURE_MAVLINKX
+#if defined TX_FRM303_F072CB || defined RX_FRM303_F072CB
+  #undef USE_FEATURE_MAVLINK_FILTER
+#endif
+
+
+#if defined TX_DIY_BOARD01_G491RE || defined TX_DIY_SXDUAL_MODULE02_G491RE || \
+    defined TX_DIY_E28DUAL_MODULE02_G491RE || defined TX_DIY_E22DUAL_MODULE02_G491RE // have plenty of RAM
+  #define USE_FEATURE_MAVLINK_PARAM_CACHE // needs USE_FEATURE_MAVLINKX
+  #define USE_FEATURE_MAVLINK_ROUTER // needs USE_FEATURE_MAVLINKX
+#endif
+
+
 #define USE_FEATURE_FLRC
 #if defined TX_FRM303_F072CB || defined RX_FRM303_F072CB // is short of RAM for tx, and possibly too slow
   #undef USE_FEATURE_FLRC
 #endif
+
+
+#define USE_FEATURE_FRAME_CRC_SLICING4
+#if defined TX_R9M_868_F103C8 || defined RX_R9M_868_F103C8 // is short of flash
+  #undef USE_FEATURE_FRAME_CRC_SLICING4
+#endif
+#ifdef MLRS_DEV_FEATURE_FRAME_CRC_HW // not yet tested on all mcus
+  #define USE_FEATURE_FRAME_CRC_HW
+#endif
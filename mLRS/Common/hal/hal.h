@@ -74,6 +74,10 @@ In rx-hal files:
 #define DEVICE_HAS_I2C_DAC          // board has a DAC for power control on I2C
 #define DEVICE_HAS_SYSTEMBOOT       // board has a means to invoke the system bootloader on startup
 
+For host simulation builds:
+
+#define DEVICE_HAS_SX_SIM           // use the simulated SX driver in sxsim_driver.h, set in addition to DEVICE_HAS_SX128x
+
 Note: Some "high-level" features are set for each device in the device_conf.h file, and not in the device's hal file.
 */
 
@@ -300,7 +304,9 @@ Note: Some "high-level" features are set for each device in the device_conf.h fi
 #endif
 
 
-#ifdef DEVICE_HAS_SX126x
+#ifdef DEVICE_HAS_SX_SIM
+  #define SX_DRIVER SxSimDriver
+#elif defined DEVICE_HAS_SX126x
   #define SX_DRIVER Sx126xDriver
 #elif defined DEVICE_HAS_SX127x
   #define SX_DRIVER Sx127xDriver
@@ -309,7 +315,9 @@ Note: Some "high-level" features are set for each device in the device_conf.h fi
 #endif
 
 #ifdef DEVICE_HAS_DIVERSITY
-  #ifdef DEVICE_HAS_SX126x
+  #ifdef DEVICE_HAS_SX_SIM
+    #define SX2_DRIVER SxSimDriver2
+  #elif defined DEVICE_HAS_SX126x
     #define SX2_DRIVER Sx126xDriver2
   #elif defined DEVICE_HAS_SX127x
     #define SX2_DRIVER Sx127xDriver2
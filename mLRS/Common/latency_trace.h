@@ -0,0 +1,332 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Latency Trace
+//*******************************************************
+// Histograms of the latency of the rc data, from the handset to the receiver output, and
+// of MAVLink messages, from the receiver serial to the transmitter serial, per mode.
+//
+// The paths are split where the frame ends on air, which is the TX_DONE of the sending
+// side and the RX_DONE of the receiving side. Each side records its segment:
+//   rc, Tx:      channels from the handset -> TX_DONE of the first frame which carries them
+//   rc, Rx:      RX_DONE -> out.SendRcData()
+//   serial, Rx:  message put into the link out queue -> TX_DONE of the frame with its last byte
+//   serial, Tx:  RX_DONE of this frame -> message send to the serial
+// The Tx fetches the Rx histograms with a cmd frame. The segments are independent, so the
+// end-to-end histogram is the convolution of the two. Lost frames are not accounted for,
+// the serial latency is that of the first transmission.
+//
+// The histograms have 16 bins, of a quarter frame period for rc, and of two frame periods
+// for serial, the last bin collects all above. Each bin also keeps the average position
+// of its samples within the bin, so that the convolution is not biased by the bin width.
+// With DEVICE_HAS_SX_SIM each sample is also handed to the harness, which so gets them
+// exactly.
+//*******************************************************
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+#pragma once
+
+
+#include <inttypes.h>
+#include <string.h>
+#include "setup_types.h"
+
+
+extern uint16_t micros(void);
+extern volatile uint32_t millis32(void);
+
+
+#define LATENCY_TRACE_BIN_NUM       16
+#define LATENCY_TRACE_PENDING_NUM   8 // number of messages which can be completed in one frame
+#define LATENCY_TRACE_FRAC_AVG      16 // the average position in a bin is over about that many samples
+
+
+typedef enum {
+    LATENCY_TRACE_RC = 0,
+    LATENCY_TRACE_SERIAL,
+    LATENCY_TRACE_NUM,
+} LATENCY_TRACE_ENUM;
+
+
+#ifdef DEVICE_HAS_SX_SIM
+// provided by the host harness
+extern void sxsim_latency_trace(uint8_t path, uint8_t mode, uint32_t latency_us);
+#endif
+
+
+//-------------------------------------------------------
+// Histogram
+//-------------------------------------------------------
+
+class tLatencyHistogram
+{
+  public:
+    void Init(uint32_t _bin_us)
+    {
+        bin_us = _bin_us;
+        Clear();
+    }
+
+    void Clear(void)
+    {
+        memset(cnt, 0, sizeof(cnt));
+        memset(frac, 0, sizeof(frac));
+    }
+
+    void Add(uint32_t t_us)
+    {
+        if (!bin_us) return; // not configured
+
+        uint32_t i = t_us / bin_us;
+        uint8_t f = ((t_us - i * bin_us) * 256) / bin_us;
+        if (i >= LATENCY_TRACE_BIN_NUM - 1) { i = LATENCY_TRACE_BIN_NUM - 1; f = 0; }
+
+        if (cnt[i] == UINT16_MAX) { // halve all, this keeps the shape
+            for (uint8_t n = 0; n < LATENCY_TRACE_BIN_NUM; n++) cnt[n] >>= 1;
+        }
+        cnt[i]++;
+
+        uint16_t navg = (cnt[i] < LATENCY_TRACE_FRAC_AVG) ? cnt[i] : LATENCY_TRACE_FRAC_AVG;
+        frac[i] += ((int16_t)f - (int16_t)frac[i]) / (int16_t)navg;
+    }
+
+    uint32_t Total(void)
+    {
+        uint32_t total = 0;
+        for (uint8_t n = 0; n < LATENCY_TRACE_BIN_NUM; n++) total += cnt[n];
+        return total;
+    }
+
+    // the average latency of the samples in bin i
+    uint32_t Value_us(uint8_t i)
+    {
+        return i * bin_us + ((uint32_t)frac[i] * bin_us) / 256;
+    }
+
+    uint32_t bin_us; // 0 if not configured
+    uint16_t cnt[LATENCY_TRACE_BIN_NUM];
+    uint8_t frac[LATENCY_TRACE_BIN_NUM]; // average position in the bin, in 1/256
+};
+
+
+//-------------------------------------------------------
+// Convolution
+//-------------------------------------------------------
+// the end-to-end distribution of two segments, in bins of the width of the first
+// weights are in 1/1000 of each histogram, so products sum up to 1000000
+
+class tLatencyConvolution
+{
+  public:
+    void Do(tLatencyHistogram* a, tLatencyHistogram* b)
+    {
+        memset(w, 0, sizeof(w));
+        bin_us = a->bin_us;
+        total = 0;
+        avg_us = 0;
+
+        uint32_t a_total = a->Total();
+        uint32_t b_total = b->Total();
+        if (!bin_us || !a_total || !b_total) return;
+
+        uint64_t sum = 0;
+        for (uint8_t i = 0; i < LATENCY_TRACE_BIN_NUM; i++) {
+            if (!a->cnt[i]) continue;
+            uint32_t wa = ((uint32_t)a->cnt[i] * 1000) / a_total;
+            for (uint8_t j = 0; j < LATENCY_TRACE_BIN_NUM; j++) {
+                if (!b->cnt[j]) continue;
+                uint32_t wb = ((uint32_t)b->cnt[j] * 1000) / b_total;
+                uint32_t t_us = a->Value_us(i) + b->Value_us(j);
+                uint32_t k = t_us / bin_us;
+                if (k >= 2 * LATENCY_TRACE_BIN_NUM) k = 2 * LATENCY_TRACE_BIN_NUM - 1;
+                w[k] += wa * wb;
+                total += wa * wb;
+                sum += (uint64_t)t_us * wa * wb;
+            }
+        }
+        if (total) avg_us = sum / total;
+    }
+
+    // linear within the bin
+    uint32_t Percentile_us(uint8_t percent)
+    {
+        if (!total) return 0;
+
+        uint32_t target = (total / 100) * percent;
+        uint32_t cum = 0;
+        for (uint8_t k = 0; k < 2 * LATENCY_TRACE_BIN_NUM; k++) {
+            if (cum + w[k] >= target && w[k]) {
+                return k * bin_us + (uint32_t)(((uint64_t)(target - cum) * bin_us) / w[k]);
+            }
+            cum += w[k];
+        }
+        return 2 * LATENCY_TRACE_BIN_NUM * bin_us;
+    }
+
+    // in 1/1000, the bins above num - 1 are collected in the last
+    uint16_t PerMille(uint8_t k, uint8_t num)
+    {
+        if (!total) return 0;
+
+        uint32_t v = w[k];
+        if (k == num - 1) {
+            for (uint8_t n = num; n < 2 * LATENCY_TRACE_BIN_NUM; n++) v += w[n];
+        }
+        return ((uint64_t)v * 1000) / total;
+    }
+
+    uint32_t bin_us;
+    uint32_t w[2 * LATENCY_TRACE_BIN_NUM];
+    uint32_t total;
+    uint32_t avg_us;
+};
+
+
+//-------------------------------------------------------
+// Trace
+//-------------------------------------------------------
+
+class tLatencyTrace
+{
+  public:
+    void Init(uint8_t _mode, uint16_t frame_rate_ms)
+    {
+        for (uint8_t m = 0; m < MODE_NUM; m++) {
+            for (uint8_t p = 0; p < LATENCY_TRACE_NUM; p++) hist[m][p].Init(0);
+        }
+        rc_fresh = false;
+        rc_sent = false;
+        pending_num = 0;
+        serial_rx_done_us = 0;
+#ifdef DEVICE_IS_TRANSMITTER
+        rx_hist.Init(0);
+        rx_hist_available = false;
+#endif
+
+        SetMode(_mode, frame_rate_ms);
+    }
+
+    // to be called when the mode changes, the bin widths follow from the frame period
+    void SetMode(uint8_t _mode, uint16_t frame_rate_ms)
+    {
+        if (_mode >= MODE_NUM) while (1) {} // must not happen
+
+        mode = _mode;
+        if (hist[mode][LATENCY_TRACE_RC].bin_us) return; // histograms of this mode were already set up
+
+        hist[mode][LATENCY_TRACE_RC].Init((uint32_t)frame_rate_ms * 250);
+        hist[mode][LATENCY_TRACE_SERIAL].Init((uint32_t)frame_rate_ms * 2000);
+    }
+
+    uint8_t Mode(void) { return mode; }
+
+    tLatencyHistogram* Get(uint8_t _mode, uint8_t path) { return &(hist[_mode][path]); }
+
+    //-- rc data, Tx
+
+    // new channels from the handset
+    void RcIn(void)
+    {
+        rc_in_us = micros();
+        rc_in_ms = millis32();
+        rc_fresh = true;
+    }
+
+    // the frame which is send now carries the latest channels
+    void RcTransmit(void)
+    {
+        rc_sent = rc_fresh;
+        rc_fresh = false;
+        if (!rc_sent) return;
+        if (millis32() - rc_in_ms > 60) { rc_sent = false; return; } // micros() would have wrapped around
+
+        rc_transmit_us = micros();
+        rc_wait_us = rc_transmit_us - rc_in_us;
+    }
+
+    //-- rc data, Rx
+
+    // rc data is output, age is since the frame was received
+    void RcOut(uint16_t age_us)
+    {
+        add(LATENCY_TRACE_RC, age_us);
+    }
+
+    //-- serial, Rx
+
+    // the last byte of a message was taken out for the frame which is send next
+    void SerialPacked(uint16_t put_ms)
+    {
+        if (pending_num >= LATENCY_TRACE_PENDING_NUM) return;
+        pending[pending_num++] = put_ms;
+    }
+
+    //-- serial, Tx
+
+    // a frame with serial data was received
+    void SerialReceived(uint16_t rx_done_us)
+    {
+        serial_rx_done_us = rx_done_us;
+    }
+
+    // a message was send to the serial
+    void SerialOut(void)
+    {
+        add(LATENCY_TRACE_SERIAL, (uint16_t)(micros() - serial_rx_done_us));
+    }
+
+    //-- both
+
+    // our frame ended on air
+    void TransmitDone(void)
+    {
+        if (rc_sent) {
+            rc_sent = false;
+            add(LATENCY_TRACE_RC, (uint32_t)rc_wait_us + (uint16_t)(micros() - rc_transmit_us));
+        }
+
+        uint16_t tnow_ms = millis32();
+        for (uint8_t n = 0; n < pending_num; n++) {
+            add(LATENCY_TRACE_SERIAL, (uint32_t)(uint16_t)(tnow_ms - pending[n]) * 1000);
+        }
+        pending_num = 0;
+    }
+
+#ifdef DEVICE_IS_TRANSMITTER
+    // the Rx histogram which was received last
+    tLatencyHistogram rx_hist;
+    uint8_t rx_hist_mode;
+    uint8_t rx_hist_path;
+    bool rx_hist_available;
+#endif
+
+  private:
+    void add(uint8_t path, uint32_t t_us)
+    {
+        hist[mode][path].Add(t_us);
+#ifdef DEVICE_HAS_SX_SIM
+        sxsim_latency_trace(path, mode, t_us);
+#endif
+    }
+
+    uint8_t mode;
+    tLatencyHistogram hist[MODE_NUM][LATENCY_TRACE_NUM];
+
+    bool rc_fresh;
+    bool rc_sent;
+    uint16_t rc_in_us;
+    uint32_t rc_in_ms;
+    uint16_t rc_transmit_us;
+    uint16_t rc_wait_us;
+
+    uint16_t pending[LATENCY_TRACE_PENDING_NUM];
+    uint8_t pending_num;
+
+    uint16_t serial_rx_done_us;
+};
+
+
+#endif // LATENCY_TRACE_H
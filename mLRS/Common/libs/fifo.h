@@ -6,16 +6,35 @@
 //*******************************************************
 // FIFO
 //********************************************************
+// Single-producer single-consumer ring buffer.
+//
+// One side only writes, i.e. calls Put(), PutBuf(), WriteSpan(), Commit(), and the
+// other side only reads, i.e. calls Get(), GetBuf(), Peek(), ReadSpan(), Consume(),
+// Flush(). Then it is safe without disabling irqs if one side runs in an ISR.
+// Each side writes only its own position, and publishes it after the data is moved.
+// We are on a single core, so a compiler barrier is all which is needed for that.
+//
+// FIFO_SIZE must be a power of two. One element is kept free to tell full from empty.
+//********************************************************
 #ifndef FIFO_H
 #define FIFO_H
 #pragma once
 
 
 #include <inttypes.h>
+#include <string.h>
+
+
+#ifndef FIFO_BARRIER
+#define FIFO_BARRIER()  __asm volatile ("" ::: "memory")
+#endif
+
 
 template <class T, uint16_t FIFO_SIZE>
 class FifoBase
 {
+    static_assert(FIFO_SIZE >= 2 && (FIFO_SIZE & (FIFO_SIZE - 1)) == 0, "FIFO_SIZE must be a power of two");
+
   public:
     FifoBase() // constructor
     {
@@ -25,56 +44,145 @@ class FifoBase
     void Init(void)
     {
         writepos = readpos = 0;
-        SIZEMASK = FIFO_SIZE - 1;
     }
 
+    //-- producer side
+
     bool Put(T c)
     {
-        uint16_t next = (writepos + 1) & (SIZEMASK);
-        if (next != readpos) { // fifo not full
-            buf[writepos] = c;
-            writepos = next;
-            return true;
-        }
-        return false;
+        uint16_t wpos = writepos;
+        uint16_t next = (wpos + 1) & SIZEMASK;
+        if (next == readpos) return false; // fifo full
+        buf[wpos] = c;
+        FIFO_BARRIER();
+        writepos = next;
+        return true;
     }
 
-    void PutBuf(void* buf, uint16_t len)
+    // copies up to len elements from buf, with at most two memcpy's, returns the number copied
+    uint16_t PutBuf(const void* buf, uint16_t len)
     {
-        for (uint16_t i = 0; i < len; i++) Put(((T*)buf)[i]);
+        uint16_t wpos = writepos;
+        uint16_t free = (readpos - wpos - 1) & SIZEMASK;
+        if (len > free) len = free;
+        if (!len) return 0;
+
+        uint16_t len1 = FIFO_SIZE - wpos; // contiguous span up to the end of the buffer
+        if (len1 > len) len1 = len;
+        memcpy(&(this->buf[wpos]), buf, len1 * sizeof(T));
+        if (len > len1) memcpy(&(this->buf[0]), (const T*)buf + len1, (len - len1) * sizeof(T));
+
+        FIFO_BARRIER();
+        writepos = (wpos + len) & SIZEMASK;
+        return len;
     }
 
-    uint16_t Available(void)
+    uint16_t Free(void)
     {
-        int16_t d = (int16_t)writepos - (int16_t)readpos;
-        if (d < 0) return d + (SIZEMASK + 1);
-        return d;
+        return (readpos - writepos - 1) & SIZEMASK;
     }
 
     bool HasSpace(uint16_t space)
     {
-        return (Available() < (FIFO_SIZE - space));
+        return (Free() >= space);
+    }
+
+    // contiguous free span, to be filled directly and then committed
+    T* WriteSpan(uint16_t* len)
+    {
+        uint16_t wpos = writepos;
+        uint16_t free = (readpos - wpos - 1) & SIZEMASK;
+        uint16_t len1 = FIFO_SIZE - wpos;
+        *len = (free < len1) ? free : len1;
+        return &(buf[wpos]);
+    }
+
+    void Commit(uint16_t len)
+    {
+        FIFO_BARRIER();
+        writepos = (writepos + len) & SIZEMASK;
+    }
+
+    //-- consumer side
+
+    uint16_t Available(void)
+    {
+        return (writepos - readpos) & SIZEMASK;
     }
 
     T Get(void)
     {
-        if (writepos != readpos) { // fifo not empty
-            T c = buf[readpos];
-            readpos = (readpos + 1) & (SIZEMASK);
-            return c;
-        }
-        return 0;
+        uint16_t rpos = readpos;
+        if (rpos == writepos) return 0; // fifo empty
+        FIFO_BARRIER();
+        T c = buf[rpos];
+        FIFO_BARRIER();
+        readpos = (rpos + 1) & SIZEMASK;
+        return c;
+    }
+
+    // copies up to len elements into buf, with at most two memcpy's, returns the number copied
+    uint16_t GetBuf(void* buf, uint16_t len)
+    {
+        len = PeekBuf(buf, len);
+        if (len) Consume(len);
+        return len;
+    }
+
+    // element at offset from the read position, the fifo is not changed
+    T Peek(uint16_t offset = 0)
+    {
+        if (offset >= Available()) return 0;
+        FIFO_BARRIER();
+        return buf[(readpos + offset) & SIZEMASK];
     }
 
+    // as GetBuf(), but the fifo is not changed
+    uint16_t PeekBuf(void* buf, uint16_t len)
+    {
+        uint16_t rpos = readpos;
+        uint16_t avail = (writepos - rpos) & SIZEMASK;
+        if (len > avail) len = avail;
+        if (!len) return 0;
+        FIFO_BARRIER();
+
+        uint16_t len1 = FIFO_SIZE - rpos; // contiguous span up to the end of the buffer
+        if (len1 > len) len1 = len;
+        memcpy(buf, &(this->buf[rpos]), len1 * sizeof(T));
+        if (len > len1) memcpy((T*)buf + len1, &(this->buf[0]), (len - len1) * sizeof(T));
+        return len;
+    }
+
+    // contiguous filled span, to be read directly and then consumed
+    T* ReadSpan(uint16_t* len)
+    {
+        uint16_t rpos = readpos;
+        uint16_t avail = (writepos - rpos) & SIZEMASK;
+        uint16_t len1 = FIFO_SIZE - rpos;
+        *len = (avail < len1) ? avail : len1;
+        FIFO_BARRIER();
+        return &(buf[rpos]);
+    }
+
+    void Consume(uint16_t len)
+    {
+        uint16_t avail = Available();
+        if (len > avail) len = avail;
+        FIFO_BARRIER();
+        readpos = (readpos + len) & SIZEMASK;
+    }
+
+    // only moves the read position, so can be called by the consumer while the producer runs
     void Flush(void)
     {
-        writepos = readpos = 0;
+        readpos = writepos;
     }
 
   private:
-    uint16_t writepos; // pos at which the next byte will be stored
-    uint16_t readpos; // pos at which the oldest byte is fetched
-    uint16_t SIZEMASK;
+    static const uint16_t SIZEMASK = FIFO_SIZE - 1;
+
+    volatile uint16_t writepos; // pos at which the next element will be stored, only changed by the producer
+    volatile uint16_t readpos; // pos at which the oldest element is fetched, only changed by the consumer
     T buf[FIFO_SIZE];
 };
 
@@ -0,0 +1,105 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Link Connect
+//*******************************************************
+// The connect state machine of the Tx and the Rx.
+//
+// Both start in listen. A valid frame brings them into sync, and CONNECT_SYNC_CNT more
+// valid frames make them connected. Each valid frame restarts the timeout, which counts
+// down with the systicks. When it runs out the Tx goes back to listen if it was connected,
+// the Rx if it was in sync or connected.
+//
+// The Tx hops each period in all states, and so sends on all channels in turn. The Rx hops
+// each period only when in sync or connected. In listen it stays on a channel for
+// CONNECT_LISTEN_HOP_CNT periods, so that the Tx comes by.
+//
+// It does not depend on the hal, so that the link simulation of tools/host-tests can have
+// one for each end.
+//*******************************************************
+#ifndef LINK_CONNECT_H
+#define LINK_CONNECT_H
+#pragma once
+
+
+#include <inttypes.h>
+#include "link_types.h"
+
+
+class tLinkConnect
+{
+  public:
+    void Init(void)
+    {
+        state = CONNECT_STATE_LISTEN;
+        tmo_cnt = 0;
+        sync_cnt = 0;
+        listen_cnt = 0;
+        occured_once = false;
+    }
+
+    uint8_t State(void) { return state; }
+    bool Connected(void) { return (state == CONNECT_STATE_CONNECTED); }
+    bool IsInListen(void) { return (state == CONNECT_STATE_LISTEN); }
+    bool IsSynced(void) { return (state >= CONNECT_STATE_SYNC); } // in sync or connected
+    bool OccuredOnce(void) { return occured_once; }
+    bool TimedOut(void) { return (tmo_cnt == 0); }
+
+    // to be called each systick
+    void Tick_ms(void)
+    {
+        if (tmo_cnt) tmo_cnt--;
+    }
+
+    // to be called for each valid frame, returns true if it just got connected
+    bool ValidFrame(void)
+    {
+        bool just_connected = false;
+
+        switch (state) {
+        case CONNECT_STATE_LISTEN:
+            state = CONNECT_STATE_SYNC;
+            sync_cnt = 0;
+            break;
+        case CONNECT_STATE_SYNC:
+            sync_cnt++;
+            if (sync_cnt >= CONNECT_SYNC_CNT) {
+                state = CONNECT_STATE_CONNECTED;
+                occured_once = true;
+                just_connected = true;
+            }
+            break;
+        }
+        tmo_cnt = CONNECT_TMO_SYSTICKS;
+
+        return just_connected;
+    }
+
+    void Listen(void)
+    {
+        state = CONNECT_STATE_LISTEN;
+        listen_cnt = 0;
+    }
+
+    // Rx: to be called each period when in listen, returns true if it should hop
+    bool ListenHop(void)
+    {
+        listen_cnt++;
+        if (listen_cnt < CONNECT_LISTEN_HOP_CNT) return false;
+        listen_cnt = 0;
+        return true;
+    }
+
+  private:
+    uint8_t state;
+    uint16_t tmo_cnt;
+    uint8_t sync_cnt;
+    uint16_t listen_cnt;
+    bool occured_once;
+};
+
+
+#endif // LINK_CONNECT_H
@@ -42,6 +42,8 @@ typedef enum {
     LINK_STATE_RECEIVE_WAIT,
     LINK_STATE_TRANSMIT,
     LINK_STATE_TRANSMIT_WAIT,
+    LINK_STATE_TRANSMIT_SLOT, // downlink slot, waiting to transmit in the place of the Tx frame
+    LINK_STATE_TRANSMIT_SLOT_WAIT,
 } LINK_STATE_ENUM;
 #endif
 
@@ -75,10 +77,14 @@ typedef enum {
     LINK_TASK_TX_SET_RX_PARAMS,
     LINK_TASK_TX_STORE_RX_PARAMS,
     LINK_TASK_TX_GET_RX_SETUPDATA_WRELOAD,
+    LINK_TASK_TX_SWITCH_MODE,
+    LINK_TASK_TX_FHSS_SWAP,
+    LINK_TASK_TX_GET_RX_TRACE,
 #endif
 
 #ifdef DEVICE_IS_RECEIVER
     LINK_TASK_RX_SEND_RX_SETUPDATA,
+    LINK_TASK_RX_SEND_RX_TRACE,
 #endif
 } LINK_TASK_ENUM;
 
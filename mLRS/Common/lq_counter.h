@@ -37,14 +37,23 @@ class StatsCount {
 class StatsLQ : public StatsCount
 {
   public:
+    void Init(void)
+    {
+        StatsCount::Init();
+        skip_count = skip_count_last = 0;
+    }
+
     void Update1Hz(void) override
     {
         // the period is Config.frame_rate_ms * Config.frame_rate_hz, and may not be exactly 1000
 
         counts_per_sec = count - count_last;
-        LQ = (counts_per_sec * 100) / Config.frame_rate_hz;
+        uint32_t skipped = skip_count - skip_count_last;
+        uint32_t expected = (skipped < Config.frame_rate_hz) ? Config.frame_rate_hz - skipped : 0;
+        LQ = (expected) ? (counts_per_sec * 100) / expected : 0;
 
         count_last = count;
+        skip_count_last = skip_count;
     }
 
     void Inc(void)
@@ -52,10 +61,20 @@ class StatsLQ : public StatsCount
         count++;
     }
 
+    // for periods in which no frame was to be expected, e.g. downlink slots
+    void Skip(void)
+    {
+        skip_count++;
+    }
+
     uint8_t GetLQ(void)
     {
         return LQ;
     }
+
+  private:
+    uint32_t skip_count;
+    uint32_t skip_count_last;
 };
 
 
@@ -81,6 +100,97 @@ class StatsBytes : public StatsCount
 };
 
 
+// targeted at latencies, average and max over the last second
+class StatsLatency
+{
+  public:
+    void Init(void)
+    {
+        sum_ms = 0;
+        cnt = 0;
+        max_ms = 0;
+        avg_ms_last = 0;
+        max_ms_last = 0;
+    }
+
+    void Update1Hz(void)
+    {
+        avg_ms_last = (cnt) ? sum_ms / cnt : 0;
+        max_ms_last = max_ms;
+        sum_ms = 0;
+        cnt = 0;
+        max_ms = 0;
+    }
+
+    void Add(uint16_t latency_ms)
+    {
+        sum_ms += latency_ms;
+        cnt++;
+        if (latency_ms > max_ms) max_ms = latency_ms;
+    }
+
+    uint16_t GetAvg_ms(void) { return avg_ms_last; }
+    uint16_t GetMax_ms(void) { return max_ms_last; }
+
+  private:
+    uint32_t sum_ms;
+    uint16_t cnt;
+    uint16_t max_ms;
+    uint16_t avg_ms_last;
+    uint16_t max_ms_last;
+};
+
+
+// targeted at timings in us, min, average and max over the last second, max - min is the jitter
+class StatsTiming
+{
+  public:
+    void Init(void)
+    {
+        sum_us = 0;
+        cnt = 0;
+        min_us = UINT16_MAX;
+        max_us = 0;
+        min_us_last = 0;
+        avg_us_last = 0;
+        max_us_last = 0;
+    }
+
+    void Update1Hz(void)
+    {
+        min_us_last = (cnt) ? min_us : 0;
+        avg_us_last = (cnt) ? sum_us / cnt : 0;
+        max_us_last = max_us;
+        sum_us = 0;
+        cnt = 0;
+        min_us = UINT16_MAX;
+        max_us = 0;
+    }
+
+    void Add(uint16_t t_us)
+    {
+        sum_us += t_us;
+        cnt++;
+        if (t_us < min_us) min_us = t_us;
+        if (t_us > max_us) max_us = t_us;
+    }
+
+    uint16_t GetMin_us(void) { return min_us_last; }
+    uint16_t GetAvg_us(void) { return avg_us_last; }
+    uint16_t GetMax_us(void) { return max_us_last; }
+    uint16_t GetJitter_us(void) { return max_us_last - min_us_last; }
+
+  private:
+    uint32_t sum_us;
+    uint16_t cnt;
+    uint16_t min_us;
+    uint16_t max_us;
+    uint16_t min_us_last;
+    uint16_t avg_us_last;
+    uint16_t max_us_last;
+};
+
+
 //-------------------------------------------------------
 // moving window statistics
 //-------------------------------------------------------
@@ -31,6 +31,53 @@ void fmav_msg_recalculate_crc(fmav_message_t* msg)
 }
 
 
+//-------------------------------------------------------
+// frame buf helper
+//-------------------------------------------------------
+// work directly on a frame buf as obtained from fmav_parse_and_check_to_frame_buf()
+// this avoids the detour via fmav_message_t, which costs RAM and copies
+
+uint8_t fmav_frame_buf_header_len(uint8_t* buf)
+{
+    return (buf[0] == FASTMAVLINK_MAGIC_V1) ? FASTMAVLINK_HEADER_V1_LEN : FASTMAVLINK_HEADER_V2_LEN;
+}
+
+
+uint8_t* fmav_frame_buf_payload(uint8_t* buf)
+{
+    return &(buf[fmav_frame_buf_header_len(buf)]);
+}
+
+
+uint8_t fmav_frame_buf_payload_len(uint8_t* buf)
+{
+    return buf[1];
+}
+
+
+// fills the payload structure, the bytes removed by the v2 zero trimming are set to zero
+void fmav_frame_buf_decode(void* payload, uint16_t payload_max_len, uint8_t* buf)
+{
+    uint8_t len = fmav_frame_buf_payload_len(buf);
+    if (len > payload_max_len) len = payload_max_len;
+
+    memcpy(payload, fmav_frame_buf_payload(buf), len);
+    memset((uint8_t*)payload + len, 0, payload_max_len - len);
+}
+
+
+// needs to be called when the payload was modified
+void fmav_frame_buf_recalculate_crc(fmav_result_t* result, uint8_t* buf)
+{
+    uint16_t pos = fmav_frame_buf_header_len(buf) + fmav_frame_buf_payload_len(buf);
+
+    uint16_t crc = fmav_crc_calculate(&(buf[1]), pos - 1); // magic is not included
+    fmav_crc_accumulate(&crc, result->crc_extra);
+    buf[pos] = (uint8_t)crc;
+    buf[pos + 1] = (uint8_t)(crc >> 8);
+}
+
+
 //-------------------------------------------------------
 // Component List Class
 //-------------------------------------------------------
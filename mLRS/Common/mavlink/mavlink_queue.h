@@ -0,0 +1,302 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// MAVLink Queue
+//*******************************************************
+// Message aware queue for the link out direction, replaces a plain byte fifo.
+//
+// The messages are held as complete frames, in the order they were put in, with some
+// info on each in a slot. They are taken out by priority class, and by order within a
+// class, so that the message sequence of e.g. parameter or mission transfers is kept.
+// A message which has been started to be taken out is completed first.
+//
+// A newer instance of a periodic telemetry message, i.e. same msgid, sysid, compid,
+// replaces the queued one in place. This limits the telemetry to one instance per
+// message, and the GCS gets the freshest data.
+//
+// The time each message waited is recorded per class. If a latency trace is given, the time
+// since it was put in is also reported for each message when its last byte is taken out.
+//
+// The messages can be taken out as bytes, or as complete frames together with the parser
+// info, so that they can be converted when they are taken out.
+//*******************************************************
+#ifndef MAVLINK_QUEUE_H
+#define MAVLINK_QUEUE_H
+#pragma once
+
+
+#include <inttypes.h>
+#include <string.h>
+#include "../lq_counter.h"
+#include "../latency_trace.h"
+
+
+extern volatile uint32_t millis32(void);
+
+
+#define MAVLINK_QUEUE_BUF_SIZE      512 // needs to be at least 82 + 280
+#define MAVLINK_QUEUE_SLOT_NUM      16
+
+
+typedef enum {
+    MAVLINK_PRIO_HIGH = 0, // heartbeat, commands and acks, status texts
+    MAVLINK_PRIO_TELEMETRY, // periodic telemetry, newer replaces older
+    MAVLINK_PRIO_BULK, // everything else, like parameters, missions, ftp, logs
+    MAVLINK_PRIO_NUM,
+} MAVLINK_PRIO_ENUM;
+
+
+uint8_t mavlink_prio_from_msgid(uint32_t msgid)
+{
+    switch (msgid) {
+    case FASTMAVLINK_MSG_ID_HEARTBEAT:
+    case FASTMAVLINK_MSG_ID_COMMAND_LONG:
+    case FASTMAVLINK_MSG_ID_COMMAND_INT:
+    case FASTMAVLINK_MSG_ID_COMMAND_ACK:
+    case FASTMAVLINK_MSG_ID_SET_MODE:
+    case FASTMAVLINK_MSG_ID_MANUAL_CONTROL:
+    case FASTMAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+    case FASTMAVLINK_MSG_ID_STATUSTEXT:
+        return MAVLINK_PRIO_HIGH;
+
+    case FASTMAVLINK_MSG_ID_SYS_STATUS:
+    case FASTMAVLINK_MSG_ID_SYSTEM_TIME:
+    case FASTMAVLINK_MSG_ID_GPS_RAW_INT:
+    case FASTMAVLINK_MSG_ID_RAW_IMU:
+    case FASTMAVLINK_MSG_ID_SCALED_PRESSURE:
+    case FASTMAVLINK_MSG_ID_ATTITUDE:
+    case FASTMAVLINK_MSG_ID_ATTITUDE_QUATERNION:
+    case FASTMAVLINK_MSG_ID_LOCAL_POSITION_NED:
+    case FASTMAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    case FASTMAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+    case FASTMAVLINK_MSG_ID_MISSION_CURRENT:
+    case FASTMAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT:
+    case FASTMAVLINK_MSG_ID_RC_CHANNELS:
+    case FASTMAVLINK_MSG_ID_VFR_HUD:
+    case FASTMAVLINK_MSG_ID_TERRAIN_REPORT:
+    case FASTMAVLINK_MSG_ID_BATTERY_STATUS:
+    case FASTMAVLINK_MSG_ID_EXTENDED_SYS_STATE:
+    case FASTMAVLINK_MSG_ID_VIBRATION:
+    case FASTMAVLINK_MSG_ID_FENCE_STATUS:
+    case FASTMAVLINK_MSG_ID_RANGEFINDER:
+    case FASTMAVLINK_MSG_ID_RPM:
+        return MAVLINK_PRIO_TELEMETRY;
+    }
+
+    return MAVLINK_PRIO_BULK;
+}
+
+
+// the telemetry messages are those which are send periodically
+uint8_t mavlink_msgid_is_periodic(uint32_t msgid)
+{
+    return (mavlink_prio_from_msgid(msgid) == MAVLINK_PRIO_TELEMETRY) ? 1 : 0;
+}
+
+
+class tMavlinkQueue
+{
+  public:
+    void Init(StatsLatency* _latency, tLatencyTrace* _trace = nullptr)
+    {
+        latency = _latency;
+        trace = _trace;
+        Flush();
+    }
+
+    void Flush(void)
+    {
+        slot_num = 0;
+        buf_len = 0;
+        cur = UINT8_MAX;
+        cur_pos = 0;
+    }
+
+    bool HasSpace(uint16_t len)
+    {
+        return (slot_num < MAVLINK_QUEUE_SLOT_NUM) && (buf_len + len <= MAVLINK_QUEUE_BUF_SIZE);
+    }
+
+    // frame is the complete frame of the message, as it is to be send
+    // result is that of the parser, it has the info on the message, so the frame needs not be decoded
+    void Put(uint8_t* frame, uint16_t len, fmav_result_t* result)
+    {
+        uint8_t prio = mavlink_prio_from_msgid(result->msgid);
+
+        if (prio == MAVLINK_PRIO_TELEMETRY) {
+            for (uint8_t n = 0; n < slot_num; n++) {
+                if (n == cur) continue; // is being taken out, too late
+                if (slot[n].msgid != result->msgid || slot[n].sysid != result->sysid || slot[n].compid != result->compid) continue;
+                if (buf_len - slot[n].len + len > MAVLINK_QUEUE_BUF_SIZE) return; // should not happen
+                replace(n, frame, len);
+                return;
+            }
+        }
+
+        if (!HasSpace(len)) return; // should not happen, caller should have checked
+
+        tSlot* s = &(slot[slot_num]);
+        s->pos = buf_len;
+        s->len = len;
+        s->msgid = result->msgid;
+        s->sysid = result->sysid;
+        s->compid = result->compid;
+        s->target_sysid = result->target_sysid;
+        s->target_compid = result->target_compid;
+        s->crc_extra = result->crc_extra;
+        s->prio = prio;
+        s->t_ms = millis32();
+        memcpy(&(buf[buf_len]), frame, len);
+        buf_len += len;
+        slot_num++;
+    }
+
+    uint16_t Available(void)
+    {
+        return buf_len - cur_pos;
+    }
+
+    uint8_t Get(void)
+    {
+        uint8_t c;
+        return (GetBuf(&c, 1)) ? c : 0;
+    }
+
+    // copies up to len bytes into data, returns the number copied
+    uint16_t GetBuf(void* data, uint16_t len)
+    {
+        uint16_t cnt = 0;
+
+        while (cnt < len) {
+            if (cur == UINT8_MAX && !select_next()) break; // nothing left
+
+            tSlot* s = &(slot[cur]);
+            uint16_t n = s->len - cur_pos;
+            if (n > len - cnt) n = len - cnt;
+            memcpy((uint8_t*)data + cnt, &(buf[s->pos + cur_pos]), n);
+            cnt += n;
+            cur_pos += n;
+
+            if (cur_pos >= s->len) { // message completed
+                if (trace) trace->SerialPacked(s->t_ms);
+                uint8_t i = cur;
+                cur = UINT8_MAX;
+                cur_pos = 0;
+                remove(i);
+            }
+        }
+
+        return cnt;
+    }
+
+    // takes out the next message as a whole, returns its length, 0 if there is none
+    // frame must be large enough for a full frame, result is filled as if the frame was just parsed
+    // t_ms is when it was put in, the caller reports it to the latency trace when it is taken out
+    uint16_t GetFrame(uint8_t* frame, fmav_result_t* result, uint16_t* t_ms = nullptr)
+    {
+        if (cur != UINT8_MAX) return 0; // is being taken out by GetBuf(), must not mix
+        if (!select_next()) return 0;
+
+        tSlot* s = &(slot[cur]);
+        uint16_t len = s->len;
+        memcpy(frame, &(buf[s->pos]), len);
+
+        *result = {};
+        result->res = FASTMAVLINK_PARSE_RESULT_OK;
+        result->frame_len = len;
+        result->msgid = s->msgid;
+        result->sysid = s->sysid;
+        result->compid = s->compid;
+        result->target_sysid = s->target_sysid;
+        result->target_compid = s->target_compid;
+        result->crc_extra = s->crc_extra;
+        if (t_ms) *t_ms = s->t_ms;
+
+        uint8_t i = cur;
+        cur = UINT8_MAX;
+        cur_pos = 0;
+        remove(i);
+        return len;
+    }
+
+  private:
+    typedef struct
+    {
+        uint16_t pos;
+        uint16_t len;
+        uint32_t msgid;
+        uint8_t sysid;
+        uint8_t compid;
+        uint8_t target_sysid;
+        uint8_t target_compid;
+        uint8_t crc_extra;
+        uint8_t prio;
+        uint16_t t_ms; // when it was put in, 16 bits are plenty
+    } tSlot;
+
+    // selects the oldest message of the highest class
+    bool select_next(void)
+    {
+        if (!slot_num) return false;
+
+        uint8_t i = 0;
+        for (uint8_t n = 1; n < slot_num; n++) {
+            if (slot[n].prio < slot[i].prio) i = n;
+        }
+
+        cur = i;
+        cur_pos = 0;
+        if (latency) latency[slot[i].prio].Add((uint16_t)millis32() - slot[i].t_ms);
+        return true;
+    }
+
+    void remove(uint8_t i)
+    {
+        uint16_t len = slot[i].len;
+        uint16_t pos_end = slot[i].pos + len;
+        memmove(&(buf[slot[i].pos]), &(buf[pos_end]), buf_len - pos_end);
+        buf_len -= len;
+
+        for (uint8_t n = i + 1; n < slot_num; n++) {
+            slot[n - 1] = slot[n];
+            slot[n - 1].pos -= len;
+        }
+        slot_num--;
+
+        if (cur != UINT8_MAX && cur > i) cur--;
+    }
+
+    // the new frame takes the place of the old, so it doesn't lose its turn
+    void replace(uint8_t i, uint8_t* frame, uint16_t len)
+    {
+        uint16_t pos_end = slot[i].pos + slot[i].len;
+        int16_t d = (int16_t)len - (int16_t)slot[i].len;
+
+        if (d) {
+            memmove(&(buf[pos_end + d]), &(buf[pos_end]), buf_len - pos_end);
+            buf_len += d;
+            for (uint8_t n = i + 1; n < slot_num; n++) slot[n].pos += d;
+        }
+
+        memcpy(&(buf[slot[i].pos]), frame, len);
+        slot[i].len = len;
+        slot[i].t_ms = millis32();
+    }
+
+    StatsLatency* latency;
+    tLatencyTrace* trace;
+
+    uint8_t buf[MAVLINK_QUEUE_BUF_SIZE];
+    uint16_t buf_len;
+    tSlot slot[MAVLINK_QUEUE_SLOT_NUM];
+    uint8_t slot_num;
+
+    uint8_t cur; // slot which is being taken out, UINT8_MAX if none
+    uint16_t cur_pos; // bytes of it which have been taken out
+};
+
+
+#endif // MAVLINK_QUEUE_H
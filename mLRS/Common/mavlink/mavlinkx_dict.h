@@ -0,0 +1,91 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// MavlinkX Dictionary
+//*******************************************************
+// generated by tools/host-tests/gen_mavlinkx_dict.cpp, do not edit
+// from synthetic telemetry and parameters, 600 s, seed 1
+// must be the same on Tx and Rx
+//*******************************************************
+#ifndef MAVLINKX_DICT_H
+#define MAVLINKX_DICT_H
+#pragma once
+
+
+const uint8_t mavlinkx_dict_0[9] = {
+    0x0A, 0x00, 0x00, 0x00, 0x01, 0x03, 0xD9, 0x04, 0x03,
+};
+
+const uint8_t mavlinkx_dict_1[31] = {
+    0x2F, 0xFC, 0x20, 0x13, 0x2F, 0xFC, 0x20, 0x13, 0x2F, 0xFC, 0x20, 0x03, 0xC2, 0x00, 0x0D, 0x30,
+    0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5B,
+};
+
+const uint8_t mavlinkx_dict_2[10] = {
+    0x3B, 0x29, 0x01, 0x19, 0x24, 0x0A, 0x06, 0x00, 0x00, 0x03,
+};
+
+const uint8_t mavlinkx_dict_22[25] = {
+    0x9A, 0x99, 0x80, 0x42, 0xE8, 0x03, 0x00, 0x00, 0x50, 0x41, 0x52, 0x41, 0x4D, 0x5F, 0x31, 0x30,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09,
+};
+
+const uint8_t mavlinkx_dict_24[30] = {
+    0x0A, 0xC1, 0x2E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x52, 0x2F, 0x40, 0x1C, 0x3D, 0xC0, 0x17, 0x05,
+    0x5F, 0x3D, 0x08, 0x00, 0x79, 0x00, 0xC8, 0x00, 0xEB, 0x05, 0x83, 0x19, 0x03, 0x0E,
+};
+
+const uint8_t mavlinkx_dict_33[28] = {
+    0x00, 0x03, 0x00, 0x00, 0x1A, 0x2F, 0x40, 0x1C, 0x2E, 0xC0, 0x17, 0x05, 0x5F, 0x3D, 0x08, 0x00,
+    0x1F, 0xCA, 0x00, 0x00, 0x25, 0xFA, 0x25, 0x05, 0x00, 0x00, 0x64, 0x1E,
+};
+
+const uint8_t mavlinkx_dict_62[25] = {
+    0x0A, 0x72, 0xB6, 0x41, 0x4F, 0x60, 0xCB, 0x3F, 0xA6, 0x9B, 0xC1, 0x3E, 0xAB, 0xF2, 0x82, 0x3E,
+    0x77, 0xBE, 0x5F, 0x3F, 0x6B, 0xFF, 0x6B, 0xFF, 0x64,
+};
+
+const uint8_t mavlinkx_dict_65[42] = {
+    0x00, 0x4D, 0x00, 0x00, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xD0, 0x07,
+    0xE8, 0x03, 0xDC, 0x05, 0xD0, 0x07, 0xE8, 0x03, 0xDC, 0x05, 0xD0, 0x07, 0xE8, 0x03, 0xDC, 0x05,
+    0xD0, 0x07, 0xE8, 0x03, 0x00, 0x00, 0x00, 0x00, 0x10, 0xCC,
+};
+
+const uint8_t mavlinkx_dict_74[19] = {
+    0xE7, 0xFB, 0x73, 0x41, 0x3F, 0xC5, 0x6C, 0x41, 0x6C, 0xFF, 0x4F, 0x42, 0x13, 0xCC, 0x4C, 0xBE,
+    0x16, 0x00, 0x31,
+};
+
+const uint8_t mavlinkx_dict_147[36] = {
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x0D, 0x30, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xC0, 0x05,
+    0x00, 0x00, 0x00, 0x5B,
+};
+
+const uint8_t mavlinkx_dict_241[20] = {
+    0x1F, 0xD8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xB8, 0x1E, 0x13, 0x3F, 0x81, 0x95, 0x0C, 0x40,
+    0x5E, 0xBA, 0x8B, 0x40,
+};
+
+
+#define MAVLINKX_DICT_NUM  11
+
+const fmavx_dict_entry_t mavlinkx_dict[MAVLINKX_DICT_NUM] = {
+    { 0, 9, mavlinkx_dict_0 },
+    { 1, 31, mavlinkx_dict_1 },
+    { 2, 10, mavlinkx_dict_2 },
+    { 22, 25, mavlinkx_dict_22 },
+    { 24, 30, mavlinkx_dict_24 },
+    { 33, 28, mavlinkx_dict_33 },
+    { 62, 25, mavlinkx_dict_62 },
+    { 65, 42, mavlinkx_dict_65 },
+    { 74, 19, mavlinkx_dict_74 },
+    { 147, 36, mavlinkx_dict_147 },
+    { 241, 20, mavlinkx_dict_241 },
+};
+
+
+#endif // MAVLINKX_DICT_H
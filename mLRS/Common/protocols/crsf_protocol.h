@@ -115,6 +115,12 @@ typedef enum {
 } CRSF_COMMAND_ENUM;
 
 
+// SubType IDs for CRSF_FRAME_ID_RADIO
+typedef enum {
+    CRSF_RADIO_TIMING_CORRECTION      = 0x10,
+} CRSF_RADIO_ENUM;
+
+
 // SubType IDs for CRSF_FRAME_ID_AP_CUSTOM_TELEM
 typedef enum {
     CRSF_AP_CUSTOM_TELEM_TYPE_SINGLE_PACKET_PASSTHROUGH = 0xF0,
@@ -265,6 +271,27 @@ typedef struct
 #define CRSF_LINK_STATISTICS_RX_LEN  5
 
 
+//-- Radio frames
+
+/* 0x3A Radio, sub type 0x10 Timing Correction
+
+  the radio sets its channels frame period to interval, and shifts the next channels frame by offset
+  uint32_t interval ( 0.1 us ), big endian
+  int32_t offset ( 0.1 us ), big endian, positive means later
+*/
+CRSF_PACKED(
+typedef struct
+{
+    uint8_t dest_address;
+    uint8_t src_address;
+    uint8_t sub_type;
+    uint32_t interval;
+    int32_t offset;
+}) tCrsfTimingCorrection;
+
+#define CRSF_TIMING_CORRECTION_LEN  11
+
+
 //-- Telemetry data frames
 
 CRSF_PACKED(
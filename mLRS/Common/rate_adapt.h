@@ -0,0 +1,133 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Rate Adaption
+//*******************************************************
+// Switches between the LoRa modes while connected, 50 Hz -> 31 Hz -> 19 Hz and back.
+//
+// The Tx decides from the LQ and the rssi margin, and announces the switch with a
+// FRAME_CMD_SWITCH_MODE. The cmd is repeated in each frame, with a countdown to the
+// frame at which the new mode is used, so both sides switch on the same frame even if
+// some of the cmd frames are lost. There is no absolute frame number in the frames, so
+// the countdown is what the two sides agree on.
+//
+// The mode is never made faster than the configured mode, the home mode. On disconnect
+// both sides go back to the home mode, so they always reconnect in a known mode.
+// The fhss hop list and the LQ averaging are kept, only the frame rate, the LoRa
+// configuration, and on the Rx the clock, are changed.
+//*******************************************************
+#ifndef RATE_ADAPT_H
+#define RATE_ADAPT_H
+#pragma once
+
+
+#include <inttypes.h>
+#include "setup_types.h"
+
+
+#define RATE_ADAPT_SWITCH_CNT         8 // number of frames the switch is announced in advance
+#define RATE_ADAPT_HOLD_S             3 // after a switch the LQs need to settle, no decisions for this time
+#define RATE_ADAPT_UP_HOLD_S          5 // the link must be good for this time before going faster
+
+#define RATE_ADAPT_LQ_DOWN            70 // LQ below which we go slower
+#define RATE_ADAPT_LQ_UP              95 // LQ above which we may go faster
+#define RATE_ADAPT_MARGIN_DOWN_DB     3 // rssi margin below which we go slower
+#define RATE_ADAPT_MARGIN_UP_DB       12 // a faster mode is ca 3 dB less sensitive, so we want plenty
+
+
+class tRateAdapt
+{
+  public:
+    void Init(bool _enabled, uint8_t _home_mode)
+    {
+        enabled = _enabled;
+        home_mode = _home_mode;
+        Reset();
+    }
+
+    void Reset(void) // called then not connected, and on bind
+    {
+        mode = home_mode;
+        switch_mode = home_mode;
+        cnt = 0;
+        hold_cnt = RATE_ADAPT_HOLD_S;
+        up_cnt = 0;
+    }
+
+    bool IsEnabled(void) { return enabled; }
+    uint8_t Mode(void) { return mode; }
+    uint8_t HomeMode(void) { return home_mode; }
+    bool IsHome(void) { return (mode == home_mode); }
+
+    //-- Tx: decision
+
+    // to be called at 1 Hz when connected
+    // returns the mode to switch to, or the current mode
+    uint8_t Decide(uint8_t LQ, int16_t margin_db)
+    {
+        if (!enabled || cnt) return mode;
+
+        if (hold_cnt) {
+            hold_cnt--;
+            return mode;
+        }
+
+        if (LQ < RATE_ADAPT_LQ_DOWN || margin_db < RATE_ADAPT_MARGIN_DOWN_DB) {
+            up_cnt = 0;
+            return (mode < MODE_19HZ) ? mode + 1 : mode;
+        }
+
+        if (LQ >= RATE_ADAPT_LQ_UP && margin_db >= RATE_ADAPT_MARGIN_UP_DB) {
+            if (up_cnt < RATE_ADAPT_UP_HOLD_S) up_cnt++;
+            if (up_cnt >= RATE_ADAPT_UP_HOLD_S && mode > home_mode) return mode - 1;
+        } else {
+            up_cnt = 0;
+        }
+
+        return mode;
+    }
+
+    //-- switch handling
+
+    // Tx: when the switch is decided, Rx: for each received FRAME_CMD_SWITCH_MODE
+    void Schedule(uint8_t _mode, uint8_t _cnt)
+    {
+        if (!enabled || !_cnt || _mode > MODE_19HZ || _mode < home_mode) return; // not a valid request
+        switch_mode = _mode;
+        cnt = _cnt;
+    }
+
+    bool SwitchPending(void) { return (cnt > 0); }
+    uint8_t SwitchMode(void) { return switch_mode; }
+    uint8_t SwitchCnt(void) { return cnt; }
+
+    // to be called once per frame, returns true when the new mode is to be used
+    // Tx: before the frame is transmitted, Rx: after the frame was or should have been received
+    bool Tick(void)
+    {
+        if (!cnt) return false;
+        cnt--;
+        if (cnt) return false;
+        mode = switch_mode;
+        hold_cnt = RATE_ADAPT_HOLD_S;
+        up_cnt = 0;
+        return true;
+    }
+
+  private:
+    bool enabled;
+    uint8_t home_mode;
+    uint8_t mode;
+
+    uint8_t switch_mode;
+    uint8_t cnt; // frames until the switch
+
+    uint8_t hold_cnt;
+    uint8_t up_cnt;
+};
+
+
+#endif // RATE_ADAPT_H
@@ -0,0 +1,320 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Rc Data Delta Coding
+//*******************************************************
+// Carries all 16 channels with 11 bits, in the same 16 bytes as the standard coding.
+//
+// Channels 1-4 are send as before in rc1, so they are available also if only crc1 is
+// valid. The 4 bits of channels 13,14 are used instead for a 2 bit seq and the distance
+// to the reference frame. Channels 5-16 are coded in rc2 relative to their values in the
+// reference frame, with a prefix code:
+//   0                      unchanged, 1 bit
+//   10 + 4 bits signed     -8 .. 7, 6 bits
+//   110 + 7 bits signed    -64 .. 63, 10 bits
+//   111 + 11 bits          absolute value, 14 bits
+// If the changes don't fit into the 80 bits, channels move towards their value as far
+// as the bits allow. Both ends keep the values as coded, so they catch up in the next
+// frames. One channel per frame is send as absolute value, in turn, when there is room.
+//
+// The reference is the last frame the Rx acknowledged, by the valid_received flag in its
+// frame, which in this mode means that the rc data was decoded. When there is none in the
+// last 3 frames, a keyframe is send, with channels 5-12 with 9 bits and channels 13-16
+// as 3-way, which is refined by the following frames.
+//
+// The flag thus no longer tells if the frame was received, so the Tx's fhss channel stats
+// do not use it in this mode.
+//*******************************************************
+#ifndef RC_CODING_H
+#define RC_CODING_H
+#pragma once
+
+
+#include <inttypes.h>
+#include <string.h>
+#include "frame_types.h"
+
+
+#define RC_CODING_CH_NUM          12 // channels 5-16
+#define RC_CODING_BITS            (FRAME_TX_RCDATA2_LEN * 8) // 80
+#define RC_CODING_HISTORY_NUM     4 // range of the 2 bit seq
+#define RC_CODING_ABSOLUTE_LEN    14
+
+
+// rc1 as used with delta coding
+PACKED(
+typedef struct
+{
+    uint16_t ch0  : 11; // 0 .. 1024 .. 2047, 11 bits
+    uint16_t ch1  : 11;
+    uint16_t ch2  : 11;
+    uint16_t ch3  : 11;
+    uint16_t seq  :  2; // frame count, mod 4
+    uint16_t ref  :  2; // distance to the reference frame, 0 = keyframe
+}) tFrameRcDataDelta1; // 6 bytes
+
+
+class tRcCoding
+{
+  public:
+    void Init(void)
+    {
+        tx_cnt = 0;
+        tx_sent = false;
+        ack_cnt = 0;
+        ack_valid = false;
+        refresh_ch = 0;
+
+        for (uint8_t n = 0; n < RC_CODING_HISTORY_NUM; n++) hist_valid[n] = false;
+        rx_decoded = false;
+    }
+
+    //-- transmitting end
+
+    void Encode(tTxFrame* frame, tRcData* rc)
+    {
+        tFrameRcDataDelta1* rc1 = (tFrameRcDataDelta1*)&(frame->rc1);
+
+        rc1->ch0 = rc->ch[0];
+        rc1->ch1 = rc->ch[1];
+        rc1->ch2 = rc->ch[2];
+        rc1->ch3 = rc->ch[3];
+
+        tx_cnt++;
+        uint8_t dist = tx_cnt - ack_cnt;
+        if (dist >= RC_CODING_HISTORY_NUM) ack_valid = false; // too old, the Rx may have overwritten it
+
+        uint8_t seq = tx_cnt % RC_CODING_HISTORY_NUM;
+        rc1->seq = seq;
+        rc1->ref = (ack_valid) ? dist : 0;
+
+        bits_start((uint8_t*)&(frame->rc2));
+        if (ack_valid) {
+            encode_delta(hist[ack_cnt % RC_CODING_HISTORY_NUM], hist[seq], rc);
+        } else {
+            encode_keyframe(hist[seq], rc);
+        }
+
+        tx_sent = true;
+    }
+
+    // to be called once per period, with whether the Rx acknowledged the frame of this period
+    void HandleAck(bool acked)
+    {
+        if (!tx_sent) return; // we did not transmit in this period
+        tx_sent = false;
+
+        if (!acked) return;
+        ack_cnt = tx_cnt;
+        ack_valid = true;
+    }
+
+    //-- receiving end
+
+    // channels 5-16 are not changed if they can't be decoded
+    bool Decode(tRcData* rc, tTxFrame* frame)
+    {
+        tFrameRcDataDelta1* rc1 = (tFrameRcDataDelta1*)&(frame->rc1);
+        uint16_t val[RC_CODING_CH_NUM];
+
+        DecodeRc1(rc, frame);
+
+        bits_start((uint8_t*)&(frame->rc2));
+        if (rc1->ref == 0) {
+            decode_keyframe(val);
+        } else {
+            uint8_t r = (uint8_t)(rc1->seq - rc1->ref) % RC_CODING_HISTORY_NUM;
+            if (!hist_valid[r]) return false;
+            if (!decode_delta(hist[r], val)) return false;
+        }
+
+        memcpy(hist[rc1->seq], val, sizeof(val));
+        hist_valid[rc1->seq] = true;
+
+        for (uint8_t i = 0; i < RC_CODING_CH_NUM; i++) rc->ch[4 + i] = val[i];
+        rx_decoded = true;
+        return true;
+    }
+
+    void DecodeRc1(tRcData* rc, tTxFrame* frame)
+    {
+        tFrameRcDataDelta1* rc1 = (tFrameRcDataDelta1*)&(frame->rc1);
+
+        rc->ch[0] = rc1->ch0;
+        rc->ch[1] = rc1->ch1;
+        rc->ch[2] = rc1->ch2;
+        rc->ch[3] = rc1->ch3;
+
+        rx_decoded = false;
+    }
+
+    // to be called when the Rx frame is prepared, returns if the rc data of the Tx frame was decoded
+    bool Ack(void)
+    {
+        bool ack = rx_decoded;
+        rx_decoded = false;
+        return ack;
+    }
+
+  private:
+    uint8_t code_len(int16_t d)
+    {
+        if (d == 0) return 1;
+        if (d >= -8 && d <= 7) return 6;
+        if (d >= -64 && d <= 63) return 10;
+        return RC_CODING_ABSOLUTE_LEN;
+    }
+
+    void encode_delta(uint16_t* ref, uint16_t* out, tRcData* rc)
+    {
+        uint8_t len[RC_CODING_CH_NUM];
+        uint16_t total = 0;
+        for (uint8_t i = 0; i < RC_CODING_CH_NUM; i++) {
+            len[i] = code_len((int16_t)rc->ch[4 + i] - (int16_t)ref[i]);
+            total += len[i];
+        }
+
+        // one channel gets an absolute refresh, if there is room
+        uint8_t refresh = RC_CODING_CH_NUM; // none
+        if (total - len[refresh_ch] + RC_CODING_ABSOLUTE_LEN <= RC_CODING_BITS) {
+            refresh = refresh_ch;
+            refresh_ch++;
+            if (refresh_ch >= RC_CODING_CH_NUM) refresh_ch = 0;
+        }
+
+        for (uint8_t i = 0; i < RC_CODING_CH_NUM; i++) {
+            int16_t d = (int16_t)rc->ch[4 + i] - (int16_t)ref[i];
+            // keep one bit for each of the following channels
+            uint8_t avail = RC_CODING_BITS - bits_pos - (RC_CODING_CH_NUM - 1 - i);
+
+            if (i == refresh || (len[i] == RC_CODING_ABSOLUTE_LEN && avail >= RC_CODING_ABSOLUTE_LEN)) {
+                bits_put(0b111, 3);
+                bits_put(rc->ch[4 + i], 11);
+                out[i] = rc->ch[4 + i];
+                continue;
+            }
+
+            if (avail >= 10 && len[i] >= 10) {
+                if (d < -64) d = -64;
+                if (d > 63) d = 63;
+                bits_put(0b110, 3);
+                bits_put(d, 7);
+            } else
+            if (avail >= 6 && len[i] >= 6) {
+                if (d < -8) d = -8;
+                if (d > 7) d = 7;
+                bits_put(0b10, 2);
+                bits_put(d, 4);
+            } else {
+                d = 0;
+                bits_put(0, 1);
+            }
+            out[i] = ref[i] + d;
+        }
+    }
+
+    bool decode_delta(uint16_t* ref, uint16_t* out)
+    {
+        for (uint8_t i = 0; i < RC_CODING_CH_NUM; i++) {
+            int16_t d;
+            if (bits_get(1) == 0) {
+                d = 0;
+            } else
+            if (bits_get(1) == 0) {
+                d = bits_get_signed(4);
+            } else
+            if (bits_get(1) == 0) {
+                d = bits_get_signed(7);
+            } else {
+                d = (int16_t)bits_get(11) - (int16_t)ref[i];
+            }
+            if (bits_pos > RC_CODING_BITS) return false; // must not happen
+            d += ref[i];
+            if (d < 0 || d > 2047) return false; // must not happen
+            out[i] = d;
+        }
+        return true;
+    }
+
+    // channels 5-12 with 9 bits, channels 13-16 as 3-way, this gives exactly 80 bits
+    void encode_keyframe(uint16_t* out, tRcData* rc)
+    {
+        for (uint8_t i = 0; i < 8; i++) {
+            uint16_t q = (rc->ch[4 + i] + 2) >> 2;
+            if (q > 511) q = 511;
+            bits_put(q, 9);
+            out[i] = q << 2;
+        }
+        for (uint8_t i = 8; i < RC_CODING_CH_NUM; i++) {
+            uint8_t v = (rc->ch[4 + i] >= 1536) ? 2 : ((rc->ch[4 + i] <= 512) ? 0 : 1); // 0 .. 1 .. 2, 3-way
+            bits_put(v, 2);
+            out[i] = (v > 1) ? 2047 : ((v < 1) ? 0 : 1024);
+        }
+    }
+
+    void decode_keyframe(uint16_t* out)
+    {
+        for (uint8_t i = 0; i < 8; i++) {
+            out[i] = bits_get(9) << 2;
+        }
+        for (uint8_t i = 8; i < RC_CODING_CH_NUM; i++) {
+            uint8_t v = bits_get(2);
+            out[i] = (v > 1) ? 2047 : ((v < 1) ? 0 : 1024);
+        }
+    }
+
+    // msb first
+    void bits_start(uint8_t* buf)
+    {
+        bits_buf = buf;
+        bits_pos = 0;
+    }
+
+    void bits_put(uint16_t v, uint8_t n)
+    {
+        for (uint8_t k = n; k > 0; k--) {
+            uint8_t mask = 0x80 >> (bits_pos & 7);
+            if (v & (1 << (k - 1))) bits_buf[bits_pos >> 3] |= mask; else bits_buf[bits_pos >> 3] &=~ mask;
+            bits_pos++;
+        }
+    }
+
+    uint16_t bits_get(uint8_t n)
+    {
+        uint16_t v = 0;
+        for (uint8_t k = 0; k < n; k++) {
+            if (bits_pos >= RC_CODING_BITS) { bits_pos++; continue; } // read past the end, caught by the caller
+            v <<= 1;
+            if (bits_buf[bits_pos >> 3] & (0x80 >> (bits_pos & 7))) v |= 1;
+            bits_pos++;
+        }
+        return v;
+    }
+
+    int16_t bits_get_signed(uint8_t n)
+    {
+        uint16_t v = bits_get(n);
+        if (v & (1 << (n - 1))) return (int16_t)v - (1 << n);
+        return v;
+    }
+
+    uint8_t* bits_buf;
+    uint8_t bits_pos;
+
+    uint8_t tx_cnt; // counts the frames, seq is taken from it
+    bool tx_sent;
+    uint8_t ack_cnt; // the frame which was acknowledged last
+    bool ack_valid;
+    uint8_t refresh_ch;
+
+    // the values of channels 5-16 as coded in the last frames, indexed by seq
+    uint16_t hist[RC_CODING_HISTORY_NUM][RC_CODING_CH_NUM];
+    bool hist_valid[RC_CODING_HISTORY_NUM];
+    bool rx_decoded;
+};
+
+
+#endif // RC_CODING_H
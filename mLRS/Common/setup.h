@@ -73,6 +73,33 @@ void setup_configure_metadata(void)
     SetupMetaData.Ortho_allowed_mask = 0; // not available, do not display
 #endif
 
+    //-- Fec: "off,on"
+    // only for FLRC, FSK, we cannot work out the actual mode here, so we go with the hal
+#if (defined DEVICE_HAS_SX128x && defined USE_FEATURE_FLRC) || defined DEVICE_HAS_SX126x
+    SetupMetaData.Fec_allowed_mask = 0b11; // all
+#else
+    SetupMetaData.Fec_allowed_mask = 0; // not available, do not display
+#endif
+
+    //-- RateAdapt: "off,on"
+    // needs at least two LoRa modes to switch between
+#if defined DEVICE_HAS_SX128x || defined DEVICE_HAS_SX126x
+    SetupMetaData.RateAdapt_allowed_mask = 0b11; // all
+#else
+    SetupMetaData.RateAdapt_allowed_mask = 0; // not available, do not display
+#endif
+
+    //-- ShortFrames: "off,on"
+    // needs LoRa explicit header, which the SX127x can't do with SF6
+#if defined DEVICE_HAS_SX128x || defined DEVICE_HAS_SX126x
+    SetupMetaData.ShortFrames_allowed_mask = 0b11; // all
+#else
+    SetupMetaData.ShortFrames_allowed_mask = 0; // not available, do not display
+#endif
+
+    //-- RcCoding: "std,delta"
+    SetupMetaData.RcCoding_allowed_mask = 0b11; // all
+
     //-- Tx:
 
     power_optstr_from_rfpower_list(SetupMetaData.Tx_Power_optstr, rfpower_list, RFPOWER_LIST_NUM, 44);
@@ -213,6 +240,10 @@ void setup_default(uint8_t config_id)
     Setup.Common[config_id].FrequencyBand = SETUP_RF_BAND;
     Setup.Common[config_id].Mode = SETUP_MODE;
     Setup.Common[config_id].Ortho = SETUP_RF_ORTHO;
+    Setup.Common[config_id].Fec = SETUP_RF_FEC;
+    Setup.Common[config_id].RateAdapt = SETUP_RATE_ADAPT;
+    Setup.Common[config_id].ShortFrames = SETUP_SHORT_FRAMES;
+    Setup.Common[config_id].RcCoding = SETUP_RC_CODING;
 
     Setup.Tx[config_id].Power = SETUP_TX_POWER;
     Setup.Tx[config_id].Diversity = SETUP_TX_DIVERSITY;
@@ -224,6 +255,7 @@ void setup_default(uint8_t config_id)
     Setup.Tx[config_id].SendRadioStatus = SETUP_TX_SEND_RADIO_STATUS;
     Setup.Tx[config_id].Buzzer = SETUP_TX_BUZZER;
     Setup.Tx[config_id].CliLineEnd = SETUP_TX_CLI_LINE_END;
+    Setup.Tx[config_id].FhssAdapt = SETUP_TX_FHSS_ADAPT;
 
     Setup.Rx.Power = SETUP_RX_POWER;
     Setup.Rx.Diversity = SETUP_RX_DIVERSITY;
@@ -236,6 +268,9 @@ void setup_default(uint8_t config_id)
     Setup.Rx.SendRadioStatus = SETUP_RX_SEND_RADIO_STATUS;
     Setup.Rx.Buzzer = SETUP_RX_BUZZER;
     Setup.Rx.SendRcChannels = SETUP_RX_SEND_RC_CHANNELS;
+    Setup.Rx.SerialArq = SETUP_RX_SERIAL_ARQ;
+    Setup.Rx.OutRate = SETUP_RX_OUT_RATE;
+    Setup.Rx.OutSmoothing = SETUP_RX_OUT_SMOOTHING;
 
     for (uint8_t ch = 0; ch < 12; ch++) { Setup.Rx.FailsafeOutChannelValues_Ch1_Ch12[ch] = 0; }
     for (uint8_t ch = 0; ch < 4; ch++) { Setup.Rx.FailsafeOutChannelValues_Ch13_Ch16[ch] = 1; }
@@ -301,6 +336,41 @@ void setup_sanitize_config(uint8_t config_id)
         Setup.Common[config_id].Ortho = ORTHO_NONE;
     }
 
+    SANITIZE(Common[config_id].Fec, FEC_NUM, SETUP_RF_FEC, FEC_OFF);
+    TST_NOTALLOWED(Fec_allowed_mask, Common[config_id].Fec, FEC_OFF);
+    switch (Setup.Common[config_id].Mode) { // restrict fec to FLRC, FSK
+    case MODE_FLRC_111HZ:
+    case MODE_FSK:
+        break;
+    default:
+        Setup.Common[config_id].Fec = FEC_OFF;
+    }
+
+    SANITIZE(Common[config_id].RateAdapt, RATE_ADAPT_NUM, SETUP_RATE_ADAPT, RATE_ADAPT_OFF);
+    TST_NOTALLOWED(RateAdapt_allowed_mask, Common[config_id].RateAdapt, RATE_ADAPT_OFF);
+    switch (Setup.Common[config_id].Mode) { // restrict rate adaption to the LoRa modes
+    case MODE_50HZ:
+    case MODE_31HZ:
+    case MODE_19HZ:
+        break;
+    default:
+        Setup.Common[config_id].RateAdapt = RATE_ADAPT_OFF;
+    }
+
+    SANITIZE(Common[config_id].ShortFrames, SHORT_FRAMES_NUM, SETUP_SHORT_FRAMES, SHORT_FRAMES_OFF);
+    TST_NOTALLOWED(ShortFrames_allowed_mask, Common[config_id].ShortFrames, SHORT_FRAMES_OFF);
+    switch (Setup.Common[config_id].Mode) { // restrict short frames to the LoRa modes
+    case MODE_50HZ:
+    case MODE_31HZ:
+    case MODE_19HZ:
+        break;
+    default:
+        Setup.Common[config_id].ShortFrames = SHORT_FRAMES_OFF;
+    }
+
+    SANITIZE(Common[config_id].RcCoding, RC_CODING_NUM, SETUP_RC_CODING, RC_CODING_STD);
+    TST_NOTALLOWED(RcCoding_allowed_mask, Common[config_id].RcCoding, RC_CODING_STD);
+
     //-- Tx:
 
     SANITIZE(Tx[config_id].Power, RFPOWER_LIST_NUM, SETUP_TX_POWER, RFPOWER_LIST_NUM - 1);
@@ -328,6 +398,8 @@ void setup_sanitize_config(uint8_t config_id)
 
     SANITIZE(Tx[config_id].CliLineEnd, CLI_LINE_END_NUM, SETUP_TX_CLI_LINE_END, CLI_LINE_END_CR);
 
+    SANITIZE(Tx[config_id].FhssAdapt, FHSS_ADAPT_NUM, SETUP_TX_FHSS_ADAPT, FHSS_ADAPT_OFF);
+
     // device cannot use mBridge (pin5) and CRSF (pin5) at the same time !
     // dest\src | NONE    | CRSF    | INPORT  | MBRIDGE
     // -------------------------------------------------
@@ -376,6 +448,12 @@ void setup_sanitize_config(uint8_t config_id)
 
     SANITIZE(Rx.SendRcChannels, SEND_RC_CHANNELS_NUM, SETUP_RX_SEND_RC_CHANNELS, SEND_RC_CHANNELS_OFF);
 
+    SANITIZE(Rx.SerialArq, SERIAL_ARQ_NUM, SETUP_RX_SERIAL_ARQ, SERIAL_ARQ_OFF);
+
+    SANITIZE(Rx.OutRate, OUT_RATE_NUM, SETUP_RX_OUT_RATE, OUT_RATE_LINK);
+
+    SANITIZE(Rx.OutSmoothing, OUT_SMOOTHING_NUM, SETUP_RX_OUT_SMOOTHING, OUT_SMOOTHING_HOLD);
+
     //-- Spares and deprecated options:
     // should be 0xFF'ed
 
@@ -538,6 +616,15 @@ void setup_configure_config(uint8_t config_id)
 
     configure_mode(Setup.Common[config_id].Mode);
 
+    Config.UseFec = (Setup.Common[config_id].Fec == FEC_ON);
+
+    Config.UseRateAdapt = (Setup.Common[config_id].RateAdapt == RATE_ADAPT_ON);
+
+    Config.UseShortFrames = (Setup.Common[config_id].ShortFrames == SHORT_FRAMES_ON);
+    Config.Sx.LoraHeaderExplicit = Config.UseShortFrames;
+
+    Config.UseRcDelta = (Setup.Common[config_id].RcCoding == RC_CODING_DELTA);
+
     Config.Sx.FrequencyBand = Config.FrequencyBand;
 
     //-- Fhss
@@ -27,6 +27,10 @@
 #define SETUP_MSK_MODE                &SetupMetaData.Mode_allowed_mask // this we infer from the hal
 #define SETUP_MSK_RFBAND              &SetupMetaData.FrequencyBand_allowed_mask // this we infer from the hal
 #define SETUP_MSK_RFORTHO             &SetupMetaData.Ortho_allowed_mask // this we infer from the hal
+#define SETUP_MSK_RFFEC               &SetupMetaData.Fec_allowed_mask // this we infer from the hal
+#define SETUP_MSK_RATEADAPT           &SetupMetaData.RateAdapt_allowed_mask // this we infer from the hal
+#define SETUP_MSK_SHORTFRAMES         &SetupMetaData.ShortFrames_allowed_mask // this we infer from the hal
+#define SETUP_MSK_RCCODING            &SetupMetaData.RcCoding_allowed_mask
 
 // for Tx,Rx, options limited depending on hardware, implementation
 #define SETUP_MSK_TX_DIVERSITY        &SetupMetaData.Tx_Diversity_allowed_mask // this we generate from the hal
@@ -82,6 +86,10 @@
   X( Setup.Common[0].Mode,          LIST, "Mode",             "MODE",             0,0,0,"", "50 Hz,31 Hz,19 Hz,FLRC,FSK", SETUP_MSK_MODE )\
   X( Setup.Common[0].FrequencyBand, LIST, "RF Band",          "RF_BAND",          0,0,0,"", SETUP_OPT_RFBAND, SETUP_MSK_RFBAND )\
   X( Setup.Common[0].Ortho,         LIST, "RF_Ortho",         "RF_ORTHO",         0,0,0,"", "off,1/3,2/3,3/3", SETUP_MSK_RFORTHO )\
+  X( Setup.Common[0].Fec,           LIST, "RF FEC",           "RF_FEC",           0,0,0,"", "off,on", SETUP_MSK_RFFEC )\
+  X( Setup.Common[0].RateAdapt,     LIST, "Rate Adapt",       "RATE_ADAPT",       0,0,0,"", "off,on", SETUP_MSK_RATEADAPT )\
+  X( Setup.Common[0].ShortFrames,   LIST, "Short Frames",     "SHORT_FRAMES",     0,0,0,"", "off,on", SETUP_MSK_SHORTFRAMES )\
+  X( Setup.Common[0].RcCoding,      LIST, "Rc Coding",        "RC_CODING",        0,0,0,"", "std,delta", SETUP_MSK_RCCODING )\
 
 #define SETUP_PARAMETER_LIST_TX \
   X( Setup.Tx[0].Power,             LIST, "Tx Power",         "TX_POWER",         0,0,0,"", SETUP_OPT_TX_POWER, MSK_ALL )\
@@ -94,6 +102,7 @@
   X( Setup.Tx[0].SendRadioStatus,   LIST, "Tx Snd RadioStat", "TX_SND_RADIOSTAT", 0,0,0,"", "off,1 Hz", MSK_ALL )\
   X( Setup.Tx[0].Buzzer,            LIST, "Tx Buzzer",        "TX_BUZZER",        0,0,0,"", "off,LP,rxLQ", SETUP_MSK_TX_BUZZER )\
   X( Setup.Tx[0].CliLineEnd,        LIST, "Tx Cli LineEnd",   "TX_CLI_LINEEND",   0,0,0,"", "CR,LF,CRLF", MSK_ALL )\
+  X( Setup.Tx[0].FhssAdapt,         LIST, "Tx Fhss Adapt",    "TX_FHSS_ADAPT",    0,0,0,"", "off,on", MSK_ALL )\
 
 #define SETUP_PARAMETER_LIST_RX \
   X( Setup.Rx.Power,              LIST, "Rx Power",         "RX_POWER",         0,0,0,"", SETUP_OPT_RX_POWER, MSK_ALL )\
@@ -103,11 +112,14 @@
   X( Setup.Rx.FailsafeMode,       LIST, "Rx FailSafe Mode", "RX_FAILSAFE_MODE", 0,0,0,"", "no sig,low thr,by cnf,low thr cnt,ch1ch4 cnt", MSK_ALL )\
   X( Setup.Rx.SerialBaudrate,     LIST, "Rx Ser Baudrate",  "RX_SER_BAUD",      0,0,0,"", SETUP_OPT_RX_SERIAL_BAUDRATE, MSK_ALL )\
   X( Setup.Rx.SerialLinkMode,     LIST, "Rx Ser Link Mode", "RX_SER_LNK_MODE",  0,0,0,"", SETUP_OPT_SERIAL_LINK_MODE, MSK_ALL )\
-  X( Setup.Rx.SendRadioStatus,    LIST, "Rx Snd RadioStat", "RX_SND_RADIOSTAT", 0,0,0,"", "off,ardu_1,meth_b", MSK_ALL )\
+  X( Setup.Rx.SendRadioStatus,    LIST, "Rx Snd RadioStat", "RX_SND_RADIOSTAT", 0,0,0,"", "off,ardu_1,meth_b,model", MSK_ALL )\
   X( Setup.Rx.SendRcChannels,     LIST, "Rx Snd RcChannel", "RX_SND_RCCHANNEL", 0,0,0,"", "off,rc override,rc channels", MSK_ALL )\
   X( Setup.Rx.Buzzer,             LIST, "Rx Buzzer",        "RX_BUZZER",        0,0,0,"", "off,LP", SETUP_MSK_RX_BUZZER )\
   X( Setup.Rx.OutRssiChannelMode, LIST, "Rx Out Rssi Ch",   "RX_OUT_RSSI_CH",   0,0,0,"", "off,5,6,7,8,9,10,11,12,13,14,15,16", MSK_ALL )\
   X( Setup.Rx.OutLqChannelMode,   LIST, "Rx Out LQ Ch",     "RX_OUT_LQ_CH",     0,0,0,"", "off,5,6,7,8,9,10,11,12,13,14,15,16", MSK_ALL )\
+  X( Setup.Rx.SerialArq,          LIST, "Rx Ser Arq",       "RX_SER_ARQ",       0,0,0,"", "off,on", MSK_ALL )\
+  X( Setup.Rx.OutRate,            LIST, "Rx Out Rate",      "RX_OUT_RATE",      0,0,0,"", "link,150 Hz,250 Hz", MSK_ALL )\
+  X( Setup.Rx.OutSmoothing,       LIST, "Rx Out Smoothing", "RX_OUT_SMOOTH",    0,0,0,"", "hold,interp,extrap", MSK_ALL )\
   \
   X( Setup.Rx.FailsafeOutChannelValues_Ch1_Ch12[0],  INT8, "Rx FS Ch1", "RX_FS_CH1", 0, -120, 120, "%", "",0 )\
   X( Setup.Rx.FailsafeOutChannelValues_Ch1_Ch12[1],  INT8, "Rx FS Ch2", "RX_FS_CH2", 0, -120, 120, "%", "",0 )\
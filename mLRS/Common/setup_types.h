@@ -63,6 +63,34 @@ typedef enum {
 } EXCEPT_ENUM;
 
 
+typedef enum {
+    FEC_OFF = 0,
+    FEC_ON,
+    FEC_NUM,
+} FEC_ENUM;
+
+
+typedef enum {
+    RATE_ADAPT_OFF = 0,
+    RATE_ADAPT_ON,
+    RATE_ADAPT_NUM,
+} RATE_ADAPT_ENUM;
+
+
+typedef enum {
+    SHORT_FRAMES_OFF = 0,
+    SHORT_FRAMES_ON,
+    SHORT_FRAMES_NUM,
+} SHORT_FRAMES_ENUM;
+
+
+typedef enum {
+    RC_CODING_STD = 0, // channels 1-8 with 11 bits, 9-12 with 8 bits, 13-16 3-way
+    RC_CODING_DELTA, // all channels with 11 bits, delta coded
+    RC_CODING_NUM,
+} RC_CODING_ENUM;
+
+
 typedef enum {
     DIVERSITY_DEFAULT = 0, // diversity enabled, both receive and transmit
     DIVERSITY_ANTENNA1, // antenna 1
@@ -118,6 +146,7 @@ typedef enum {
     RX_SEND_RADIO_STATUS_OFF = 0,
     RX_SEND_RADIO_STATUS_METHOD_ARDUPILOT_1,
     RX_SEND_RADIO_STATUS_METHOD_PX4,
+    RX_SEND_RADIO_STATUS_METHOD_MODEL,
     RX_SEND_RADIO_STATUS_NUM,
 } RX_SEND_RADIO_STATUS_ENUM;
 
@@ -169,6 +198,13 @@ typedef enum {
 } TX_CLI_LINE_END_ENUM;
 
 
+typedef enum {
+    FHSS_ADAPT_OFF = 0,
+    FHSS_ADAPT_ON,
+    FHSS_ADAPT_NUM,
+} TX_FHSS_ADAPT_ENUM;
+
+
 typedef enum {
     BUZZER_OFF = 0,
     BUZZER_LOST_PACKETS,
@@ -223,6 +259,29 @@ typedef enum {
 } RX_SEND_RCCHANNELS_ENUM;
 
 
+typedef enum {
+    SERIAL_ARQ_OFF = 0,
+    SERIAL_ARQ_ON,
+    SERIAL_ARQ_NUM,
+} SERIAL_ARQ_ENUM;
+
+
+typedef enum {
+    OUT_RATE_LINK = 0,
+    OUT_RATE_150HZ,
+    OUT_RATE_250HZ,
+    OUT_RATE_NUM,
+} RX_OUT_RATE_ENUM;
+
+
+typedef enum {
+    OUT_SMOOTHING_HOLD = 0,
+    OUT_SMOOTHING_INTERPOLATE,
+    OUT_SMOOTHING_EXTRAPOLATE,
+    OUT_SMOOTHING_NUM,
+} RX_OUT_SMOOTHING_ENUM;
+
+
 //-------------------------------------------------------
 // Config Enums
 //-------------------------------------------------------
@@ -260,8 +319,12 @@ typedef struct
     uint8_t FrequencyBand;
     uint8_t Mode;
     uint8_t Ortho;
+    uint8_t Fec;
+    uint8_t RateAdapt;
+    uint8_t ShortFrames;
+    uint8_t RcCoding;
 
-    uint8_t spare[6];
+    uint8_t spare[2];
 } tCommonSetup; // 16 bytes
 
 
@@ -278,8 +341,9 @@ typedef struct
     uint8_t SendRadioStatus;
     uint8_t Buzzer;
     uint8_t CliLineEnd;
+    uint8_t FhssAdapt;
 
-    uint8_t spare[9];
+    uint8_t spare[8];
 } tTxSetup; // 20 bytes
 
 
@@ -298,8 +362,11 @@ typedef struct
     uint8_t SendRcChannels;
     uint8_t __RadioStatusMethod; // deprecated
     uint8_t OutLqChannelMode;
+    uint8_t SerialArq;
+    uint8_t OutRate;
+    uint8_t OutSmoothing;
 
-    uint8_t spare[7];
+    uint8_t spare[4];
 
     int8_t FailsafeOutChannelValues_Ch1_Ch12[12]; // -120 .. +120
     uint8_t FailsafeOutChannelValues_Ch13_Ch16[4]; // 0,1,2 = -120, 0, +120
@@ -350,6 +417,10 @@ typedef struct
     uint16_t FrequencyBand_allowed_mask;
     uint16_t Mode_allowed_mask;
     uint16_t Ortho_allowed_mask;
+    uint16_t Fec_allowed_mask;
+    uint16_t RateAdapt_allowed_mask;
+    uint16_t ShortFrames_allowed_mask;
+    uint16_t RcCoding_allowed_mask;
 
     char Tx_Power_optstr[44+1];
     uint16_t Tx_Diversity_allowed_mask;
@@ -381,6 +452,7 @@ typedef struct
     uint32_t FlrcSyncWord;
     int8_t Power_dbm;
     uint8_t FrequencyBand;
+    bool LoraHeaderExplicit; // needed for short frames, the receiving sx must know the length
     // helper
     bool is_lora;
     bool modeIsLora(void) { return is_lora; }
@@ -408,6 +480,10 @@ typedef struct
     uint8_t send_frame_tmo_ms;
 
     uint16_t FrameSyncWord;
+    bool UseFec;
+    bool UseRateAdapt;
+    bool UseShortFrames;
+    bool UseRcDelta;
     
     tFhssGlobalConfig Fhss;
 
@@ -0,0 +1,127 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Slot Schedule
+//*******************************************************
+// Asymmetric use of the frame periods, for bulk transfers in the downlink, like log or
+// parameter downloads.
+//
+// Normally each period has a Tx frame followed by a Rx frame. In a downlink slot the Tx
+// does not transmit, and the Rx sends a frame in the place of the Tx frame, in addition
+// to its own. The schedule alternates normal and downlink slots, so that in two periods
+// one frame goes up and three go down. The rc data hence comes at half the frame rate,
+// which is allowed only if this is at least SLOT_SCHEDULE_RC_RATE_MIN_HZ.
+//
+// The Rx sets the downlink flag in its frames when its serial data backs up. The Tx
+// switches the schedule on when it got the flag in some frames in a row, and off when it
+// hasn't seen it for a while. It announces each downlink slot by the downlink flag in the
+// Tx frame before it. The Rx sends in the place of the Tx frame only if it got the
+// announcement, so if this is lost the slot is just not used. A Rx which doesn't know
+// about slots never sets the flag, and is hence never asked to do it.
+//
+// It is not used together with ARQ, as the stop-and-wait needs the strict alternation,
+// and not while a link task, mode switch or fhss swap is going on.
+//*******************************************************
+#ifndef SLOT_SCHEDULE_H
+#define SLOT_SCHEDULE_H
+#pragma once
+
+
+#include <inttypes.h>
+
+
+#define SLOT_SCHEDULE_RC_RATE_MIN_HZ      15 // rc data must come at least that often
+#define SLOT_SCHEDULE_BACKLOG_BYTES       256 // Rx requests downlink slots if more serial data is waiting
+#define SLOT_SCHEDULE_ON_CNT              3 // number of Rx frames in a row with request to switch on
+#define SLOT_SCHEDULE_HOLD_MS             500 // switches off if no request for this time
+#define SLOT_SCHEDULE_FRAME_WAIT_US       500 // Tx: time the frame in the Tx's place may come late
+
+
+class tSlotSchedule
+{
+  public:
+    void Init(void)
+    {
+        Reset();
+    }
+
+    void Reset(void) // called then not connected
+    {
+        active = false;
+        request_cnt = 0;
+        hold_cnt = 0;
+        downlink = false;
+        downlink_next = false;
+    }
+
+    bool IsActive(void) { return active; }
+    bool IsDownlink(void) { return downlink; } // the current period is a downlink slot
+
+    // the frame rate must be high enough for the rc data to come often enough
+    bool RateAllowed(void) { return (Config.frame_rate_hz >= 2 * SLOT_SCHEDULE_RC_RATE_MIN_HZ); }
+
+    //-- Tx
+
+    // to be called for each valid Rx frame, with its downlink flag
+    void HandleRequest(bool request)
+    {
+        if (!request) {
+            request_cnt = 0;
+            return;
+        }
+        if (request_cnt < SLOT_SCHEDULE_ON_CNT) request_cnt++;
+        if (request_cnt >= SLOT_SCHEDULE_ON_CNT) active = true;
+        hold_cnt = SLOT_SCHEDULE_HOLD_MS / Config.frame_rate_ms;
+    }
+
+    // to be called once per period, before the frame is transmitted
+    // returns true if the period is a downlink slot
+    bool Tick(void)
+    {
+        if (hold_cnt) hold_cnt--; else active = false;
+        downlink = downlink_next;
+        downlink_next = false;
+        return downlink;
+    }
+
+    // to be called when the Tx frame is packed, returns the downlink flag to put into it
+    uint8_t Announce(bool allowed)
+    {
+        downlink_next = (active && allowed && !downlink);
+        return (downlink_next) ? 1 : 0;
+    }
+
+    //-- Rx
+
+    // returns the downlink flag to put into the Rx frame
+    uint8_t Request(uint16_t backlog_bytes)
+    {
+        return (backlog_bytes > SLOT_SCHEDULE_BACKLOG_BYTES) ? 1 : 0;
+    }
+
+    // to be called for each valid Tx frame, with its downlink flag
+    void SetAnnounced(bool announced) { downlink_next = announced; }
+
+    // to be called when going to receive, after the Rx frame was transmitted
+    // returns true if the next period is a downlink slot, so that we transmit in place of the Tx
+    bool Next(bool allowed)
+    {
+        downlink = (downlink_next && allowed);
+        downlink_next = false;
+        return downlink;
+    }
+
+  private:
+    bool active;
+    uint8_t request_cnt;
+    uint16_t hold_cnt;
+
+    bool downlink;
+    bool downlink_next; // Tx: was announced in the last Tx frame, Rx: was announced in the last received Tx frame
+};
+
+
+#endif // SLOT_SCHEDULE_H
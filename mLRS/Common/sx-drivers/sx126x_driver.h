@@ -81,6 +81,30 @@ const tSxGfskConfiguration Sx126xGfskConfiguration[] = {
 };
 
 
+// time on air for a LoRa configuration, see lora_time_over_air_us()
+uint32_t Sx126xLoraTimeOverAir_us(const tSxLoraConfiguration* config, uint8_t payload_len, bool header_explicit)
+{
+uint8_t sf, cr;
+uint32_t bw_hz;
+
+    switch (config->SpreadingFactor) {
+    case SX126X_LORA_SF5: sf = 5; break;
+    case SX126X_LORA_SF6: sf = 6; break;
+    default: while (1) {} // must not happen, only what is used in the configurations
+    }
+    switch (config->Bandwidth) {
+    case SX126X_LORA_BW_500: bw_hz = 500000; break;
+    default: while (1) {} // must not happen
+    }
+    switch (config->CodingRate) {
+    case SX126X_LORA_CR_4_5: cr = 1; break;
+    default: while (1) {} // must not happen
+    }
+
+    return lora_time_over_air_us(sf, bw_hz, cr, config->PreambleLength, header_explicit, (config->CrcEnabled != SX126X_LORA_CRC_DISABLE), payload_len);
+}
+
+
 typedef enum {
     SX12xx_OSCILLATOR_CONFIG_TXCO_1P6_V = SX126X_DIO3_OUTPUT_1_6,
     SX12xx_OSCILLATOR_CONFIG_TXCO_1P7_V = SX126X_DIO3_OUTPUT_1_7,
@@ -134,8 +158,12 @@ class Sx126xDriverCommon : public Sx126xDriverBase
                             config->Bandwidth,
                             config->CodingRate);
 
+        // with short frames the header is needed, so that the receiving sx knows the length
+        lora_header_type = (gconfig->LoraHeaderExplicit) ? SX126X_LORA_HEADER_ENABLE : config->HeaderType;
+        lora_payload_length = config->PayloadLength;
+
         SetPacketParams(config->PreambleLength,
-                        config->HeaderType,
+                        lora_header_type,
                         config->PayloadLength,
                         config->CrcEnabled,
                         config->InvertIQ);
@@ -273,6 +301,7 @@ class Sx126xDriverCommon : public Sx126xDriverBase
 
     void SendFrame(uint8_t* data, uint8_t len, uint16_t tmo_ms)
     {
+        SetLoraPayloadLength(len);
         WriteBuffer(0, data, len);
         ClearIrqStatus(SX126X_IRQ_ALL);
         SetTx(tmo_ms * 64); // 0 = no timeout. TimeOut period inn ms. sx1262 have static 15p625 period base, so for 1 ms needs 64 tmo value
@@ -280,6 +309,7 @@ class Sx126xDriverCommon : public Sx126xDriverBase
 
     void SetToRx(uint16_t tmo_ms)
     {
+        SetLoraPayloadLength(FRAME_TX_RX_LEN); // the max length we accept
         ClearIrqStatus(SX126X_IRQ_ALL);
         SetRx(tmo_ms * 64); // 0 = no timeout
     }
@@ -308,6 +338,19 @@ class Sx126xDriverCommon : public Sx126xDriverBase
 
     void HandleAFC(void) {}
 
+    // with explicit header the length of the frame to send must be set, else this does nothing
+    void SetLoraPayloadLength(uint8_t len)
+    {
+        if (!gconfig->modeIsLora() || !gconfig->LoraHeaderExplicit) return;
+        if (len == lora_payload_length) return;
+        lora_payload_length = len;
+        SetPacketParams(lora_configuration->PreambleLength,
+                        lora_header_type,
+                        len,
+                        lora_configuration->CrcEnabled,
+                        lora_configuration->InvertIQ);
+    }
+
     //-- RF power interface
 
     virtual void RfPowerCalc(int8_t power_dbm, uint8_t* sx_power, int8_t* actual_power_dbm) = 0;
@@ -336,6 +379,18 @@ class Sx126xDriverCommon : public Sx126xDriverBase
         return (gconfig->modeIsLora()) ? lora_configuration->TimeOverAir : gfsk_configuration->TimeOverAir;
     }
 
+    // time on air of a frame with len bytes, differs from the above only for short frames
+    // we correct the hardcoded value by the calculated difference
+    uint32_t TimeOverAir_us(uint8_t len)
+    {
+        uint32_t toa_us = TimeOverAir_us();
+        if (!gconfig->modeIsLora() || !gconfig->LoraHeaderExplicit) return toa_us;
+
+        uint32_t toa_full_us = Sx126xLoraTimeOverAir_us(lora_configuration, lora_configuration->PayloadLength, false);
+        uint32_t toa_len_us = Sx126xLoraTimeOverAir_us(lora_configuration, len, true);
+        return toa_us + toa_len_us - toa_full_us;
+    }
+
     int16_t ReceiverSensitivity_dbm(void)
     {
         if (lora_configuration == nullptr && gfsk_configuration == nullptr) config_calc(); // ensure it is set
@@ -355,6 +410,8 @@ class Sx126xDriverCommon : public Sx126xDriverBase
 
   private:
     const tSxLoraConfiguration* lora_configuration;
+    uint8_t lora_header_type;
+    uint8_t lora_payload_length;
     const tSxGfskConfiguration* gfsk_configuration;
     tSxGlobalConfig* gconfig;
     uint8_t sx_power;
@@ -229,6 +229,9 @@ class Sx127xDriverCommon : public Sx127xDriverBase
         return lora_configuration->TimeOverAir;
     }
 
+    // short frames are not supported, SF6 can't do explicit header
+    uint32_t TimeOverAir_us(uint8_t len) { return TimeOverAir_us(); }
+
     int16_t ReceiverSensitivity_dbm(void)
     {
         if (lora_configuration == nullptr) config_calc(); // ensure it is set
@@ -86,6 +86,31 @@ const tSxFlrcConfiguration Sx128xFlrcConfiguration[] = {
 };
 
 
+// time on air for a LoRa configuration, see lora_time_over_air_us()
+uint32_t Sx128xLoraTimeOverAir_us(const tSxLoraConfiguration* config, uint8_t payload_len, bool header_explicit)
+{
+uint8_t sf, cr;
+uint32_t bw_hz;
+
+    switch (config->SpreadingFactor) {
+    case SX1280_LORA_SF5: sf = 5; break;
+    case SX1280_LORA_SF6: sf = 6; break;
+    case SX1280_LORA_SF7: sf = 7; break;
+    default: while (1) {} // must not happen, only what is used in the configurations
+    }
+    switch (config->Bandwidth) {
+    case SX1280_LORA_BW_800: bw_hz = 812500; break;
+    default: while (1) {} // must not happen
+    }
+    switch (config->CodingRate) {
+    case SX1280_LORA_CR_LI_4_5: cr = 1; break;
+    default: while (1) {} // must not happen
+    }
+
+    return lora_time_over_air_us(sf, bw_hz, cr, config->PreambleLength, header_explicit, (config->CrcEnabled != SX1280_LORA_CRC_DISABLE), payload_len);
+}
+
+
 #ifdef POWER_USE_DEFAULT_RFPOWER_CALC
 void sx1280_rfpower_calc(const int8_t power_dbm, uint8_t* sx_power, int8_t* actual_power_dbm, const uint8_t GAIN_DBM, const uint8_t SX1280_MAX_DBM)
 {
@@ -124,8 +149,12 @@ class Sx128xDriverCommon : public Sx128xDriverBase
                             config->Bandwidth,
                             config->CodingRate);
 
+        // with short frames the header is needed, so that the receiving sx knows the length
+        lora_header_type = (gconfig->LoraHeaderExplicit) ? SX1280_LORA_HEADER_ENABLE : config->HeaderType;
+        lora_payload_length = config->PayloadLength;
+
         SetPacketParams(config->PreambleLength,
-                        config->HeaderType,
+                        lora_header_type,
                         config->PayloadLength,
                         config->CrcEnabled,
                         config->InvertIQ);
@@ -231,6 +260,7 @@ class Sx128xDriverCommon : public Sx128xDriverBase
 
     void SendFrame(uint8_t* data, uint8_t len, uint16_t tmo_ms)
     {
+        SetLoraPayloadLength(len);
         WriteBuffer(0, data, len);
         ClearIrqStatus(SX1280_IRQ_ALL);
         SetTx(SX1280_PERIODBASE_62p5_US, tmo_ms*16); // 0 = no timeout, if a Tx timeout occurs we have a serious problem
@@ -238,6 +268,7 @@ class Sx128xDriverCommon : public Sx128xDriverBase
 
     void SetToRx(uint16_t tmo_ms)
     {
+        SetLoraPayloadLength(FRAME_TX_RX_LEN); // the max length we accept
         ClearIrqStatus(SX1280_IRQ_ALL);
         SetRx(SX1280_PERIODBASE_62p5_US, tmo_ms*16); // 0 = no timeout
     }
@@ -268,6 +299,19 @@ class Sx128xDriverCommon : public Sx128xDriverBase
 
     void HandleAFC(void) {}
 
+    // with explicit header the length of the frame to send must be set, else this does nothing
+    void SetLoraPayloadLength(uint8_t len)
+    {
+        if (!gconfig->modeIsLora() || !gconfig->LoraHeaderExplicit) return;
+        if (len == lora_payload_length) return;
+        lora_payload_length = len;
+        SetPacketParams(lora_configuration->PreambleLength,
+                        lora_header_type,
+                        len,
+                        lora_configuration->CrcEnabled,
+                        lora_configuration->InvertIQ);
+    }
+
     //-- RF power interface
 
     virtual void RfPowerCalc(int8_t power_dbm, uint8_t* sx_power, int8_t* actual_power_dbm) = 0;
@@ -296,6 +340,18 @@ class Sx128xDriverCommon : public Sx128xDriverBase
         return (gconfig->modeIsLora()) ? lora_configuration->TimeOverAir : flrc_configuration->TimeOverAir;
     }
 
+    // time on air of a frame with len bytes, differs from the above only for short frames
+    // we correct the hardcoded value by the calculated difference
+    uint32_t TimeOverAir_us(uint8_t len)
+    {
+        uint32_t toa_us = TimeOverAir_us();
+        if (!gconfig->modeIsLora() || !gconfig->LoraHeaderExplicit) return toa_us;
+
+        uint32_t toa_full_us = Sx128xLoraTimeOverAir_us(lora_configuration, lora_configuration->PayloadLength, false);
+        uint32_t toa_len_us = Sx128xLoraTimeOverAir_us(lora_configuration, len, true);
+        return toa_us + toa_len_us - toa_full_us;
+    }
+
     int16_t ReceiverSensitivity_dbm(void)
     {
         if (lora_configuration == nullptr && flrc_configuration == nullptr) config_calc(); // ensure it is set
@@ -312,6 +368,8 @@ class Sx128xDriverCommon : public Sx128xDriverBase
 
   private:
     const tSxLoraConfiguration* lora_configuration;
+    uint8_t lora_header_type;
+    uint8_t lora_payload_length;
     const tSxFlrcConfiguration* flrc_configuration;
     tSxGlobalConfig* gconfig;
     uint8_t sx_power;
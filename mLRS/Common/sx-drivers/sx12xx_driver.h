@@ -78,6 +78,28 @@ typedef struct
 } tSxLoraConfiguration;
 
 
+// LoRa time on air, as given in the Semtech datasheets
+// sf = 5..12, cr = 1..4 for 4/5..4/8, low data rate optimization is not used by us
+// SF5 and SF6 are as for the SX126x and SX128x
+// the results are somewhat larger than the measured values in the configuration tables,
+// so we use it for differences only
+uint32_t lora_time_over_air_us(uint8_t sf, uint32_t bw_hz, uint8_t cr, uint16_t preamble_len, bool header_explicit, bool crc_enabled, uint8_t payload_len)
+{
+    int32_t bits = 8 * (int32_t)payload_len - 4 * sf;
+    if (crc_enabled) bits += 16;
+    if (header_explicit) bits += 20;
+    if (sf >= 7) bits += 8;
+
+    int32_t payload_symb = 8;
+    if (bits > 0) payload_symb += ((bits + 4 * sf - 1) / (4 * sf)) * (cr + 4);
+
+    // in units of quarter symbols, to handle the 4.25 or 6.25 of the preamble
+    uint32_t symb_x4 = 4 * ((uint32_t)preamble_len + payload_symb) + ((sf >= 7) ? 17 : 25);
+
+    return (((uint64_t)symb_x4 << sf) * 250000) / bw_hz;
+}
+
+
 class SxDriverDummy
 {
   public:
@@ -92,6 +114,7 @@ class SxDriverDummy
     void SetToRx(uint16_t tmo_ms) {}
     void SetToIdle(void) {}
 
+    void SetLoraConfigurationByIndex(uint8_t index) {}
     void ResetToLoraConfiguration() {}
     void SetRfPower_dbm(int8_t power_dbm) {}
     void ClearIrqStatus(uint16_t IrqMask) {}
@@ -103,7 +126,9 @@ class SxDriverDummy
 };
 
 
-#ifdef DEVICE_HAS_SX126x
+#ifdef DEVICE_HAS_SX_SIM
+#include "sxsim_driver.h"
+#elif defined DEVICE_HAS_SX126x
 #include "sx126x_driver.h"
 #elif defined DEVICE_HAS_SX127x
 #include "sx127x_driver.h"
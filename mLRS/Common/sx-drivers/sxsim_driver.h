@@ -0,0 +1,318 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// SX Simulation Driver
+//*******************************************************
+// Software stand-in for the SX_DRIVER/SX2_DRIVER API, for running the main loops
+// as host processes. Enabled by DEVICE_HAS_SX_SIM, which is set in addition to
+// DEVICE_HAS_SX128x, i.e., a SX1280 is mimicked.
+//
+// Frames sent with SendFrame() are handed to a tSxSimMedium, which is provided
+// by the host harness and moves the bytes to the other side by whatever means.
+// The harness hands frames back in with Deliver(), where the channel model is
+// applied. The channel model is deterministic for a given seed.
+//
+// tools/host-tests/sim_link.cpp uses it to step the Tx and the Rx against each other, with the
+// connect state machine of link_connect.h, fhss and ARQ.
+//*******************************************************
+#ifndef SXSIM_DRIVER_H
+#define SXSIM_DRIVER_H
+#pragma once
+
+
+#include <string.h>
+
+
+//-------------------------------------------------------
+// Medium and Channel Model
+//-------------------------------------------------------
+
+class tSxSimMedium
+{
+  public:
+    virtual void Put(uint8_t node, uint32_t freq, uint8_t* data, uint8_t len) = 0;
+};
+
+
+typedef struct
+{
+    uint32_t seed;
+    uint32_t loss_ppm; // probability to lose a frame, in parts per million
+    uint32_t ber_ppm; // probability of a bit error, in parts per million
+    int8_t rssi; // rssi of received frames, in dBm
+    int8_t snr; // snr of received frames, in dB
+} tSxSimChannelConfig;
+
+
+class tSxSimChannel
+{
+  public:
+    void Init(tSxSimChannelConfig* _config)
+    {
+        config = *_config;
+        state = (config.seed) ? config.seed : 0x2545F491;
+        frames_cnt = 0;
+        frames_lost_cnt = 0;
+        bit_errors_cnt = 0;
+    }
+
+    // returns false if the frame is lost
+    bool Apply(uint8_t* data, uint8_t len)
+    {
+        frames_cnt++;
+
+        if (config.loss_ppm && (rand() % 1000000) < config.loss_ppm) {
+            frames_lost_cnt++;
+            return false;
+        }
+
+        if (config.ber_ppm) {
+            for (uint16_t n = 0; n < len; n++) {
+                for (uint8_t bit = 0; bit < 8; bit++) {
+                    if ((rand() % 1000000) < config.ber_ppm) {
+                        data[n] ^= (1 << bit);
+                        bit_errors_cnt++;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    int8_t Rssi(void) { return config.rssi; }
+    int8_t Snr(void) { return config.snr; }
+
+    uint32_t frames_cnt;
+    uint32_t frames_lost_cnt;
+    uint32_t bit_errors_cnt;
+
+  private:
+    // xorshift32, we want it deterministic and independent of the host's libc
+    uint32_t rand(void)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    tSxSimChannelConfig config;
+    uint32_t state;
+};
+
+
+//-------------------------------------------------------
+// SX Driver
+//-------------------------------------------------------
+
+#define SXSIM_BUF_LEN  256
+
+
+const uint32_t SxSimLoraTimeOverAir[] = { 7892, 13418, 23527 }; // same as Sx128xLoraConfiguration
+const int16_t SxSimLoraReceiverSensitivity[] = { -105, -108, -112 };
+#define SXSIM_FLRC_TIME_OVER_AIR              2383
+#define SXSIM_FLRC_RECEIVER_SENSITIVITY       -104
+
+
+// the irq bits, same values as for the SX1280, but we don't want to depend on the sx12xx-lib
+typedef enum {
+    SXSIM_IRQ_TX_DONE       = 0x0001,
+    SXSIM_IRQ_RX_DONE       = 0x0002,
+    SXSIM_IRQ_RX_TX_TIMEOUT = 0x4000,
+    SXSIM_IRQ_ALL           = 0xFFFF,
+} SXSIM_IRQ_ENUM;
+
+
+// map the irq bits
+typedef enum {
+    SX_IRQ_TX_DONE = SXSIM_IRQ_TX_DONE,
+    SX_IRQ_RX_DONE = SXSIM_IRQ_RX_DONE,
+    SX_IRQ_TIMEOUT = SXSIM_IRQ_RX_TX_TIMEOUT,
+    SX_IRQ_ALL     = SXSIM_IRQ_ALL,
+} SX_IRQ_ENUM;
+
+typedef enum {
+    SX2_IRQ_TX_DONE = SXSIM_IRQ_TX_DONE,
+    SX2_IRQ_RX_DONE = SXSIM_IRQ_RX_DONE,
+    SX2_IRQ_TIMEOUT = SXSIM_IRQ_RX_TX_TIMEOUT,
+    SX2_IRQ_ALL     = SXSIM_IRQ_ALL,
+} SX2_IRQ_ENUM;
+
+
+typedef enum {
+    SXSIM_STATE_IDLE = 0,
+    SXSIM_STATE_RX,
+    SXSIM_STATE_TX,
+} SXSIM_STATE_ENUM;
+
+
+class SxSimDriverBase
+{
+  public:
+    void Init(void)
+    {
+        medium = nullptr;
+        channel = nullptr;
+        dio_callback = nullptr;
+        gconfig = nullptr;
+        state = SXSIM_STATE_IDLE;
+        irq_status = 0;
+        freq = 0;
+        actual_power_dbm = 0;
+        rx_len = 0;
+        memset(buf, 0, SXSIM_BUF_LEN);
+    }
+
+    // to be called by the host harness before StartUp()
+    void SetMedium(tSxSimMedium* _medium, tSxSimChannel* _channel, uint8_t _node, void (*_dio_callback)(void))
+    {
+        medium = _medium;
+        channel = _channel;
+        node = _node;
+        dio_callback = _dio_callback;
+    }
+
+    //-- high level API functions
+
+    bool isOk(void) { return true; }
+
+    void StartUp(tSxGlobalConfig* global_config)
+    {
+        gconfig = global_config;
+        SetRfPower_dbm(gconfig->Power_dbm);
+    }
+
+    void SetRfFrequency(uint32_t RfFrequency) { freq = RfFrequency; }
+
+    void SetLoraConfigurationByIndex(uint8_t index) {} // the index is taken from gconfig
+
+    void ResetToLoraConfiguration(void) {}
+
+    void SetRfPower_dbm(int8_t power_dbm) { actual_power_dbm = power_dbm; }
+
+    uint16_t GetAndClearIrqStatus(uint16_t IrqMask)
+    {
+        uint16_t irq = irq_status & IrqMask;
+        irq_status &= ~IrqMask;
+        return irq;
+    }
+
+    void ClearIrqStatus(uint16_t IrqMask) { irq_status &= ~IrqMask; }
+
+    void GetRxBufferStatus(uint8_t* rxPayloadLength, uint8_t* rxStartBufferPointer)
+    {
+        *rxPayloadLength = 0; // header is disabled, so is always 0, as for the real chip
+        *rxStartBufferPointer = 0;
+    }
+
+    void ReadBuffer(uint8_t offset, uint8_t* data, uint8_t len)
+    {
+        if ((uint16_t)offset + len > SXSIM_BUF_LEN) while (1) {} // must not happen
+        memcpy(data, &(buf[offset]), len);
+    }
+
+    //-- this are the API functions used in the loop
+
+    void ReadFrame(uint8_t* data, uint8_t len)
+    {
+        ReadBuffer(0, data, len);
+    }
+
+    void SendFrame(uint8_t* data, uint8_t len, uint16_t tmo_ms = 0)
+    {
+        state = SXSIM_STATE_TX;
+        irq_status = 0;
+        if (medium) medium->Put(node, freq, data, len);
+        // we do not model the time on air, the harness needs to take care of that
+        state = SXSIM_STATE_IDLE;
+        irq_status |= SXSIM_IRQ_TX_DONE;
+        if (dio_callback) dio_callback();
+    }
+
+    void SetToRx(uint16_t tmo_ms = 0)
+    {
+        irq_status = 0;
+        state = SXSIM_STATE_RX;
+    }
+
+    void SetToIdle(void)
+    {
+        state = SXSIM_STATE_IDLE;
+        irq_status = 0;
+    }
+
+    void GetPacketStatus(int8_t* RssiSync, int8_t* Snr)
+    {
+        *RssiSync = (channel) ? channel->Rssi() : -50;
+        *Snr = (gconfig && gconfig->modeIsLora() && channel) ? channel->Snr() : 0;
+    }
+
+    void HandleAFC(void) {}
+
+    //-- interface to the host harness
+
+    // a frame arrives from the medium, only accepted if we are in rx and on the same frequency
+    void Deliver(uint32_t _freq, uint8_t* data, uint8_t len)
+    {
+        if (state != SXSIM_STATE_RX || _freq != freq) return;
+
+        memcpy(buf, data, len);
+        if (channel && !channel->Apply(buf, len)) return; // lost
+
+        rx_len = len;
+        state = SXSIM_STATE_IDLE;
+        irq_status |= SXSIM_IRQ_RX_DONE;
+        if (dio_callback) dio_callback();
+    }
+
+    bool IsInRx(void) { return (state == SXSIM_STATE_RX); }
+
+    //-- helper
+
+    uint32_t TimeOverAir_us(void)
+    {
+        if (!gconfig) return 0;
+        if (!gconfig->modeIsLora()) return SXSIM_FLRC_TIME_OVER_AIR;
+        if (gconfig->LoraConfigIndex >= sizeof(SxSimLoraTimeOverAir)/sizeof(SxSimLoraTimeOverAir[0])) while (1) {} // must not happen
+        return SxSimLoraTimeOverAir[gconfig->LoraConfigIndex];
+    }
+
+    uint32_t TimeOverAir_us(uint8_t len) { return TimeOverAir_us(); } // short frames are not modeled
+
+    int16_t ReceiverSensitivity_dbm(void)
+    {
+        if (!gconfig) return 0;
+        if (!gconfig->modeIsLora()) return SXSIM_FLRC_RECEIVER_SENSITIVITY;
+        if (gconfig->LoraConfigIndex >= sizeof(SxSimLoraReceiverSensitivity)/sizeof(SxSimLoraReceiverSensitivity[0])) while (1) {} // must not happen
+        return SxSimLoraReceiverSensitivity[gconfig->LoraConfigIndex];
+    }
+
+    int8_t RfPower_dbm(void) { return actual_power_dbm; }
+
+  private:
+    tSxSimMedium* medium;
+    tSxSimChannel* channel;
+    uint8_t node;
+    void (*dio_callback)(void);
+    tSxGlobalConfig* gconfig;
+
+    uint8_t state;
+    uint16_t irq_status;
+    uint32_t freq;
+    int8_t actual_power_dbm;
+
+    uint8_t buf[SXSIM_BUF_LEN];
+    uint8_t rx_len;
+};
+
+
+class SxSimDriver : public SxSimDriverBase {};
+
+class SxSimDriver2 : public SxSimDriverBase {};
+
+
+#endif // SXSIM_DRIVER_H
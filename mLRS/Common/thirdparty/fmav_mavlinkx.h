@@ -18,6 +18,8 @@
 
 #define MAVLINKX_CRC8_LOOKUP_TABLE
 #define MAVLINKX_COMPRESSION // compression with O3 costs ca 8 kB flash
+#define MAVLINKX_DELTA // needs MAVLINKX_COMPRESSION
+#define MAVLINKX_DICTIONARY // needs MAVLINKX_COMPRESSION
 #define MAVLINKX_O3
 
 
@@ -85,8 +87,10 @@
 typedef enum {
     MAVLINKX_FLAGS_IS_V1              = 0x01,
     MAVLINKX_FLAGS_HAS_MSGID16        = 0x02,
+    MAVLINKX_FLAGS_IS_DELTA_CODED     = 0x04, // payload was xor'ed with the previous instance before compression
     MAVLINKX_FLAGS_HAS_TARGETS        = 0x08,
     MAVLINKX_FLAGS_HAS_CRC_EXTRA      = 0x10, // not yet used, indicates the possibility
+    MAVLINKX_FLAGS_IS_DICT_CODED      = 0x20, // payload was xor'ed with the dictionary entry before compression
     MAVLINKX_FLAGS_IS_COMPRESSED      = 0x40,
     MAVLINKX_FLAGS_HAS_EXTENSION      = 0x80,
 } fmavx_flags_e;
@@ -137,9 +141,30 @@ void fmavX_status_reset(fmavx_status_t* xstatus)
 }
 
 
+typedef enum {
+    MAVLINKX_DELTA_OFF = 0,
+    MAVLINKX_DELTA_ENCODE, // delta coding is done in one direction only
+    MAVLINKX_DELTA_DECODE,
+} fmavx_delta_mode_e;
+
+
+// dictionary entry, holds the reference payload for a msgid
+// the dictionary is a list of these, it is generated from logs, and should be in flash
+typedef struct
+{
+    uint32_t msgid;
+    uint8_t len;
+    const uint8_t* payload;
+} fmavx_dict_entry_t;
+
+
 typedef struct
 {
     uint8_t compression_enabled;
+    uint8_t delta_mode;
+    uint8_t (*delta_msgid_is_periodic)(uint32_t msgid);
+    const fmavx_dict_entry_t* dict;
+    uint8_t dict_num;
 } fmavx_config_t;
 static fmavx_config_t fmavx_config_g = {}; // we use a global here
 
@@ -150,6 +175,24 @@ void fmavX_config_compression(uint8_t compression_flag)
 }
 
 
+// the msgids which are delta coded must be the same on both ends
+// it is only used if compression is enabled
+void fmavX_config_delta(uint8_t delta_mode, uint8_t (*msgid_is_periodic)(uint32_t msgid))
+{
+    fmavx_config_g.delta_mode = (msgid_is_periodic) ? delta_mode : MAVLINKX_DELTA_OFF;
+    fmavx_config_g.delta_msgid_is_periodic = msgid_is_periodic;
+}
+
+
+// the dictionary must be the same on both ends
+// it is only used if compression is enabled
+void fmavX_config_dictionary(const fmavx_dict_entry_t* dict, uint8_t dict_num)
+{
+    fmavx_config_g.dict = dict;
+    fmavx_config_g.dict_num = dict_num;
+}
+
+
 // TODO: shouldn't be global
 fmavx_status_t fmavx_status = {};
 
@@ -158,6 +201,18 @@ fmavx_status_t fmavx_status = {};
 uint8_t _fmavX_payload_compress(uint8_t* payload_out, uint8_t* len_out, uint8_t* payload, uint8_t len);
 void _fmavX_payload_decompress(uint8_t* payload_out, uint8_t* len_out, uint8_t len);
 #endif
+#ifdef MAVLINKX_DELTA
+void fmavX_delta_reset(void);
+void fmavX_delta_msg_sent(void);
+void fmavX_delta_link_ack(uint8_t ack);
+uint8_t _fmavX_payload_compress_delta(uint8_t* payload_out, uint8_t* len_out, struct _fmavx_frame_info* info);
+void _fmavX_payload_undo_delta(uint8_t* buf, uint8_t header_len, uint8_t len, uint8_t delta_seq);
+void _fmavX_delta_store_frame_buf(uint8_t* buf, fmav_result_t* result);
+#endif
+#ifdef MAVLINKX_DICTIONARY
+uint8_t _fmavX_payload_compress_dict(uint8_t* payload_out, uint8_t* len_out, uint8_t* payload, uint8_t len, uint32_t msgid);
+uint8_t _fmavX_payload_undo_dict(uint8_t* payload, uint8_t len, uint32_t msgid);
+#endif
 
 
 //-------------------------------------------------------
@@ -170,6 +225,14 @@ FASTMAVLINK_FUNCTION_DECORATOR void fmavX_init(void)
     memset(&fmavx_status, 0, sizeof(fmavx_status));
 
     fmavx_config_g.compression_enabled = 0; // disable it per default
+    fmavx_config_g.dict = NULL;
+    fmavx_config_g.dict_num = 0;
+    fmavx_config_g.delta_mode = MAVLINKX_DELTA_OFF;
+    fmavx_config_g.delta_msgid_is_periodic = NULL;
+
+#ifdef MAVLINKX_DELTA
+    fmavX_delta_reset();
+#endif
 }
 
 
@@ -305,10 +368,28 @@ FASTMAVLINK_FUNCTION_DECORATOR uint8_t fmavX_crc8_calculate(const uint8_t* buf,
 //-------------------------------------------------------
 // Converter
 //-------------------------------------------------------
-// convert fmav msg structure into fmavX packet
-// fmav_message_t has all info on the packet which we need, so it's quite straightforward to do
+// convert fmav packet into fmavX packet
+// the packet can be given as fmav msg structure or as fmav frame_buf, both carry all info we need
+// the frame_buf version avoids the detour via fmav_message_t, which saves a copy of the payload
 
-FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmavX_msg_to_frame_buf(uint8_t* buf, fmav_message_t* msg)
+typedef struct _fmavx_frame_info {
+    uint8_t is_v1;
+    uint8_t is_signed;
+    uint8_t len;
+    uint8_t seq;
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t target_sysid;
+    uint8_t target_compid;
+    uint32_t msgid;
+    uint8_t crc_extra;
+    uint8_t* payload;
+    uint16_t checksum;
+    uint8_t* signature;
+} fmavx_frame_info_t;
+
+
+FASTMAVLINK_FUNCTION_DECORATOR uint16_t _fmavX_info_to_frame_buf(uint8_t* buf, fmavx_frame_info_t* info)
 {
     uint16_t pos = 0;
     uint8_t flags_ext = 0;
@@ -320,28 +401,28 @@ FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmavX_msg_to_frame_buf(uint8_t* buf, fma
 
     // flags
     buf[2] = 0;
-    if (msg->magic == FASTMAVLINK_MAGIC_V1) {
+    if (info->is_v1) {
         buf[2] |= MAVLINKX_FLAGS_IS_V1;
     }
-    if (msg->incompat_flags & FASTMAVLINK_INCOMPAT_FLAGS_SIGNED) {
+    if (info->is_signed) {
         buf[2] |= MAVLINKX_FLAGS_HAS_EXTENSION;
         flags_ext |= MAVLINKX_FLAGS_EXT_HAS_SIGNATURE;
     }
     // can be > 0 only if we know the message, so this implicitly does it only if we know the message
-    if (msg->target_sysid > 0 || msg->target_compid > 0) {
+    if (info->target_sysid > 0 || info->target_compid > 0) {
         buf[2] |= MAVLINKX_FLAGS_HAS_TARGETS;
     }
-    if (msg->msgid < 256) {
+    if (info->msgid < 256) {
         // no flag needed
     } else
-    if (msg->msgid < 65536) {
+    if (info->msgid < 65536) {
         buf[2] |= MAVLINKX_FLAGS_HAS_MSGID16;
     } else {
         buf[2] |= MAVLINKX_FLAGS_HAS_EXTENSION;
         flags_ext |= MAVLINKX_FLAGS_EXT_HAS_MSGID24;
     }
 
-    // we should do it based on whether we know the message, but we don't currently have that info easily available in msg
+    // we should do it based on whether we know the message, but we don't currently have that info easily available
     // if (known) buf[2] |= MAVLINKX_FLAGS_HAS_CRC_EXTRA;
 
     pos = 3;
@@ -355,29 +436,29 @@ FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmavX_msg_to_frame_buf(uint8_t* buf, fma
 #ifdef MAVLINKX_COMPRESSION
     uint8_t pos_of_len = pos;
 #endif
-    buf[pos++] = msg->len;
-    buf[pos++] = msg->seq;
-    buf[pos++] = msg->sysid;
-    buf[pos++] = msg->compid;
+    buf[pos++] = info->len;
+    buf[pos++] = info->seq;
+    buf[pos++] = info->sysid;
+    buf[pos++] = info->compid;
 
     // targets
     if (buf[2] & MAVLINKX_FLAGS_HAS_TARGETS) {
-        buf[pos++] = msg->target_sysid;
-        buf[pos++] = msg->target_compid;
+        buf[pos++] = info->target_sysid;
+        buf[pos++] = info->target_compid;
     }
 
     // msgid
-    buf[pos++] = (uint8_t)msg->msgid;
+    buf[pos++] = (uint8_t)info->msgid;
     if (buf[2] & MAVLINKX_FLAGS_HAS_MSGID16) {
-        buf[pos++] = (uint8_t)((msg->msgid) >> 8);
+        buf[pos++] = (uint8_t)((info->msgid) >> 8);
     }
     if (flags_ext & MAVLINKX_FLAGS_EXT_HAS_MSGID24) {
-        buf[pos++] = (uint8_t)((msg->msgid) >> 16);
+        buf[pos++] = (uint8_t)((info->msgid) >> 16);
     }
 
     // extra crc
     if (buf[2] & MAVLINKX_FLAGS_HAS_CRC_EXTRA) {
-        buf[pos++] = msg->crc_extra;
+        buf[pos++] = info->crc_extra;
     }
 
 #ifdef MAVLINKX_COMPRESSION
@@ -390,13 +471,27 @@ FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmavX_msg_to_frame_buf(uint8_t* buf, fma
     // we should want to remove the targets if there are any, for the moment we just don't
     // do compression, but do not advance pos since we need to do crc8
     uint8_t len;
+#ifdef MAVLINKX_DELTA
     if (fmavx_config_g.compression_enabled &&
-        _fmavX_payload_compress(&(buf[pos + 1]), &len, msg->payload, msg->len)) {
+        _fmavX_payload_compress_delta(&(buf[pos + 1]), &len, info)) {
+        buf[2] |= MAVLINKX_FLAGS_IS_COMPRESSED | MAVLINKX_FLAGS_IS_DELTA_CODED;
+        buf[pos_of_len] = len;
+    } else
+#endif
+#ifdef MAVLINKX_DICTIONARY
+    if (fmavx_config_g.compression_enabled &&
+        _fmavX_payload_compress_dict(&(buf[pos + 1]), &len, info->payload, info->len, info->msgid)) {
+        buf[2] |= MAVLINKX_FLAGS_IS_COMPRESSED | MAVLINKX_FLAGS_IS_DICT_CODED;
+        buf[pos_of_len] = len;
+    } else
+#endif
+    if (fmavx_config_g.compression_enabled &&
+        _fmavX_payload_compress(&(buf[pos + 1]), &len, info->payload, info->len)) {
         buf[2] |= MAVLINKX_FLAGS_IS_COMPRESSED;
         buf[pos_of_len] = len;
     } else {
-        memcpy(&(buf[pos + 1]), msg->payload, msg->len);
-        len = msg->len;
+        memcpy(&(buf[pos + 1]), info->payload, info->len);
+        len = info->len;
     }
 
     // now we can do crc8
@@ -410,17 +505,17 @@ FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmavX_msg_to_frame_buf(uint8_t* buf, fma
     buf[pos++] = crc8;
 
     // payload
-    memcpy(&(buf[pos]), msg->payload, msg->len);
-    pos += msg->len;
+    memcpy(&(buf[pos]), info->payload, info->len);
+    pos += info->len;
 #endif
 
     // crc16
-    buf[pos++] = (uint8_t)msg->checksum;
-    buf[pos++] = (uint8_t)((msg->checksum) >> 8);
+    buf[pos++] = (uint8_t)info->checksum;
+    buf[pos++] = (uint8_t)((info->checksum) >> 8);
 
     // signature
-    if (msg->incompat_flags & FASTMAVLINK_INCOMPAT_FLAGS_SIGNED) {
-        memcpy(&(buf[pos]), msg->signature_a, FASTMAVLINK_SIGNATURE_LEN);
+    if (info->is_signed) {
+        memcpy(&(buf[pos]), info->signature, FASTMAVLINK_SIGNATURE_LEN);
         pos += FASTMAVLINK_SIGNATURE_LEN;
     }
 
@@ -428,6 +523,55 @@ FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmavX_msg_to_frame_buf(uint8_t* buf, fma
 }
 
 
+FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmavX_msg_to_frame_buf(uint8_t* buf, fmav_message_t* msg)
+{
+    fmavx_frame_info_t info;
+
+    info.is_v1 = (msg->magic == FASTMAVLINK_MAGIC_V1);
+    info.is_signed = (msg->incompat_flags & FASTMAVLINK_INCOMPAT_FLAGS_SIGNED) ? 1 : 0;
+    info.len = msg->len;
+    info.seq = msg->seq;
+    info.sysid = msg->sysid;
+    info.compid = msg->compid;
+    info.target_sysid = msg->target_sysid;
+    info.target_compid = msg->target_compid;
+    info.msgid = msg->msgid;
+    info.crc_extra = msg->crc_extra;
+    info.payload = msg->payload;
+    info.checksum = msg->checksum;
+    info.signature = msg->signature_a;
+
+    return _fmavX_info_to_frame_buf(buf, &info);
+}
+
+
+// frame_buf and result must be as obtained from fmav_parse_and_check_to_frame_buf()
+// buf and frame_buf must not overlap, the fmavX header can be longer than the fmav header
+FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmavX_frame_buf_to_frame_buf(uint8_t* buf, fmav_result_t* result, uint8_t* frame_buf)
+{
+    fmavx_frame_info_t info;
+
+    info.is_v1 = (frame_buf[0] == FASTMAVLINK_MAGIC_V1);
+    uint8_t header_len = (info.is_v1) ? FASTMAVLINK_HEADER_V1_LEN : FASTMAVLINK_HEADER_V2_LEN;
+
+    info.is_signed = (!info.is_v1 && (frame_buf[2] & FASTMAVLINK_INCOMPAT_FLAGS_SIGNED)) ? 1 : 0;
+    info.len = frame_buf[1];
+    info.seq = (info.is_v1) ? frame_buf[2] : frame_buf[4];
+    info.sysid = result->sysid;
+    info.compid = result->compid;
+    info.target_sysid = result->target_sysid;
+    info.target_compid = result->target_compid;
+    info.msgid = result->msgid;
+    info.crc_extra = result->crc_extra;
+    info.payload = &(frame_buf[header_len]);
+    uint16_t pos = header_len + info.len;
+    info.checksum = (uint16_t)frame_buf[pos] + ((uint16_t)frame_buf[pos + 1] << 8);
+    info.signature = &(frame_buf[pos + FASTMAVLINK_CHECKSUM_LEN]);
+
+    return _fmavX_info_to_frame_buf(buf, &info);
+}
+
+
 //-------------------------------------------------------
 // Parser
 //-------------------------------------------------------
@@ -658,6 +802,17 @@ FASTMAVLINK_FUNCTION_DECORATOR uint8_t fmavX_parse_to_frame_buf(fmav_result_t* r
         buf[status->rx_cnt++] = c; // payload
         if (status->rx_cnt >= status->rx_header_len + fmavx_status.rx_payload_len) {
 
+#ifdef MAVLINKX_DELTA
+            uint8_t delta_seq = 0;
+            if (fmavx_status.flags & MAVLINKX_FLAGS_IS_DELTA_CODED) { // the first byte is the seq of the reference, remove it
+                delta_seq = buf[status->rx_header_len];
+                fmavx_status.rx_payload_len--;
+                memmove(&(buf[status->rx_header_len]), &(buf[status->rx_header_len + 1]), fmavx_status.rx_payload_len);
+                status->rx_cnt--;
+                status->rx_frame_len--;
+                buf[fmavx_status.pos_of_len] = fmavx_status.rx_payload_len;
+            }
+#endif
 #ifdef MAVLINKX_COMPRESSION
             if (fmavx_status.flags & MAVLINKX_FLAGS_IS_COMPRESSED) {
                 uint8_t len;
@@ -669,6 +824,21 @@ FASTMAVLINK_FUNCTION_DECORATOR uint8_t fmavX_parse_to_frame_buf(fmav_result_t* r
                 buf[fmavx_status.pos_of_len] = len;
             }
 #endif
+#ifdef MAVLINKX_DELTA
+            if (fmavx_status.flags & MAVLINKX_FLAGS_IS_DELTA_CODED) {
+                // if we don't have the reference the payload is wrong, the crc check will catch it
+                _fmavX_payload_undo_delta(buf, status->rx_header_len, fmavx_status.rx_payload_len, delta_seq);
+            }
+#endif
+#ifdef MAVLINKX_DICTIONARY
+            if (fmavx_status.flags & MAVLINKX_FLAGS_IS_DICT_CODED) {
+                // msgid is at 5 for v1, and at 7,8,9 for v2
+                uint32_t msgid = (fmavx_status.flags & MAVLINKX_FLAGS_IS_V1) ? buf[5] :
+                                 (uint32_t)buf[7] + ((uint32_t)buf[8] << 8) + ((uint32_t)buf[9] << 16);
+                // if we don't know the msgid the payload is wrong, the crc check will catch it
+                _fmavX_payload_undo_dict(&(buf[status->rx_header_len]), fmavx_status.rx_payload_len, msgid);
+            }
+#endif
 
             status->rx_state = FASTMAVLINK_FASTPARSE_STATE_FRAME;
         }
@@ -707,6 +877,9 @@ uint8_t res;
     res = fmav_check_frame_buf(result, buf);
     // result can be MSGID_UNKNOWN, LENGTH_ERROR, CRC_ERROR, SIGNATURE_ERROR, or OK
     if (res == FASTMAVLINK_PARSE_RESULT_MSGID_UNKNOWN || res == FASTMAVLINK_PARSE_RESULT_OK) {
+#ifdef MAVLINKX_DELTA
+        if (res == FASTMAVLINK_PARSE_RESULT_OK) _fmavX_delta_store_frame_buf(buf, result); // is the reference for the next
+#endif
         return 1;
     }
 
@@ -1003,6 +1176,303 @@ void _fmavX_payload_decompress(uint8_t* payload_out, uint8_t* len_out, uint8_t l
 #endif // MAVLINKX_COMPRESSION
 
 
+//-------------------------------------------------------
+// Delta
+//-------------------------------------------------------
+/*
+Periodic telemetry messages, like ATTITUDE or GLOBAL_POSITION_INT, change only in a few bytes from
+one instance to the next. The payload is xor'ed with that of the previous instance of the message,
+i.e. of same sysid, compid, msgid, before compression, which turns all unchanged bytes into 0.
+
+The decoder uses the instance which was last received. The first payload byte of a delta coded
+frame is the seq of the instance it was xor'ed with. If the decoder doesn't have this instance,
+the payload is wrong and the crc check drops the frame.
+
+The encoder hence uses an instance as reference only if the other end has confirmed that it got
+it. The application tells when the last converted frame has been put completely into link frames,
+fmavX_delta_msg_sent(), and for each link frame whether the other end has received it,
+fmavX_delta_link_ack(). If a link frame is not acked, the instances in it lose their reference
+state, and the next instance of each is send as keyframe, i.e. not delta coded. An instance is
+also send as keyframe if the previous one is not yet confirmed.
+
+In addition, every MAVLINKX_DELTA_KEYFRAME_NUM-th instance is send as keyframe. The encoder can
+also be reset, then all next instances are keyframes.
+
+Which msgids are periodic is set by the application, and must be the same on both ends. Delta
+coding is done in one direction only, as the table is shared.
+*/
+#ifdef MAVLINKX_DELTA
+
+#define MAVLINKX_DELTA_NUM              8 // number of messages which are tracked
+#define MAVLINKX_DELTA_PAYLOAD_LEN_MAX  56 // longer messages are not delta coded
+#define MAVLINKX_DELTA_KEYFRAME_NUM     5
+
+
+typedef enum {
+    MAVLINKX_DELTA_REF_NONE = 0, // the other end may not have it, encoder only
+    MAVLINKX_DELTA_REF_SENDING, // is being put into link frames
+    MAVLINKX_DELTA_REF_SENT, // is completely in link frames, waits for the ack
+    MAVLINKX_DELTA_REF_CONFIRMED, // the other end has it
+} fmavx_delta_ref_state_e;
+
+
+typedef struct
+{
+    uint32_t msgid;
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t seq;
+    uint8_t len; // 0 indicates that entry has no reference
+    uint8_t cnt; // number of delta coded instances since the last keyframe
+    uint8_t state; // fmavx_delta_ref_state_e, encoder only
+    uint16_t tlast; // for replacing the least recently used
+    uint8_t payload[MAVLINKX_DELTA_PAYLOAD_LEN_MAX];
+} fmavx_delta_entry_t;
+
+
+// TODO: shouldn't be global
+fmavx_delta_entry_t fmavx_delta[MAVLINKX_DELTA_NUM];
+uint16_t fmavx_delta_tick;
+
+
+void fmavX_delta_reset(void)
+{
+    memset(fmavx_delta, 0, sizeof(fmavx_delta));
+    fmavx_delta_tick = 0;
+}
+
+
+fmavx_delta_entry_t* _fmavX_delta_find(uint8_t sysid, uint8_t compid, uint32_t msgid)
+{
+    for (uint8_t i = 0; i < MAVLINKX_DELTA_NUM; i++) {
+        fmavx_delta_entry_t* e = &(fmavx_delta[i]);
+        if (e->len && e->msgid == msgid && e->sysid == sysid && e->compid == compid) return e;
+    }
+    return NULL;
+}
+
+
+// finds the entry for the message, or takes the least recently used one
+fmavx_delta_entry_t* _fmavX_delta_get(uint8_t sysid, uint8_t compid, uint32_t msgid)
+{
+    fmavx_delta_entry_t* entry = &(fmavx_delta[0]);
+
+    fmavx_delta_tick++;
+
+    for (uint8_t i = 0; i < MAVLINKX_DELTA_NUM; i++) {
+        fmavx_delta_entry_t* e = &(fmavx_delta[i]);
+        if (e->len && e->msgid == msgid && e->sysid == sysid && e->compid == compid) {
+            e->tlast = fmavx_delta_tick;
+            return e;
+        }
+        if (!e->len) { // unused, take it
+            entry = e;
+        } else
+        if (entry->len && (uint16_t)(fmavx_delta_tick - e->tlast) > (uint16_t)(fmavx_delta_tick - entry->tlast)) {
+            entry = e;
+        }
+    }
+
+    entry->msgid = msgid;
+    entry->sysid = sysid;
+    entry->compid = compid;
+    entry->len = 0;
+    entry->cnt = 0;
+    entry->state = MAVLINKX_DELTA_REF_NONE;
+    entry->tlast = fmavx_delta_tick;
+    return entry;
+}
+
+
+void _fmavX_delta_store(fmavx_delta_entry_t* entry, uint8_t seq, uint8_t* payload, uint8_t len)
+{
+    entry->seq = seq;
+    memcpy(entry->payload, payload, len);
+    entry->len = len;
+}
+
+
+// xor is its own inverse, so works for both directions
+void _fmavX_delta_xor(uint8_t* payload_out, uint8_t* payload, uint8_t len, fmavx_delta_entry_t* entry)
+{
+    uint8_t n = (len < entry->len) ? len : entry->len;
+    for (uint8_t i = 0; i < n; i++) payload_out[i] = payload[i] ^ entry->payload[i];
+    for (uint8_t i = n; i < len; i++) payload_out[i] = payload[i];
+}
+
+
+// the payload becomes the reference for the next instance, once the other end has confirmed it
+// returns 0 if it is to be send as keyframe, or compression didn't reduce payload len
+// we use fmavx_in_buf as working buffer, it is only used in decompression otherwise
+uint8_t _fmavX_payload_compress_delta(uint8_t* payload_out, uint8_t* len_out, fmavx_frame_info_t* info)
+{
+    if (fmavx_config_g.delta_mode != MAVLINKX_DELTA_ENCODE) return 0;
+    if (info->len > MAVLINKX_DELTA_PAYLOAD_LEN_MAX) return 0;
+    if (!fmavx_config_g.delta_msgid_is_periodic(info->msgid)) return 0;
+
+    fmavx_delta_entry_t* entry = _fmavX_delta_get(info->sysid, info->compid, info->msgid);
+
+    uint8_t res = 0;
+    if (entry->len && entry->state == MAVLINKX_DELTA_REF_CONFIRMED && entry->cnt < MAVLINKX_DELTA_KEYFRAME_NUM) {
+        _fmavX_delta_xor(fmavx_in_buf, info->payload, info->len, entry);
+        res = _fmavX_payload_compress(&(payload_out[1]), len_out, fmavx_in_buf, info->len);
+        if (res && *len_out + 1 >= info->len) res = 0; // the seq byte must be worth it
+    }
+
+    if (res) {
+        payload_out[0] = entry->seq;
+        (*len_out)++;
+        entry->cnt++;
+    } else {
+        entry->cnt = 0; // is send as keyframe
+    }
+
+    _fmavX_delta_store(entry, info->seq, info->payload, info->len);
+    entry->state = MAVLINKX_DELTA_REF_SENDING;
+    return res;
+}
+
+
+// to be called when all of the last converted frame has been put into link frames
+void fmavX_delta_msg_sent(void)
+{
+    for (uint8_t i = 0; i < MAVLINKX_DELTA_NUM; i++) {
+        if (fmavx_delta[i].state == MAVLINKX_DELTA_REF_SENDING) fmavx_delta[i].state = MAVLINKX_DELTA_REF_SENT;
+    }
+}
+
+
+// to be called before a link frame is transmitted, with the ack the other end gave for the last
+// link frame, which must be 0 if it is not known
+void fmavX_delta_link_ack(uint8_t ack)
+{
+    for (uint8_t i = 0; i < MAVLINKX_DELTA_NUM; i++) {
+        fmavx_delta_entry_t* e = &(fmavx_delta[i]);
+        if (e->state == MAVLINKX_DELTA_REF_SENT) {
+            e->state = (ack) ? MAVLINKX_DELTA_REF_CONFIRMED : MAVLINKX_DELTA_REF_NONE;
+        } else
+        if (e->state == MAVLINKX_DELTA_REF_SENDING && !ack) { // a part of it was lost
+            e->state = MAVLINKX_DELTA_REF_NONE;
+        }
+    }
+}
+
+
+FASTMAVLINK_FUNCTION_DECORATOR void _fmavX_frame_buf_ids(uint8_t* buf, uint8_t* seq, uint8_t* sysid, uint8_t* compid, uint32_t* msgid)
+{
+    if (buf[0] == FASTMAVLINK_MAGIC_V1) {
+        *seq = buf[2];
+        *sysid = buf[3];
+        *compid = buf[4];
+        *msgid = buf[5];
+    } else {
+        *seq = buf[4];
+        *sysid = buf[5];
+        *compid = buf[6];
+        *msgid = (uint32_t)buf[7] + ((uint32_t)buf[8] << 8) + ((uint32_t)buf[9] << 16);
+    }
+}
+
+
+// buf is the frame buf, the payload is undone in place
+void _fmavX_payload_undo_delta(uint8_t* buf, uint8_t header_len, uint8_t len, uint8_t delta_seq)
+{
+    if (fmavx_config_g.delta_mode != MAVLINKX_DELTA_DECODE) return;
+
+    uint8_t seq, sysid, compid;
+    uint32_t msgid;
+    _fmavX_frame_buf_ids(buf, &seq, &sysid, &compid, &msgid);
+
+    fmavx_delta_entry_t* entry = _fmavX_delta_find(sysid, compid, msgid);
+    if (!entry || entry->seq != delta_seq) return; // we don't have the reference
+
+    _fmavX_delta_xor(&(buf[header_len]), &(buf[header_len]), len, entry);
+}
+
+
+// to be called for each frame which passed the crc check, it becomes the reference for the next instance
+void _fmavX_delta_store_frame_buf(uint8_t* buf, fmav_result_t* result)
+{
+    if (fmavx_config_g.delta_mode != MAVLINKX_DELTA_DECODE) return;
+
+    uint8_t len = buf[1];
+    if (len > MAVLINKX_DELTA_PAYLOAD_LEN_MAX) return;
+    if (!fmavx_config_g.delta_msgid_is_periodic(result->msgid)) return;
+
+    uint8_t seq, sysid, compid;
+    uint32_t msgid;
+    _fmavX_frame_buf_ids(buf, &seq, &sysid, &compid, &msgid);
+
+    fmavx_delta_entry_t* entry = _fmavX_delta_get(sysid, compid, msgid);
+    uint8_t header_len = (buf[0] == FASTMAVLINK_MAGIC_V1) ? FASTMAVLINK_HEADER_V1_LEN : FASTMAVLINK_HEADER_V2_LEN;
+    _fmavX_delta_store(entry, seq, &(buf[header_len]), len);
+}
+
+#endif // MAVLINKX_DELTA
+
+
+//-------------------------------------------------------
+// Dictionary
+//-------------------------------------------------------
+/*
+The X4 scheme uses one code for all messages. Many messages however have bytes which hardly ever
+change, like bitmasks, types, ids, or the upper bytes of positions. Most of these are not 0 or 255,
+so don't benefit from X4.
+
+The dictionary holds a reference payload for some msgids. The payload is xor'ed with it before
+compression, which turns all bytes which match the reference into 0, which X4 codes in 3 bits or
+less. The reference is static, so nothing is lost if a frame is lost. It is used for the instances
+which are not delta coded, i.e. for the messages which are not periodic, and for keyframes.
+
+The dictionary is generated from logs by tools/host-tests/gen_mavlinkx_dict.cpp. It is chosen per
+byte position as the most frequent value.
+*/
+#ifdef MAVLINKX_DICTIONARY
+
+const fmavx_dict_entry_t* _fmavX_dict_find(uint32_t msgid)
+{
+    for (uint8_t i = 0; i < fmavx_config_g.dict_num; i++) {
+        if (fmavx_config_g.dict[i].msgid == msgid) return &(fmavx_config_g.dict[i]);
+    }
+    return NULL;
+}
+
+
+// xor is its own inverse, so works for both directions
+void _fmavX_dict_xor(uint8_t* payload_out, uint8_t* payload, uint8_t len, const fmavx_dict_entry_t* entry)
+{
+    uint8_t n = (len < entry->len) ? len : entry->len;
+    for (uint8_t i = 0; i < n; i++) payload_out[i] = payload[i] ^ entry->payload[i];
+    for (uint8_t i = n; i < len; i++) payload_out[i] = payload[i];
+}
+
+
+// returns 0 if there is no dictionary entry for the msgid, or compression didn't reduce payload len
+// we use fmavx_in_buf as working buffer, it is only used in decompression otherwise
+uint8_t _fmavX_payload_compress_dict(uint8_t* payload_out, uint8_t* len_out, uint8_t* payload, uint8_t len, uint32_t msgid)
+{
+    const fmavx_dict_entry_t* entry = _fmavX_dict_find(msgid);
+    if (!entry) return 0;
+
+    _fmavX_dict_xor(fmavx_in_buf, payload, len, entry);
+
+    return _fmavX_payload_compress(payload_out, len_out, fmavx_in_buf, len);
+}
+
+
+// returns 0 if there is no dictionary entry for the msgid
+uint8_t _fmavX_payload_undo_dict(uint8_t* payload, uint8_t len, uint32_t msgid)
+{
+    const fmavx_dict_entry_t* entry = _fmavX_dict_find(msgid);
+    if (!entry) return 0;
+
+    _fmavX_dict_xor(payload, payload, len, entry);
+    return 1;
+}
+
+#endif // MAVLINKX_DICTIONARY
+
+
 #ifdef MAVLINKX_O3
   #ifdef __GNUC__
     #pragma GCC pop_options
@@ -25,7 +25,7 @@
 
 volatile bool doPostReceive;
 
-uint16_t CLOCK_PERIOD_10US; // does not change while isr is enabled, so no need for volatile
+uint16_t CLOCK_PERIOD_10US; // is only changed with isr disabled, so no need for volatile
 
 
 //-------------------------------------------------------
@@ -36,12 +36,14 @@ class ClockBase
 {
   public:
     void Init(uint16_t frame_rate_ms);
-    void Reset(void);
+    void Reset(int16_t shift_10us = 0);
+    void SetPeriod(uint16_t frame_rate_ms, int16_t shift_10us);
 
     void init_isr_off(void);
     void enable_isr(void);
 
     uint16_t tim_10us(void);
+    uint16_t TimeToTick_10us(void);
 };
 
 
@@ -55,12 +57,13 @@ void ClockBase::Init(uint16_t frame_rate_ms)
 }
 
 
-void ClockBase::Reset(void)
+// shift moves the reference point, i.e., when the frame is considered to have been received
+void ClockBase::Reset(int16_t shift_10us)
 {
     if (!CLOCK_PERIOD_10US) while (1) {}
 
     __disable_irq();
-    uint32_t CNT = CLOCK_TIMx->CNT; // works for both 16 and 32 bit timer
+    uint32_t CNT = CLOCK_TIMx->CNT + shift_10us; // works for both 16 and 32 bit timer
     CLOCK_TIMx->CCR1 = CNT + CLOCK_PERIOD_10US;
     CLOCK_TIMx->CCR3 = CNT + CLOCK_SHIFT_10US;
     LL_TIM_ClearFlag_CC1(CLOCK_TIMx); // important to do
@@ -69,6 +72,16 @@ void ClockBase::Reset(void)
 }
 
 
+// change the frame rate on the fly, the next tick is moved by shift
+void ClockBase::SetPeriod(uint16_t frame_rate_ms, int16_t shift_10us)
+{
+    __disable_irq();
+    CLOCK_PERIOD_10US = frame_rate_ms * 100;
+    CLOCK_TIMx->CCR1 = CLOCK_TIMx->CCR1 + shift_10us; // works for both 16 and 32 bit timer
+    __enable_irq();
+}
+
+
 void ClockBase::init_isr_off(void)
 {
     tim_init_up(CLOCK_TIMx, 0xFFFFFFFF, TIMER_BASE_10US); // works for both 16 and 32 bit timer
@@ -97,6 +110,13 @@ uint16_t ClockBase::tim_10us(void)
 }
 
 
+// time until the next tick, i.e., until a Tx frame is expected to have been received
+uint16_t ClockBase::TimeToTick_10us(void)
+{
+    return CLOCK_TIMx->CCR1 - CLOCK_TIMx->CNT; // works for both 16 and 32 bit timer
+}
+
+
 //-------------------------------------------------------
 // Clock ISR
 //-------------------------------------------------------
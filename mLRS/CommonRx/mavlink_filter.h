@@ -0,0 +1,141 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// MAVLink Filter
+//*******************************************************
+// Drops, decimates or rate limits messages from the vehicle, before they take airtime.
+//
+// Companion computers, gimbals and other components on the vehicle emit streams which
+// the autopilot routes also to the telemetry port, but nobody on the ground needs them.
+//
+// The rules are in a table keyed by msgid and sysid/compid, 0 meaning any. The first
+// rule which matches applies, messages which match no rule are forwarded. A rate
+// limit is done with a token bucket per rule, i.e., all messages matching a rule share
+// the rate. The table is set at compile time, by defining MAVLINK_FILTER_RULES. It is
+// empty per default, so no message is touched unless the user asks for it. An example,
+// which rate limits streams the autopilot may route but a GCS usually doesn't need, is
+// given below.
+//*******************************************************
+/*
+#define MAVLINK_FILTER_RULES \
+    { FASTMAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, 0, 0, MAVLINK_FILTER_RATE, 2 }, \
+    { FASTMAVLINK_MSG_ID_VISION_POSITION_ESTIMATE, 0, 0, MAVLINK_FILTER_RATE, 1 }, \
+    { FASTMAVLINK_MSG_ID_ODOMETRY, 0, 0, MAVLINK_FILTER_RATE, 1 }, \
+    { FASTMAVLINK_MSG_ID_OBSTACLE_DISTANCE, 0, 0, MAVLINK_FILTER_RATE, 1 },
+*/
+#ifndef MAVLINK_FILTER_H
+#define MAVLINK_FILTER_H
+#pragma once
+
+
+#include <inttypes.h>
+
+
+typedef enum {
+    MAVLINK_FILTER_DROP = 0,
+    MAVLINK_FILTER_DECIMATE, // forward only one in value messages
+    MAVLINK_FILTER_RATE, // forward at most value messages per second, with a burst of up to value
+} MAVLINK_FILTER_ACTION_ENUM;
+
+
+typedef struct
+{
+    uint32_t msgid; // MAVLINK_FILTER_ANY for any
+    uint8_t sysid; // 0 for any
+    uint8_t compid; // 0 for any
+    uint8_t action;
+    uint8_t value;
+} tMavlinkFilterRule;
+
+
+#define MAVLINK_FILTER_ANY          UINT32_MAX
+#define MAVLINK_FILTER_RULES_MAX    16
+
+
+#ifdef MAVLINK_FILTER_RULES
+const tMavlinkFilterRule mavlink_filter_rules[] = { MAVLINK_FILTER_RULES };
+
+#define MAVLINK_FILTER_RULES_NUM    (sizeof(mavlink_filter_rules) / sizeof(tMavlinkFilterRule))
+#else
+const tMavlinkFilterRule mavlink_filter_rules[1] = {}; // is not used
+
+#define MAVLINK_FILTER_RULES_NUM    0
+#endif
+
+
+class tMavlinkFilter
+{
+  public:
+    void Init(void)
+    {
+        if (MAVLINK_FILTER_RULES_NUM > MAVLINK_FILTER_RULES_MAX) while (1) {} // must not happen
+
+        for (uint8_t i = 0; i < MAVLINK_FILTER_RULES_NUM; i++) {
+            state[i].cnt = 0;
+            state[i].tokens = (uint32_t)mavlink_filter_rules[i].value * 1000; // start with full bucket
+            state[i].tlast_ms = 0;
+        }
+    }
+
+    // returns true if the message is to be forwarded
+    bool Pass(fmav_result_t* result, uint32_t tnow_ms)
+    {
+        uint8_t i = find(result);
+
+        return (i == UINT8_MAX || pass(i, tnow_ms));
+    }
+
+  private:
+    uint8_t find(fmav_result_t* result)
+    {
+        for (uint8_t i = 0; i < MAVLINK_FILTER_RULES_NUM; i++) {
+            const tMavlinkFilterRule* rule = &(mavlink_filter_rules[i]);
+            if (rule->msgid != MAVLINK_FILTER_ANY && rule->msgid != result->msgid) continue;
+            if (rule->sysid && rule->sysid != result->sysid) continue;
+            if (rule->compid && rule->compid != result->compid) continue;
+            return i;
+        }
+        return UINT8_MAX;
+    }
+
+    bool pass(uint8_t i, uint32_t tnow_ms)
+    {
+        const tMavlinkFilterRule* rule = &(mavlink_filter_rules[i]);
+
+        switch (rule->action) {
+        case MAVLINK_FILTER_DECIMATE:
+            state[i].cnt++;
+            if (state[i].cnt < rule->value) return false;
+            state[i].cnt = 0;
+            return true;
+
+        case MAVLINK_FILTER_RATE:{
+            // tokens are in units of 1/1000 message, a message costs 1000, value tokens per ms are added
+            uint32_t dt_ms = tnow_ms - state[i].tlast_ms;
+            state[i].tlast_ms = tnow_ms;
+            uint32_t tokens = state[i].tokens + dt_ms * rule->value;
+            uint32_t tokens_max = (uint32_t)rule->value * 1000;
+            if (tokens > tokens_max || dt_ms > 1000) tokens = tokens_max;
+            if (tokens < 1000) {
+                state[i].tokens = tokens;
+                return false;
+            }
+            state[i].tokens = tokens - 1000;
+            return true; }
+        }
+
+        return false; // MAVLINK_FILTER_DROP
+    }
+
+    struct {
+        uint8_t cnt;
+        uint32_t tokens;
+        uint32_t tlast_ms;
+    } state[MAVLINK_FILTER_RULES_MAX];
+};
+
+
+#endif // MAVLINK_FILTER_H
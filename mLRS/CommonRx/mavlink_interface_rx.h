@@ -13,9 +13,14 @@
 
 #include "../Common/mavlink/fmav_extension.h"
 #include "../Common/libs/filters.h"
+#include "mavlink_txbuf.h"
 #ifdef USE_FEATURE_MAVLINKX
 #include "../Common/thirdparty/fmav_mavlinkx.h"
-#include "../Common/libs/fifo.h"
+#include "../Common/mavlink/mavlinkx_dict.h"
+#include "../Common/mavlink/mavlink_queue.h"
+#endif
+#ifdef USE_FEATURE_MAVLINK_FILTER
+#include "mavlink_filter.h"
 #endif
 
 
@@ -38,11 +43,14 @@ class MavlinkBase
     void Do(void);
     void SendRcData(tRcData* rc_out, bool failsafe);
     void FrameLost(void);
+    void FrameAck(uint8_t ack);
 
     void putc(char c);
     bool available(void);
     uint8_t getc(void);
+    uint16_t getbuf(uint8_t* buf, uint16_t len);
     void flush(void);
+    uint16_t bytes_available(void);
 
   private:
     void send_msg_serial_out(void);
@@ -53,41 +61,39 @@ class MavlinkBase
     void generate_radio_link_flow_control(void);
 
     uint16_t serial_in_available(void);
-    bool handle_txbuf_ardupilot(uint32_t tnow_ms);
-    bool handle_txbuf_method_b(uint32_t tnow_ms); // for PX4, aka "brad"
+#ifdef USE_FEATURE_MAVLINKX
+    uint16_t link_out_available(void);
+    uint16_t link_out_getbuf(uint8_t* buf, uint16_t len);
+    void link_out_flush(void);
+    bool filter_pass(uint32_t tnow_ms);
+#endif
 
     // fields for link in -> parser -> serial out
     fmav_status_t status_link_in;
     fmav_result_t result_link_in;
     uint8_t buf_link_in[MAVLINK_BUF_SIZE]; // buffer for link in parser
     fmav_status_t status_serial_out; // not needed, status_link_in could be used, but clearer so
-    fmav_message_t msg_serial_out; // could be avoided by more efficient coding, is used only momentarily/locally
+    fmav_message_t msg_serial_out; // only for generated messages, is used only momentarily/locally
 
     // fields for serial in -> parser -> link out
 #ifdef USE_FEATURE_MAVLINKX
     fmav_status_t status_serial_in;
     fmav_result_t result_serial_in;
     uint8_t buf_serial_in[MAVLINK_BUF_SIZE]; // buffer for serial in parser
-    fmav_message_t msg_link_out; // could be avoided by more efficient coding, is used only momentarily/locally
-    FifoBase<char,512> fifo_link_out; // needs to be at least 82 + 280
+    tMavlinkQueue queue_link_out; // holds messages by priority, needs to be at least 82 + 280
+    uint8_t buf_link_out[MAVLINKX_FRAME_LEN_MAX]; // MavlinkX frame which is being taken out
+    uint16_t link_out_len;
+    uint16_t link_out_pos;
+    uint16_t link_out_t_ms; // when it was put into the queue, for the latency trace
+#endif
+#ifdef USE_FEATURE_MAVLINK_FILTER
+    tMavlinkFilter filter; // drops, decimates, rate limits messages before they go to link out
 #endif
 
     // to inject RADIO_STATUS or RADIO_LINK_FLOW_CONTROL
-    uint32_t radio_status_tlast_ms;
-    uint32_t bytes_serial_in;
-    uint8_t radio_status_txbuf;
-
-    uint32_t bytes_serial_in_cnt;
+    tTxBufControl txbuf_control;
     LPFilterRate bytes_serial_in_rate_filt;
 
-    typedef enum {
-        TXBUF_STATE_NORMAL = 0,
-        TXBUF_STATE_BURST,
-        TXBUF_STATE_BURST_HIGH,
-        TXBUF_STATE_PX4_RECOVER, // for PX4, buffer draining, resume bulk download
-    } TXBUF_STATE_ENUM;
-    uint8_t txbuf_state;
-
     // to inject RC_CHANNELS_OVERRIDE or RADIO_RC_CHANNELS & RADIO_LINK_STATS
     bool inject_rc_channels;
     uint16_t rc_chan[16]; // holds the rc data in MAVLink format
@@ -122,18 +128,21 @@ void MavlinkBase::Init(void)
 #ifdef USE_FEATURE_MAVLINKX
     fmavX_init();
     fmavX_config_compression((Config.Mode == MODE_19HZ) ? 1 : 0); // use compression only in 19 Hz mode
+    fmavX_config_delta(MAVLINKX_DELTA_ENCODE, mavlink_msgid_is_periodic); // we send the telemetry
+    fmavX_config_dictionary(mavlinkx_dict, MAVLINKX_DICT_NUM);
 
     result_serial_in = {};
     status_serial_in = {};
-    fifo_link_out.Init();
+    queue_link_out.Init(stats.mavlink_latency, &latency_trace);
+    link_out_len = 0;
+    link_out_pos = 0;
+    link_out_t_ms = 0;
+#endif
+#ifdef USE_FEATURE_MAVLINK_FILTER
+    filter.Init();
 #endif
 
-    radio_status_tlast_ms = millis32() + 1000;
-    radio_status_txbuf = 0;
-    txbuf_state = TXBUF_STATE_NORMAL;
-
-    bytes_serial_in = 0;
-    bytes_serial_in_cnt = 0;
+    txbuf_control.Init(millis32());
     bytes_serial_in_rate_filt.Reset();
 
     inject_rc_channels = false;
@@ -190,7 +199,7 @@ void MavlinkBase::Do(void)
         //Init();
         //radio_status_tlast_ms = tnow_ms + 1000;
 #ifdef USE_FEATURE_MAVLINKX
-        fifo_link_out.Flush();
+        link_out_flush();
 #endif
     }
 
@@ -198,29 +207,21 @@ void MavlinkBase::Do(void)
 
     // parse serial in -> link out
 #ifdef USE_FEATURE_MAVLINKX
-    if (fifo_link_out.HasSpace(290)) { // we have space for a full MAVLink message, so can safely parse
-        while (serial.available()) {
+    if (queue_link_out.HasSpace(290)) { // we have space for a full MAVLink message, so can safely parse
+        while (serial.available() && queue_link_out.HasSpace(290)) {
             char c = serial.getc();
             if (fmav_parse_and_check_to_frame_buf(&result_serial_in, buf_serial_in, &status_serial_in, c)) {
-
-                // TODO: this could be be done more efficiently by not going via msg_link_out
-                // but by directly going buf_serial_in -> _buf
-
-                fmav_frame_buf_to_msg(&msg_link_out, &result_serial_in, buf_serial_in);
-
-                uint16_t len;
-                if (Setup.Rx.SerialLinkMode == SERIAL_LINK_MODE_MAVLINK_X) {
-                    len = fmavX_msg_to_frame_buf(_buf, &msg_link_out); // X frame now in _buf
+                // relay the frame, without going via a fmav_message_t
+                // in MAVLINK_X mode it is converted when taken out, see link_out_getbuf()
+                if (!filter_pass(tnow_ms)) {
+                    // dropped, takes no airtime
                 } else {
-                    len = fmav_msg_to_frame_buf(_buf, &msg_link_out);
+                    queue_link_out.Put(buf_serial_in, result_serial_in.frame_len, &result_serial_in);
                 }
 
-                fifo_link_out.PutBuf(_buf, len);
-
-                if (msg_link_out.msgid == FASTMAVLINK_MSG_ID_COMMAND_LONG) {
+                if (result_serial_in.msgid == FASTMAVLINK_MSG_ID_COMMAND_LONG) {
                     handle_cmd_long();
                 }
-
             }
         }
     }
@@ -228,23 +229,14 @@ void MavlinkBase::Do(void)
 
     if (Setup.Rx.SendRadioStatus && connected()) {
         // we currently know that if we determine inject_radio_status here it will be executed immediately
-        switch (Setup.Rx.SendRadioStatus) {
-        case RX_SEND_RADIO_STATUS_METHOD_ARDUPILOT_1:
-            inject_radio_status = handle_txbuf_ardupilot(tnow_ms);
-            break;
-        case RX_SEND_RADIO_STATUS_METHOD_PX4:
-            inject_radio_status = handle_txbuf_method_b(tnow_ms);
-            break;
-        }
+        inject_radio_status = txbuf_control.Do(Setup.Rx.SendRadioStatus, tnow_ms, serial_in_available(), stats.received_LQ);
+        // only for "educational" purposes currently
+        if (inject_radio_status) bytes_serial_in_rate_filt.Update(tnow_ms, txbuf_control.BytesTakenCnt(), 1000);
     } else if (Setup.Rx.SendRadioStatus && !connected()) {
-        if ((tnow_ms - radio_status_tlast_ms) >= 1000) {
-            radio_status_tlast_ms = tnow_ms;
-            inject_radio_status = true;
-            radio_status_txbuf = 50; // ArduPilot: 50-90, PX4: 35-50  -> no change
-        }
+        inject_radio_status = txbuf_control.DoNotConnected(tnow_ms);
         bytes_serial_in_rate_filt.Reset();
     } else {
-        radio_status_tlast_ms = tnow_ms;
+        txbuf_control.Reset(tnow_ms);
         bytes_serial_in_rate_filt.Reset();
     }
 
@@ -313,6 +305,16 @@ void MavlinkBase::FrameLost(void)
 }
 
 
+// ack = 1 if the Tx has received the frame we transmitted last, called before we transmit the next
+void MavlinkBase::FrameAck(uint8_t ack)
+{
+#if defined USE_FEATURE_MAVLINKX && defined MAVLINKX_DELTA
+    // the delta coding may use only instances the Tx has received as reference
+    fmavX_delta_link_ack(ack);
+#endif
+}
+
+
 typedef enum {
     MAVFTP_OPCODE_OpenFileRO = 4,
 } MAVFTPOPCODEENUM;
@@ -332,7 +334,7 @@ void MavlinkBase::putc(char c)
 #else
     if (fmav_parse_and_check_to_frame_buf(&result_link_in, buf_link_in, &status_link_in, c)) {
 #endif
-        fmav_frame_buf_to_msg(&msg_serial_out, &result_link_in, buf_link_in);
+        // we work directly on the frame buf, it is a complete MAVLink frame
 
 #if MAVLINK_OPT_FAKE_PARAMFTP > 0
 #if MAVLINK_OPT_FAKE_PARAMFTP > 1
@@ -348,21 +350,24 @@ void MavlinkBase::putc(char c)
         // if it's a mavftp call to @PARAM/param.pck we fake the url
         // this will make ArduPilot to response with a NACK:FileNotFound
         // which will make MissionPlanner (any GCS?) to fallback to normal parameter upload
-        if (msg_serial_out.msgid == FASTMAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL) {
-            uint8_t target_component = msg_serial_out.payload[2];
-            uint8_t opcode = msg_serial_out.payload[6];
-            char* url = (char*)(msg_serial_out.payload + 15);
+        // the payload can be zero trimmed, but if it's shorter than 15 + 16 it can't hold the url
+        if (result_link_in.msgid == FASTMAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL &&
+            fmav_frame_buf_payload_len(buf_link_in) >= 15 + 16) {
+            uint8_t* payload = fmav_frame_buf_payload(buf_link_in);
+            uint8_t target_component = payload[2];
+            uint8_t opcode = payload[6];
+            char* url = (char*)(payload + 15);
             if (((target_component == MAV_COMP_ID_AUTOPILOT1) || (target_component == MAV_COMP_ID_ALL)) &&
                 (opcode == MAVFTP_OPCODE_OpenFileRO)) {
                 if (!strncmp(url, "@PARAM/param.pck", 16)) {
                     url[1] = url[7] = url[13] = 'x'; // now fake it to "@xARAM/xaram.xck"
-                    fmav_msg_recalculate_crc(&msg_serial_out); // we need to recalculate CRC
+                    fmav_frame_buf_recalculate_crc(&result_link_in, buf_link_in); // we need to recalculate CRC
                 }
             }
         }
 #endif
 
-        send_msg_serial_out();
+        serial.putbuf(buf_link_in, result_link_in.frame_len);
     }
 }
 
@@ -370,7 +375,7 @@ void MavlinkBase::putc(char c)
 bool MavlinkBase::available(void)
 {
 #ifdef USE_FEATURE_MAVLINKX
-    return fifo_link_out.Available();
+    return link_out_available();
 #else
     return serial.available();
 #endif
@@ -379,273 +384,139 @@ bool MavlinkBase::available(void)
 
 uint8_t MavlinkBase::getc(void)
 {
-    bytes_serial_in++;
-    bytes_serial_in_cnt++;
+    txbuf_control.BytesTaken(1);
 
 #ifdef USE_FEATURE_MAVLINKX
-    return fifo_link_out.Get();
+    uint8_t c;
+    return (link_out_getbuf(&c, 1)) ? c : 0;
 #else
     return serial.getc();
 #endif
 }
 
 
-void MavlinkBase::flush(void)
+uint16_t MavlinkBase::getbuf(uint8_t* buf, uint16_t len)
 {
 #ifdef USE_FEATURE_MAVLINKX
-    fifo_link_out.Flush();
+    len = link_out_getbuf(buf, len);
+#else
+    len = serial.getbuf(buf, len);
 #endif
-    serial.flush();
+
+    txbuf_control.BytesTaken(len);
+    return len;
 }
 
 
-void MavlinkBase::send_msg_serial_out(void)
+// all bytes which wait to be send over the link
+uint16_t MavlinkBase::bytes_available(void)
 {
-    uint16_t len = fmav_msg_to_frame_buf(_buf, &msg_serial_out);
-
-    serial.putbuf(_buf, len);
+#ifdef USE_FEATURE_MAVLINKX
+    return link_out_available() + serial.bytes_available();
+#else
+    return serial.bytes_available();
+#endif
 }
 
 
-//-------------------------------------------------------
-// Handle txbuf
-//-------------------------------------------------------
-// for the txbuf rate-based mechanism see design_decissions.h for details
-
-uint16_t MavlinkBase::serial_in_available(void)
+void MavlinkBase::flush(void)
 {
 #ifdef USE_FEATURE_MAVLINKX
-    return fifo_link_out.Available();
-#else
-    return serial.bytes_available();
+    link_out_flush();
 #endif
+    serial.flush();
 }
 
 
-bool MavlinkBase::handle_txbuf_ardupilot(uint32_t tnow_ms)
+#ifdef USE_FEATURE_MAVLINKX
+// in MAVLINK_X mode the messages are converted only when they are taken out of the queue, so
+// that the delta coding uses the instance which was actually send before
+uint16_t MavlinkBase::link_out_getbuf(uint8_t* buf, uint16_t len)
 {
-    // work out state
-    bool inject_radio_status = false;
-    uint8_t txbuf_state_last = txbuf_state; // to track changes in txbuf_state
-
-    if ((tnow_ms - radio_status_tlast_ms) >= 1000) {
-        //txbuf_state = TXBUF_STATE_NORMAL; // ??? or should we enter this case only if in normal?? does it matter ??
-        radio_status_tlast_ms = tnow_ms;
-        inject_radio_status = true;
-    } else
-    if ((tnow_ms - radio_status_tlast_ms) >= 100) { // limit to 10 Hz
-        switch (txbuf_state) {
-        case TXBUF_STATE_NORMAL:
-            if (serial_in_available() > 1024) { // ups, suddenly lots of traffic
-                txbuf_state = TXBUF_STATE_BURST;
-                radio_status_tlast_ms = tnow_ms;
-                inject_radio_status = true;
-            }
-            break;
-        case TXBUF_STATE_BURST:
-            if (serial_in_available() > 1024) { // it hasn't depleted, so raise alarm high
-                txbuf_state = TXBUF_STATE_BURST_HIGH;
-                radio_status_tlast_ms = tnow_ms;
-                inject_radio_status = true;
-            } else
-            if (serial_in_available() < 384) { // quite empty, so we can go back and try normal
-                txbuf_state = TXBUF_STATE_NORMAL;
-                radio_status_tlast_ms = tnow_ms;
-                inject_radio_status = true;
-            }
-            break;
-        case TXBUF_STATE_BURST_HIGH:
-            if (serial_in_available() < 1024) { // it has depleted, we can go back and try burst
-                txbuf_state = TXBUF_STATE_BURST;
-            }
-            radio_status_tlast_ms = tnow_ms;
-            inject_radio_status = true;
-            break;
-        }
+    if (Setup.Rx.SerialLinkMode != SERIAL_LINK_MODE_MAVLINK_X) {
+        return queue_link_out.GetBuf(buf, len);
     }
 
-    if (!inject_radio_status) return false;
-
-    // now calculate txbuf
-    uint8_t txbuf = 100;
-
-    // method C, with improvements
-    // assumes 1 sec delta time
-    uint32_t rate_max = ((uint32_t)1000 * FRAME_RX_PAYLOAD_LEN) / Config.frame_rate_ms; // theoretical rate, bytes per sec
-    uint32_t rate_percentage = (bytes_serial_in * 100) / rate_max;
-
-    // https://github.com/ArduPilot/ardupilot/blob/fa6441544639bd5dc84c3e6e3d2f7bfd2aecf96d/libraries/GCS_MAVLink/GCS_Common.cpp#L782-L801
-    // aim at 75%..85% rate usage in steady state
-    if (rate_percentage > 95) {
-        txbuf = 0;                        // ArduPilot:  0-19  -> +60 ms,    PX4:  0-24  -> *0.8
-    } else if (rate_percentage > 85) {
-        txbuf = 30;                       // ArduPilot: 20-49  -> +20 ms,    PX4: 25-34  -> *0.975
-    } else if (rate_percentage < 60) {
-        txbuf = 100;                      // ArduPilot: 96-100 -> -40 ms,    PX4: 51-100 -> *1.025
-    } else if (rate_percentage < 75) {
-        txbuf = 91;                       // ArduPilot: 91-95  -> -20 ms,    PX4: 51-100 -> *1.025
-    } else {
-        txbuf = 50;                       // ArduPilot: 50-90  -> no change, PX4: 35-50  -> no change
-    }
+    uint16_t cnt = 0;
 
-    if (txbuf_state == TXBUF_STATE_BURST_HIGH) {
-        txbuf = 0; // try to slow down as much as possible
-    } else
-    if (txbuf_state == TXBUF_STATE_BURST) {
-        txbuf = 50; // cut out PARAMS but don't change stream rate
-    } else
-    if ((txbuf_state == TXBUF_STATE_NORMAL) && (txbuf_state_last > TXBUF_STATE_NORMAL)) { // has changed back to NORMAL
-        txbuf = 51; // allow PARAMS but don't change stream rate
-    }
-    txbuf_state_last = txbuf_state;
-
-    // only for "educational" purposes currently
-    bytes_serial_in_rate_filt.Update(tnow_ms, bytes_serial_in_cnt, 1000);
-/*
-static uint32_t t_last = 0;
-uint32_t t = millis32(), dt = t - t_last; t_last = t;
-dbg.puts("\nMa: ");
-dbg.puts(u16toBCD_s(t));dbg.puts(" (");dbg.puts(u16toBCD_s(dt));dbg.puts("), ");
-//dbg.puts(u16toBCD_s(stats.GetTransmitBandwidthUsage()*41));dbg.puts(", ");
-dbg.puts(u16toBCD_s(bytes_serial_in));dbg.puts(" (");
-dbg.puts(u16toBCD_s(bytes_serial_in_rate_filt.Get()));dbg.puts("), ");
-dbg.puts(u16toBCD_s(serial_in_available()));dbg.puts(", ");
-dbg.puts(u8toBCD_s((rate_percentage<256)?rate_percentage:255));dbg.puts(", ");
-if(txbuf_state==2) dbg.puts("high, "); else
-if(txbuf_state==1) dbg.puts("brst, "); else dbg.puts("norm, ");
-dbg.puts(u8toBCD_s(txbuf));dbg.puts(", ");
-if(txbuf<20) dbg.puts("+60 "); else
-if(txbuf<50) dbg.puts("+20 "); else
-if(txbuf>95) dbg.puts("-40 "); else
-if(txbuf>90) dbg.puts("-20 "); else dbg.puts("0   ");
-*/
-    if ((txbuf_state == TXBUF_STATE_NORMAL) && (txbuf == 100)) {
-        radio_status_tlast_ms -= 666; // do again in 1/3 sec
-        bytes_serial_in = (bytes_serial_in * 2)/3; // approximate by 2/3 of what was received in the last 1 sec
-    } else {
-        bytes_serial_in = 0; // reset, to restart rate measurement
+    while (cnt < len) {
+        if (link_out_pos >= link_out_len) { // get next message
+            fmav_result_t result;
+            if (!queue_link_out.GetFrame(_buf, &result, &link_out_t_ms)) break; // nothing left
+            link_out_len = fmavX_frame_buf_to_frame_buf(buf_link_out, &result, _buf);
+            link_out_pos = 0;
+        }
+
+        uint16_t n = link_out_len - link_out_pos;
+        if (n > len - cnt) n = len - cnt;
+        memcpy(buf + cnt, &(buf_link_out[link_out_pos]), n);
+        cnt += n;
+        link_out_pos += n;
+        if (link_out_pos >= link_out_len) { // message completed
+            latency_trace.SerialPacked(link_out_t_ms);
+#ifdef MAVLINKX_DELTA
+            fmavX_delta_msg_sent();
+#endif
+        }
     }
 
-    radio_status_txbuf = txbuf;
-    return true;
+    return cnt;
 }
 
 
-// this method should be selected for PX4 and currently may be a useful alternative for Ardupilot
-bool MavlinkBase::handle_txbuf_method_b(uint32_t tnow_ms)
+uint16_t MavlinkBase::link_out_available(void)
 {
-    // work out state
-    bool inject_radio_status = false;
+    return queue_link_out.Available() + (link_out_len - link_out_pos);
+}
 
-    if ((tnow_ms - radio_status_tlast_ms) >= 1000) {
-        radio_status_tlast_ms = tnow_ms;
-        inject_radio_status = true;
-    } else
-    switch (txbuf_state) {
-        case TXBUF_STATE_NORMAL:
-            if (serial_in_available() > 800) { // oops, buffer filling
-                txbuf_state = TXBUF_STATE_BURST;
-                radio_status_tlast_ms = tnow_ms;
-                inject_radio_status = true;
-            }
-            break;
-        case TXBUF_STATE_BURST:
-            if (serial_in_available() > 1400) { // still growing, so raise alarm high
-                txbuf_state = TXBUF_STATE_BURST_HIGH;
-                radio_status_tlast_ms = tnow_ms;
-                inject_radio_status = true;
-            } else
-            if (serial_in_available() < FRAME_RX_PAYLOAD_LEN*2) { // less than 2 radio messages remain, back to normal
-                txbuf_state = TXBUF_STATE_PX4_RECOVER;
-                radio_status_tlast_ms = tnow_ms;
-                inject_radio_status = true;
-            }
-            break;
-        case TXBUF_STATE_BURST_HIGH:
-            if ((tnow_ms - radio_status_tlast_ms) >= 100) { // limit to 10 Hz
-                if (serial_in_available() < 1400) { // it has stopped growing, we can go back and try burst
-                    txbuf_state = TXBUF_STATE_BURST;
-                }
-                radio_status_tlast_ms = tnow_ms;
-                inject_radio_status = true;
-            }
-            break;
-        case TXBUF_STATE_PX4_RECOVER: // transient state so we don't need txbuf_state_last
-            txbuf_state = TXBUF_STATE_NORMAL;
-            break;
+
+void MavlinkBase::link_out_flush(void)
+{
+    queue_link_out.Flush();
+    link_out_len = 0;
+    link_out_pos = 0;
+#ifdef MAVLINKX_DELTA
+    fmavX_delta_reset(); // the Tx may have been restarted, or a message was cut
+#endif
+}
+
+
+// the message parsed from serial in is dropped if it doesn't pass, before it takes airtime
+bool MavlinkBase::filter_pass(uint32_t tnow_ms)
+{
+#ifdef USE_FEATURE_MAVLINK_FILTER
+    if (!filter.Pass(&result_serial_in, tnow_ms)) {
+        stats.filter_bytes_dropped.Add(result_serial_in.frame_len);
+        stats.filter_msgs_dropped.Add(1);
+        return false;
     }
+#endif
+    stats.filter_bytes_forwarded.Add(result_serial_in.frame_len);
+    return true;
+}
+#endif
 
-    if (!inject_radio_status) return false;
-
-    // now calculate txbuf
-    uint8_t txbuf = 100;
-
-    // method C, with improvements
-    // assumes 1 sec delta time
-    uint32_t rate_max = ((uint32_t)1000 * FRAME_RX_PAYLOAD_LEN) / Config.frame_rate_ms; // theoretical rate, bytes per sec
-    uint32_t rate_percentage = (bytes_serial_in * 100) / rate_max;
-
-    // https://github.com/ArduPilot/ardupilot/blob/fa6441544639bd5dc84c3e6e3d2f7bfd2aecf96d/libraries/GCS_MAVLink/GCS_Common.cpp#L782-L801
-    // https://github.com/PX4/PX4-Autopilot/blob/fe80e7aa468a50bec6b035d0e8e4e37e516c84ff/src/modules/mavlink/mavlink_main.cpp#L1436-L1463
-    // https://github.com/PX4/PX4-Autopilot/blob/fe80e7aa468a50bec6b035d0e8e4e37e516c84ff/src/modules/mavlink/mavlink_main.h#L690
-    // PX4 is less bursty for normal streams, we might be able to sustain higher rates of 80%..90%
-    switch (txbuf_state) {
-        case TXBUF_STATE_NORMAL:
-            if (rate_percentage > 95) {
-                txbuf = 0;                        // ArduPilot:  0-19  -> +60 ms,    PX4:  0-24  -> *0.8
-            } else if (rate_percentage > 85) {
-                txbuf = 30;                       // ArduPilot: 20-49  -> +20 ms,    PX4: 25-34  -> *0.975
-            } else if (rate_percentage < 60) {
-                txbuf = 100;                      // ArduPilot: 96-100 -> -40 ms,    PX4: 51-100 -> *1.025
-            } else if (rate_percentage < 75) {
-                txbuf = 91;                       // ArduPilot: 91-95  -> -20 ms,    PX4: 51-100 -> *1.025
-            } else {
-                txbuf = 50;                       // ArduPilot: 50-90  -> no change, PX4: 35-50  -> no change
-            }
-            break;
 
-        case TXBUF_STATE_BURST:
-            txbuf = 33; // just enough to stop parameter flow
-            break;
+void MavlinkBase::send_msg_serial_out(void)
+{
+    uint16_t len = fmav_msg_to_frame_buf(_buf, &msg_serial_out);
 
-        case TXBUF_STATE_BURST_HIGH:
-            txbuf = 0; // slow down as much as possible
-            break;
+    serial.putbuf(_buf, len);
+}
 
-        case TXBUF_STATE_PX4_RECOVER:
-            txbuf = 93; // restart data flow
-            break;
-    }
 
-    // only for "educational" purposes currently
-    bytes_serial_in_rate_filt.Update(tnow_ms, bytes_serial_in_cnt, 1000);
-#if 0 // Debug
-static uint32_t t_last = 0;
-uint32_t t = millis32(), dt = t - t_last; t_last = t;
-dbg.puts("\nMp: ");
-dbg.puts(u16toBCD_s(t));dbg.puts(" (");dbg.puts(u16toBCD_s(dt));dbg.puts("), ");
-//dbg.puts(u16toBCD_s(stats.GetTransmitBandwidthUsage()*41));dbg.puts(", ");
-dbg.puts(u16toBCD_s(bytes_serial_in));dbg.puts(", ");
-dbg.puts(u16toBCD_s(serial_in_available()));dbg.puts(", ");
-dbg.puts(u8toBCD_s((rate_percentage<256)?rate_percentage:255));dbg.puts(", ");
-if(txbuf_state==1) dbg.puts("brst, "); else
-if(txbuf_state==2) dbg.puts("high, "); else
-if(txbuf_state==3) dbg.puts("recv, "); else dbg.puts("norm, ");
-dbg.puts(u8toBCD_s(txbuf));dbg.puts(", ");
-if(txbuf<25) dbg.puts("*0.8 "); else
-if(txbuf<35) dbg.puts("*0.975 "); else
-if(txbuf>50) dbg.puts("*1.025 "); else dbg.puts("*1 ");
-#endif
-    // increase rate faster after transient traffic since PX4 currently has no fast recovery. Could also try 100ms
-    if ((txbuf_state == TXBUF_STATE_NORMAL) && (txbuf == 100)) {
-        radio_status_tlast_ms -= 800; // do again in 200ms
-        bytes_serial_in = (bytes_serial_in * 4)/5; // rolling average
-    } else {
-        bytes_serial_in = 0; // reset, to restart rate measurement
-    }
+//-------------------------------------------------------
+// Handle txbuf
+//-------------------------------------------------------
+// for the txbuf rate-based mechanism see mavlink_txbuf.h and design_decissions.h for details
 
-    radio_status_txbuf = txbuf;
-    return true;
+uint16_t MavlinkBase::serial_in_available(void)
+{
+#ifdef USE_FEATURE_MAVLINKX
+    return link_out_available();
+#else
+    return serial.bytes_available();
+#endif
 }
 
 
@@ -673,7 +544,7 @@ uint8_t rssi, remrssi, txbuf, noise;
     int16_t snr = -stats.GetLastSnr() + 10;
     noise = (snr < 0) ? 0 : (snr > 127) ? 127 : snr;
 
-    txbuf = radio_status_txbuf;
+    txbuf = txbuf_control.Get();
 
     fmav_msg_radio_status_pack(
         &msg_serial_out,
@@ -781,7 +652,7 @@ uint8_t flags, rx_rssi1, rx_rssi2, tx_rssi;
 
 void MavlinkBase::generate_radio_link_flow_control(void)
 {
-    uint8_t txbuf = radio_status_txbuf;
+    uint8_t txbuf = txbuf_control.Get();
 
     fmav_msg_radio_link_flow_control_pack(
         &msg_serial_out,
@@ -816,7 +687,7 @@ void MavlinkBase::handle_cmd_long(void)
 #ifdef USE_FEATURE_MAVLINKX
 fmav_command_long_t payload;
 
-    fmav_msg_command_long_decode(&payload, &msg_link_out);
+    fmav_frame_buf_decode(&payload, sizeof(payload), buf_serial_in);
 
     // check if it is for us, only allow targeted commands
     if (payload.target_system != RADIO_LINK_SYSTEM_ID) return;
@@ -834,8 +705,8 @@ fmav_command_long_t payload;
 
     inject_cmd_ack = true;
     cmd_ack.command = payload.command;
-    cmd_ack.cmd_src_sysid = msg_link_out.sysid;
-    cmd_ack.cmd_src_compid = msg_link_out.compid;
+    cmd_ack.cmd_src_sysid = result_serial_in.sysid;
+    cmd_ack.cmd_src_compid = result_serial_in.compid;
 
     bool cmd_valid = false;
     switch (payload.command) {
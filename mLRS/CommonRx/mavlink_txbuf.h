@@ -0,0 +1,422 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// MAVLink TxBuf Control
+//*******************************************************
+// Works out when to send RADIO_STATUS or RADIO_LINK_FLOW_CONTROL, and which txbuf value,
+// with which the autopilot is made to adapt its stream rates to the link.
+// See design_decissions.h for the methods.
+//
+// The inputs are the filling of the queue from serial in to link out, the bytes taken
+// out of it, and the LQ of our frames as reported by the Tx. It has no dependency on
+// fastmavlink, but needs Config and FRAME_RX_PAYLOAD_LEN_USABLE from its includer.
+//*******************************************************
+#ifndef MAVLINK_TXBUF_H
+#define MAVLINK_TXBUF_H
+#pragma once
+
+
+#include <inttypes.h>
+
+
+#define TXBUF_MODEL_DELAY_TARGET_MS 100 // model method: queue delay we want to stay below
+#define TXBUF_MODEL_DELAY_MAX_MS    250 // model method: queue delay at which we slow down hard
+
+
+class tTxBufControl
+{
+  public:
+    void Init(uint32_t tnow_ms);
+    bool Do(uint8_t method, uint32_t tnow_ms, uint16_t queue, uint8_t received_LQ);
+    bool DoNotConnected(uint32_t tnow_ms);
+    void Reset(uint32_t tnow_ms);
+
+    void BytesTaken(uint16_t len) { bytes_serial_in += len; bytes_serial_in_cnt += len; }
+    uint32_t BytesTakenCnt(void) { return bytes_serial_in_cnt; }
+    uint8_t Get(void) { return radio_status_txbuf; }
+
+  private:
+    bool handle_ardupilot(uint32_t tnow_ms, uint16_t queue);
+    bool handle_method_b(uint32_t tnow_ms, uint16_t queue); // for PX4, aka "brad"
+    bool handle_model(uint32_t tnow_ms, uint16_t queue, uint8_t received_LQ);
+    void reset_model(void);
+
+    uint32_t radio_status_tlast_ms;
+    uint32_t bytes_serial_in;
+    uint8_t radio_status_txbuf;
+
+    uint32_t bytes_serial_in_cnt;
+
+    typedef enum {
+        TXBUF_STATE_NORMAL = 0,
+        TXBUF_STATE_BURST,
+        TXBUF_STATE_BURST_HIGH,
+        TXBUF_STATE_PX4_RECOVER, // for PX4, buffer draining, resume bulk download
+    } TXBUF_STATE_ENUM;
+    uint8_t txbuf_state;
+
+    // for the model based method
+    uint32_t model_tick_tlast_ms;
+    uint32_t model_bytes_cnt_last;
+    uint16_t model_queue_last;
+    int32_t model_arrival_rate; // bytes/s, filtered
+    int32_t model_capacity; // bytes/s, filtered
+    int32_t model_delay_ms;
+};
+
+
+void tTxBufControl::Init(uint32_t tnow_ms)
+{
+    radio_status_tlast_ms = tnow_ms + 1000;
+    radio_status_txbuf = 0;
+    txbuf_state = TXBUF_STATE_NORMAL;
+
+    bytes_serial_in = 0;
+    bytes_serial_in_cnt = 0;
+    reset_model();
+}
+
+
+// method is one of RX_SEND_RADIO_STATUS_METHOD_xxx
+// returns true if RADIO_STATUS or RADIO_LINK_FLOW_CONTROL should be send now
+bool tTxBufControl::Do(uint8_t method, uint32_t tnow_ms, uint16_t queue, uint8_t received_LQ)
+{
+    switch (method) {
+    case RX_SEND_RADIO_STATUS_METHOD_ARDUPILOT_1: return handle_ardupilot(tnow_ms, queue);
+    case RX_SEND_RADIO_STATUS_METHOD_PX4: return handle_method_b(tnow_ms, queue);
+    case RX_SEND_RADIO_STATUS_METHOD_MODEL: return handle_model(tnow_ms, queue, received_LQ);
+    }
+    return false;
+}
+
+
+// we send at 1 Hz, with a txbuf which doesn't change the rates
+bool tTxBufControl::DoNotConnected(uint32_t tnow_ms)
+{
+    reset_model();
+
+    if ((tnow_ms - radio_status_tlast_ms) < 1000) return false;
+    radio_status_tlast_ms = tnow_ms;
+    radio_status_txbuf = 50; // ArduPilot: 50-90, PX4: 35-50  -> no change
+    return true;
+}
+
+
+void tTxBufControl::Reset(uint32_t tnow_ms)
+{
+    radio_status_tlast_ms = tnow_ms;
+    reset_model();
+}
+
+
+//-------------------------------------------------------
+// Methods
+//-------------------------------------------------------
+
+bool tTxBufControl::handle_ardupilot(uint32_t tnow_ms, uint16_t queue)
+{
+    // work out state
+    bool inject_radio_status = false;
+    uint8_t txbuf_state_last = txbuf_state; // to track changes in txbuf_state
+
+    if ((tnow_ms - radio_status_tlast_ms) >= 1000) {
+        //txbuf_state = TXBUF_STATE_NORMAL; // ??? or should we enter this case only if in normal?? does it matter ??
+        radio_status_tlast_ms = tnow_ms;
+        inject_radio_status = true;
+    } else
+    if ((tnow_ms - radio_status_tlast_ms) >= 100) { // limit to 10 Hz
+        switch (txbuf_state) {
+        case TXBUF_STATE_NORMAL:
+            if (queue > 1024) { // ups, suddenly lots of traffic
+                txbuf_state = TXBUF_STATE_BURST;
+                radio_status_tlast_ms = tnow_ms;
+                inject_radio_status = true;
+            }
+            break;
+        case TXBUF_STATE_BURST:
+            if (queue > 1024) { // it hasn't depleted, so raise alarm high
+                txbuf_state = TXBUF_STATE_BURST_HIGH;
+                radio_status_tlast_ms = tnow_ms;
+                inject_radio_status = true;
+            } else
+            if (queue < 384) { // quite empty, so we can go back and try normal
+                txbuf_state = TXBUF_STATE_NORMAL;
+                radio_status_tlast_ms = tnow_ms;
+                inject_radio_status = true;
+            }
+            break;
+        case TXBUF_STATE_BURST_HIGH:
+            if (queue < 1024) { // it has depleted, we can go back and try burst
+                txbuf_state = TXBUF_STATE_BURST;
+            }
+            radio_status_tlast_ms = tnow_ms;
+            inject_radio_status = true;
+            break;
+        }
+    }
+
+    if (!inject_radio_status) return false;
+
+    // now calculate txbuf
+    uint8_t txbuf = 100;
+
+    // method C, with improvements
+    // assumes 1 sec delta time
+    uint32_t rate_max = ((uint32_t)1000 * FRAME_RX_PAYLOAD_LEN_USABLE) / Config.frame_rate_ms; // theoretical rate, bytes per sec
+    uint32_t rate_percentage = (bytes_serial_in * 100) / rate_max;
+
+    // https://github.com/ArduPilot/ardupilot/blob/fa6441544639bd5dc84c3e6e3d2f7bfd2aecf96d/libraries/GCS_MAVLink/GCS_Common.cpp#L782-L801
+    // aim at 75%..85% rate usage in steady state
+    if (rate_percentage > 95) {
+        txbuf = 0;                        // ArduPilot:  0-19  -> +60 ms,    PX4:  0-24  -> *0.8
+    } else if (rate_percentage > 85) {
+        txbuf = 30;                       // ArduPilot: 20-49  -> +20 ms,    PX4: 25-34  -> *0.975
+    } else if (rate_percentage < 60) {
+        txbuf = 100;                      // ArduPilot: 96-100 -> -40 ms,    PX4: 51-100 -> *1.025
+    } else if (rate_percentage < 75) {
+        txbuf = 91;                       // ArduPilot: 91-95  -> -20 ms,    PX4: 51-100 -> *1.025
+    } else {
+        txbuf = 50;                       // ArduPilot: 50-90  -> no change, PX4: 35-50  -> no change
+    }
+
+    if (txbuf_state == TXBUF_STATE_BURST_HIGH) {
+        txbuf = 0; // try to slow down as much as possible
+    } else
+    if (txbuf_state == TXBUF_STATE_BURST) {
+        txbuf = 50; // cut out PARAMS but don't change stream rate
+    } else
+    if ((txbuf_state == TXBUF_STATE_NORMAL) && (txbuf_state_last > TXBUF_STATE_NORMAL)) { // has changed back to NORMAL
+        txbuf = 51; // allow PARAMS but don't change stream rate
+    }
+    txbuf_state_last = txbuf_state;
+
+/*
+static uint32_t t_last = 0;
+uint32_t t = millis32(), dt = t - t_last; t_last = t;
+dbg.puts("\nMa: ");
+dbg.puts(u16toBCD_s(t));dbg.puts(" (");dbg.puts(u16toBCD_s(dt));dbg.puts("), ");
+//dbg.puts(u16toBCD_s(stats.GetTransmitBandwidthUsage()*41));dbg.puts(", ");
+dbg.puts(u16toBCD_s(bytes_serial_in));dbg.puts(", ");
+dbg.puts(u16toBCD_s(queue));dbg.puts(", ");
+dbg.puts(u8toBCD_s((rate_percentage<256)?rate_percentage:255));dbg.puts(", ");
+if(txbuf_state==2) dbg.puts("high, "); else
+if(txbuf_state==1) dbg.puts("brst, "); else dbg.puts("norm, ");
+dbg.puts(u8toBCD_s(txbuf));dbg.puts(", ");
+if(txbuf<20) dbg.puts("+60 "); else
+if(txbuf<50) dbg.puts("+20 "); else
+if(txbuf>95) dbg.puts("-40 "); else
+if(txbuf>90) dbg.puts("-20 "); else dbg.puts("0   ");
+*/
+    if ((txbuf_state == TXBUF_STATE_NORMAL) && (txbuf == 100)) {
+        radio_status_tlast_ms -= 666; // do again in 1/3 sec
+        bytes_serial_in = (bytes_serial_in * 2)/3; // approximate by 2/3 of what was received in the last 1 sec
+    } else {
+        bytes_serial_in = 0; // reset, to restart rate measurement
+    }
+
+    radio_status_txbuf = txbuf;
+    return true;
+}
+
+
+// this method should be selected for PX4 and currently may be a useful alternative for Ardupilot
+bool tTxBufControl::handle_method_b(uint32_t tnow_ms, uint16_t queue)
+{
+    // work out state
+    bool inject_radio_status = false;
+
+    if ((tnow_ms - radio_status_tlast_ms) >= 1000) {
+        radio_status_tlast_ms = tnow_ms;
+        inject_radio_status = true;
+    } else
+    switch (txbuf_state) {
+        case TXBUF_STATE_NORMAL:
+            if (queue > 800) { // oops, buffer filling
+                txbuf_state = TXBUF_STATE_BURST;
+                radio_status_tlast_ms = tnow_ms;
+                inject_radio_status = true;
+            }
+            break;
+        case TXBUF_STATE_BURST:
+            if (queue > 1400) { // still growing, so raise alarm high
+                txbuf_state = TXBUF_STATE_BURST_HIGH;
+                radio_status_tlast_ms = tnow_ms;
+                inject_radio_status = true;
+            } else
+            if (queue < FRAME_RX_PAYLOAD_LEN*2) { // less than 2 radio messages remain, back to normal
+                txbuf_state = TXBUF_STATE_PX4_RECOVER;
+                radio_status_tlast_ms = tnow_ms;
+                inject_radio_status = true;
+            }
+            break;
+        case TXBUF_STATE_BURST_HIGH:
+            if ((tnow_ms - radio_status_tlast_ms) >= 100) { // limit to 10 Hz
+                if (queue < 1400) { // it has stopped growing, we can go back and try burst
+                    txbuf_state = TXBUF_STATE_BURST;
+                }
+                radio_status_tlast_ms = tnow_ms;
+                inject_radio_status = true;
+            }
+            break;
+        case TXBUF_STATE_PX4_RECOVER: // transient state so we don't need txbuf_state_last
+            txbuf_state = TXBUF_STATE_NORMAL;
+            break;
+    }
+
+    if (!inject_radio_status) return false;
+
+    // now calculate txbuf
+    uint8_t txbuf = 100;
+
+    // method C, with improvements
+    // assumes 1 sec delta time
+    uint32_t rate_max = ((uint32_t)1000 * FRAME_RX_PAYLOAD_LEN_USABLE) / Config.frame_rate_ms; // theoretical rate, bytes per sec
+    uint32_t rate_percentage = (bytes_serial_in * 100) / rate_max;
+
+    // https://github.com/ArduPilot/ardupilot/blob/fa6441544639bd5dc84c3e6e3d2f7bfd2aecf96d/libraries/GCS_MAVLink/GCS_Common.cpp#L782-L801
+    // https://github.com/PX4/PX4-Autopilot/blob/fe80e7aa468a50bec6b035d0e8e4e37e516c84ff/src/modules/mavlink/mavlink_main.cpp#L1436-L1463
+    // https://github.com/PX4/PX4-Autopilot/blob/fe80e7aa468a50bec6b035d0e8e4e37e516c84ff/src/modules/mavlink/mavlink_main.h#L690
+    // PX4 is less bursty for normal streams, we might be able to sustain higher rates of 80%..90%
+    switch (txbuf_state) {
+        case TXBUF_STATE_NORMAL:
+            if (rate_percentage > 95) {
+                txbuf = 0;                        // ArduPilot:  0-19  -> +60 ms,    PX4:  0-24  -> *0.8
+            } else if (rate_percentage > 85) {
+                txbuf = 30;                       // ArduPilot: 20-49  -> +20 ms,    PX4: 25-34  -> *0.975
+            } else if (rate_percentage < 60) {
+                txbuf = 100;                      // ArduPilot: 96-100 -> -40 ms,    PX4: 51-100 -> *1.025
+            } else if (rate_percentage < 75) {
+                txbuf = 91;                       // ArduPilot: 91-95  -> -20 ms,    PX4: 51-100 -> *1.025
+            } else {
+                txbuf = 50;                       // ArduPilot: 50-90  -> no change, PX4: 35-50  -> no change
+            }
+            break;
+
+        case TXBUF_STATE_BURST:
+            txbuf = 33; // just enough to stop parameter flow
+            break;
+
+        case TXBUF_STATE_BURST_HIGH:
+            txbuf = 0; // slow down as much as possible
+            break;
+
+        case TXBUF_STATE_PX4_RECOVER:
+            txbuf = 93; // restart data flow
+            break;
+    }
+
+#if 0 // Debug
+static uint32_t t_last = 0;
+uint32_t t = millis32(), dt = t - t_last; t_last = t;
+dbg.puts("\nMp: ");
+dbg.puts(u16toBCD_s(t));dbg.puts(" (");dbg.puts(u16toBCD_s(dt));dbg.puts("), ");
+//dbg.puts(u16toBCD_s(stats.GetTransmitBandwidthUsage()*41));dbg.puts(", ");
+dbg.puts(u16toBCD_s(bytes_serial_in));dbg.puts(", ");
+dbg.puts(u16toBCD_s(queue));dbg.puts(", ");
+dbg.puts(u8toBCD_s((rate_percentage<256)?rate_percentage:255));dbg.puts(", ");
+if(txbuf_state==1) dbg.puts("brst, "); else
+if(txbuf_state==2) dbg.puts("high, "); else
+if(txbuf_state==3) dbg.puts("recv, "); else dbg.puts("norm, ");
+dbg.puts(u8toBCD_s(txbuf));dbg.puts(", ");
+if(txbuf<25) dbg.puts("*0.8 "); else
+if(txbuf<35) dbg.puts("*0.975 "); else
+if(txbuf>50) dbg.puts("*1.025 "); else dbg.puts("*1 ");
+#endif
+    // increase rate faster after transient traffic since PX4 currently has no fast recovery. Could also try 100ms
+    if ((txbuf_state == TXBUF_STATE_NORMAL) && (txbuf == 100)) {
+        radio_status_tlast_ms -= 800; // do again in 200ms
+        bytes_serial_in = (bytes_serial_in * 4)/5; // rolling average
+    } else {
+        bytes_serial_in = 0; // reset, to restart rate measurement
+    }
+
+    radio_status_txbuf = txbuf;
+    return true;
+}
+
+
+// model based method
+// estimates the rate at which the autopilot sends, and the capacity of the link, and from
+// this and the queue filling the queue delay, and uses txbuf to keep the delay bounded
+// see design_decissions.h for details
+bool tTxBufControl::handle_model(uint32_t tnow_ms, uint16_t queue, uint8_t received_LQ)
+{
+    // update the model, at 10 Hz
+    if ((tnow_ms - model_tick_tlast_ms) >= 100) {
+        int32_t dt_ms = tnow_ms - model_tick_tlast_ms;
+        model_tick_tlast_ms = tnow_ms;
+
+        int32_t drained = bytes_serial_in_cnt - model_bytes_cnt_last;
+        int32_t arrived = drained + (int32_t)queue - (int32_t)model_queue_last;
+        model_bytes_cnt_last = bytes_serial_in_cnt;
+
+        if (dt_ms > 1000) { // first call, or we were not called for long, so the numbers are meaningless
+            model_queue_last = queue;
+            return false;
+        }
+
+        // the capacity as expected from the frame rate and the LQ the Tx reports for our frames
+        // lost frames cost a slot, also with ARQ, as they are resent
+        int32_t rate_max = ((int32_t)1000 * FRAME_RX_PAYLOAD_LEN_USABLE) / Config.frame_rate_ms; // theoretical rate, bytes per sec
+        int32_t capacity = (rate_max * received_LQ) / 100;
+
+        // if the queue didn't run empty, what was drained is what the link can do, so we measure it
+        // this catches what the LQ doesn't tell, like frames which carry less than a full payload
+        if (model_queue_last >= FRAME_RX_PAYLOAD_LEN && queue >= FRAME_RX_PAYLOAD_LEN) {
+            capacity = (drained * 1000) / dt_ms;
+        }
+        if (capacity < rate_max / 10) capacity = rate_max / 10; // play it safe
+        model_capacity += (capacity - model_capacity) / 4;
+
+        model_arrival_rate += ((arrived * 1000) / dt_ms - model_arrival_rate) / 8;
+        if (model_arrival_rate < 0) model_arrival_rate = 0;
+
+        model_delay_ms = ((int32_t)queue * 1000) / model_capacity;
+        model_queue_last = queue;
+    }
+
+    // work out when to send
+    // the autopilot changes the rates in steps for each RADIO_STATUS, so we send faster if the delay is too large
+    uint32_t period_ms = (model_delay_ms > TXBUF_MODEL_DELAY_TARGET_MS) ? 200 : 1000;
+    if ((tnow_ms - radio_status_tlast_ms) < period_ms) return false;
+    radio_status_tlast_ms = tnow_ms;
+
+    // now calculate txbuf
+    // we aim at 65%..85% of the capacity, and at a queue delay below the target
+    uint8_t txbuf;
+    int32_t usage_percentage = (model_arrival_rate * 100) / model_capacity;
+
+    if (model_delay_ms > TXBUF_MODEL_DELAY_MAX_MS || usage_percentage > 100) {
+        txbuf = 0;                        // ArduPilot:  0-19  -> +60 ms,    PX4:  0-24  -> *0.8
+    } else if (model_delay_ms > TXBUF_MODEL_DELAY_TARGET_MS || usage_percentage > 85) {
+        txbuf = 30;                       // ArduPilot: 20-49  -> +20 ms,    PX4: 25-34  -> *0.975
+    } else if (usage_percentage < 50 && model_delay_ms < TXBUF_MODEL_DELAY_TARGET_MS/2) {
+        txbuf = 100;                      // ArduPilot: 96-100 -> -40 ms,    PX4: 51-100 -> *1.025
+    } else if (usage_percentage < 65) {
+        txbuf = 91;                       // ArduPilot: 91-95  -> -20 ms,    PX4: 51-100 -> *1.025
+    } else {
+        txbuf = 50;                       // ArduPilot: 50-90  -> no change, PX4: 35-50  -> no change
+    }
+
+    bytes_serial_in = 0;
+
+    radio_status_txbuf = txbuf;
+    return true;
+}
+
+
+void tTxBufControl::reset_model(void)
+{
+    model_tick_tlast_ms = 0;
+    model_bytes_cnt_last = bytes_serial_in_cnt;
+    model_queue_last = 0;
+    model_arrival_rate = 0;
+    model_capacity = ((int32_t)1000 * FRAME_RX_PAYLOAD_LEN_USABLE) / Config.frame_rate_ms;
+    model_delay_ms = 0;
+}
+
+
+#endif // MAVLINK_TXBUF_H
@@ -116,6 +116,7 @@ void init(void)
     fan.Init();
     dbg.Init();
 
+    frame_crc_engine_init();
     sx.Init();
     sx2.Init();
 
@@ -132,6 +133,7 @@ void init(void)
 
 volatile uint16_t irq_status;
 volatile uint16_t irq2_status;
+volatile uint16_t irq_rx_done_us; // when the last frame was received, by either antenna
 
 IRQHANDLER(
 void SX_DIO_EXTI_IRQHandler(void)
@@ -139,6 +141,7 @@ void SX_DIO_EXTI_IRQHandler(void)
     sx_dio_exti_isr_clearflag();
     irq_status = sx.GetAndClearIrqStatus(SX_IRQ_ALL);
     if (irq_status & SX_IRQ_RX_DONE) {
+        irq_rx_done_us = micros();
         if (bind.IsInBind()) {
             uint64_t bind_signature;
             sx.ReadBuffer(0, (uint8_t*)&bind_signature, 8);
@@ -157,6 +160,7 @@ void SX2_DIO_EXTI_IRQHandler(void)
     sx2_dio_exti_isr_clearflag();
     irq2_status = sx2.GetAndClearIrqStatus(SX2_IRQ_ALL);
     if (irq2_status & SX2_IRQ_RX_DONE) {
+        irq_rx_done_us = micros();
         if (bind.IsInBind()) {
             uint64_t bind_signature;
             sx2.ReadBuffer(0, (uint8_t*)&bind_signature, 8);
@@ -173,6 +177,7 @@ void SX2_DIO_EXTI_IRQHandler(void)
 
 uint8_t link_rx1_status;
 uint8_t link_rx2_status;
+bool frame_combined; // the frame of this period was recovered by combining the frames of both antennas
 
 
 //-- Tx/Rx cmd frame handling
@@ -180,6 +185,8 @@ uint8_t link_rx2_status;
 uint8_t link_task;
 uint8_t transmit_frame_type;
 bool doParamsStore;
+uint8_t rx_trace_mode; // the histogram which was asked for with GET_RX_TRACE
+uint8_t rx_trace_path;
 
 
 void link_task_init(void)
@@ -188,6 +195,7 @@ void link_task_init(void)
     transmit_frame_type = TRANSMIT_FRAME_TYPE_NORMAL;
 
     doParamsStore = false;
+    rx_trace_mode = rx_trace_path = 0;
 }
 
 
@@ -230,6 +238,23 @@ tCmdFrameHeader* head = (tCmdFrameHeader*)(frame->payload);
         // request to send setup data, trigger sending RX_SETUPDATA in next transmission
         link_task_set(LINK_TASK_RX_SEND_RX_SETUPDATA);
         break;
+    case FRAME_CMD_SWITCH_MODE: {
+        // switch mode in cnt frames, no response
+        uint8_t mode, cnt;
+        unpack_txcmdframe_switchmode(frame, &mode, &cnt);
+        rate_adapt.Schedule(mode, cnt);
+        }break;
+    case FRAME_CMD_FHSS_SWAP: {
+        // replace the channel of a fhss index in cnt frames, no response
+        uint8_t i, ch, cnt;
+        unpack_txcmdframe_fhssswap(frame, &i, &ch, &cnt);
+        fhss.ScheduleSwap(i, ch, cnt);
+        }break;
+    case FRAME_CMD_GET_RX_TRACE:
+        // request to send a latency histogram, trigger sending RX_TRACE in next transmission
+        unpack_txcmdframe_getrxtrace(frame, &rx_trace_mode, &rx_trace_path);
+        link_task_set(LINK_TASK_RX_SEND_RX_TRACE);
+        break;
     }
 }
 
@@ -241,30 +266,60 @@ void pack_rxcmdframe(tRxFrame* frame, tFrameStats* frame_stats)
         // send rx setup data
         pack_rxcmdframe_rxsetupdata(frame, frame_stats);
         break;
+    case LINK_TASK_RX_SEND_RX_TRACE:
+        // send latency histogram
+        pack_rxcmdframe_rxtrace(frame, frame_stats, rx_trace_mode, rx_trace_path);
+        break;
     }
 }
 
 
+//-- Rate adaption
+
+bool doRateAdaptSwitch;
+
+
+void rate_adapt_switch_mode(uint8_t mode)
+{
+    uint32_t toa_us = sx.TimeOverAir_us();
+
+    configure_mode(mode);
+    sxSetLoraConfigurationByIndex(Config.Sx.LoraConfigIndex);
+    tdiversity.Init(Config.frame_rate_ms);
+    latency_trace.SetMode(Config.Mode, Config.frame_rate_ms);
+
+    // the Tx sends the next frame one old period after the last, so it is received
+    // later or earlier by the change in time on air
+    int16_t shift_10us = ((int32_t)sx.TimeOverAir_us() - (int32_t)toa_us) / 10;
+    clock.SetPeriod(Config.frame_rate_ms, shift_10us);
+}
+
+
 //-- normal Tx, Rx frames handling
 
 void prepare_transmit_frame(uint8_t antenna, uint8_t ack)
 {
-uint8_t payload[FRAME_RX_PAYLOAD_LEN];
 uint8_t payload_len = 0;
 
     if (transmit_frame_type == TRANSMIT_FRAME_TYPE_NORMAL) {
 
         // read data from serial
         if (connected()) {
-            for (uint8_t i = 0; i < FRAME_RX_PAYLOAD_LEN; i++) {
-                if (!sx_serial.available()) break;
-                payload[payload_len] = sx_serial.getc();
-//dbg.putc(payload[payload_len]);
-                payload_len++;
-            }
+            if (arq.Pending()) {
+                // resend the payload which has not been acknowledged
+                payload_len = arq.GetPayload(rxFrame.payload);
+
+                stats.serial_data_retransmitted.Inc();
+            } else {
+                // read directly into the frame's payload
+                payload_len = sx_serial.getbuf(rxFrame.payload, FRAME_RX_PAYLOAD_LEN_USABLE);
+
+                if (payload_len) stats.transmit_seq_no++;
+                arq.PutPayload(rxFrame.payload, payload_len);
 
-            stats.bytes_transmitted.Add(payload_len);
-            stats.serial_data_transmitted.Inc();
+                stats.bytes_transmitted.Add(payload_len);
+                stats.serial_data_transmitted.Inc();
+            }
         } else {
             sx_serial.flush();
         }
@@ -280,9 +335,14 @@ uint8_t payload_len = 0;
     frame_stats.rssi = stats.GetLastRssi();
     frame_stats.LQ = rxstats.GetLQ();
     frame_stats.LQ_serial_data = rxstats.GetLQ_serial_data();
+    frame_stats.valid_received = (link_rx1_status > RX_STATUS_INVALID) || (link_rx2_status > RX_STATUS_INVALID);
+    if (Config.UseRcDelta) { // the Tx takes the frame as reference for the rc data, so it must have been decoded
+        frame_stats.valid_received = rc_coding.Ack();
+    }
+    frame_stats.downlink = slot_schedule.Request(sx_serial.bytes_available());
 
     if (transmit_frame_type == TRANSMIT_FRAME_TYPE_NORMAL) {
-        pack_rxframe(&rxFrame, &frame_stats, payload, payload_len);
+        pack_rxframe(&rxFrame, &frame_stats, rxFrame.payload, payload_len);
     } else {
         pack_rxcmdframe(&rxFrame, &frame_stats);
     }
@@ -304,7 +364,14 @@ void process_received_frame(bool do_payload, tTxFrame* frame)
         return;
     }
 
-    rcdata_from_txframe(&rcData, frame);
+    // a combined frame passed one of several crc checks, which is too weak for the rc data,
+    // the downlink slot announcement, and commands, as a wrong command can't be undone
+    if (frame_combined) {
+        if (frame->status.frame_type == FRAME_TYPE_TX_RX_CMD) return;
+    } else {
+        rcdata_from_txframe(&rcData, frame);
+        slot_schedule.SetAnnounced(frame->status.downlink);
+    }
 
     // handle cmd frame
     if (frame->status.frame_type == FRAME_TYPE_TX_RX_CMD) {
@@ -314,6 +381,12 @@ void process_received_frame(bool do_payload, tTxFrame* frame)
 
     link_task_reset(); // clear it if non-cmd frame is received
 
+    // drop it if it is a retransmission of a payload we already have
+    if (frame->status.payload_len && arq.IsDuplicate(frame->status.seq_no)) {
+        stats.serial_data_duplicates_received.Inc();
+        return;
+    }
+
     // output data on serial, but only if connected
     if (connected()) {
         for (uint8_t i = 0; i < frame->status.payload_len; i++) {
@@ -365,6 +438,8 @@ tTxFrame* frame;
         stats.received_ack = 0;
     }
 
+    arq.SetReceived(rx_status == RX_STATUS_VALID);
+
     // we set it for all received frames
     stats.last_antenna = antenna;
 
@@ -377,24 +452,27 @@ void handle_receive_none(void) // RX_STATUS_NONE
 {
     stats.received_seq_no = UINT8_MAX;
     stats.received_ack = 0;
+    arq.SetReceived(false);
 }
 
 
 void do_transmit(uint8_t antenna) // we send a frame to transmitter
 {
-uint8_t ack = 1;
-
     if (bind.IsInBind()) {
         bind.do_transmit(antenna);
         return;
     }
 
-    stats.transmit_seq_no++;
+    arq.SetEnabled(Setup.Rx.SerialArq == SERIAL_ARQ_ON);
+    arq.HandleAck(stats.received_ack);
+    stats.retransmit_cnt = arq.RetransmitCnt();
+    // in a downlink slot we did not receive, so we don't know if the Tx got our last frame
+    mavlink.FrameAck((slot_schedule.IsDownlink()) ? 0 : stats.received_ack);
 
-    prepare_transmit_frame(antenna, ack);
+    prepare_transmit_frame(antenna, arq.Ack());
 
     // to test asymmetric connection, fake rxFrame, to no send doesn't work as it blocks the sx
-    sxSendFrame(antenna, &rxFrame, FRAME_TX_RX_LEN, SEND_FRAME_TMO_MS); // 10ms tmo
+    sxSendFrame(antenna, &rxFrame, rxframe_len(&rxFrame), SEND_FRAME_TMO_MS); // 10ms tmo
 }
 
 
@@ -412,6 +490,14 @@ uint8_t rx_status = RX_STATUS_INVALID; // this also signals that a frame was rec
     sxReadFrame(antenna, &txFrame, &txFrame2, FRAME_TX_RX_LEN);
     res = (antenna == ANTENNA_1) ? check_txframe(&txFrame) : check_txframe(&txFrame2);
 
+    if (res != CHECK_OK && Config.UseFec) {
+        tTxFrame* frame = (antenna == ANTENNA_1) ? &txFrame : &txFrame2;
+        if (fec_decode_frame((uint8_t*)frame)) {
+            res = check_txframe(frame);
+            if (res == CHECK_OK) stats.frames_fec_corrected.Inc();
+        }
+    }
+
     if (res) {
         DBG_MAIN(dbg.puts("fail ");dbg.putc('\n');)
 dbg.puts("fail a");dbg.putc(antenna+'0');dbg.puts(" ");dbg.puts(u8toHEX_s(res));dbg.putc('\n');
@@ -423,7 +509,12 @@ dbg.puts("fail a");dbg.putc(antenna+'0');dbg.puts(" ");dbg.puts(u8toHEX_s(res));
 
     if (res == CHECK_OK || res == CHECK_ERROR_CRC) {
 
-        if (do_clock_reset) clock.Reset();
+        if (do_clock_reset) {
+            // a short frame is received earlier, shift so that the clock runs as for a full length frame
+            tTxFrame* frame = (antenna == ANTENNA_1) ? &txFrame : &txFrame2;
+            uint32_t toa_us = sx.TimeOverAir_us(txframe_len(frame));
+            clock.Reset(((int32_t)sx.TimeOverAir_us() - (int32_t)toa_us) / 10);
+        }
 
         rx_status = (res == CHECK_OK) ? RX_STATUS_VALID : RX_STATUS_CRC1_VALID;
     }
@@ -445,20 +536,61 @@ uint16_t tick_1hz;
 uint16_t tick_1hz_commensurate;
 
 uint8_t link_state;
-uint8_t connect_state;
-uint16_t connect_tmo_cnt;
-uint8_t connect_sync_cnt;
-uint8_t connect_listen_cnt;
-bool connect_occured_once;
 
 uint8_t doPostReceive2_cnt;
 bool doPostReceive2;
 bool frame_missed;
 
+uint8_t rcdata_out_early; // rx status of the frame with which the rc data of this period was output early, RX_STATUS_NONE if not
+bool rcdata_updated; // the rc data was updated by a frame of this period
+uint16_t rcdata_received_us; // when the frame with the rc data was received
+
 
 static inline bool connected(void)
 {
-  return (connect_state == CONNECT_STATE_CONNECTED);
+  return link_connect.Connected();
+}
+
+
+//-- rc data output
+
+// updated: rcData was received in this period and is output the first time
+void out_rcdata(bool missed, bool updated)
+{
+    out.SetChannelOrder(Setup.Rx.ChannelOrder);
+    out.SendRcData(&rcData, updated, missed, false, stats.GetLastRssi(), rxstats.GetLQ());
+    mavlink.SendRcData(out.GetRcDataPtr(), false);
+
+    if (updated) {
+        uint16_t age_us = micros() - rcdata_received_us;
+        stats.rcdata_age.Add(age_us);
+        latency_trace.RcOut(age_us);
+    }
+}
+
+
+// the rc data is output as soon as a frame with valid rc data was received, and not only after
+// doPostReceive, which saves ca 1 ms plus some loops, only the first such frame of a period is used
+// if it had only crc1 valid, a frame with all valid from the other antenna is output again
+// the output when no frame was received, or when disconnected, stays with doPostReceive2
+void out_rcdata_early(uint8_t antenna, uint8_t rx_status)
+{
+    if (bind.IsInBind() || !connected()) return;
+    if (rx_status <= RX_STATUS_INVALID) return; // RX_STATUS_CRC1_VALID, RX_STATUS_VALID
+    if (rx_status <= rcdata_out_early) return; // was output already, with at least as much valid
+
+    tTxFrame* frame = (antenna == ANTENNA_1) ? &txFrame : &txFrame2;
+    if (rx_status == RX_STATUS_VALID) {
+        rcdata_from_txframe(&rcData, frame);
+    } else {
+        rcdata_rc1_from_txframe(&rcData, frame);
+    }
+
+    bool first = (rcdata_out_early == RX_STATUS_NONE);
+    if (first) rcdata_received_us = irq_rx_done_us;
+    rcdata_updated = true;
+    out_rcdata(false, first);
+    rcdata_out_early = rx_status;
 }
 
 
@@ -492,18 +624,24 @@ RESTARTCONTROLLER:
   sx2.SetRfFrequency(fhss.GetCurrFreq());
 
   link_state = LINK_STATE_RECEIVE;
-  connect_state = CONNECT_STATE_LISTEN;
-  connect_tmo_cnt = 0;
-  connect_listen_cnt = 0;
-  connect_sync_cnt = 0;
-  connect_occured_once = false;
+  link_connect.Init();
   link_rx1_status = link_rx2_status = RX_STATUS_NONE;
   link_task_init();
   doPostReceive2_cnt = 0;
   doPostReceive2 = false;
   frame_missed = false;
+  rcdata_out_early = RX_STATUS_NONE;
+  frame_combined = false;
+  rcdata_updated = false;
+  rcdata_received_us = 0;
 
   rxstats.Init(Config.LQAveragingPeriod);
+  arq.Init();
+  rc_coding.Init();
+  latency_trace.Init(Config.Mode, Config.frame_rate_ms);
+  rate_adapt.Init(Config.UseRateAdapt, Config.Mode);
+  doRateAdaptSwitch = false;
+  slot_schedule.Init();
   rdiversity.Init();
   tdiversity.Init(Config.frame_rate_ms);
 
@@ -523,9 +661,7 @@ RESTARTCONTROLLER:
     if (doSysTask) {
         doSysTask = 0;
 
-        if (connect_tmo_cnt) {
-            connect_tmo_cnt--;
-        }
+        link_connect.Tick_ms();
 
         if (connected()) {
             DECc(led_blink, SYSTICK_DELAY_MS(500));
@@ -546,10 +682,17 @@ RESTARTCONTROLLER:
 
         DECc(tick_1hz, SYSTICK_DELAY_MS(1000));
 
-        if (!connect_occured_once) bind.AutoBind();
+        if (!link_connect.OccuredOnce()) bind.AutoBind();
 
         if (!tick_1hz) {
             dbg.puts(".");
+#if defined USE_FEATURE_MAVLINK_FILTER && defined MAVLINK_FILTER_RULES
+            // MAVLink filter, bytes/s forwarded, dropped, messages/s dropped
+            dbg.puts("\nflt: ");
+            dbg.puts(u16toBCD_s(stats.filter_bytes_forwarded.GetBytesPerSec())); dbg.putc(',');
+            dbg.puts(u16toBCD_s(stats.filter_bytes_dropped.GetBytesPerSec())); dbg.putc(',');
+            dbg.puts(u16toBCD_s(stats.filter_msgs_dropped.counts_per_sec)); dbg.puts("; ");
+#endif
 /*            dbg.puts("\nRX: ");
             dbg.puts(u8toBCD_s(rxstats.GetLQ())); dbg.putc(',');
             dbg.puts(u8toBCD_s(rxstats.GetLQ_serial_data()));
@@ -565,7 +708,10 @@ RESTARTCONTROLLER:
             dbg.puts(s8toBCD_s(stats.last_snr1)); dbg.puts("; ");
 
             dbg.puts(u16toBCD_s(stats.bytes_transmitted.GetBytesPerSec())); dbg.puts(", ");
-            dbg.puts(u16toBCD_s(stats.bytes_received.GetBytesPerSec())); dbg.puts("; "); */
+            dbg.puts(u16toBCD_s(stats.bytes_received.GetBytesPerSec())); dbg.puts("; ");
+
+            dbg.puts(u16toBCD_s(stats.rcdata_age.GetAvg_us())); dbg.putc(',');
+            dbg.puts(u16toBCD_s(stats.rcdata_age.GetJitter_us())); dbg.puts("; "); */
         }
     }
 
@@ -573,11 +719,19 @@ RESTARTCONTROLLER:
 
     switch (link_state) {
     case LINK_STATE_RECEIVE:
-        if (connect_state >= CONNECT_STATE_SYNC) { // we hop only if not in listen
+        if (doRateAdaptSwitch) { // must be done before we go into receive, but after the last response was sent
+            doRateAdaptSwitch = false;
+            rate_adapt_switch_mode(rate_adapt.Mode());
+        }
+        if (link_connect.IsSynced()) { // we hop only if not in listen
             fhss.HopToNext();
         }
         sx.SetRfFrequency(fhss.GetCurrFreq());
         sx2.SetRfFrequency(fhss.GetCurrFreq());
+        if (slot_schedule.Next(connected() && !bind.IsInBind())) { // downlink slot, so we transmit in place of the Tx
+            link_state = LINK_STATE_TRANSMIT_SLOT;
+            break;
+        }
         IF_ANTENNA1(sx.SetToRx(0)); // single without tmo
         IF_ANTENNA2(sx2.SetToRx(0));
         link_state = LINK_STATE_RECEIVE_WAIT;
@@ -591,6 +745,14 @@ RESTARTCONTROLLER:
         link_state = LINK_STATE_TRANSMIT_WAIT;
         irq_status = irq2_status = 0; // important, in low connection condition, RxDone isr could trigger
         break;
+
+    case LINK_STATE_TRANSMIT_SLOT:
+        // the Tx frame would start one time on air before the tick
+        if (clock.TimeToTick_10us() > sx.TimeOverAir_us() / 10) break;
+        do_transmit(tdiversity.Antenna());
+        link_state = LINK_STATE_TRANSMIT_SLOT_WAIT;
+        irq_status = irq2_status = 0;
+        break;
     }//end of switch(link_state)
 
 IF_SX(
@@ -598,16 +760,25 @@ IF_SX(
         if (link_state == LINK_STATE_TRANSMIT_WAIT) {
             if (irq_status & SX_IRQ_TX_DONE) {
                 irq_status = 0;
+                latency_trace.TransmitDone();
                 link_state = LINK_STATE_RECEIVE;
                 DBG_MAIN_SLIM(dbg.puts("1<");)
             }
         } else
+        if (link_state == LINK_STATE_TRANSMIT_SLOT_WAIT) {
+            if (irq_status & SX_IRQ_TX_DONE) {
+                irq_status = 0;
+                latency_trace.TransmitDone();
+                link_state = LINK_STATE_RECEIVE_WAIT; // the Tx does not transmit in this slot, so just wait for doPostReceive
+            }
+        } else
         if (link_state == LINK_STATE_RECEIVE_WAIT) {
             if (irq_status & SX_IRQ_RX_DONE) {
                 irq_status = 0;
                 bool do_clock_reset = (link_rx2_status == RX_STATUS_NONE);
                 link_rx1_status = do_receive(ANTENNA_1, do_clock_reset);
                 if (link_rx1_status == RX_STATUS_VALID) sx.HandleAFC();
+                out_rcdata_early(ANTENNA_1, link_rx1_status);
                 DBG_MAIN_SLIM(dbg.puts("1!");)
             }
         }
@@ -634,16 +805,25 @@ IF_SX2(
         if (link_state == LINK_STATE_TRANSMIT_WAIT) {
             if (irq2_status & SX2_IRQ_TX_DONE) {
                 irq2_status = 0;
+                latency_trace.TransmitDone();
                 link_state = LINK_STATE_RECEIVE;
                 DBG_MAIN_SLIM(dbg.puts("2<");)
             }
         } else
+        if (link_state == LINK_STATE_TRANSMIT_SLOT_WAIT) {
+            if (irq2_status & SX2_IRQ_TX_DONE) {
+                irq2_status = 0;
+                latency_trace.TransmitDone();
+                link_state = LINK_STATE_RECEIVE_WAIT; // the Tx does not transmit in this slot, so just wait for doPostReceive
+            }
+        } else
         if (link_state == LINK_STATE_RECEIVE_WAIT) {
             if (irq2_status & SX2_IRQ_RX_DONE) {
                 irq2_status = 0;
                 bool do_clock_reset = (link_rx1_status == RX_STATUS_NONE);
                 link_rx2_status = do_receive(ANTENNA_2, do_clock_reset);
                 if (link_rx2_status == RX_STATUS_VALID) sx2.HandleAFC();
+                out_rcdata_early(ANTENNA_2, link_rx2_status);
                 DBG_MAIN_SLIM(dbg.puts("2!");)
             }
         }
@@ -674,6 +854,17 @@ IF_SX2(
 
         bool frame_received, valid_frame_received, invalid_frame_received;
         if (USE_ANTENNA1 && USE_ANTENNA2) {
+            // both frames are corrupted, try to recover one by combining them
+            // a recovered frame is attributed to antenna 1
+            frame_combined = false;
+            if ((link_rx1_status == RX_STATUS_INVALID || link_rx1_status == RX_STATUS_CRC1_VALID) &&
+                (link_rx2_status == RX_STATUS_INVALID || link_rx2_status == RX_STATUS_CRC1_VALID) && !bind.IsInBind()) {
+                if (combine_txframes(&txFrame, &txFrame2)) {
+                    link_rx1_status = RX_STATUS_VALID;
+                    frame_combined = true;
+                    stats.frames_combined.Inc();
+                }
+            }
             frame_received = (link_rx1_status > RX_STATUS_NONE) || (link_rx2_status > RX_STATUS_NONE);
             valid_frame_received = (link_rx1_status > RX_STATUS_INVALID) || (link_rx2_status > RX_STATUS_INVALID);
             invalid_frame_received = frame_received && !valid_frame_received;
@@ -687,6 +878,9 @@ IF_SX2(
             invalid_frame_received = (link_rx1_status == RX_STATUS_INVALID); // frame_received && !valid_frame_received;
         }
 
+        // in a downlink slot the Tx did not transmit, so nothing was to be expected
+        bool downlink_slot = slot_schedule.IsDownlink();
+
 /*dbg.puts("\n> 1: ");
 dbg.puts(s8toBCD_s(stats.last_rssi1));
 dbg.puts(" 2: ");
@@ -714,58 +908,48 @@ dbg.puts(s8toBCD_s(stats.last_rssi2));*/
         }
 
         // serial data is received if !IsInBind() && RX_STATUS_VALID && !FRAME_TYPE_TX_RX_CMD && connected()
-        if (!valid_frame_received) {
+        if (!valid_frame_received && !downlink_slot) {
             mavlink.FrameLost();
         }
 
         if (valid_frame_received) { // valid frame received
-            switch (connect_state) {
-            case CONNECT_STATE_LISTEN:
-                connect_state = CONNECT_STATE_SYNC;
-                connect_sync_cnt = 0;
-                break;
-            case CONNECT_STATE_SYNC:
-                connect_sync_cnt++;
-                if (connect_sync_cnt >= CONNECT_SYNC_CNT) {
-                    connect_state = CONNECT_STATE_CONNECTED;
-                    connect_occured_once = true;
-                }
-                break;
-            }
-            connect_tmo_cnt = CONNECT_TMO_SYSTICKS;
-
+            link_connect.ValidFrame();
             link_state = LINK_STATE_TRANSMIT; // switch to TX
         }
 
         // when in listen: we received something, but something wrong, so we need go back to RX
-        if ((connect_state == CONNECT_STATE_LISTEN) && invalid_frame_received) {
+        if (link_connect.IsInListen() && invalid_frame_received) {
             link_state = LINK_STATE_RECEIVE;
         }
 
         // when in listen, slowly loop through frequencies
-        if (connect_state == CONNECT_STATE_LISTEN) {
-            connect_listen_cnt++;
-            if (connect_listen_cnt >= CONNECT_LISTEN_HOP_CNT) {
+        if (link_connect.IsInListen()) {
+            if (link_connect.ListenHop()) {
                 fhss.HopToNext();
-                connect_listen_cnt = 0;
                 link_state = LINK_STATE_RECEIVE; // switch back to RX
             }
             if (fhss.HopToNextBind()) { link_state = LINK_STATE_RECEIVE; } // switch back to RX
         }
 
         // we just disconnected, or are in sync but don't receive anything
-        if ((connect_state >= CONNECT_STATE_SYNC) && !connect_tmo_cnt) {
+        if (link_connect.IsSynced() && link_connect.TimedOut()) {
             // switch to listen state
             // only do it if not in listen, since otherwise it never could reach receive wait and hence never could connect
-            connect_state = CONNECT_STATE_LISTEN;
-            connect_listen_cnt = 0;
+            link_connect.Listen();
             link_state = LINK_STATE_RECEIVE; // switch back to RX
         }
 
+        // the rc data of a frame which was not output early goes out with doPostReceive2
+        // a combined frame provides no rc data, so it is output as missed, unless crc1 was valid for a copy
+        if (valid_frame_received && !frame_combined && rcdata_out_early == RX_STATUS_NONE) {
+            rcdata_updated = true;
+            rcdata_received_us = irq_rx_done_us;
+        }
+
         // we didn't receive a valid frame
         frame_missed = false;
-        if ((connect_state >= CONNECT_STATE_SYNC) && !valid_frame_received) {
-            frame_missed = true;
+        if (link_connect.IsSynced() && !valid_frame_received) {
+            frame_missed = !downlink_slot;
             // reset sync counter, relevant if in sync
             // connect_sync_cnt = 0; // NO!! when in sync this means that we need to get five in a row, right!?!
             // switch to transmit state
@@ -773,27 +957,60 @@ dbg.puts(s8toBCD_s(stats.last_rssi2));*/
             // we are on the correct frequency, so no need to hop
             link_state = LINK_STATE_TRANSMIT;
         }
+        if (link_connect.IsSynced() && frame_combined) {
+            frame_missed = !downlink_slot;
+        }
 
-        if ((connect_state >= CONNECT_STATE_SYNC) ||
+        if (link_connect.IsSynced() ||
             (link_state == LINK_STATE_RECEIVE) || (link_state == LINK_STATE_TRANSMIT)) {
             sx.SetToIdle();
             sx2.SetToIdle();
         }
 
+        // rate adaption, when not connected go back to home mode, this is where the Tx looks for us
+        if (!connected()) {
+            if (!rate_adapt.IsHome()) rate_adapt_switch_mode(rate_adapt.HomeMode());
+            rate_adapt.Reset();
+            doRateAdaptSwitch = false;
+        } else
+        if (rate_adapt.Tick()) { // the switch is due, the next frame comes in the new mode
+            doRateAdaptSwitch = true;
+        }
+
+        // fhss adaption, when not connected go back to the original hop list, this is what the Tx uses
+        if (!connected() && !bind.IsInBind()) {
+            if (fhss.IsModified()) fhss.Init(&Config.Fhss);
+            fhss.CancelSwap();
+        } else {
+            if (connected() && !bind.IsInBind() && !downlink_slot) {
+                // we have not hopped yet, so this is for the channel of this slot
+                fhss.ChannelStatsUpdate(frame_received, valid_frame_received, true, stats.GetLastRssi(), stats.GetLastSnr());
+            }
+            fhss.TickSwap(); // the next frame comes with the new channel if the swap is due
+        }
+
+        // slot schedule, count the slots of this period
+        if (connected()) {
+            stats.downlink_slots.Inc();
+            if (downlink_slot) stats.downlink_slots.Inc(); else stats.uplink_slots.Inc();
+        } else {
+            slot_schedule.Reset();
+        }
+
         DECc(tick_1hz_commensurate, Config.frame_rate_hz);
         if (!tick_1hz_commensurate) {
             rxstats.Update1Hz();
         }
-        rxstats.Next();
+        if (downlink_slot) rxstats.Skip(); else rxstats.Next();
         if (!connected()) rxstats.Clear();
 
-        if (connect_state == CONNECT_STATE_LISTEN) {
+        if (link_connect.IsInListen()) {
             link_task_reset();
             link_task_set(LINK_TASK_RX_SEND_RX_SETUPDATA);
         }
 
-        if (Setup.Rx.Buzzer == BUZZER_LOST_PACKETS && connect_occured_once && !bind.IsInBind()) {
-            if (!valid_frame_received) buzzer.BeepLP();
+        if (Setup.Rx.Buzzer == BUZZER_LOST_PACKETS && link_connect.OccuredOnce() && !bind.IsInBind()) {
+            if (!valid_frame_received && !downlink_slot) buzzer.BeepLP();
         }
 
         powerup.Do();
@@ -802,13 +1019,15 @@ dbg.puts(s8toBCD_s(stats.last_rssi2));*/
         bind.Do();
         switch (bind.Task()) {
         case BIND_TASK_CHANGED_TO_BIND:
+            rate_adapt.Reset(); // bind sets its own mode
+            doRateAdaptSwitch = false;
             bind.ConfigForBind();
             CLOCK_PERIOD_10US = ((uint16_t)Config.frame_rate_ms * 100);
             clock.Reset();
             fhss.SetToBind(Config.frame_rate_ms);
             LED_GREEN_ON;
             LED_RED_OFF;
-            connect_state = CONNECT_STATE_LISTEN;
+            link_connect.Listen();
             link_state = LINK_STATE_RECEIVE;
             break;
         case BIND_TASK_RX_STORE_PARAMS:
@@ -831,19 +1050,21 @@ dbg.puts(s8toBCD_s(stats.last_rssi2));*/
     if (doPostReceive2) {
         doPostReceive2 = false;
 
-        out.SetChannelOrder(Setup.Rx.ChannelOrder);
         if (connected()) {
-            out.SendRcData(&rcData, frame_missed, false, stats.GetLastRssi(), rxstats.GetLQ());
+            if (rcdata_out_early == RX_STATUS_NONE) out_rcdata(frame_missed, rcdata_updated);
             out.SendLinkStatistics();
-            mavlink.SendRcData(out.GetRcDataPtr(), false);
         } else {
-            if (connect_occured_once) {
+            if (link_connect.OccuredOnce()) {
                 // generally output a signal only if we had a connection at least once
-                out.SendRcData(&rcData, true, true, RSSI_MIN, 0);
+                out.SetChannelOrder(Setup.Rx.ChannelOrder);
+                out.SendRcData(&rcData, false, true, true, RSSI_MIN, 0);
                 out.SendLinkStatisticsDisconnected();
                 mavlink.SendRcData(out.GetRcDataPtr(), true);
             }
         }
+
+        rcdata_out_early = RX_STATUS_NONE;
+        rcdata_updated = false;
     }//end of if(doPostReceive2)
 
     out.Do();
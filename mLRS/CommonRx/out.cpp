@@ -34,6 +34,14 @@ void OutBase::Init(tRxSetup* _setup)
 
     rc = {};
 
+    rate_period_us = 0;
+    rate_valid = false;
+    rate_fresh = false;
+    rate_tlast_us = 0;
+    rate_tsample_us = 0;
+    rate_frame_period_us = 0;
+    rate_rc = {};
+
     setup = _setup;
 }
 
@@ -83,6 +91,7 @@ void OutBase::Do(void)
         // nothing to do
         break;
     case OUT_CONFIG_CRSF:
+        do_rate();
         do_crsf();
         break;
     }
@@ -95,7 +104,8 @@ void OutBase::SetChannelOrder(uint8_t new_channel_order)
 }
 
 
-void OutBase::SendRcData(tRcData* rc_orig, bool frame_lost, bool failsafe, int8_t rssi, uint8_t lq)
+// updated: rc_orig holds newly received rc data, and it is the first output of it in this frame period
+void OutBase::SendRcData(tRcData* rc_orig, bool updated, bool frame_lost, bool failsafe, int8_t rssi, uint8_t lq)
 {
     memcpy(&rc, rc_orig, sizeof(tRcData)); // copy rc data, to not modify it !!
     channel_order.Apply(&rc);
@@ -106,6 +116,8 @@ void OutBase::SendRcData(tRcData* rc_orig, bool frame_lost, bool failsafe, int8_
         switch (failsafe_mode) {
         case FAILSAFE_MODE_NO_SIGNAL:
             // do not output anything, so jump out
+            rate_valid = false;
+            rate_fresh = false;
             return;
         case FAILSAFE_MODE_LOW_THROTTLE:
             // is done below
@@ -163,7 +175,25 @@ void OutBase::SendRcData(tRcData* rc_orig, bool frame_lost, bool failsafe, int8_
         send_sbus_rcdata(&rc, frame_lost, failsafe);
         break;
     case OUT_CONFIG_CRSF:
-        send_crsf_rcdata(&rc);
+        switch (setup->OutRate) {
+        case OUT_RATE_150HZ: rate_period_us = 6667; break;
+        case OUT_RATE_250HZ: rate_period_us = 4000; break;
+        default: rate_period_us = 0;
+        }
+        if (rate_period_us) {
+            if (frame_lost || failsafe) {
+                rate_update(false);
+            } else
+            if (updated) {
+                rate_update(true);
+            } else {
+                rate_repeat();
+            }
+            send_crsf_rcdata(&rate_rc);
+            rate_tlast_us = micros(); // the next goes out one output period later
+        } else {
+            send_crsf_rcdata(&rc);
+        }
         break;
     }
 }
@@ -355,6 +385,119 @@ void OutBase::do_crsf(void)
 }
 
 
+//-------------------------------------------------------
+// High Rate Output
+//-------------------------------------------------------
+// The channels are output with a fixed rate, which is higher than the frame rate, and
+// smoothed in between frames. It is done only for CRSF, SBus is too slow for this. Only
+// the stick channels are smoothed, the others, like switches, are just repeated.
+// hold:   repeats the last received values, adds no latency
+// interp: ramps from the values which were output when the frame was received to the
+//         received values within one frame period, adds one frame period of latency
+// extrap: continues with the change from the previous to the last frame, for at most
+//         one frame period and OUT_EXTRAPOLATE_MAX_US, this predicts the values and
+//         saves up to one frame period of latency, but overshoots when the sticks stop
+// When a frame is missed, or in failsafe, the received values are held.
+
+// called for each rc data, rc is what would be output with the frame rate
+void OutBase::rate_update(bool fresh)
+{
+    uint16_t tnow_us = micros();
+
+    if (!fresh) {
+        memcpy(&rate_rc, &rc, sizeof(tRcData));
+        rate_fresh = false;
+        rate_valid = true;
+        return;
+    }
+
+    rate_calc(); // rate_rc is now what was output at this time
+
+    // the period can be measured only if the previous was fresh, this also ensures that
+    // the uint16_t us difference does not roll over
+    rate_frame_period_us = (rate_fresh) ? tnow_us - rate_tsample_us : 0;
+
+    uint8_t smoothing = setup->OutSmoothing;
+    for (uint8_t n = 0; n < OUT_RATE_CHANNEL_NUM; n++) {
+        switch (smoothing) {
+        case OUT_SMOOTHING_INTERPOLATE:
+            rate_base[n] = (rate_fresh) ? rate_rc.ch[n] : rc.ch[n];
+            rate_delta[n] = (int16_t)rc.ch[n] - rate_base[n];
+            break;
+        case OUT_SMOOTHING_EXTRAPOLATE:
+            rate_delta[n] = (rate_fresh) ? (int16_t)rc.ch[n] - rate_base[n] : 0; // rate_base holds the previous
+            rate_base[n] = rc.ch[n];
+            break;
+        default:
+            rate_base[n] = rc.ch[n];
+            rate_delta[n] = 0;
+        }
+    }
+
+    memcpy(&rate_rc, &rc, sizeof(tRcData));
+    rate_tsample_us = tnow_us;
+    rate_fresh = true;
+    rate_valid = true;
+
+    rate_calc();
+}
+
+
+// called when the rc data of this frame period is output again, e.g. with all channels after
+// a crc1 valid frame, or with unchanged rc data in a downlink slot, this must not start a new
+// sample, as the stick channels are the same, only the other channels are taken
+void OutBase::rate_repeat(void)
+{
+    if (!rate_fresh) {
+        rate_update(false);
+        return;
+    }
+
+    for (uint8_t n = OUT_RATE_CHANNEL_NUM; n < RC_DATA_LEN; n++) rate_rc.ch[n] = rc.ch[n];
+}
+
+
+void OutBase::rate_calc(void)
+{
+    if (!rate_fresh) return; // is held
+
+    uint16_t dt_us = micros() - rate_tsample_us;
+    uint16_t period_us = rate_frame_period_us;
+
+    if (setup->OutSmoothing == OUT_SMOOTHING_EXTRAPOLATE) {
+        if (period_us > OUT_EXTRAPOLATE_MAX_US) period_us = OUT_EXTRAPOLATE_MAX_US;
+        if (dt_us > period_us) dt_us = period_us; // stop at the bound
+        period_us = rate_frame_period_us;
+    } else {
+        if (dt_us > period_us) dt_us = period_us;
+    }
+
+    for (uint8_t n = 0; n < OUT_RATE_CHANNEL_NUM; n++) {
+        int32_t v = rate_base[n];
+        if (period_us) v += ((int32_t)rate_delta[n] * dt_us) / period_us; else v += rate_delta[n];
+        if (v < 0) v = 0;
+        if (v > 2047) v = 2047;
+        rate_rc.ch[n] = v;
+    }
+}
+
+
+void OutBase::do_rate(void)
+{
+    if (!rate_period_us || !rate_valid) return;
+
+    uint16_t dt_us = micros() - rate_tlast_us;
+    if (dt_us < rate_period_us) return;
+
+    // keep the rate steady, but don't try to catch up if we are late
+    rate_tlast_us += rate_period_us;
+    if (dt_us >= 2 * rate_period_us) rate_tlast_us = micros();
+
+    rate_calc();
+    send_crsf_rcdata(&rate_rc);
+}
+
+
 //-------------------------------------------------------
 // FPort
 //-------------------------------------------------------
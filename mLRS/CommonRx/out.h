@@ -22,6 +22,13 @@
 // Generic Out Class
 //-------------------------------------------------------
 
+#ifndef OUT_EXTRAPOLATE_MAX_US
+#define OUT_EXTRAPOLATE_MAX_US  30000 // extrapolation goes at most this far, and at most one frame period
+#endif
+
+#define OUT_RATE_CHANNEL_NUM    4 // only the stick channels are interpolated/extrapolated
+
+
 typedef struct
 {
     int8_t receiver_rssi1;
@@ -52,7 +59,7 @@ class OutBase
 
     void Do(void);
 
-    void SendRcData(tRcData* rc, bool frame_lost, bool failsafe, int8_t rssi, uint8_t lq);
+    void SendRcData(tRcData* rc, bool updated, bool frame_lost, bool failsafe, int8_t rssi, uint8_t lq);
     void SendLinkStatistics(tOutLinkStats* lstats);
     void SendLinkStatisticsDisconnected(void);
 
@@ -66,6 +73,11 @@ class OutBase
     void send_crsf_linkstatistics(tOutLinkStats* lstats);
     void do_crsf(void);
 
+    void rate_update(bool fresh);
+    void rate_repeat(void);
+    void rate_calc(void);
+    void do_rate(void);
+
     void putbuf(uint8_t* buf, uint16_t len);
 
     virtual void putc(char c) {}
@@ -84,6 +96,16 @@ class OutBase
     tOutLinkStats link_stats;
 
     tRcData rc;
+
+    uint16_t rate_period_us; // 0 if output with the frame rate
+    bool rate_valid; // rate_rc can be output
+    bool rate_fresh; // rate_rc follows the received rc data, false if held
+    uint16_t rate_tlast_us;
+    uint16_t rate_tsample_us; // when the last fresh rc data was received
+    uint16_t rate_frame_period_us; // measured, 0 if not known
+    int16_t rate_base[OUT_RATE_CHANNEL_NUM];
+    int16_t rate_delta[OUT_RATE_CHANNEL_NUM]; // change within one frame period
+    tRcData rate_rc; // the rc data which is output
 };
 
 
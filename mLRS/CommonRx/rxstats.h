@@ -24,6 +24,7 @@ class RxStatsBase
 
     void Update1Hz(void); // called at 1 Hz
     void Next(void); // called at each cycle
+    void Skip(void); // called instead of Next() for cycles in which no frame was to be expected
     void Clear(void); // called then not connected
 
     void doFrameReceived(void);
@@ -64,9 +65,20 @@ void RxStatsBase::Next(void) // this is called when transmit starts, or shortly
 }
 
 
+// the Tx did not transmit, e.g. in a downlink slot, so the cycle is not counted
+void RxStatsBase::Skip(void)
+{
+    stats.frames_received.Skip();
+    stats.valid_crc1_received.Skip();
+    stats.valid_frames_received.Skip();
+    stats.serial_data_received.Skip();
+}
+
+
 void RxStatsBase::Clear(void)
 {
     stats.Clear();
+    arq.Clear();
 
     LQma_valid_crc1.Reset(); // start with 100% if not connected
     LQma_valid.Reset();
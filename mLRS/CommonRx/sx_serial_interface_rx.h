@@ -36,6 +36,22 @@ class tRxSxSerial : public tSerialBase
           return serial.getc(); // get from serial
       }
 
+      virtual uint16_t getbuf(void* buf, uint16_t len)
+      {
+          if (SERIAL_LINK_MODE_IS_MAVLINK(Setup.Rx.SerialLinkMode)) {
+              return mavlink.getbuf((uint8_t*)buf, len); // get from serial via mavlink parser
+          }
+          return serial.getbuf(buf, len); // get from serial
+      }
+
+      virtual uint16_t bytes_available(void)
+      {
+          if (SERIAL_LINK_MODE_IS_MAVLINK(Setup.Rx.SerialLinkMode)) {
+              return mavlink.bytes_available(); // waiting in serial and mavlink handler
+          }
+          return serial.bytes_available();
+      }
+
       virtual void flush(void)
       {
           mavlink.flush(); // we don't distinguish here, can't harm to always flush mavlink handler
@@ -279,6 +279,7 @@ typedef enum {
     CLI_TASK_BOOT,
     CLI_TASK_FLASH_ESP,
     CLI_TASK_CHANGE_CONFIG_ID,
+    CLI_TASK_RX_TRACE,
 } CLI_TASK_ENUM;
 
 
@@ -295,6 +296,7 @@ class tTxCli
     typedef enum {
         CLI_STATE_NORMAL = 0,
         CLI_STATE_STATS,
+        CLI_STATE_TRACE,
     } CLI_STATE_ENUM;
 
     void addc(uint8_t c);
@@ -305,6 +307,8 @@ class tTxCli
     void print_param_opt_list(uint8_t idx);
     void print_device_version(void);
     void stream(void);
+    void print_trace(uint8_t path);
+    void print_ms(uint32_t t_us);
 
     bool is_cmd(const char* cmd);
     bool is_cmd_param_set(char* name, char* svalue);
@@ -329,6 +333,7 @@ class tTxCli
     int32_t task_value;
 
     uint8_t state;
+    uint8_t trace_path;
 };
 
 
@@ -346,6 +351,7 @@ void tTxCli::Init(tSerialBase* _com)
     task_pending = CLI_TASK_NONE;
 
     state = CLI_STATE_NORMAL;
+    trace_path = LATENCY_TRACE_RC;
 }
 
 
@@ -592,12 +598,102 @@ void tTxCli::stream(void)
             puts(u16toBCD_s(stats.bytes_transmitted.GetBytesPerSec()));
             puts(", ");
             puts(u16toBCD_s(stats.bytes_received.GetBytesPerSec()));
+            puts("; ");
+
+            // max latency of the MAVLink queue, high, telemetry, bulk
+            puts(u16toBCD_s(stats.mavlink_latency[0].GetMax_ms()));
+            puts(",");
+            puts(u16toBCD_s(stats.mavlink_latency[1].GetMax_ms()));
+            puts(",");
+            puts(u16toBCD_s(stats.mavlink_latency[2].GetMax_ms()));
+            puts("; ");
+
+            // slots per second, up, down
+            puts(u16toBCD_s(stats.uplink_slots.counts_per_sec));
+            puts(",");
+            puts(u16toBCD_s(stats.downlink_slots.counts_per_sec));
+            puts("; ");
+
+            // age of the rc data in us, average, jitter
+            puts(u16toBCD_s(stats.rcdata_age.GetAvg_us()));
+            puts(",");
+            puts(u16toBCD_s(stats.rcdata_age.GetJitter_us()));
             putsn(";");
         }
+    } else
+    if (state == CLI_STATE_TRACE) {
+        if (tnow_ms - tlast_ms >= 1000) {
+            tlast_ms = tnow_ms;
+
+            // the Rx histogram of this path was asked for a second ago, ask now for the other
+            print_trace(trace_path);
+            trace_path = (trace_path == LATENCY_TRACE_RC) ? LATENCY_TRACE_SERIAL : LATENCY_TRACE_RC;
+            task_pending = CLI_TASK_RX_TRACE;
+            task_value = trace_path;
+        }
     }
 }
 
 
+// ms with one decimal
+void tTxCli::print_ms(uint32_t t_us)
+{
+    uint32_t t = (t_us + 50) / 100;
+    if (t > 655359) t = 655359;
+    puts(u16toBCD_s(t / 10));
+    putc('.');
+    putc('0' + t % 10);
+}
+
+
+// end-to-end latency of the current mode, average and percentiles in ms, sample counts of Tx and Rx,
+// followed by the histogram in 1/1000 of the samples, the last bin collects all above
+void tTxCli::print_trace(uint8_t path)
+{
+char s[16];
+uint8_t param_idx;
+tLatencyConvolution conv;
+
+    uint8_t mode = latency_trace.Mode();
+    tLatencyHistogram* tx_hist = latency_trace.Get(mode, path);
+
+    puts((path == LATENCY_TRACE_RC) ? "  rc " : "  ser ");
+    if (param_get_idx(&param_idx, (char*)"MODE") && _param_get_listval_fromoptstr(s, param_idx, mode, PARAM_FORMAT_CLI)) {
+        puts(s);
+    }
+    puts(": ");
+
+    if (!connected() || !latency_trace.rx_hist_available ||
+        latency_trace.rx_hist_mode != mode || latency_trace.rx_hist_path != path ||
+        latency_trace.rx_hist.bin_us != tx_hist->bin_us) {
+        putsn("no rx data");
+        return;
+    }
+
+    conv.Do(tx_hist, &(latency_trace.rx_hist));
+    if (!conv.total) {
+        putsn("no data");
+        return;
+    }
+
+    print_ms(conv.avg_us); puts(", ");
+    print_ms(conv.Percentile_us(50)); puts(",");
+    print_ms(conv.Percentile_us(90)); puts(",");
+    print_ms(conv.Percentile_us(99)); puts(" ms; ");
+    uint32_t tx_total = tx_hist->Total();
+    uint32_t rx_total = latency_trace.rx_hist.Total();
+    puts(u16toBCD_s((tx_total < UINT16_MAX) ? tx_total : UINT16_MAX)); puts(",");
+    puts(u16toBCD_s((rx_total < UINT16_MAX) ? rx_total : UINT16_MAX)); putsn(";");
+
+    puts("    "); print_ms(conv.bin_us); puts(" ms: ");
+    for (uint8_t k = 0; k < LATENCY_TRACE_BIN_NUM; k++) {
+        puts(u16toBCD_s(conv.PerMille(k, LATENCY_TRACE_BIN_NUM)));
+        puts((k < LATENCY_TRACE_BIN_NUM - 1) ? "," : ";");
+    }
+    putsn("");
+}
+
+
 void tTxCli::print_device_version(void)
 {
     putsn("  Tx: " DEVICE_NAME ", " VERSIONONLYSTR);
@@ -636,6 +732,7 @@ void tTxCli::print_help(void)
     putsn("  bind        -> start binding");
     putsn("  reload      -> reload all parameter settings");
     putsn("  stats       -> starts streaming statistics");
+    putsn("  trace       -> starts streaming latency histograms");
     delay_ms(10);
 
     putsn("  ptser       -> enter serial passthrough");
@@ -718,7 +815,12 @@ bool rx_param_changed;
     if (pos && (tnow_ms - tlast_ms > 2000)) { putsn(">"); putsn("  timeout"); clear(); }
 
     if (state != CLI_STATE_NORMAL) {
-        if (com->available()) { com->getc(); state = CLI_STATE_NORMAL; putsn("  streaming stats stopped"); return; }
+        if (com->available()) {
+            com->getc();
+            putsn((state == CLI_STATE_TRACE) ? "  streaming trace stopped" : "  streaming stats stopped");
+            state = CLI_STATE_NORMAL;
+            return;
+        }
         stream();
     }
 
@@ -807,6 +909,16 @@ bool rx_param_changed;
             putsn("  starts streaming stats");
             putsn("  send any character to stop");
 
+        } else
+        if (is_cmd("trace")) {
+            state = CLI_STATE_TRACE;
+            tlast_ms = tnow_ms;
+            trace_path = LATENCY_TRACE_RC;
+            task_pending = CLI_TASK_RX_TRACE;
+            task_value = trace_path;
+            putsn("  starts streaming latency histograms");
+            putsn("  send any character to stop");
+
         //-- System Bootloader
         } else
         if (is_cmd("systemboot")) {
@@ -34,6 +34,7 @@ typedef enum {
     TXCRSF_SEND_LINK_STATISTICS_TX,
     TXCRSF_SEND_LINK_STATISTICS_RX,
     TXCRSF_SEND_TELEMETRY_FRAME, // native or passthrough telemetry frame
+    TXCRSF_SEND_TIMING_CORRECTION,
 } TXCRSF_SEND_ENUM;
 
 
@@ -49,6 +50,8 @@ class tTxCrsf : public tPin5BridgeBase
     void Init(bool enable_flag);
     bool ChannelsUpdated(tRcData* rc);
     bool TelemetryUpdate(uint8_t* task, uint16_t frame_rate_ms);
+    void FrameStart(uint16_t frame_rate_ms);
+    bool GetRcDataAge_us(uint16_t* age_us);
 
     bool CommandReceived(uint8_t* cmd);
     uint8_t* GetCmdDataPtr(void);
@@ -65,6 +68,7 @@ class tTxCrsf : public tPin5BridgeBase
     void SendTelemetryFrame(void);
 
     void SendMBridgeFrame(void* payload, const uint8_t payload_len);
+    void SendTimingCorrection(void);
 
     // helper
     uint8_t crc8(const uint8_t* buf);
@@ -78,6 +82,7 @@ class tTxCrsf : public tPin5BridgeBase
 
     uint8_t frame[CRSF_FRAME_LEN_MAX + 16];
     volatile bool channels_received;
+    volatile uint16_t channels_received_us; // when the last channels frame was completely received
     volatile bool cmd_received;
     volatile bool cmd_modelid_received; // we handle it extra just to really catch it, could do also cmd fifo
     volatile uint8_t cmd_modelid_value;
@@ -86,6 +91,17 @@ class tTxCrsf : public tPin5BridgeBase
     uint8_t tx_frame[CRSF_FRAME_LEN_MAX + 16];
     volatile uint8_t tx_available; // this signals if something needs to be send to radio
 
+    // timing correction
+
+    uint16_t channels_applied_us; // when the channels frame which is in the rc data was received
+    bool channels_applied; // a channels frame was put into the rc data since the last frame start
+    bool rcdata_age_valid;
+    uint16_t rcdata_age_us;
+    uint32_t timing_interval; // in 0.1 us
+    int32_t timing_offset_us;
+    bool timing_correction_due;
+    uint32_t timing_correction_tlast_ms;
+
     // crsf telemetry
 
     tCrsfFlightMode flightmode; // collected from HEARTBEAT
@@ -212,6 +228,7 @@ void tTxCrsf::parse_nextchar(uint8_t c)
         // this is called in isr, so we want to do crc check later, if we want to do it all
         if (frame[2] == CRSF_FRAME_ID_CHANNELS) { // frame_id
             channels_received = true;
+            channels_received_us = tnow_us;
         } else
         if (frame[0] == CRSF_OPENTX_SYNC && frame[2] == CRSF_FRAME_ID_COMMAND &&
             frame[5] == CRSF_COMMAND_ID && frame[6] == CRSF_COMMAND_MODEL_SELECT_ID) {
@@ -279,9 +296,19 @@ void tTxCrsf::Init(bool enable_flag)
     tx_available = 0;
     tx_free = false;
     channels_received = false;
+    channels_received_us = 0;
     cmd_received = false;
     cmd_modelid_received = false;
 
+    channels_applied_us = 0;
+    channels_applied = false;
+    rcdata_age_valid = false;
+    rcdata_age_us = 0;
+    timing_interval = 0;
+    timing_offset_us = 0;
+    timing_correction_due = false;
+    timing_correction_tlast_ms = 0;
+
     flightmode_updated = false;
     flightmode_send_tlast_ms = 0;
     battery_updated = false;
@@ -323,6 +350,8 @@ bool tTxCrsf::ChannelsUpdated(tRcData* rc)
     if (crc != frame[frame[1] + 1]) return false;
 
     fill_rcdata(rc);
+    channels_applied_us = channels_received_us;
+    channels_applied = true;
     return true;
 }
 
@@ -351,6 +380,13 @@ bool tTxCrsf::TelemetryUpdate(uint8_t* task, uint16_t frame_rate_ms)
         }
     }
 
+    // timing correction goes out when due, it doesn't take a slot of the telemetry sequence
+    if (timing_correction_due) {
+        timing_correction_due = false;
+        *task = TXCRSF_SEND_TIMING_CORRECTION;
+        return true;
+    }
+
     // next slot
     uint8_t curr_telemetry_state = telemetry_state;
     telemetry_state++;
@@ -920,6 +956,76 @@ void crsf_send_LinkStatistics(void) {}
 void crsf_send_LinkStatisticsTx(void) {}
 void crsf_send_LinkStatisticsRx(void) {}
 
+//-------------------------------------------------------
+// CRSF Timing Correction
+// The radio sends the channels frames at its own pace, so without correction the rc data
+// which goes out in a frame has a random age of up to a channels frame period. We ask the
+// radio to send them with a period which is commensurate with our frame period, and to
+// shift them so that a channels frame arrives just before a frame is transmitted. This is
+// the timing correction frame of EdgeTX/OpenTX, a radio which doesn't know it ignores it.
+
+#define CRSF_TIMING_PERIOD_US           4000 // the radio should send channels frames about this often
+#define CRSF_TIMING_MARGIN_US           500 // the channels frame should arrive this much before we transmit
+#define CRSF_TIMING_CORRECTION_MS       200 // the timing correction is send this often
+
+
+// to be called when a frame is about to be transmitted, i.e., with the rc data which goes out
+void tTxCrsf::FrameStart(uint16_t frame_rate_ms)
+{
+    if (!enabled) return;
+
+    // the rc data is only fresh if a channels frame was put into it in this frame period,
+    // this also ensures that the uint16_t us difference does not roll over
+    rcdata_age_us = micros() - channels_applied_us;
+    rcdata_age_valid = channels_applied;
+    channels_applied = false;
+
+    if (!rcdata_age_valid) return;
+
+    // period which is commensurate with our frame period
+    uint16_t n = (frame_rate_ms * 1000 + CRSF_TIMING_PERIOD_US / 2) / CRSF_TIMING_PERIOD_US;
+    if (n < 1) n = 1;
+    timing_interval = ((uint32_t)frame_rate_ms * 10000) / n;
+
+    // by how much the next channels frame should come later, a shift by a full period doesn't matter
+    int32_t interval_us = timing_interval / 10;
+    int32_t offset_us = (int32_t)rcdata_age_us - CRSF_TIMING_MARGIN_US;
+    while (offset_us > interval_us / 2) offset_us -= interval_us;
+    while (offset_us < -interval_us / 2) offset_us += interval_us;
+    timing_offset_us = offset_us;
+
+    uint32_t tnow_ms = millis32();
+    if ((tnow_ms - timing_correction_tlast_ms) >= CRSF_TIMING_CORRECTION_MS) {
+        timing_correction_tlast_ms = tnow_ms;
+        timing_correction_due = true;
+    }
+}
+
+
+// returns false if the rc data in the frame is not fresh
+bool tTxCrsf::GetRcDataAge_us(uint16_t* age_us)
+{
+    if (!enabled || !rcdata_age_valid) return false;
+
+    *age_us = rcdata_age_us;
+    return true;
+}
+
+
+void tTxCrsf::SendTimingCorrection(void)
+{
+tCrsfTimingCorrection payload;
+
+    payload.dest_address = CRSF_ADDRESS_RADIO;
+    payload.src_address = CRSF_ADDRESS_TRANSMITTER_MODULE;
+    payload.sub_type = CRSF_RADIO_TIMING_CORRECTION;
+    payload.interval = CRSF_REV_U32(timing_interval);
+    payload.offset = (int32_t)CRSF_REV_U32((uint32_t)(timing_offset_us * 10));
+
+    SendFrame(CRSF_FRAME_ID_RADIO, &payload, CRSF_TIMING_CORRECTION_LEN);
+}
+
+
 #endif // if (defined DEVICE_HAS_JRPIN5)
 
 #endif // CRSF_INTERFACE_TX_H
@@ -15,7 +15,14 @@
 #include "../Common/protocols/ardupilot_protocol.h"
 #ifdef USE_FEATURE_MAVLINKX
 #include "../Common/thirdparty/fmav_mavlinkx.h"
-#include "../Common/libs/fifo.h"
+#include "../Common/mavlink/mavlinkx_dict.h"
+#include "../Common/mavlink/mavlink_queue.h"
+#endif
+#ifdef USE_FEATURE_MAVLINK_PARAM_CACHE
+#include "mavlink_param_cache.h"
+#endif
+#ifdef USE_FEATURE_MAVLINK_ROUTER
+#include "mavlink_router.h"
 #endif
 
 
@@ -33,6 +40,9 @@ class MavlinkBase
 {
   public:
     void Init(void);
+#ifdef USE_FEATURE_MAVLINK_ROUTER
+    void InitRouter(tSerialBase* _serial, tSerialBase* _mbridge, tSerialBase* _serial2);
+#endif
     void Do(void);
     uint8_t VehicleState(void);
     void FrameLost(void);
@@ -40,27 +50,47 @@ class MavlinkBase
     void putc(char c);
     bool available(void);
     uint8_t getc(void);
+    uint16_t getbuf(uint8_t* buf, uint16_t len);
     void flush(void);
 
   private:
     void send_msg_serial_out(void);
+    void send_frame_serial_out(uint8_t* buf, uint16_t len, fmav_result_t* result);
     void handle_msg_serial_out(void);
+#ifdef USE_FEATURE_MAVLINKX
+    void relay_msg_link_out(fmav_result_t* result, uint8_t* buf);
+#endif
     void generate_radio_status(void);
+#ifdef USE_FEATURE_MAVLINK_PARAM_CACHE
+    bool handle_msg_link_out_param_cache(fmav_result_t* result, uint8_t* buf);
+    void send_param_cache(uint32_t tnow_ms);
+#endif
 
     // fields for link in -> parser -> serial out
     fmav_status_t status_link_in;
     fmav_result_t result_link_in;
     uint8_t buf_link_in[MAVLINK_BUF_SIZE]; // buffer for link in parser
     fmav_status_t status_serial_out; // not needed, status_link_in could be used, but clearer so
-    fmav_message_t msg_serial_out; // could be avoided by more efficient coding
+    fmav_message_t msg_serial_out; // only for messages which are inspected or generated
 
     // fields for serial in -> parser -> link out
 #ifdef USE_FEATURE_MAVLINKX
     fmav_status_t status_serial_in;
     fmav_result_t result_serial_in;
     uint8_t buf_serial_in[MAVLINK_BUF_SIZE]; // buffer for serial in parser
-    fmav_message_t msg_link_out; // could be avoided by more efficient coding
-    FifoBase<char,512> fifo_link_out; // needs to be at least 82 + 280
+    tMavlinkQueue queue_link_out; // holds messages by priority, needs to be at least 82 + 280
+#endif
+
+    // to share the link among several ground ports, has its own parsers for serial in
+#ifdef USE_FEATURE_MAVLINK_ROUTER
+    tMavlinkRouter router;
+#endif
+
+    // to answer parameter requests of the GCS locally
+#ifdef USE_FEATURE_MAVLINK_PARAM_CACHE
+    tMavlinkParamCache param_cache;
+    uint32_t param_cache_tlast_ms;
+    uint16_t param_cache_bytes; // budget for sending
 #endif
 
     // to inject RADIO_STATUS messages
@@ -87,10 +117,18 @@ void MavlinkBase::Init(void)
 #ifdef USE_FEATURE_MAVLINKX
     fmavX_init();
     fmavX_config_compression((Config.Mode == MODE_19HZ) ? 1 : 0); // use compression only in 19 Hz mode
+    fmavX_config_delta(MAVLINKX_DELTA_DECODE, mavlink_msgid_is_periodic); // the Rx sends the telemetry
+    fmavX_config_dictionary(mavlinkx_dict, MAVLINKX_DICT_NUM);
 
     result_serial_in = {};
     status_serial_in = {};
-    fifo_link_out.Init();
+    queue_link_out.Init(stats.mavlink_latency);
+#endif
+
+#ifdef USE_FEATURE_MAVLINK_PARAM_CACHE
+    param_cache.Init();
+    param_cache_tlast_ms = 0;
+    param_cache_bytes = 0;
 #endif
 
     radio_status_tlast_ms = millis32() + 1000;
@@ -103,6 +141,20 @@ void MavlinkBase::Init(void)
 }
 
 
+#ifdef USE_FEATURE_MAVLINK_ROUTER
+// the serial destination port is always used, the others only when a GCS is found on them
+// mBridge can only be used if it is enabled, else it is not talking to the radio
+void MavlinkBase::InitRouter(tSerialBase* _serial, tSerialBase* _mbridge, tSerialBase* _serial2)
+{
+    router.Init();
+    router.AddPort(serialport, true);
+    router.AddPort(_serial, false);
+    router.AddPort(_serial2, false);
+    if (Config.UseMbridge) router.AddPort(_mbridge, false);
+}
+#endif
+
+
 void MavlinkBase::Do(void)
 {
     uint32_t tnow_ms = millis32();
@@ -112,32 +164,37 @@ void MavlinkBase::Do(void)
         //Init();
         radio_status_tlast_ms = tnow_ms;
 #ifdef USE_FEATURE_MAVLINKX
-        fifo_link_out.Flush();
+        queue_link_out.Flush();
 #endif
     }
 
     if (!SERIAL_LINK_MODE_IS_MAVLINK(Setup.Rx.SerialLinkMode)) return;
 
     // parse serial in -> link out
-#ifdef USE_FEATURE_MAVLINKX
-    if (fifo_link_out.HasSpace(290)) { // we have space for a full MAVLink message, so can safely parse
-        while (serialport->available()) {
+#if defined USE_FEATURE_MAVLINK_ROUTER
+    // messages from all ports go into the one queue, in the order they are parsed
+    for (uint8_t i = 0; i < router.PortNum(); i++) {
+        tMavlinkRouterPort* port = router.Port(i);
+        while (port->ser->available() && queue_link_out.HasSpace(290)) {
+            char c = port->ser->getc();
+            if (!fmav_parse_and_check_to_frame_buf(&(port->result), port->buf, &(port->status), c)) continue;
+            if (!router.HandleMsgIn(i, tnow_ms)) continue; // is a copy, was relayed already
+            uint8_t mask = router.TargetMask(&(port->result), i, tnow_ms);
+            if (mask) { // targets a component on another port, so doesn't go over the air
+                for (uint8_t n = 0; n < router.PortNum(); n++) {
+                    if (mask & (1 << n)) router.Port(n)->ser->putbuf(port->buf, port->result.frame_len);
+                }
+                continue;
+            }
+            relay_msg_link_out(&(port->result), port->buf);
+        }
+    }
+#elif defined USE_FEATURE_MAVLINKX
+    if (queue_link_out.HasSpace(290)) { // we have space for a full MAVLink message, so can safely parse
+        while (serialport->available() && queue_link_out.HasSpace(290)) {
             char c = serialport->getc();
             if (fmav_parse_and_check_to_frame_buf(&result_serial_in, buf_serial_in, &status_serial_in, c)) {
-
-                // TODO: this could be be done more efficiently by not going via msg_link_out
-                // but by directly going buf_serial_in -> _buf
-
-                fmav_frame_buf_to_msg(&msg_link_out, &result_serial_in, buf_serial_in);
-
-                uint16_t len;
-                if (Setup.Rx.SerialLinkMode == SERIAL_LINK_MODE_MAVLINK_X) {
-                    len = fmavX_msg_to_frame_buf(_buf, &msg_link_out);
-                } else {
-                    len = fmav_msg_to_frame_buf(_buf, &msg_link_out);
-                }
-
-                fifo_link_out.PutBuf(_buf, len);
+                relay_msg_link_out(&result_serial_in, buf_serial_in);
             }
         }
     }
@@ -157,6 +214,10 @@ void MavlinkBase::Do(void)
         generate_radio_status();
         send_msg_serial_out();
     }
+
+#ifdef USE_FEATURE_MAVLINK_PARAM_CACHE
+    send_param_cache(tnow_ms);
+#endif
 }
 
 
@@ -172,6 +233,7 @@ void MavlinkBase::FrameLost(void)
 {
 #ifdef USE_FEATURE_MAVLINKX
     // reset parser link in -> serial out
+    // the delta references need not be reset, the Rx uses only those we acked
     fmav_parse_reset(&status_link_in);
 #endif
 }
@@ -191,9 +253,14 @@ void MavlinkBase::putc(char c)
 #else
     if (fmav_parse_and_check_to_frame_buf(&result_link_in, buf_link_in, &status_link_in, c)) {
 #endif
-        fmav_frame_buf_to_msg(&msg_serial_out, &result_link_in, buf_link_in);
+        // the frame buf is a complete MAVLink frame, so we can send it as is
+        send_frame_serial_out(buf_link_in, result_link_in.frame_len, &result_link_in);
+        latency_trace.SerialOut();
 
-        send_msg_serial_out();
+        // crsf and we only look at messages from the autopilot, so only these need to be decoded
+        if (result_link_in.compid != MAV_COMP_ID_AUTOPILOT1) return;
+
+        fmav_frame_buf_to_msg(&msg_serial_out, &result_link_in, buf_link_in);
 
         // allow crsf to capture it
         crsf.TelemetryHandleMavlinkMsg(&msg_serial_out);
@@ -209,7 +276,7 @@ bool MavlinkBase::available(void)
     if (!serialport) return false; // should not happen
 
 #ifdef USE_FEATURE_MAVLINKX
-    return fifo_link_out.Available();
+    return queue_link_out.Available();
 #else
     return serialport->available();
 #endif
@@ -221,19 +288,31 @@ uint8_t MavlinkBase::getc(void)
     if (!serialport) return 0; // should not happen
 
 #ifdef USE_FEATURE_MAVLINKX
-    return fifo_link_out.Get();
+    return queue_link_out.Get();
 #else
     return serialport->getc();
 #endif
 }
 
 
+uint16_t MavlinkBase::getbuf(uint8_t* buf, uint16_t len)
+{
+    if (!serialport) return 0; // should not happen
+
+#ifdef USE_FEATURE_MAVLINKX
+    return queue_link_out.GetBuf(buf, len);
+#else
+    return serialport->getbuf(buf, len);
+#endif
+}
+
+
 void MavlinkBase::flush(void)
 {
     if (!serialport) return; // should not happen
 
 #ifdef USE_FEATURE_MAVLINKX
-    fifo_link_out.Flush();
+    queue_link_out.Flush();
 #endif
     serialport->flush();
 }
@@ -245,10 +324,53 @@ void MavlinkBase::send_msg_serial_out(void)
 
     uint16_t len = fmav_msg_to_frame_buf(_buf, &msg_serial_out);
 
+#ifdef USE_FEATURE_MAVLINK_ROUTER
+    uint8_t mask = router.ActiveMask(millis32()); // the messages we generate go to all
+    for (uint8_t n = 0; n < router.PortNum(); n++) {
+        if (mask & (1 << n)) router.Port(n)->ser->putbuf(_buf, len);
+    }
+#else
     serialport->putbuf(_buf, len);
+#endif
 }
 
 
+// result is needed for routing
+void MavlinkBase::send_frame_serial_out(uint8_t* buf, uint16_t len, fmav_result_t* result)
+{
+    if (!serialport) return; // should not happen
+
+#ifdef USE_FEATURE_MAVLINK_ROUTER
+    uint32_t tnow_ms = millis32();
+    uint8_t mask = router.TargetMask(result, UINT8_MAX, tnow_ms);
+    if (!mask) mask = router.ActiveMask(tnow_ms); // targets no or an unknown component, so to all
+    for (uint8_t n = 0; n < router.PortNum(); n++) {
+        if (mask & (1 << n)) router.Port(n)->ser->putbuf(buf, len);
+    }
+#else
+    serialport->putbuf(buf, len);
+#endif
+}
+
+
+#ifdef USE_FEATURE_MAVLINKX
+// relays a message from the GCS, without going via a fmav_message_t
+void MavlinkBase::relay_msg_link_out(fmav_result_t* result, uint8_t* buf)
+{
+#ifdef USE_FEATURE_MAVLINK_PARAM_CACHE
+    if (handle_msg_link_out_param_cache(result, buf)) return; // answered locally, so not relayed
+#endif
+
+    if (Setup.Rx.SerialLinkMode == SERIAL_LINK_MODE_MAVLINK_X) {
+        uint16_t len = fmavX_frame_buf_to_frame_buf(_buf, result, buf);
+        queue_link_out.Put(_buf, len, result);
+    } else {
+        queue_link_out.Put(buf, result->frame_len, result);
+    }
+}
+#endif
+
+
 //-------------------------------------------------------
 // Handle Messages
 //-------------------------------------------------------
@@ -282,10 +404,90 @@ void MavlinkBase::handle_msg_serial_out(void)
         fmav_msg_extended_sys_state_decode(&payload, &msg_serial_out);
         vehicle_is_flying = (payload.landed_state == MAV_LANDED_STATE_IN_AIR) ? 1 : 0;
         }break;
+
+#ifdef USE_FEATURE_MAVLINK_PARAM_CACHE
+    case FASTMAVLINK_MSG_ID_PARAM_VALUE:{
+        // only the autopilot's, other components have their own parameters, and the cache answers only for it
+        if (msg_serial_out.sysid != vehicle_sysid || msg_serial_out.compid != MAV_COMP_ID_AUTOPILOT1) break;
+        fmav_param_value_t payload;
+        fmav_msg_param_value_decode(&payload, &msg_serial_out);
+        param_cache.HandleParamValue(msg_serial_out.sysid, &payload);
+        }break;
+    case FASTMAVLINK_MSG_ID_ATTITUDE:{
+        // is send frequently, so good to detect a reboot
+        // only the autopilot's, a companion's has its own time_boot_ms
+        if (msg_serial_out.sysid != vehicle_sysid || msg_serial_out.compid != MAV_COMP_ID_AUTOPILOT1) break;
+        fmav_attitude_t payload;
+        fmav_msg_attitude_decode(&payload, &msg_serial_out);
+        param_cache.HandleTimeBoot(msg_serial_out.sysid, payload.time_boot_ms);
+        }break;
+#endif
+    }
+}
+
+
+//-------------------------------------------------------
+// Parameter Cache
+//-------------------------------------------------------
+#ifdef USE_FEATURE_MAVLINK_PARAM_CACHE
+
+// called for each message from the GCS, returns true if it was answered from the cache
+// only requests which target the autopilot are answered, requests to all components are
+// relayed, since other components need to answer too
+bool MavlinkBase::handle_msg_link_out_param_cache(fmav_result_t* result, uint8_t* buf)
+{
+    if (!param_cache.IsComplete() || !connected_and_rx_setup_available()) return false;
+
+    switch (result->msgid) {
+    case FASTMAVLINK_MSG_ID_PARAM_REQUEST_LIST:{
+        fmav_param_request_list_t payload;
+        fmav_frame_buf_decode(&payload, sizeof(payload), buf);
+        if (payload.target_system != param_cache.SysId() || payload.target_component != MAV_COMP_ID_AUTOPILOT1) return false;
+        param_cache.StartList();
+        return true; }
+
+    case FASTMAVLINK_MSG_ID_PARAM_REQUEST_READ:{
+        fmav_param_request_read_t payload;
+        fmav_frame_buf_decode(&payload, sizeof(payload), buf);
+        if (payload.target_system != param_cache.SysId() || payload.target_component != MAV_COMP_ID_AUTOPILOT1) return false;
+        return param_cache.StartRead(payload.param_index, payload.param_id); }
     }
+
+    return false;
 }
 
 
+// we use only half of the serial bandwidth, so that there is room for the telemetry
+void MavlinkBase::send_param_cache(uint32_t tnow_ms)
+{
+    uint32_t dt_ms = tnow_ms - param_cache_tlast_ms;
+    if (dt_ms > 100) dt_ms = 100;
+    uint32_t bytes = (dt_ms * Config.SerialBaudrate) / 20000; // 10 bits per byte, half
+    if (bytes) { // this way we don't lose fractions, which matters for low baudrates
+        param_cache_tlast_ms = tnow_ms;
+        param_cache_bytes += bytes;
+        if (param_cache_bytes > 128) param_cache_bytes = 128; // don't let it burst
+    }
+
+    while (param_cache_bytes >= MAVLINK_PARAM_VALUE_FRAME_LEN) {
+        fmav_param_value_t payload;
+        if (!param_cache.GetNext(&payload)) {
+            param_cache_bytes = 0;
+            return;
+        }
+        fmav_msg_param_value_encode(
+            &msg_serial_out,
+            param_cache.SysId(), MAV_COMP_ID_AUTOPILOT1,
+            &payload,
+            &status_serial_out);
+        send_msg_serial_out();
+        param_cache_bytes -= MAVLINK_PARAM_VALUE_FRAME_LEN;
+    }
+}
+
+#endif // USE_FEATURE_MAVLINK_PARAM_CACHE
+
+
 //-------------------------------------------------------
 // Generate Messages
 //-------------------------------------------------------
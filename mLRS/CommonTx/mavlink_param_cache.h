@@ -0,0 +1,168 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// MAVLink Parameter Cache
+//*******************************************************
+// Keeps a copy of the autopilot's parameters, so that a GCS which reconnects can get
+// them from the Tx module, and they don't need to be downloaded again over the air.
+//
+// The cache is filled by snooping the PARAM_VALUE messages the autopilot sends, i.e.,
+// by the first download, and is kept fresh by the PARAM_VALUE messages it sends in
+// response to PARAM_SET. It is complete when all indices have been seen.
+//
+// It is cleared if the autopilot is found to have rebooted, which is detected by its
+// time since boot going backwards, or if the parameter count or the sysid changes.
+//*******************************************************
+#ifndef MAVLINK_PARAM_CACHE_H
+#define MAVLINK_PARAM_CACHE_H
+#pragma once
+
+
+#include <inttypes.h>
+#include <string.h>
+
+
+#define MAVLINK_PARAM_CACHE_SIZE    1536 // ArduPilot has ca 1000 - 1400 parameters, takes 1536 x 21 bytes = 32 kB
+#define MAVLINK_PARAM_VALUE_FRAME_LEN  37 // 25 bytes payload + 12, without signature
+
+
+PACKED(
+typedef struct
+{
+    float value;
+    char id[16]; // is not zero terminated if 16 chars long
+    uint8_t type;
+}) tParamCacheItem;
+
+
+class tMavlinkParamCache
+{
+  public:
+    void Init(void)
+    {
+        Clear();
+    }
+
+    void Clear(void)
+    {
+        sysid = 0;
+        count = 0;
+        received_cnt = 0;
+        memset(received, 0, sizeof(received));
+        time_boot_ms_last = 0;
+        list_pos = UINT16_MAX;
+        read_pos = UINT16_MAX;
+    }
+
+    bool IsComplete(void) { return (count > 0 && received_cnt >= count); }
+    uint8_t SysId(void) { return sysid; }
+
+    //-- vehicle side
+
+    void HandleParamValue(uint8_t _sysid, fmav_param_value_t* payload)
+    {
+        if (_sysid != sysid || payload->param_count != count) { // new vehicle, or parameters have changed
+            Clear();
+            if (!payload->param_count || payload->param_count > MAVLINK_PARAM_CACHE_SIZE) return; // can't do it
+            sysid = _sysid;
+            count = payload->param_count;
+        }
+
+        uint16_t index = payload->param_index;
+        if (index >= count) { // is the response to a PARAM_SET, so find it by name
+            index = find(payload->param_id);
+            if (index == UINT16_MAX) return;
+        }
+
+        item[index].value = payload->param_value;
+        memcpy(item[index].id, payload->param_id, 16);
+        item[index].type = payload->param_type;
+
+        if (!(received[index >> 3] & (1 << (index & 0x07)))) {
+            received[index >> 3] |= (1 << (index & 0x07));
+            received_cnt++;
+        }
+    }
+
+    // to be called with the time_boot_ms of some frequent message of the vehicle
+    void HandleTimeBoot(uint8_t _sysid, uint32_t time_boot_ms)
+    {
+        if (_sysid != sysid) return;
+        if (time_boot_ms < time_boot_ms_last) { // vehicle has rebooted, parameters may have changed
+            Clear();
+            return;
+        }
+        time_boot_ms_last = time_boot_ms;
+    }
+
+    //-- GCS side, only to be called if complete
+
+    void StartList(void)
+    {
+        list_pos = 0;
+    }
+
+    // returns false if not in cache
+    bool StartRead(int16_t index, char* id)
+    {
+        uint16_t i = (index >= 0) ? index : find(id);
+        if (i >= count) return false;
+        read_pos = i;
+        return true;
+    }
+
+    // returns false if there is nothing to send
+    bool GetNext(fmav_param_value_t* payload)
+    {
+        if (!IsComplete()) {
+            list_pos = read_pos = UINT16_MAX;
+            return false;
+        }
+
+        uint16_t i;
+        if (read_pos != UINT16_MAX) { // a read is answered before the list is continued
+            i = read_pos;
+            read_pos = UINT16_MAX;
+        } else
+        if (list_pos < count) {
+            i = list_pos++;
+        } else {
+            list_pos = UINT16_MAX;
+            return false;
+        }
+
+        payload->param_value = item[i].value;
+        payload->param_count = count;
+        payload->param_index = i;
+        memcpy(payload->param_id, item[i].id, 16);
+        payload->param_type = item[i].type;
+        return true;
+    }
+
+  private:
+    uint16_t find(const char* id)
+    {
+        for (uint16_t i = 0; i < count; i++) {
+            if (!(received[i >> 3] & (1 << (i & 0x07)))) continue;
+            if (!strncmp(item[i].id, id, 16)) return i;
+        }
+        return UINT16_MAX;
+    }
+
+    uint8_t sysid;
+    uint16_t count; // number of parameters of the vehicle, 0 if unknown
+    uint16_t received_cnt;
+    uint8_t received[MAVLINK_PARAM_CACHE_SIZE / 8];
+    tParamCacheItem item[MAVLINK_PARAM_CACHE_SIZE];
+
+    uint32_t time_boot_ms_last;
+
+    uint16_t list_pos; // next item to send for a PARAM_REQUEST_LIST, UINT16_MAX if none
+    uint16_t read_pos; // item to send for a PARAM_REQUEST_READ, UINT16_MAX if none
+};
+
+
+#endif // MAVLINK_PARAM_CACHE_H
@@ -0,0 +1,215 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// MAVLink Router
+//*******************************************************
+// Lets several ground ports share the link, like the serial port with a USB GCS, the
+// serial2 port with a WiFi bridge, and mBridge with the radio's Lua scripts.
+//
+// The port set by SerialDestination is always used, as before. Any other port becomes
+// active when a valid MAVLink message is received on it, and inactive when nothing was
+// received for MAVLINK_ROUTER_PORT_TMO_MS, GCSes send a heartbeat each second.
+//
+// The sysid/compid of the messages received on a port are learned, so that messages
+// which target a component are send only to the ports it is on. A component can be seen
+// on several ports, like a GCS which is connected via two ports, so a route is kept for
+// each sysid/compid and port, and is dropped when nothing was received from the component
+// on this port for MAVLINK_ROUTER_PORT_TMO_MS. Messages which target no or an unknown
+// component are send to all active ports.
+//
+// A message which is received on more than one port is send over the air only once. It
+// is recognized by its header and crc.
+//*******************************************************
+#ifndef MAVLINK_ROUTER_H
+#define MAVLINK_ROUTER_H
+#pragma once
+
+
+#include <inttypes.h>
+#include <string.h>
+
+
+#define MAVLINK_ROUTER_PORT_NUM         3 // serial, serial2, mbridge
+#define MAVLINK_ROUTER_ROUTE_NUM        16
+#define MAVLINK_ROUTER_DUPLICATE_NUM    16
+#define MAVLINK_ROUTER_PORT_TMO_MS      5000
+#define MAVLINK_ROUTER_DUPLICATE_TMO_MS 500 // copies of a message arrive within this time
+#define MAVLINK_ROUTER_BUF_SIZE         300 // needs to be larger than max mavlink frame size = 286 bytes
+
+
+typedef struct
+{
+    tSerialBase* ser;
+    bool primary;
+    uint32_t tlast_ms; // when a message was last received
+
+    // fields for serial in -> parser
+    fmav_status_t status;
+    fmav_result_t result;
+    uint8_t buf[MAVLINK_ROUTER_BUF_SIZE];
+} tMavlinkRouterPort;
+
+
+class tMavlinkRouter
+{
+  public:
+    void Init(void)
+    {
+        port_num = 0;
+        route_num = 0;
+        duplicate_pos = 0;
+        memset(duplicate, 0, sizeof(duplicate));
+        duplicates_dropped = 0;
+    }
+
+    void AddPort(tSerialBase* ser, bool primary)
+    {
+        if (!ser) return;
+        for (uint8_t i = 0; i < port_num; i++) if (port[i].ser == ser) return; // already there
+        if (port_num >= MAVLINK_ROUTER_PORT_NUM) while (1) {} // must not happen
+
+        tMavlinkRouterPort* p = &(port[port_num]);
+        p->ser = ser;
+        p->primary = primary;
+        p->tlast_ms = 0;
+        p->status = {};
+        p->result = {};
+        port_num++;
+    }
+
+    uint8_t PortNum(void) { return port_num; }
+    tMavlinkRouterPort* Port(uint8_t i) { return &(port[i]); }
+
+    bool IsActive(uint8_t i, uint32_t tnow_ms)
+    {
+        if (port[i].primary) return true;
+        return (port[i].tlast_ms && (tnow_ms - port[i].tlast_ms) < MAVLINK_ROUTER_PORT_TMO_MS);
+    }
+
+    uint8_t ActiveMask(uint32_t tnow_ms)
+    {
+        uint8_t mask = 0;
+        for (uint8_t i = 0; i < port_num; i++) if (IsActive(i, tnow_ms)) mask |= (1 << i);
+        return mask;
+    }
+
+    // to be called for each message received on port i
+    // returns false if it is a copy of a message which was received before on another port
+    bool HandleMsgIn(uint8_t i, uint32_t tnow_ms)
+    {
+        fmav_result_t* result = &(port[i].result);
+
+        port[i].tlast_ms = (tnow_ms) ? tnow_ms : 1; // 0 means never
+
+        learn(i, result->sysid, result->compid, tnow_ms); // also from copies, the component is on this port too
+
+        if (is_duplicate(i, result, port[i].buf, tnow_ms)) {
+            duplicates_dropped++;
+            return false;
+        }
+
+        return true;
+    }
+
+    // returns the mask of all active ports on which the component targeted by the message was
+    // seen recently, except port from, 0 if it targets no or an unknown component
+    uint8_t TargetMask(fmav_result_t* result, uint8_t from, uint32_t tnow_ms)
+    {
+        if (!result->target_sysid) return 0;
+
+        uint8_t mask = 0;
+        for (uint8_t n = 0; n < route_num; n++) {
+            if (route[n].sysid != result->target_sysid) continue;
+            if (result->target_compid && route[n].compid != result->target_compid) continue;
+            if ((tnow_ms - route[n].tlast_ms) > MAVLINK_ROUTER_PORT_TMO_MS) continue; // not seen recently on this port
+            if (route[n].port == from || !IsActive(route[n].port, tnow_ms)) continue;
+            mask |= (1 << route[n].port);
+        }
+        return mask;
+    }
+
+    uint32_t duplicates_dropped;
+
+  private:
+    void learn(uint8_t i, uint8_t sysid, uint8_t compid, uint32_t tnow_ms)
+    {
+        uint8_t oldest = 0;
+        for (uint8_t n = 0; n < route_num; n++) {
+            if (route[n].sysid == sysid && route[n].compid == compid && route[n].port == i) {
+                route[n].tlast_ms = tnow_ms;
+                return;
+            }
+            if ((tnow_ms - route[n].tlast_ms) > (tnow_ms - route[oldest].tlast_ms)) oldest = n;
+        }
+
+        uint8_t n = (route_num < MAVLINK_ROUTER_ROUTE_NUM) ? route_num++ : oldest;
+        route[n].sysid = sysid;
+        route[n].compid = compid;
+        route[n].port = i;
+        route[n].tlast_ms = tnow_ms;
+    }
+
+    // a copy has the same sysid, compid, seq, msgid and crc, and came on another port
+    bool is_duplicate(uint8_t i, fmav_result_t* result, uint8_t* buf, uint32_t tnow_ms)
+    {
+        uint8_t seq;
+        uint16_t crc;
+        if (buf[0] == FASTMAVLINK_MAGIC_V2) {
+            seq = buf[4];
+            crc = buf[10 + buf[1]] + ((uint16_t)buf[11 + buf[1]] << 8);
+        } else {
+            seq = buf[2];
+            crc = buf[6 + buf[1]] + ((uint16_t)buf[7 + buf[1]] << 8);
+        }
+
+        for (uint8_t n = 0; n < MAVLINK_ROUTER_DUPLICATE_NUM; n++) {
+            tDuplicate* d = &(duplicate[n]);
+            if (!d->tlast_ms || (tnow_ms - d->tlast_ms) > MAVLINK_ROUTER_DUPLICATE_TMO_MS) continue;
+            if (d->port == i) continue; // a port doesn't send copies to itself, it may however wrap around seq
+            if (d->msgid != result->msgid || d->sysid != result->sysid || d->compid != result->compid) continue;
+            if (d->seq != seq || d->crc != crc) continue;
+            return true;
+        }
+
+        tDuplicate* d = &(duplicate[duplicate_pos]);
+        d->msgid = result->msgid;
+        d->crc = crc;
+        d->sysid = result->sysid;
+        d->compid = result->compid;
+        d->seq = seq;
+        d->port = i;
+        d->tlast_ms = (tnow_ms) ? tnow_ms : 1;
+        duplicate_pos++;
+        if (duplicate_pos >= MAVLINK_ROUTER_DUPLICATE_NUM) duplicate_pos = 0;
+        return false;
+    }
+
+    tMavlinkRouterPort port[MAVLINK_ROUTER_PORT_NUM];
+    uint8_t port_num;
+
+    struct { // one for each sysid/compid and port
+        uint8_t sysid;
+        uint8_t compid;
+        uint8_t port;
+        uint32_t tlast_ms;
+    } route[MAVLINK_ROUTER_ROUTE_NUM];
+    uint8_t route_num;
+
+    typedef struct {
+        uint32_t msgid;
+        uint16_t crc;
+        uint8_t sysid;
+        uint8_t compid;
+        uint8_t seq;
+        uint8_t port;
+        uint32_t tlast_ms; // 0 means empty
+    } tDuplicate;
+    tDuplicate duplicate[MAVLINK_ROUTER_DUPLICATE_NUM];
+    uint8_t duplicate_pos;
+};
+
+
+#endif // MAVLINK_ROUTER_H
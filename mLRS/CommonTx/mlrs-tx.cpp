@@ -241,6 +241,7 @@ void init(void)
     fan.Init();
     dbg.Init();
 
+    frame_crc_engine_init();
     sx.Init();
     sx2.Init();
 
@@ -260,6 +261,7 @@ void init(void)
 
 volatile uint16_t irq_status;
 volatile uint16_t irq2_status;
+volatile uint16_t irq_rx_done_us; // when the last frame was received, by either antenna
 
 IRQHANDLER(
 void SX_DIO_EXTI_IRQHandler(void)
@@ -267,6 +269,7 @@ void SX_DIO_EXTI_IRQHandler(void)
     sx_dio_exti_isr_clearflag();
     irq_status = sx.GetAndClearIrqStatus(SX_IRQ_ALL);
     if (irq_status & SX_IRQ_RX_DONE) {
+        irq_rx_done_us = micros();
         if (bind.IsInBind()) {
             uint64_t bind_signature;
             sx.ReadBuffer(0, (uint8_t*)&bind_signature, 8);
@@ -285,6 +288,7 @@ void SX2_DIO_EXTI_IRQHandler(void)
     sx2_dio_exti_isr_clearflag();
     irq2_status = sx2.GetAndClearIrqStatus(SX2_IRQ_ALL);
     if (irq2_status & SX2_IRQ_RX_DONE) {
+        irq_rx_done_us = micros();
         if (bind.IsInBind()) {
             uint64_t bind_signature;
             sx2.ReadBuffer(0, (uint8_t*)&bind_signature, 8);
@@ -301,6 +305,7 @@ void SX2_DIO_EXTI_IRQHandler(void)
 
 uint8_t link_rx1_status;
 uint8_t link_rx2_status;
+bool frame_combined; // the frame was recovered by combining the frames of both antennas
 
 
 //-- Tx/Rx cmd frame handling
@@ -309,6 +314,8 @@ uint8_t link_task;
 uint8_t transmit_frame_type;
 uint16_t link_task_delay_ms;
 bool doParamsStore;
+uint8_t rx_trace_mode; // the Rx histogram which is asked for with LINK_TASK_TX_GET_RX_TRACE
+uint8_t rx_trace_path;
 
 
 void link_task_init(void)
@@ -318,6 +325,7 @@ void link_task_init(void)
     transmit_frame_type = TRANSMIT_FRAME_TYPE_NORMAL;
 
     doParamsStore = false;
+    rx_trace_mode = rx_trace_path = 0;
 }
 
 
@@ -339,6 +347,9 @@ bool link_task_set(uint8_t task)
     case LINK_TASK_TX_STORE_RX_PARAMS: // store rx parameters
         link_task_delay_ms = 500; // we set a delay, the actual store is triggered when it expires
         break;
+    case LINK_TASK_TX_GET_RX_TRACE:
+        link_task_delay_ms = 500; // we give up if the Rx doesn't respond, e.g. since it doesn't know the cmd
+        break;
     }
 
     return true;
@@ -385,6 +396,11 @@ tCmdFrameHeader* head = (tCmdFrameHeader*)(frame->payload);
         mbridge.Unlock();
 #endif
         break;
+    case FRAME_CMD_RX_TRACE:
+        // received a latency histogram of the rx
+        unpack_rxcmdframe_rxtrace(frame);
+        link_task_reset();
+        break;
     }
 }
 
@@ -405,31 +421,107 @@ void pack_txcmdframe(tTxFrame* frame, tFrameStats* frame_stats, tRcData* rc)
         pack_txcmdframe_cmd(frame, frame_stats, rc, FRAME_CMD_STORE_RX_PARAMS);
         transmit_frame_type = TRANSMIT_FRAME_TYPE_NORMAL;
         break;
+    case LINK_TASK_TX_SWITCH_MODE:
+        pack_txcmdframe_switchmode(frame, frame_stats, rc, rate_adapt.SwitchMode(), rate_adapt.SwitchCnt());
+        break;
+    case LINK_TASK_TX_FHSS_SWAP:
+        pack_txcmdframe_fhssswap(frame, frame_stats, rc, fhss.SwapI(), fhss.SwapCh(), fhss.SwapCnt());
+        break;
+    case LINK_TASK_TX_GET_RX_TRACE:
+        pack_txcmdframe_getrxtrace(frame, frame_stats, rc, rx_trace_mode, rx_trace_path);
+        break;
     }
 }
 
 
+//-- Rate adaption
+
+void rate_adapt_switch_mode(uint8_t mode)
+{
+    configure_mode(mode);
+    sxSetLoraConfigurationByIndex(Config.Sx.LoraConfigIndex);
+    tdiversity.Init(Config.frame_rate_ms);
+    latency_trace.SetMode(Config.Mode, Config.frame_rate_ms);
+    // tx_tick is reloaded with the new frame rate on the next tick
+}
+
+
+void rate_adapt_do(void)
+{
+    if (!rate_adapt.IsEnabled() || bind.IsInBind()) return;
+
+    // the LQ of both directions, and the weaker rssi
+    uint8_t LQ = stats.valid_frames_received.GetLQ();
+    if (stats.received_LQ < LQ) LQ = stats.received_LQ;
+    int8_t rssi = stats.GetLastRssi();
+    if (stats.received_rssi < rssi) rssi = stats.received_rssi; // RSSI_INVALID is the largest value, so is never taken
+    if (rssi == RSSI_INVALID) return; // no decision without rssi
+    int16_t margin_db = rssi - sx.ReceiverSensitivity_dbm();
+
+    uint8_t mode = rate_adapt.Decide(LQ, margin_db);
+    if (mode == rate_adapt.Mode()) return;
+
+    if (!link_task_set(LINK_TASK_TX_SWITCH_MODE)) return; // busy, retry next time
+    rate_adapt.Schedule(mode, RATE_ADAPT_SWITCH_CNT);
+}
+
+
+//-- Fhss adaption
+
+void fhss_adapt_do(void)
+{
+    if (Setup.Tx[Config.ConfigId].FhssAdapt != FHSS_ADAPT_ON || bind.IsInBind()) return;
+    if (fhss.SwapPending()) return;
+
+    uint8_t i = fhss.FindBadChannel();
+    if (i == UINT8_MAX) return;
+    uint8_t ch = fhss.FindSpareChannel(i);
+    if (ch == UINT8_MAX) return; // no spare channel left, we have to live with it
+
+    if (!link_task_set(LINK_TASK_TX_FHSS_SWAP)) return; // busy, retry next time
+    fhss.ScheduleSwap(i, ch, FHSS_SWAP_CNT);
+}
+
+
+//-- Slot schedule
+
+bool slot_schedule_allowed(void)
+{
+    if (!connected() || bind.IsInBind()) return false;
+    if (link_task != LINK_TASK_NONE || transmit_frame_type != TRANSMIT_FRAME_TYPE_NORMAL) return false;
+    if (rate_adapt.SwitchPending() || fhss.SwapPending()) return false;
+    if (arq.IsEnabled()) return false; // stop-and-wait needs strict alternation
+    return slot_schedule.RateAllowed();
+}
+
+
 //-- normal Tx, Rx frames handling
 
 void prepare_transmit_frame(uint8_t antenna, uint8_t ack)
 {
-uint8_t payload[FRAME_TX_PAYLOAD_LEN];
 uint8_t payload_len = 0;
 
     if (transmit_frame_type == TRANSMIT_FRAME_TYPE_NORMAL) {
 
         // read data from serial port
         if (connected()) {
-            if (sx_serial.IsEnabled()) {
-                for (uint8_t i = 0; i < FRAME_TX_PAYLOAD_LEN; i++) {
-                    if (!sx_serial.available()) break;
-                    payload[payload_len] = sx_serial.getc();
-                    payload_len++;
+            if (arq.Pending()) {
+                // resend the payload which has not been acknowledged
+                payload_len = arq.GetPayload(txFrame.payload);
+
+                stats.serial_data_retransmitted.Inc();
+            } else {
+                if (sx_serial.IsEnabled()) {
+                    // read directly into the frame's payload
+                    payload_len = sx_serial.getbuf(txFrame.payload, FRAME_TX_PAYLOAD_LEN_USABLE);
                 }
-            }
 
-            stats.bytes_transmitted.Add(payload_len);
-            stats.serial_data_transmitted.Inc();
+                if (payload_len) stats.transmit_seq_no++;
+                arq.PutPayload(txFrame.payload, payload_len);
+
+                stats.bytes_transmitted.Add(payload_len);
+                stats.serial_data_transmitted.Inc();
+            }
         } else {
             sx_serial.flush();
         }
@@ -445,9 +537,11 @@ uint8_t payload_len = 0;
     frame_stats.rssi = stats.GetLastRssi();
     frame_stats.LQ = txstats.GetLQ();
     frame_stats.LQ_serial_data = txstats.GetLQ_serial_data();
+    frame_stats.valid_received = 0; // not used in Tx->Rx frames
+    frame_stats.downlink = slot_schedule.Announce(slot_schedule_allowed());
 
     if (transmit_frame_type == TRANSMIT_FRAME_TYPE_NORMAL) {
-        pack_txframe(&txFrame, &frame_stats, &rcData, payload, payload_len);
+        pack_txframe(&txFrame, &frame_stats, &rcData, txFrame.payload, payload_len);
     } else {
         pack_txcmdframe(&txFrame, &frame_stats, &rcData);
     }
@@ -461,15 +555,27 @@ void process_received_frame(bool do_payload, tRxFrame* frame)
     stats.received_rssi = rssi_i8_from_u7(frame->status.rssi_u7);
     stats.received_LQ = frame->status.LQ;
     stats.received_LQ_serial_data = frame->status.LQ_serial_data;
+    stats.received_valid = frame->status.valid_received;
 
     if (!do_payload) return;
 
+    // a combined frame passed one of several crc checks, which is too weak for commands and
+    // the downlink slot request
     if (frame->status.frame_type == FRAME_TYPE_TX_RX_CMD) {
-        process_received_rxcmdframe(frame);
+        if (!frame_combined) process_received_rxcmdframe(frame);
+        return;
+    }
+
+    if (!frame_combined) slot_schedule.HandleRequest(frame->status.downlink);
+
+    // drop it if it is a retransmission of a payload we already have
+    if (frame->status.payload_len && arq.IsDuplicate(frame->status.seq_no)) {
+        stats.serial_data_duplicates_received.Inc();
         return;
     }
 
     // output data on serial
+    if (frame->status.payload_len) latency_trace.SerialReceived(irq_rx_done_us);
     if (sx_serial.IsEnabled()) {
         for (uint8_t i = 0; i < frame->status.payload_len; i++) {
             uint8_t c = frame->payload[i];
@@ -517,6 +623,8 @@ tRxFrame* frame;
         stats.received_ack = 0;
     }
 
+    arq.SetReceived(rx_status == RX_STATUS_VALID);
+
     // we set it for all received frames
     stats.last_antenna = antenna;
 
@@ -529,23 +637,57 @@ void handle_receive_none(void) // RX_STATUS_NONE
 {
     stats.received_seq_no = UINT8_MAX;
     stats.received_ack = 0;
+    arq.SetReceived(false);
 }
 
 
-void do_transmit(uint8_t antenna) // we send a TX frame to receiver
+// the frame the Rx sent in a downlink slot in place of our frame
+// only the payload is of interest, the frame of the slot is handled as usual
+void handle_receive_slot_frame(void)
 {
-uint8_t ack = 1;
+    frame_combined = false;
+    if (USE_ANTENNA1 && USE_ANTENNA2) {
+        if (link_rx1_status == RX_STATUS_INVALID && link_rx2_status == RX_STATUS_INVALID) {
+            if (combine_rxframes(&rxFrame, &rxFrame2)) {
+                link_rx1_status = RX_STATUS_VALID;
+                frame_combined = true;
+                stats.frames_combined.Inc();
+            }
+        }
+    }
 
+    tRxFrame* frame = nullptr;
+    if (USE_ANTENNA1 && link_rx1_status == RX_STATUS_VALID) {
+        frame = &rxFrame;
+    } else
+    if (USE_ANTENNA2 && link_rx2_status == RX_STATUS_VALID) {
+        frame = &rxFrame2;
+    }
+
+    if (!frame) {
+        mavlink.FrameLost();
+        return;
+    }
+
+    process_received_frame(true, frame);
+}
+
+
+void do_transmit(uint8_t antenna) // we send a TX frame to receiver
+{
     if (bind.IsInBind()) {
         bind.do_transmit(antenna);
         return;
     }
 
-    stats.transmit_seq_no++;
+    // Setup.Rx is what we got from the receiver, so both ends agree
+    arq.SetEnabled(Setup.Rx.SerialArq == SERIAL_ARQ_ON);
+    arq.HandleAck(stats.received_ack);
+    stats.retransmit_cnt = arq.RetransmitCnt();
 
-    prepare_transmit_frame(antenna, ack);
+    prepare_transmit_frame(antenna, arq.Ack());
 
-    sxSendFrame(antenna, &txFrame, FRAME_TX_RX_LEN, SEND_FRAME_TMO_MS); // 10 ms tmo
+    sxSendFrame(antenna, &txFrame, txframe_len(&txFrame), SEND_FRAME_TMO_MS); // 10 ms tmo
 }
 
 
@@ -563,6 +705,14 @@ uint8_t rx_status = RX_STATUS_INVALID; // this also signals that a frame was rec
     sxReadFrame(antenna, &rxFrame, &rxFrame2, FRAME_TX_RX_LEN);
     res = (antenna == ANTENNA_1) ? check_rxframe(&rxFrame) : check_rxframe(&rxFrame2);
 
+    if (res != CHECK_OK && Config.UseFec) {
+        tRxFrame* frame = (antenna == ANTENNA_1) ? &rxFrame : &rxFrame2;
+        if (fec_decode_frame((uint8_t*)frame)) {
+            res = check_rxframe(frame);
+            if (res == CHECK_OK) stats.frames_fec_corrected.Inc();
+        }
+    }
+
     if (res) {
         DBG_MAIN(dbg.puts("fail ");dbg.putc('\n');)
 //dbg.puts("fail a");dbg.putc(antenna+'0');dbg.puts(" ");dbg.puts(u8toHEX_s(res));dbg.putc('\n');
@@ -594,15 +744,13 @@ uint16_t tick_1hz_commensurate;
 bool doPreTransmit;
 
 uint16_t link_state;
-uint8_t connect_state;
-uint16_t connect_tmo_cnt;
-uint8_t connect_sync_cnt;
-bool connect_occured_once;
+bool slot_frame_wait; // downlink slot, the Rx frame in place of our frame is expected
+uint16_t slot_frame_tstart_us;
 
 
 static inline bool connected(void)
 {
-    return (connect_state == CONNECT_STATE_CONNECTED);
+    return link_connect.Connected();
 }
 
 static inline bool connected_and_rx_setup_available(void)
@@ -645,15 +793,19 @@ RESTARTCONTROLLER:
   tx_tick = 0;
   doPreTransmit = false;
   link_state = LINK_STATE_IDLE;
-  connect_state = CONNECT_STATE_LISTEN;
-  connect_tmo_cnt = 0;
-  connect_sync_cnt = 0;
-  connect_occured_once = false;
+  link_connect.Init();
   link_rx1_status = link_rx2_status = RX_STATUS_NONE;
+  frame_combined = false;
   link_task_init();
   link_task_set(LINK_TASK_TX_GET_RX_SETUPDATA); // we start with wanting to get rx setup data
 
   txstats.Init(Config.LQAveragingPeriod);
+  arq.Init();
+  rc_coding.Init();
+  latency_trace.Init(Config.Mode, Config.frame_rate_ms);
+  rate_adapt.Init(Config.UseRateAdapt, Config.Mode);
+  slot_schedule.Init();
+  slot_frame_wait = false;
   rdiversity.Init();
   tdiversity.Init(Config.frame_rate_ms);
 
@@ -680,9 +832,7 @@ RESTARTCONTROLLER:
         // the commands below must not be sensitive to strict ms timing
         doSysTask--; // doSysTask = 0;
 
-        if (connect_tmo_cnt) {
-            connect_tmo_cnt--;
-        }
+        link_connect.Tick_ms();
 
         if (connected()) {
             DECc(led_blink, SYSTICK_DELAY_MS(500));
@@ -704,7 +854,7 @@ RESTARTCONTROLLER:
         DECc(tick_1hz, SYSTICK_DELAY_MS(1000));
 
         if (!tick_1hz) {
-            if (Setup.Tx[Config.ConfigId].Buzzer == BUZZER_RX_LQ && connect_occured_once) {
+            if (Setup.Tx[Config.ConfigId].Buzzer == BUZZER_RX_LQ && link_connect.OccuredOnce()) {
                 buzzer.BeepLQ(stats.received_LQ);
             }
         }
@@ -750,7 +900,14 @@ RESTARTCONTROLLER:
         fhss.HopToNext();
         sx.SetRfFrequency(fhss.GetCurrFreq());
         sx2.SetRfFrequency(fhss.GetCurrFreq());
+        if (slot_schedule.IsDownlink()) { // downlink slot, the Rx transmits in place of us
+            slot_frame_wait = true;
+            slot_frame_tstart_us = micros();
+            link_state = LINK_STATE_RECEIVE;
+            break;
+        }
         do_transmit(tdiversity.Antenna());
+        if (connected()) latency_trace.RcTransmit();
         link_state = LINK_STATE_TRANSMIT_WAIT;
         irq_status = irq2_status = 0;
         DBG_MAIN_SLIM(dbg.puts("\n>");)
@@ -771,6 +928,7 @@ IF_SX(
         if (link_state == LINK_STATE_TRANSMIT_WAIT) {
             if (irq_status & SX_IRQ_TX_DONE) {
                 irq_status = 0;
+                latency_trace.TransmitDone();
                 link_state = LINK_STATE_RECEIVE;
                 DBG_MAIN_SLIM(dbg.puts("1!");)
             }
@@ -804,6 +962,7 @@ IF_SX2(
         if (link_state == LINK_STATE_TRANSMIT_WAIT) {
             if (irq2_status & SX2_IRQ_TX_DONE) {
                 irq2_status = 0;
+                latency_trace.TransmitDone();
                 link_state = LINK_STATE_RECEIVE;
                 DBG_MAIN_SLIM(dbg.puts("2!");)
             }
@@ -833,6 +992,21 @@ IF_SX2(
     }//end of if(irq2_status)
 );
 
+    // downlink slot, the Rx frame in place of our frame needs to be handled before the Rx frame of the slot comes
+    if (slot_frame_wait && link_state == LINK_STATE_RECEIVE_WAIT) {
+        bool all_received = (!USE_ANTENNA1 || link_rx1_status > RX_STATUS_NONE) && (!USE_ANTENNA2 || link_rx2_status > RX_STATUS_NONE);
+        bool tmo = ((uint16_t)(micros() - slot_frame_tstart_us) > sx.TimeOverAir_us() + SLOT_SCHEDULE_FRAME_WAIT_US);
+        if (all_received || tmo) {
+            slot_frame_wait = false;
+            if (link_rx1_status > RX_STATUS_NONE || link_rx2_status > RX_STATUS_NONE) {
+                handle_receive_slot_frame();
+                link_state = LINK_STATE_RECEIVE; // go back to receive for the Rx frame of the slot
+            } else {
+                mavlink.FrameLost(); // nothing came, the radios are still in receive
+            }
+        }
+    }
+
     // this happens before switching to transmit, i.e. after a frame was or should have been received
     uint8_t link_state_before = link_state; // to detect changes in link state
 
@@ -844,6 +1018,16 @@ IF_SX2(
 
         bool frame_received, valid_frame_received;
         if (USE_ANTENNA1 && USE_ANTENNA2) {
+            // both frames are corrupted, try to recover one by combining them
+            // a recovered frame is attributed to antenna 1
+            frame_combined = false;
+            if (link_rx1_status == RX_STATUS_INVALID && link_rx2_status == RX_STATUS_INVALID && !bind.IsInBind()) {
+                if (combine_rxframes(&rxFrame, &rxFrame2)) {
+                    link_rx1_status = RX_STATUS_VALID;
+                    frame_combined = true;
+                    stats.frames_combined.Inc();
+                }
+            }
             frame_received = (link_rx1_status > RX_STATUS_NONE) || (link_rx2_status > RX_STATUS_NONE);
             valid_frame_received = (link_rx1_status > RX_STATUS_INVALID) || (link_rx2_status > RX_STATUS_INVALID);
         } else if (USE_ANTENNA2) {
@@ -879,44 +1063,43 @@ IF_SX2(
             mavlink.FrameLost();
         }
 
+        // the rc data of the frame of this slot can be taken as reference if the Rx acknowledged it
+        rc_coding.HandleAck(valid_frame_received && stats.received_valid);
+
         txstats.fhss_curr_i = fhss.CurrI();
         txstats.rx1_valid = (link_rx1_status > RX_STATUS_INVALID);
         txstats.rx2_valid = (link_rx2_status > RX_STATUS_INVALID);
 
+        if (connected() && !bind.IsInBind()) {
+            // we have not hopped yet, so this is for the channel of this slot
+            // in a downlink slot we did not transmit, so the Rx could not have received anything
+            // with delta rc coding the flag tells that the rc data was decoded, which can fail also for
+            // a received frame, so it does not tell about the channel and is not used
+            bool received_valid = stats.received_valid || slot_schedule.IsDownlink() || Config.UseRcDelta;
+            fhss.ChannelStatsUpdate(frame_received, valid_frame_received, received_valid, stats.GetLastRssi(), stats.GetLastSnr());
+        }
+
         if (valid_frame_received) { // valid frame received
-            switch (connect_state) {
-            case CONNECT_STATE_LISTEN:
-                connect_state = CONNECT_STATE_SYNC;
-                connect_sync_cnt = 0;
-                break;
-            case CONNECT_STATE_SYNC:
-                connect_sync_cnt++;
-                if (connect_sync_cnt >= CONNECT_SYNC_CNT) {
-                    if (!SetupMetaData.rx_available && !bind.IsInBind()) {
-                        // should not have happen, but does very occasionally happen, so let's cope with
-                        // we must have gotten it at least once, on first connect, since we need it
-                        // later on we can accept to be gentle and be ok with not getting it again
-                        // bottom line: the receiver must not change after first connection
-                        if (connect_occured_once) {
-                            link_task_reset();
-                            SetupMetaData.rx_available = true;
-                        } else {
-                            // we could be more gentle and postpone connection by one cnt
-                            FAILALWAYS(BLINK_3, "rx_available not true");
-                        }
-                    }
-                    connect_state = CONNECT_STATE_CONNECTED;
-                    connect_occured_once = true;
+            bool occured_once = link_connect.OccuredOnce();
+            if (link_connect.ValidFrame() && !SetupMetaData.rx_available && !bind.IsInBind()) { // just connected
+                // should not have happen, but does very occasionally happen, so let's cope with
+                // we must have gotten it at least once, on first connect, since we need it
+                // later on we can accept to be gentle and be ok with not getting it again
+                // bottom line: the receiver must not change after first connection
+                if (occured_once) {
+                    link_task_reset();
+                    SetupMetaData.rx_available = true;
+                } else {
+                    // we could be more gentle and postpone connection by one cnt
+                    FAILALWAYS(BLINK_3, "rx_available not true");
                 }
-                break;
             }
-            connect_tmo_cnt = CONNECT_TMO_SYSTICKS;
         }
 
         // we are connected but tmo ran out
-        if (connected() && !connect_tmo_cnt) {
+        if (connected() && link_connect.TimedOut()) {
             // so disconnect
-            connect_state = CONNECT_STATE_LISTEN;
+            link_connect.Listen();
             // link_state will be set to LINK_STATE_TRANSMIT below
         }
 
@@ -929,20 +1112,51 @@ IF_SX2(
         link_state = LINK_STATE_TRANSMIT;
         link_rx1_status = RX_STATUS_NONE;
         link_rx2_status = RX_STATUS_NONE;
+        slot_frame_wait = false;
 
-        if (connect_state == CONNECT_STATE_LISTEN) {
+        // slot schedule, count the slots of the last period, and find out if the next is a downlink slot
+        if (connected()) {
+            stats.downlink_slots.Inc();
+            if (slot_schedule.IsDownlink()) stats.downlink_slots.Inc(); else stats.uplink_slots.Inc();
+        } else {
+            slot_schedule.Reset();
+        }
+        slot_schedule.Tick();
+
+        if (link_connect.IsInListen()) {
             link_task_reset(); // to ensure that the following set is enforced
             link_task_set(LINK_TASK_TX_GET_RX_SETUPDATA);
         }
 
+        // rate adaption, when not connected go back to home mode, this is where the Rx looks for us
+        if (!connected()) {
+            if (!rate_adapt.IsHome()) rate_adapt_switch_mode(rate_adapt.HomeMode());
+            rate_adapt.Reset();
+        } else
+        if (rate_adapt.Tick()) { // the switch is due, this frame goes out in the new mode
+            rate_adapt_switch_mode(rate_adapt.Mode());
+            if (link_task == LINK_TASK_TX_SWITCH_MODE) link_task_reset();
+        }
+
+        // fhss adaption, when not connected go back to the original hop list, this is what the Rx uses
+        if (!connected() && !bind.IsInBind()) {
+            if (fhss.IsModified()) fhss.Init(&Config.Fhss);
+            fhss.CancelSwap();
+        } else
+        if (fhss.TickSwap()) { // the swap is due, we hop next with the new channel
+            if (link_task == LINK_TASK_TX_FHSS_SWAP) link_task_reset();
+        }
+
         DECc(tick_1hz_commensurate, Config.frame_rate_hz);
         if (!tick_1hz_commensurate) {
             txstats.Update1Hz();
+            if (connected()) rate_adapt_do();
+            if (connected()) fhss_adapt_do();
         }
         txstats.Next();
         if (!connected()) txstats.Clear();
 
-        if (Setup.Tx[Config.ConfigId].Buzzer == BUZZER_LOST_PACKETS && connect_occured_once && !bind.IsInBind()) {
+        if (Setup.Tx[Config.ConfigId].Buzzer == BUZZER_LOST_PACKETS && link_connect.OccuredOnce() && !bind.IsInBind()) {
             if (!valid_frame_received) buzzer.BeepLP();
         }
 
@@ -955,16 +1169,24 @@ IF_SX2(
         bind.Do();
         switch (bind.Task()) {
         case BIND_TASK_CHANGED_TO_BIND:
+            rate_adapt.Reset(); // bind sets its own mode
             bind.ConfigForBind();
             fhss.SetToBind();
             LED_GREEN_ON;
             LED_RED_OFF;
-            connect_state = CONNECT_STATE_LISTEN;
+            link_connect.Listen();
             // link_state was set to LINK_STATE_TRANSMIT already
             break;
         case BIND_TASK_TX_RESTART_CONTROLLER: goto RESTARTCONTROLLER; break;
         }
 
+        // the rc data goes out with this frame, measure its age and align the radio to us
+IF_CRSF(
+        crsf.FrameStart(Config.frame_rate_ms);
+        uint16_t rcdata_age_us;
+        if (connected() && crsf.GetRcDataAge_us(&rcdata_age_us)) stats.rcdata_age.Add(rcdata_age_us);
+);
+
 //dbg.puts((valid_frame_received) ? "\nvalid" : "\ninval");
     }//end of if(doPreTransmit)
 
@@ -979,6 +1201,7 @@ IF_MBRIDGE(
         if (Setup.Tx[Config.ConfigId].ChannelsSource == CHANNEL_SOURCE_MBRIDGE) {
             channelOrder.Set(Setup.Tx[Config.ConfigId].ChannelOrder); //TODO: better than before, but still better place!?
             channelOrder.Apply(&rcData);
+            latency_trace.RcIn();
         }
         // when we receive channels packet from transmitter, we send link stats to transmitter
         mbridge.TelemetryStart();
@@ -1042,6 +1265,7 @@ IF_CRSF(
         // update channels
         channelOrder.Set(Setup.Tx[Config.ConfigId].ChannelOrder); //TODO: better than before, but still better place!?
         channelOrder.Apply(&rcData);
+        latency_trace.RcIn();
     }
     uint8_t crsftask; uint8_t crsfcmd;
     uint8_t mbcmd; static uint8_t do_cnt = 0; // if it's too fast Lua script gets out of sync
@@ -1051,6 +1275,7 @@ IF_CRSF(
         case TXCRSF_SEND_LINK_STATISTICS: crsf_send_LinkStatistics(); do_cnt = 0; break;
         case TXCRSF_SEND_LINK_STATISTICS_TX: crsf_send_LinkStatisticsTx(); break;
         case TXCRSF_SEND_LINK_STATISTICS_RX: crsf_send_LinkStatisticsRx(); break;
+        case TXCRSF_SEND_TIMING_CORRECTION: crsf.SendTimingCorrection(); break;
         case TXCRSF_SEND_TELEMETRY_FRAME:
             if (!do_cnt && mbridge.CommandInFifo(&mbcmd)) {
                 mbridge_send_cmd(mbcmd);
@@ -1083,6 +1308,7 @@ IF_IN(
         // update channels
         channelOrder.Set(Setup.Tx[Config.ConfigId].ChannelOrder); //TODO: better than before, but still better place!?
         channelOrder.Apply(&rcData);
+        latency_trace.RcIn();
     }
 );
 
@@ -1125,6 +1351,13 @@ IF_IN(
     case CLI_TASK_BOOT: enter_system_bootloader(); break;
     case CLI_TASK_FLASH_ESP: enter_flash_esp(); break;
     case CLI_TASK_CHANGE_CONFIG_ID: config_id.Change(cli.GetTaskValue()); break;
+    case CLI_TASK_RX_TRACE:
+        if (connected()) {
+            rx_trace_mode = latency_trace.Mode();
+            rx_trace_path = cli.GetTaskValue();
+            link_task_set(LINK_TASK_TX_GET_RX_TRACE);
+        }
+        break;
     }
 
     //-- Handle esp wifi bridge
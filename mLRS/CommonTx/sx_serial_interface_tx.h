@@ -34,6 +34,10 @@ class tTxSxSerial : public tSerialBase
         default:
             while (1) {} // must not happen
         }
+
+#ifdef USE_FEATURE_MAVLINK_ROUTER
+        mavlink.InitRouter(_serial, _mbridge, _serial2);
+#endif
     }
 
     bool IsEnabled(void)
@@ -59,6 +63,15 @@ class tTxSxSerial : public tSerialBase
         return serialport->getc(); // get from serial
     }
 
+    virtual uint16_t getbuf(void* buf, uint16_t len)
+    {
+        if (!connected_and_rx_setup_available()) return 0;
+        if (SERIAL_LINK_MODE_IS_MAVLINK(Setup.Rx.SerialLinkMode)) {
+            return mavlink.getbuf((uint8_t*)buf, len); // get from serial via mavlink parser
+        }
+        return serialport->getbuf(buf, len); // get from serial
+    }
+
     virtual void flush(void)
     {
         mavlink.flush(); // we don't distinguish here, can't harm to always flush mavlink handler
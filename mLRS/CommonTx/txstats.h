@@ -70,6 +70,7 @@ void TxStatsBase::Next(void) // this is called when transmit starts, or shortly
 void TxStatsBase::Clear(void) // this is called when transmit starts, or shortly after
 {
     stats.Clear();
+    arq.Clear();
 
     LQma_valid.Reset(); // start with 100% if not connected
     LQma_received.Reset();
@@ -0,0 +1,73 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Benchmark FIFO
+//*******************************************************
+// Throughput of FifoBase of fifo.h, with the element-wise, the buffer and the span
+// functions, in chunks of a frame payload. Cycles are those of the host, and only good for
+// comparing the functions.
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/libs/fifo.h"
+
+
+#define SIZE    2048
+#define CHUNK   82 // FRAME_RX_PAYLOAD_LEN
+#define TOTAL   (64 * 1024 * 1024)
+
+FifoBase<uint8_t, SIZE> fifo;
+uint8_t src[CHUNK], dst[CHUNK];
+volatile uint32_t sink;
+
+
+void report(const char* name, uint64_t cycles, double seconds)
+{
+    printf("  %-22s %6.2f cycles/byte  %7.1f MB/s\n", name, (double)cycles / TOTAL, TOTAL / seconds / 1.0e6);
+}
+
+
+int main(void)
+{
+    for (uint16_t n = 0; n < CHUNK; n++) src[n] = n;
+    printf("bench_fifo, %u byte chunks\n", CHUNK);
+
+    fifo.Init();
+    double t = host_seconds();
+    uint64_t c = host_cycles();
+    for (uint32_t i = 0; i < TOTAL; i += CHUNK) {
+        for (uint16_t n = 0; n < CHUNK; n++) fifo.Put(src[n]);
+        for (uint16_t n = 0; n < CHUNK; n++) dst[n] = fifo.Get();
+        sink += dst[i % CHUNK];
+    }
+    report("Put()/Get()", host_cycles() - c, host_seconds() - t);
+
+    fifo.Init();
+    t = host_seconds();
+    c = host_cycles();
+    for (uint32_t i = 0; i < TOTAL; i += CHUNK) {
+        fifo.PutBuf(src, CHUNK);
+        fifo.GetBuf(dst, CHUNK);
+        sink += dst[i % CHUNK];
+    }
+    report("PutBuf()/GetBuf()", host_cycles() - c, host_seconds() - t);
+
+    fifo.Init();
+    t = host_seconds();
+    c = host_cycles();
+    for (uint32_t i = 0; i < TOTAL; i += CHUNK) {
+        fifo.PutBuf(src, CHUNK);
+        uint16_t len;
+        uint8_t* r = fifo.ReadSpan(&len);
+        if (len > CHUNK) len = CHUNK;
+        memcpy(dst, r, len); // that's where the frame packing would read from
+        fifo.Consume(len);
+        sink += dst[0];
+    }
+    report("PutBuf()/ReadSpan()", host_cycles() - c, host_seconds() - t);
+
+    return 0;
+}
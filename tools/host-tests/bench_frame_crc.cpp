@@ -0,0 +1,105 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Benchmark Frame CRC
+//*******************************************************
+// The slicing-by-4 engine of frame_crc.h, against the bytewise table and the bitwise X.25
+// crc. The latter two are those of fastmavlink with and without FASTMAVLINK_CRC_LOOKUP_TABLE,
+// repeated here, since the fastmavlink submodule is not needed for the host build. The table
+// is the same as frame_crc_table0. The hw crc unit can't be run on the host.
+//
+// All engines are first checked to give the same results. Cycles are those of the host, and
+// only good for comparing the engines.
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/frame_crc.h"
+#include "../../mLRS/Common/frame_types.h"
+
+
+#define LEN     (FRAME_TX_RX_LEN - 2) // the crc covers the frame without the crc
+#define TOTAL   (64 * 1024 * 1024)
+
+uint8_t buf[LEN];
+volatile uint16_t sink;
+
+
+// as fmav_crc_accumulate() without lookup table
+void crc_accumulate_bitwise(uint16_t* crc, const uint8_t* data, uint16_t len)
+{
+    while (len--) {
+        uint8_t tmp = *data++ ^ (uint8_t)(*crc & 0xFF);
+        tmp ^= (tmp << 4);
+        *crc = (*crc >> 8) ^ ((uint16_t)tmp << 8) ^ ((uint16_t)tmp << 3) ^ (tmp >> 4);
+    }
+}
+
+
+// as fmav_crc_accumulate() with lookup table
+void crc_accumulate_table(uint16_t* crc, const uint8_t* data, uint16_t len)
+{
+    while (len--) {
+        *crc = (*crc >> 8) ^ frame_crc_table0[(*crc ^ *data++) & 0xFF];
+    }
+}
+
+
+void report(const char* name, uint64_t cycles, double seconds)
+{
+    printf("  %-16s %6.2f cycles/byte  %7.1f MB/s\n", name, (double)cycles / TOTAL, TOTAL / seconds / 1.0e6);
+}
+
+
+int main(void)
+{
+uint32_t rnd = 1;
+
+    printf("bench_frame_crc, %u byte frames\n", LEN);
+
+    for (uint32_t i = 0; i < 100000; i++) {
+        rnd = rnd * 1103515245 + 12345;
+        uint16_t len = (rnd >> 16) % (LEN + 1);
+        uint16_t split = (len) ? (rnd >> 8) % len : 0;
+        for (uint16_t n = 0; n < len; n++) buf[n] = rnd >> (n % 24);
+
+        uint16_t crc_bitwise = 0xFFFF, crc_table = 0xFFFF, crc;
+        crc_accumulate_bitwise(&crc_bitwise, buf, len);
+        crc_accumulate_table(&crc_table, buf, len);
+        frame_crc_init(&crc);
+        frame_crc_accumulate_buf(&crc, buf, split); // continues from any value, as the frames.h calls do
+        frame_crc_accumulate_buf(&crc, buf + split, len - split);
+        CHECK_EQ(crc_table, crc_bitwise);
+        CHECK_EQ(crc, crc_bitwise);
+        if (host_checks_failed) return host_result("bench_frame_crc");
+    }
+
+    double t = host_seconds();
+    uint64_t c = host_cycles();
+    for (uint32_t i = 0; i < TOTAL; i += LEN) {
+        uint16_t crc = 0xFFFF;
+        crc_accumulate_bitwise(&crc, buf, LEN);
+        sink = crc;
+    }
+    report("bitwise", host_cycles() - c, host_seconds() - t);
+
+    t = host_seconds();
+    c = host_cycles();
+    for (uint32_t i = 0; i < TOTAL; i += LEN) {
+        uint16_t crc = 0xFFFF;
+        crc_accumulate_table(&crc, buf, LEN);
+        sink = crc;
+    }
+    report("table", host_cycles() - c, host_seconds() - t);
+
+    t = host_seconds();
+    c = host_cycles();
+    for (uint32_t i = 0; i < TOTAL; i += LEN) {
+        sink = frame_crc_calculate(buf, LEN);
+    }
+    report("slicing-by-4", host_cycles() - c, host_seconds() - t);
+
+    return 0;
+}
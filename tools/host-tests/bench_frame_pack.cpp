@@ -0,0 +1,108 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Benchmark Frame Packing
+//*******************************************************
+// The part of prepare_transmit_frame() from the serial fifo to the packed Rx frame, which
+// must be done between the clock tick and sxSendFrame(), in the two ways it was done:
+//
+// - old: the payload is read byte-wise with available()/getc() into a stack buffer, the
+//   frame is cleared, and the payload is copied into it
+// - new: the payload is read with GetBuf() right into the frame, which is packed in place
+//
+// Both use the frame crc of the host config, see bench_frame_crc for the crc itself. The
+// fifo is refilled for each frame, this cost is measured alone and taken out. Cycles are
+// those of the host, and only good for comparing the two.
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/frames.h"
+#include "../../mLRS/Common/libs/fifo.h"
+
+
+tRcCoding rc_coding;
+tLatencyTrace latency_trace;
+
+
+#define FRAMES  2000000
+
+FifoBase<uint8_t, 2048> fifo; // as the serial rx fifo
+uint8_t src[FRAME_RX_PAYLOAD_LEN];
+tRxFrame rxFrame;
+tFrameStats frame_stats = {};
+volatile uint32_t sink;
+
+
+void refill(void)
+{
+    fifo.PutBuf(src, FRAME_RX_PAYLOAD_LEN_USABLE);
+}
+
+
+void pack_old(void)
+{
+uint8_t payload[FRAME_RX_PAYLOAD_LEN];
+uint8_t payload_len = 0;
+
+    while (fifo.Available() && payload_len < FRAME_RX_PAYLOAD_LEN_USABLE) {
+        payload[payload_len++] = fifo.Get();
+    }
+    memset(&rxFrame, 0, sizeof(tRxFrame));
+    pack_rxframe(&rxFrame, &frame_stats, payload, payload_len);
+}
+
+
+void pack_new(void)
+{
+    uint8_t payload_len = fifo.GetBuf(rxFrame.payload, FRAME_RX_PAYLOAD_LEN_USABLE);
+    pack_rxframe(&rxFrame, &frame_stats, rxFrame.payload, payload_len);
+}
+
+
+uint64_t run(void (*pack)(void))
+{
+    fifo.Init();
+    uint64_t c = host_cycles();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        refill();
+        if (pack) pack();
+        sink += rxFrame.crc;
+    }
+    return host_cycles() - c;
+}
+
+
+int main(void)
+{
+tRxFrame frame_old;
+
+    Config.FrameSyncWord = 0x1234;
+    Config.UseFec = false;
+    for (uint8_t n = 0; n < FRAME_RX_PAYLOAD_LEN; n++) src[n] = n;
+
+    printf("bench_frame_pack, %u byte payloads\n", FRAME_RX_PAYLOAD_LEN_USABLE);
+
+    // both give the same frame
+    fifo.Init();
+    refill();
+    pack_old();
+    memcpy(&frame_old, &rxFrame, sizeof(tRxFrame));
+    refill();
+    memset(&rxFrame, 0xAA, sizeof(tRxFrame)); // the new path must not rely on a cleared frame
+    pack_new();
+    CHECK(!memcmp(&frame_old, &rxFrame, sizeof(tRxFrame)));
+    CHECK_EQ(check_rxframe(&rxFrame), CHECK_OK);
+    if (host_checks_failed) return host_result("bench_frame_pack");
+
+    uint64_t base = run(nullptr);
+    uint64_t old_path = run(pack_old);
+    uint64_t new_path = run(pack_new);
+
+    printf("  %-24s %6.0f cycles/frame\n", "getc() + copy (old)", (double)(old_path - base) / FRAMES);
+    printf("  %-24s %6.0f cycles/frame\n", "GetBuf() in place (new)", (double)(new_path - base) / FRAMES);
+
+    return 0;
+}
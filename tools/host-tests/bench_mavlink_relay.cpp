@@ -0,0 +1,216 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Benchmark MAVLink Relay
+//*******************************************************
+// The relay of the parsed MAVLink frames in MavlinkBase, with the frame buf going directly into
+// the link out queue, or into the MavlinkX converter, or to the serial port, against the old
+// round trip via fmav_message_t, which went fmav_frame_buf_to_msg() and fmav_msg_to_frame_buf()
+// or fmavX_msg_to_frame_buf().
+//
+// Paths:
+// - serial in -> link out, MAVLink mode: frame buf -> queue
+// - serial in -> link out, MAVLinkX mode: frame buf -> fmavX frame -> queue, with compression
+//   off and on
+// - link in -> serial out: frame buf -> serial
+//
+// Reports host cycles per message and bytes per second of the relay, i.e. from the parsed frame
+// buf to the queue or serial, the parser is the same for both and not included. Checks that
+// both give the same bytes.
+//
+// What is not the firmware: fastmavlink, see host_mavlink.h, and the serial, which takes the
+// bytes into a fifo. The queue is emptied after each message, this is not in the cycles.
+//
+// usage: bench_mavlink_relay [--synth telemetry|params|ftp] [--seconds n] [--seed n]
+//                            [--passes n] [log1.tlog ...]
+//*******************************************************
+
+#include "host.h"
+#include "host_mavlink.h"
+#include "../../mLRS/Common/mavlink/mavlink_queue.h"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized" // RLE_char in _fmavX_payload_compress(), is set before it is used
+#include "../../mLRS/Common/thirdparty/fmav_mavlinkx.h"
+#pragma GCC diagnostic pop
+
+
+tHostMavlinkStream stream;
+tMavlinkQueue queue_link_out;
+StatsLatency queue_latency[MAVLINK_PRIO_NUM];
+fmav_message_t msg;
+uint8_t _buf[MAVLINKX_FRAME_LEN_MAX];
+
+
+// takes the bytes into a fifo, as the serial's putc does, and records them if out is set
+class tBenchSerial : public tSerialBase
+{
+  public:
+    void putc(char c) override
+    {
+        fifo[pos++ & 1023] = c;
+        if (out) out->push_back(c);
+    }
+
+    uint8_t fifo[1024];
+    uint16_t pos;
+    std::vector<uint8_t>* out;
+};
+
+tBenchSerial serial;
+
+
+typedef enum {
+    PATH_LINK_OUT_MAVLINK = 0,
+    PATH_LINK_OUT_MAVLINKX,
+    PATH_LINK_OUT_MAVLINKX_COMPRESSED,
+    PATH_SERIAL_OUT,
+    PATH_NUM,
+} PATH_ENUM;
+
+const char* path_str[PATH_NUM] = {
+    "serial in -> link out, mavlink   ",
+    "serial in -> link out, mavlinkX  ",
+    "serial in -> link out, mavlinkX c",
+    "link in -> serial out            ",
+};
+
+
+typedef struct {
+    uint64_t cycles;
+    uint32_t msgs;
+    uint32_t bytes_in;
+    std::vector<uint8_t> out;
+} tBenchResult;
+
+
+void drain(std::vector<uint8_t>* out)
+{
+uint8_t buf[64];
+
+    while (queue_link_out.Available()) {
+        uint16_t n = queue_link_out.GetBuf(buf, sizeof(buf));
+        if (out) out->insert(out->end(), buf, buf + n);
+    }
+}
+
+
+// the first pass records the output and is not timed
+void relay(tBenchResult* r, uint8_t path, bool old, uint32_t passes)
+{
+    fmavX_config_compression((path == PATH_LINK_OUT_MAVLINKX_COMPRESSED) ? 1 : 0);
+
+    for (uint32_t pass = 0; pass <= passes; pass++) {
+        std::vector<uint8_t>* out = (pass == 0) ? &(r->out) : nullptr;
+        serial.out = out;
+
+        for (uint32_t i = 0; i < stream.frames.size(); i++) {
+            uint8_t* frame_buf = stream.Frame(i);
+            fmav_result_t* result = &(stream.frames[i].result);
+
+            uint64_t t0 = host_cycles();
+
+            if (path == PATH_SERIAL_OUT) {
+                if (old) {
+                    fmav_frame_buf_to_msg(&msg, result, frame_buf);
+                    uint16_t len = fmav_msg_to_frame_buf(_buf, &msg);
+                    serial.putbuf(_buf, len);
+                } else {
+                    serial.putbuf(frame_buf, result->frame_len);
+                }
+            } else {
+                if (old) {
+                    fmav_frame_buf_to_msg(&msg, result, frame_buf);
+                    uint16_t len;
+                    if (path == PATH_LINK_OUT_MAVLINK) {
+                        len = fmav_msg_to_frame_buf(_buf, &msg);
+                    } else {
+                        len = fmavX_msg_to_frame_buf(_buf, &msg);
+                    }
+                    queue_link_out.Put(_buf, len, result);
+                } else {
+                    if (path == PATH_LINK_OUT_MAVLINK) {
+                        queue_link_out.Put(frame_buf, result->frame_len, result);
+                    } else {
+                        uint16_t len = fmavX_frame_buf_to_frame_buf(_buf, result, frame_buf);
+                        queue_link_out.Put(_buf, len, result);
+                    }
+                }
+            }
+
+            uint64_t t1 = host_cycles();
+            if (pass > 0) {
+                r->cycles += t1 - t0;
+                r->msgs++;
+                r->bytes_in += result->frame_len;
+            }
+
+            drain(out);
+        }
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+const char* synth = "telemetry";
+uint32_t seconds = 60;
+uint32_t seed = 1;
+uint32_t passes = 20;
+uint8_t tlog_num = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2)) {
+            if (!stream.ReadTlog(argv[i])) { printf("can't read %s\n", argv[i]); return 1; }
+            tlog_num++;
+            continue;
+        }
+        if (i + 1 >= argc) { printf("option %s needs a value\n", argv[i]); return 1; }
+        const char* s = argv[++i];
+        uint32_t v = strtoul(s, nullptr, 10);
+        if (!strcmp(argv[i - 1], "--synth")) { synth = s; }
+        else if (!strcmp(argv[i - 1], "--seconds")) { seconds = v; }
+        else if (!strcmp(argv[i - 1], "--seed")) { seed = v; }
+        else if (!strcmp(argv[i - 1], "--passes")) { passes = (v) ? v : 1; }
+        else { printf("unknown option %s\n", argv[i - 1]); return 1; }
+    }
+
+    if (!tlog_num) {
+        if (!stream.MakeSynth(synth, seconds, seed)) { printf("unknown synth %s\n", synth); return 1; }
+    } else {
+        if (stream.frames.empty()) { printf("no messages in the tlogs\n"); return 1; }
+    }
+
+    fmavX_init();
+    queue_link_out.Init(queue_latency);
+    for (uint8_t n = 0; n < MAVLINK_PRIO_NUM; n++) queue_latency[n].Init();
+
+    // calibrate the host cycles
+    double s0 = host_seconds();
+    uint64_t c0 = host_cycles();
+    while (host_seconds() - s0 < 0.1) {}
+    double cycles_per_s = (host_cycles() - c0) / (host_seconds() - s0);
+
+    printf("bench_mavlink_relay, %s, %u msgs, %u bytes, %u passes\n",
+        (tlog_num) ? "tlog" : synth, (unsigned)stream.frames.size(), (unsigned)stream.bytes, (unsigned)passes);
+    printf("  path                                   cycles/msg          MB/s\n");
+    printf("                                         old    new      old    new\n");
+
+    bool same = true;
+    for (uint8_t path = 0; path < PATH_NUM; path++) {
+        tBenchResult r_old = {}, r_new = {};
+        relay(&r_old, path, true, passes);
+        relay(&r_new, path, false, passes);
+        if (r_old.out != r_new.out) same = false;
+
+        printf("  %s  %6.0f %6.0f   %6.1f %6.1f\n", path_str[path],
+            (double)r_old.cycles / r_old.msgs, (double)r_new.cycles / r_new.msgs,
+            r_old.bytes_in / (r_old.cycles / cycles_per_s) * 1.0e-6, r_new.bytes_in / (r_new.cycles / cycles_per_s) * 1.0e-6);
+    }
+    printf("  RAM saved per fmav_message_t  %u bytes\n", (unsigned)sizeof(fmav_message_t));
+    printf("  output of old and new %s\n", (same) ? "is the same" : "DIFFERS");
+
+    return (same) ? 0 : 1;
+}
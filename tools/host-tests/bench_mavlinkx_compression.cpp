@@ -0,0 +1,147 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Benchmark MavlinkX Compression
+//*******************************************************
+// The MavlinkX frames as the Rx sends them in 19 Hz mode, with X4 only, with the dictionary
+// of mavlinkx_dict.h, with the delta coding, and with both, as in the firmware.
+//
+// Reports the bytes of the MAVLink v2 frames and of the MavlinkX frames, and host cycles per
+// message of fmavX_frame_buf_to_frame_buf(). Without delta coding, each MavlinkX frame is
+// parsed back with fmavX_parse_and_check_to_frame_buf(), and must give the MAVLink v2 frame.
+// The delta coding has one table for both ends, so it can't be checked here, all link frames
+// are taken as acked.
+//
+// The dictionary is generated from synthetic messages with seed 1, so this runs by default
+// on other synthetic messages, with seed 2.
+//
+// What is not the firmware: fastmavlink, see host_mavlink.h.
+//
+// usage: bench_mavlinkx_compression [--synth telemetry|params|ftp] [--seconds n] [--seed n]
+//                                   [log1.tlog ...]
+//*******************************************************
+
+#include "host.h"
+#include "host_mavlink.h"
+#include "../../mLRS/Common/mavlink/mavlink_queue.h"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized" // RLE_char in _fmavX_payload_compress(), is set before it is used
+#include "../../mLRS/Common/thirdparty/fmav_mavlinkx.h"
+#pragma GCC diagnostic pop
+#include "../../mLRS/Common/mavlink/mavlinkx_dict.h"
+
+
+tHostMavlinkStream stream;
+
+
+typedef enum {
+    CODING_X4 = 0,
+    CODING_X4_DICT,
+    CODING_X4_DELTA,
+    CODING_X4_DELTA_DICT,
+    CODING_NUM,
+} CODING_ENUM;
+
+const char* coding_str[CODING_NUM] = { "X4          ", "X4 + dict   ", "X4 + delta  ", "X4 + both   " };
+
+
+typedef struct {
+    uint32_t bytes_x;
+    uint64_t cycles;
+    uint32_t dict_coded;
+    uint32_t delta_coded;
+    uint32_t errors;
+} tBenchResult;
+
+
+void run(tBenchResult* r, uint8_t coding)
+{
+uint8_t xbuf[MAVLINKX_FRAME_LEN_MAX];
+uint8_t buf[FASTMAVLINK_FRAME_LEN_MAX];
+fmav_result_t result;
+fmav_status_t status = {};
+
+    bool dict = (coding == CODING_X4_DICT || coding == CODING_X4_DELTA_DICT);
+    bool delta = (coding == CODING_X4_DELTA || coding == CODING_X4_DELTA_DICT);
+
+    fmavX_init();
+    fmavX_config_compression(1);
+    if (delta) fmavX_config_delta(MAVLINKX_DELTA_ENCODE, mavlink_msgid_is_periodic);
+    if (dict) fmavX_config_dictionary(mavlinkx_dict, MAVLINKX_DICT_NUM);
+    fmav_parse_reset(&status);
+
+    for (uint32_t i = 0; i < stream.frames.size(); i++) {
+        uint8_t* frame_buf = stream.Frame(i);
+
+        uint64_t t0 = host_cycles();
+        uint16_t len = fmavX_frame_buf_to_frame_buf(xbuf, &(stream.frames[i].result), frame_buf);
+        r->cycles += host_cycles() - t0;
+
+        r->bytes_x += len;
+        if (xbuf[2] & MAVLINKX_FLAGS_IS_DICT_CODED) r->dict_coded++;
+        if (xbuf[2] & MAVLINKX_FLAGS_IS_DELTA_CODED) r->delta_coded++;
+
+        if (delta) { // the whole frame went out, and the Tx got it
+            fmavX_delta_msg_sent();
+            fmavX_delta_link_ack(1);
+            continue;
+        }
+
+        bool ok = false;
+        for (uint16_t n = 0; n < len; n++) {
+            if (fmavX_parse_and_check_to_frame_buf(&result, buf, &status, xbuf[n])) {
+                ok = (n == len - 1 && result.frame_len == stream.frames[i].len && !memcmp(buf, frame_buf, result.frame_len));
+            }
+        }
+        if (!ok) r->errors++;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+const char* synth = "telemetry";
+uint32_t seconds = 600;
+uint32_t seed = 2;
+uint8_t tlog_num = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2)) {
+            if (!stream.ReadTlog(argv[i])) { printf("can't read %s\n", argv[i]); return 1; }
+            tlog_num++;
+            continue;
+        }
+        if (i + 1 >= argc) { printf("option %s needs a value\n", argv[i]); return 1; }
+        const char* s = argv[++i];
+        uint32_t v = strtoul(s, nullptr, 10);
+        if (!strcmp(argv[i - 1], "--synth")) { synth = s; }
+        else if (!strcmp(argv[i - 1], "--seconds")) { seconds = v; }
+        else if (!strcmp(argv[i - 1], "--seed")) { seed = v; }
+        else { printf("unknown option %s\n", argv[i - 1]); return 1; }
+    }
+
+    if (!tlog_num) {
+        if (!stream.MakeSynth(synth, seconds, seed)) { printf("unknown synth %s\n", synth); return 1; }
+    } else {
+        if (stream.frames.empty()) { printf("no messages in the tlogs\n"); return 1; }
+    }
+
+    printf("bench_mavlinkx_compression, %s, %u msgs, %u bytes, dictionary with %u msgids\n",
+        (tlog_num) ? "tlog" : synth, (unsigned)stream.frames.size(), (unsigned)stream.bytes, MAVLINKX_DICT_NUM);
+    printf("  coding        bytes  ratio  cycles/msg  dict coded  delta coded  errors\n");
+
+    uint32_t errors = 0;
+    for (uint8_t coding = 0; coding < CODING_NUM; coding++) {
+        tBenchResult r = {};
+        run(&r, coding);
+        errors += r.errors;
+        printf("  %s %7u  %5.3f  %10.0f  %10u  %11u  %6u\n", coding_str[coding],
+            (unsigned)r.bytes_x, (double)r.bytes_x / stream.bytes, (double)r.cycles / stream.frames.size(),
+            (unsigned)r.dict_coded, (unsigned)r.delta_coded, (unsigned)r.errors);
+    }
+
+    return (errors) ? 1 : 0;
+}
@@ -0,0 +1,522 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Benchmark Serial Pipeline
+//*******************************************************
+// The MAVLink messages from the vehicle to the GCS, through the firmware's serial rx fifo,
+// MAVLink queue, ARQ and frames of the Rx, and frames, ARQ and serial tx fifo of the Tx, with
+// the frame loop of a mode. To compare changes against a baseline.
+//
+// Reports goodput, per-message latency percentiles per class of the queue, high-water marks,
+// and host cycles per byte of the firmware code.
+//
+// What is not the firmware:
+// - MavlinkBase and MavlinkX need fastmavlink, so the messages are relayed as MAVLink v2, as
+//   in the MAVLink mode. The parser is replaced by a splitter which takes the frame length
+//   from the header. It is included in the cycles.
+// - The crc of each message is replaced by its index, so that it can be found at the
+//   output. The crc is not checked anywhere here.
+// - Messages are put into the serial rx fifo whole, when the UART would have finished them.
+//   A message which doesn't fit is lost.
+// - Frames are lost at random in both directions. The frames alternate strictly, the main
+//   loops, fhss, and the downlink slots are not run.
+//
+// The messages come from tlogs, or from a synthetic stream:
+// - telemetry: streams as ArduPilot sends them, about 1.3 kB/s
+// - params: telemetry, and 1000 PARAM_VALUE at 1 s
+// - ftp: telemetry, and 500 FILE_TRANSFER_PROTOCOL at 1 s
+// Of tlogs, only the MAVLink v2 messages not from a GCS (sysid 255) are taken.
+//
+// usage: bench_serial [--mode 50hz|31hz|19hz|flrc|fsk] [--baud n] [--loss ppm] [--arq 0|1]
+//                     [--fec 0|1] [--synth telemetry|params|ftp] [--seconds n] [--seed n]
+//                     [log1.tlog ...]
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/frames.h"
+#include "../../mLRS/Common/arq.h"
+#include "../../mLRS/Common/libs/fifo.h"
+#include <vector>
+#include <algorithm>
+
+
+tRcCoding rc_coding;
+tLatencyTrace latency_trace;
+
+
+//-------------------------------------------------------
+// fastmavlink
+//-------------------------------------------------------
+// what mavlink_queue.h needs of it
+
+typedef enum {
+    FASTMAVLINK_PARSE_RESULT_NONE = 0,
+    FASTMAVLINK_PARSE_RESULT_OK,
+} fmav_parse_result_e;
+
+typedef struct
+{
+    uint8_t res;
+    uint16_t frame_len;
+    uint32_t msgid;
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t target_sysid;
+    uint8_t target_compid;
+    uint8_t crc_extra;
+} fmav_result_t;
+
+#define FASTMAVLINK_MSG_ID_HEARTBEAT                0
+#define FASTMAVLINK_MSG_ID_SYS_STATUS               1
+#define FASTMAVLINK_MSG_ID_SYSTEM_TIME              2
+#define FASTMAVLINK_MSG_ID_SET_MODE                 11
+#define FASTMAVLINK_MSG_ID_PARAM_VALUE              22
+#define FASTMAVLINK_MSG_ID_GPS_RAW_INT              24
+#define FASTMAVLINK_MSG_ID_RAW_IMU                  27
+#define FASTMAVLINK_MSG_ID_SCALED_PRESSURE          29
+#define FASTMAVLINK_MSG_ID_ATTITUDE                 30
+#define FASTMAVLINK_MSG_ID_ATTITUDE_QUATERNION      31
+#define FASTMAVLINK_MSG_ID_LOCAL_POSITION_NED       32
+#define FASTMAVLINK_MSG_ID_GLOBAL_POSITION_INT      33
+#define FASTMAVLINK_MSG_ID_SERVO_OUTPUT_RAW         36
+#define FASTMAVLINK_MSG_ID_MISSION_CURRENT          42
+#define FASTMAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT    62
+#define FASTMAVLINK_MSG_ID_RC_CHANNELS              65
+#define FASTMAVLINK_MSG_ID_MANUAL_CONTROL           69
+#define FASTMAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE     70
+#define FASTMAVLINK_MSG_ID_VFR_HUD                  74
+#define FASTMAVLINK_MSG_ID_COMMAND_INT              75
+#define FASTMAVLINK_MSG_ID_COMMAND_LONG             76
+#define FASTMAVLINK_MSG_ID_COMMAND_ACK              77
+#define FASTMAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL   110
+#define FASTMAVLINK_MSG_ID_TERRAIN_REPORT           136
+#define FASTMAVLINK_MSG_ID_BATTERY_STATUS           147
+#define FASTMAVLINK_MSG_ID_FENCE_STATUS             162
+#define FASTMAVLINK_MSG_ID_RANGEFINDER              173
+#define FASTMAVLINK_MSG_ID_RPM                      226
+#define FASTMAVLINK_MSG_ID_VIBRATION                241
+#define FASTMAVLINK_MSG_ID_EXTENDED_SYS_STATE       245
+#define FASTMAVLINK_MSG_ID_STATUSTEXT               253
+
+#include "../../mLRS/Common/mavlink/mavlink_queue.h"
+
+
+//-------------------------------------------------------
+// Messages
+//-------------------------------------------------------
+
+typedef struct
+{
+    uint32_t t_us; // when the vehicle sends it
+    uint32_t pos; // in msg_data
+    uint16_t len;
+    uint32_t msgid;
+    uint32_t t_delivered_us; // 0 if not delivered
+} tBenchMsg;
+
+std::vector<tBenchMsg> msgs;
+std::vector<uint8_t> msg_data;
+
+
+uint32_t rnd_state = 1;
+
+uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+
+void add_msg(uint32_t t_us, uint8_t* frame, uint16_t len, uint32_t msgid)
+{
+    tBenchMsg m = { t_us, (uint32_t)msg_data.size(), len, msgid, 0 };
+    msg_data.insert(msg_data.end(), frame, frame + len);
+    msgs.push_back(m);
+}
+
+
+void add_synth_msg(uint32_t t_us, uint32_t msgid, uint8_t payload_len, uint8_t* seq)
+{
+uint8_t frame[280];
+
+    frame[0] = 0xFD;
+    frame[1] = payload_len;
+    frame[2] = frame[3] = 0;
+    frame[4] = (*seq)++;
+    frame[5] = frame[6] = 1;
+    frame[7] = msgid; frame[8] = msgid >> 8; frame[9] = msgid >> 16;
+    for (uint8_t n = 0; n < payload_len; n++) frame[10 + n] = rnd();
+    add_msg(t_us, frame, 12 + payload_len, msgid);
+}
+
+
+// msgid, rate in Hz, payload len, as ArduPilot sends them
+const uint16_t synth_telemetry[][3] = {
+    { 0, 1, 9 }, { 1, 2, 31 }, { 24, 2, 30 }, { 30, 10, 28 }, { 33, 5, 28 }, { 74, 5, 20 },
+    { 62, 2, 26 }, { 65, 2, 42 }, { 147, 1, 36 }, { 2, 1, 12 }, { 42, 1, 2 }, { 241, 1, 32 },
+};
+
+
+void make_synth(const char* kind, uint32_t seconds)
+{
+uint8_t seq = 0;
+
+    for (uint8_t i = 0; i < ARRAY_LEN(synth_telemetry); i++) {
+        uint32_t rate = synth_telemetry[i][1];
+        for (uint32_t n = 0; n < seconds * rate; n++) {
+            add_synth_msg((n * 1000000) / rate + rnd() % 1000, synth_telemetry[i][0], synth_telemetry[i][2], &seq);
+        }
+    }
+    if (!strcmp(kind, "params")) {
+        for (uint32_t n = 0; n < 1000; n++) add_synth_msg(1000000 + n * 100, FASTMAVLINK_MSG_ID_PARAM_VALUE, 25, &seq);
+    }
+    if (!strcmp(kind, "ftp")) {
+        for (uint32_t n = 0; n < 500; n++) add_synth_msg(1000000 + n * 100, FASTMAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 251, &seq);
+    }
+
+    std::vector<uint8_t> data;
+    data.swap(msg_data);
+    std::vector<tBenchMsg> m;
+    m.swap(msgs);
+    std::stable_sort(m.begin(), m.end(), [](const tBenchMsg& a, const tBenchMsg& b) { return a.t_us < b.t_us; });
+    for (uint32_t i = 0; i < m.size(); i++) add_msg(m[i].t_us, &data[m[i].pos], m[i].len, m[i].msgid);
+}
+
+
+// a record is a 64 bit big endian time in us, followed by the frame
+bool read_tlog(const char* filename, uint32_t t_offset_us)
+{
+FILE* fp = fopen(filename, "rb");
+uint8_t rec[8 + 280];
+uint64_t t0_us = 0;
+bool t0_set = false;
+
+    if (!fp) return false;
+
+    while (fread(rec, 1, 8 + 2, fp) == 8 + 2) {
+        if (rec[8] != 0xFD && rec[8] != 0xFE) { // not in sync, search for the next record
+            fseek(fp, -(8 + 2 - 1), SEEK_CUR);
+            continue;
+        }
+        uint16_t len = (rec[8] == 0xFD) ? 12 + rec[9] : 8 + rec[9];
+        if (fread(rec + 10, 1, len - 2, fp) != (size_t)(len - 2)) break;
+        if (rec[8] == 0xFD && (rec[10] & 0x01)) { // signed
+            if (fread(rec + 8 + len, 1, 13, fp) != 13) break;
+            len += 13;
+        }
+
+        uint64_t t_us = 0;
+        for (uint8_t n = 0; n < 8; n++) t_us = (t_us << 8) | rec[n];
+        if (!t0_set) { t0_us = t_us; t0_set = true; }
+
+        if (rec[8] != 0xFD || rec[8 + 5] == 255) continue; // only v2, not from a GCS
+        uint32_t msgid = rec[8 + 7] + ((uint32_t)rec[8 + 8] << 8) + ((uint32_t)rec[8 + 9] << 16);
+        add_msg(t_offset_us + (t_us - t0_us), rec + 8, len, msgid);
+    }
+
+    fclose(fp);
+    return true;
+}
+
+
+// the index goes into the crc, so that the message can be found at the output
+void tag_msgs(void)
+{
+    for (uint32_t i = 0; i < msgs.size(); i++) {
+        uint8_t* frame = &msg_data[msgs[i].pos];
+        frame[10 + frame[1]] = i;
+        frame[10 + frame[1] + 1] = i >> 8;
+    }
+}
+
+
+// takes the MAVLink v2 frames out of a byte stream, the length is from the header
+class tSplitter
+{
+  public:
+    void Init(void) { len = 0; }
+
+    // returns true if a frame is complete
+    bool Put(uint8_t c)
+    {
+        if (len == 0 && c != 0xFD) return false; // not in sync
+        buf[len++] = c;
+        if (len < 3) return false;
+        uint16_t frame_len = 12 + buf[1] + ((buf[2] & 0x01) ? 13 : 0);
+        if (len < frame_len) return false;
+        len = 0;
+        return true;
+    }
+
+    uint8_t buf[280];
+    uint16_t len;
+};
+
+
+//-------------------------------------------------------
+// Benchmark
+//-------------------------------------------------------
+
+typedef struct
+{
+    const char* name;
+    uint8_t frame_rate_ms;
+} tBenchMode;
+
+const tBenchMode bench_modes[] = {
+    { "50hz", 20 },
+    { "31hz", 32 },
+    { "19hz", 53 },
+    { "flrc", 9 },
+    { "fsk", 20 },
+};
+
+
+FifoBase<uint8_t, RX_SERIAL_RXBUFSIZE> rx_serial_in; // Rx, from the vehicle
+tMavlinkQueue queue_link_out;
+StatsLatency queue_latency[MAVLINK_PRIO_NUM];
+tSplitter splitter_serial_in;
+tArq rx_arq;
+tRxFrame rxFrame;
+
+FifoBase<uint8_t, TX_SERIAL_TXBUFSIZE> tx_serial_out; // Tx, to the GCS
+tSplitter splitter_serial_out;
+tArq tx_arq;
+tRxFrame rxFrame_tx;
+
+uint32_t hw_serial_in, hw_queue, hw_serial_out; // high-water marks
+uint32_t msgs_lost_serial_in, bytes_lost_serial_out, bytes_link;
+uint64_t cycles_rx, cycles_tx;
+
+
+// as MavlinkBase::Do() of the Rx, parse serial in -> link out
+void rx_do(void)
+{
+fmav_result_t result = {};
+
+    while (rx_serial_in.Available() && queue_link_out.HasSpace(290)) {
+        if (!splitter_serial_in.Put(rx_serial_in.Get())) continue;
+        uint8_t* frame = splitter_serial_in.buf;
+        result.res = FASTMAVLINK_PARSE_RESULT_OK;
+        result.frame_len = 12 + frame[1] + ((frame[2] & 0x01) ? 13 : 0);
+        result.sysid = frame[5];
+        result.compid = frame[6];
+        result.msgid = frame[7] + ((uint32_t)frame[8] << 8) + ((uint32_t)frame[9] << 16);
+        queue_link_out.Put(frame, result.frame_len, &result);
+    }
+}
+
+
+// as prepare_transmit_frame() of the Rx
+void rx_transmit(uint8_t received_ack, uint8_t* seq_no)
+{
+uint8_t payload_len;
+tFrameStats frame_stats = {};
+
+    rx_arq.HandleAck(received_ack);
+    if (rx_arq.Pending()) {
+        payload_len = rx_arq.GetPayload(rxFrame.payload);
+    } else {
+        payload_len = queue_link_out.GetBuf(rxFrame.payload, FRAME_RX_PAYLOAD_LEN_USABLE);
+        if (payload_len) (*seq_no)++;
+        rx_arq.PutPayload(rxFrame.payload, payload_len);
+    }
+    frame_stats.seq_no = *seq_no;
+    pack_rxframe(&rxFrame, &frame_stats, rxFrame.payload, payload_len);
+}
+
+
+// as do_receive() and process_received_frame() of the Tx
+void tx_receive(bool valid)
+{
+    if (valid) valid = (check_rxframe(&rxFrame_tx) == CHECK_OK);
+    tx_arq.SetReceived(valid);
+    if (!valid) return;
+
+    uint8_t len = rxFrame_tx.status.payload_len;
+    if (len && tx_arq.IsDuplicate(rxFrame_tx.status.seq_no)) return;
+    bytes_link += len;
+    uint16_t n = tx_serial_out.PutBuf(rxFrame_tx.payload, len);
+    bytes_lost_serial_out += len - n;
+}
+
+
+void run(const tBenchMode* mode, uint32_t baud, uint32_t loss_ppm, uint32_t seconds)
+{
+uint32_t uart_free_us = 0, next_msg = 0, pending_msg = 0;
+uint32_t uart_out_budget = 0; // in bytes * 1000000
+uint8_t seq_no = 0;
+uint8_t ack_to_rx = 0;
+
+    Config.frame_rate_ms = mode->frame_rate_ms;
+    rx_serial_in.Init();
+    tx_serial_out.Init();
+    queue_link_out.Init(queue_latency);
+    for (uint8_t n = 0; n < MAVLINK_PRIO_NUM; n++) queue_latency[n].Init();
+    splitter_serial_in.Init();
+    splitter_serial_out.Init();
+
+    std::vector<uint32_t> uart_done_us(msgs.size());
+
+    for (uint32_t t_ms = 0; t_ms < seconds * 1000; t_ms++) {
+        host_time_us = t_ms * 1000;
+
+        // vehicle -> UART -> serial in, one message after the other
+        while (next_msg < msgs.size() && msgs[next_msg].t_us <= host_time_us) {
+            uint32_t t_start = (msgs[next_msg].t_us > uart_free_us) ? msgs[next_msg].t_us : uart_free_us;
+            uart_free_us = t_start + ((uint32_t)msgs[next_msg].len * 10 * 1000000) / baud;
+            uart_done_us[next_msg] = uart_free_us;
+            next_msg++;
+        }
+        while (pending_msg < next_msg && uart_done_us[pending_msg] <= host_time_us) {
+            tBenchMsg* m = &msgs[pending_msg++];
+            if (!rx_serial_in.HasSpace(m->len)) { msgs_lost_serial_in++; continue; }
+            rx_serial_in.PutBuf(&msg_data[m->pos], m->len);
+        }
+        if (rx_serial_in.Available() > hw_serial_in) hw_serial_in = rx_serial_in.Available();
+
+        uint64_t c = host_cycles();
+        rx_do();
+        cycles_rx += host_cycles() - c;
+        if (queue_link_out.Available() > hw_queue) hw_queue = queue_link_out.Available();
+
+        // the frames, the Tx frame carries the ack of the Tx, the Rx frame the serial data
+        if ((t_ms % Config.frame_rate_ms) == 0) {
+            bool up_valid = (rnd() % 1000000) >= loss_ppm;
+            c = host_cycles();
+            rx_transmit((up_valid) ? ack_to_rx : 0, &seq_no);
+            cycles_rx += host_cycles() - c;
+
+            bool down_valid = (rnd() % 1000000) >= loss_ppm;
+            if (down_valid) memcpy(&rxFrame_tx, &rxFrame, sizeof(tRxFrame));
+            c = host_cycles();
+            tx_receive(down_valid);
+            cycles_tx += host_cycles() - c;
+            ack_to_rx = tx_arq.Ack();
+        }
+        if (tx_serial_out.Available() > hw_serial_out) hw_serial_out = tx_serial_out.Available();
+
+        // serial out -> UART -> GCS
+        uart_out_budget += baud / 10;
+        while (uart_out_budget >= 1000 && tx_serial_out.Available()) {
+            uart_out_budget -= 1000;
+            if (!splitter_serial_out.Put(tx_serial_out.Get())) continue;
+            uint8_t* frame = splitter_serial_out.buf;
+            uint16_t tag = frame[10 + frame[1]] + ((uint16_t)frame[10 + frame[1] + 1] << 8);
+            // the message with this tag which was send last
+            uint32_t i = (pending_msg & 0xFFFF0000) | tag;
+            if (i >= pending_msg) i -= 0x10000;
+            if (i < msgs.size() && msgs[i].len == 12 + frame[1] + ((frame[2] & 0x01) ? 13 : 0)) {
+                msgs[i].t_delivered_us = host_time_us;
+            }
+        }
+        if (!tx_serial_out.Available()) uart_out_budget = 0;
+    }
+}
+
+
+uint32_t percentile(std::vector<uint32_t>& v, uint32_t p)
+{
+    if (v.empty()) return 0;
+    return v[((v.size() - 1) * p) / 100];
+}
+
+
+int main(int argc, char* argv[])
+{
+const tBenchMode* mode = &bench_modes[2];
+uint32_t baud = 57600;
+uint32_t loss_ppm = 0;
+bool arq = true;
+const char* synth = "telemetry";
+uint32_t seconds = 60;
+uint8_t tlog_num = 0;
+
+    Config.FrameSyncWord = 0x1234;
+    Config.UseFec = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2)) {
+            if (!read_tlog(argv[i], (msgs.empty()) ? 0 : msgs.back().t_us)) { printf("can't read %s\n", argv[i]); return 1; }
+            tlog_num++;
+            continue;
+        }
+        if (i + 1 >= argc) { printf("option %s needs a value\n", argv[i]); return 1; }
+        const char* s = argv[++i];
+        uint32_t v = strtoul(s, nullptr, 10);
+        if (!strcmp(argv[i - 1], "--mode")) {
+            mode = nullptr;
+            for (uint8_t k = 0; k < ARRAY_LEN(bench_modes); k++) if (!strcmp(s, bench_modes[k].name)) mode = &bench_modes[k];
+            if (!mode) { printf("unknown mode %s\n", s); return 1; }
+        }
+        else if (!strcmp(argv[i - 1], "--baud")) { baud = v; }
+        else if (!strcmp(argv[i - 1], "--loss")) { loss_ppm = v; }
+        else if (!strcmp(argv[i - 1], "--arq")) { arq = (v != 0); }
+        else if (!strcmp(argv[i - 1], "--fec")) { Config.UseFec = (v != 0); }
+        else if (!strcmp(argv[i - 1], "--synth")) { synth = s; }
+        else if (!strcmp(argv[i - 1], "--seconds")) { seconds = v; }
+        else if (!strcmp(argv[i - 1], "--seed")) { rnd_state = (v) ? v : 1; }
+        else { printf("unknown option %s\n", argv[i - 1]); return 1; }
+    }
+
+    if (!tlog_num) {
+        if (strcmp(synth, "telemetry") && strcmp(synth, "params") && strcmp(synth, "ftp")) { printf("unknown synth %s\n", synth); return 1; }
+        make_synth(synth, seconds);
+    } else {
+        if (msgs.empty()) { printf("no messages in the tlogs\n"); return 1; }
+        seconds = msgs.back().t_us / 1000000 + 1;
+    }
+    tag_msgs();
+
+    rx_arq.Init();
+    rx_arq.SetEnabled(arq);
+    tx_arq.Init();
+    tx_arq.SetEnabled(arq);
+
+    // some more time at the end, so that what is queued can come out
+    run(mode, baud, loss_ppm, seconds + 5);
+
+    uint32_t bytes_offered = 0, bytes_delivered = 0, msgs_delivered = 0;
+    std::vector<uint32_t> latency[MAVLINK_PRIO_NUM];
+    uint32_t msgs_num[MAVLINK_PRIO_NUM] = {};
+    for (uint32_t i = 0; i < msgs.size(); i++) {
+        uint8_t prio = mavlink_prio_from_msgid(msgs[i].msgid);
+        bytes_offered += msgs[i].len;
+        msgs_num[prio]++;
+        if (!msgs[i].t_delivered_us) continue;
+        bytes_delivered += msgs[i].len;
+        msgs_delivered++;
+        latency[prio].push_back((msgs[i].t_delivered_us - msgs[i].t_us) / 1000);
+    }
+    uint32_t capacity = ((uint32_t)1000 * FRAME_RX_PAYLOAD_LEN_USABLE) / Config.frame_rate_ms;
+
+    printf("bench_serial, %s, %u baud, loss %u ppm, arq %s, fec %s, %s, %u s\n",
+        mode->name, (unsigned)baud, (unsigned)loss_ppm, (arq) ? "on" : "off", (Config.UseFec) ? "on" : "off",
+        (tlog_num) ? "tlog" : synth, (unsigned)seconds);
+    printf("  offered     %6.0f B/s, %u msgs\n", (double)bytes_offered / seconds, (unsigned)msgs.size());
+    printf("  goodput     %6.0f B/s, %u msgs, link capacity %u B/s\n",
+        (double)bytes_delivered / seconds, (unsigned)msgs_delivered, (unsigned)capacity);
+    printf("  not delivered  %u msgs, of which %u lost at serial in, %u bytes lost at serial out\n",
+        (unsigned)(msgs.size() - msgs_delivered), (unsigned)msgs_lost_serial_in, (unsigned)bytes_lost_serial_out);
+    printf("  latency ms  class       msgs  delivered    p50    p90    p99    max\n");
+    const char* prio_names[MAVLINK_PRIO_NUM] = { "high", "telemetry", "bulk" };
+    for (uint8_t prio = 0; prio < MAVLINK_PRIO_NUM; prio++) {
+        std::sort(latency[prio].begin(), latency[prio].end());
+        printf("              %-9s %6u  %9u %6u %6u %6u %6u\n", prio_names[prio],
+            (unsigned)msgs_num[prio], (unsigned)latency[prio].size(),
+            (unsigned)percentile(latency[prio], 50), (unsigned)percentile(latency[prio], 90),
+            (unsigned)percentile(latency[prio], 99), (unsigned)percentile(latency[prio], 100));
+    }
+    printf("  high-water  serial in %u/%u, queue %u/%u, serial out %u/%u\n",
+        (unsigned)hw_serial_in, RX_SERIAL_RXBUFSIZE - 1, (unsigned)hw_queue, MAVLINK_QUEUE_BUF_SIZE,
+        (unsigned)hw_serial_out, TX_SERIAL_TXBUFSIZE - 1);
+    printf("  cycles      Rx %.1f/B, Tx %.1f/B of link payload\n",
+        (bytes_link) ? (double)cycles_rx / bytes_link : 0.0, (bytes_link) ? (double)cycles_tx / bytes_link : 0.0);
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Generate MavlinkX Dictionary
+//*******************************************************
+// Builds the dictionary of the MavlinkX compression, Common/mavlink/mavlinkx_dict.h, from
+// tlogs, or from synthetic telemetry and parameters, see host_mavlink.h.
+//
+// The reference payload of a msgid is the most frequent value at each byte position. A msgid
+// is taken if xor'ing with it before X4 makes its payloads smaller by at least MIN_GAIN_PERCENT
+// than X4 alone. The payload sizes with X4 and with dictionary + X4 are reported per msgid.
+//
+// usage: gen_mavlinkx_dict [--out file] [--tlog-out file] [--seconds n] [--seed n] [log1.tlog ...]
+//   --out       the header is written to file, else it is only reported
+//   --tlog-out  the messages it is generated from are written to file, for the synthetic ones
+//*******************************************************
+
+#include "host.h"
+#include "host_mavlink.h"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized" // RLE_char in _fmavX_payload_compress(), is set before it is used
+#include "../../mLRS/Common/thirdparty/fmav_mavlinkx.h"
+#pragma GCC diagnostic pop
+
+
+#define MIN_GAIN_PERCENT  5
+
+
+tHostMavlinkStream stream;
+
+
+typedef struct {
+    uint32_t msgid;
+    uint32_t num;
+    uint8_t len; // the longest payload
+    uint32_t hist[FASTMAVLINK_PAYLOAD_LEN_MAX][256];
+    uint8_t ref[FASTMAVLINK_PAYLOAD_LEN_MAX];
+    uint8_t ref_len;
+    uint32_t bytes_raw;
+    uint32_t bytes_x4;
+    uint32_t bytes_dict;
+} tDictMsg;
+
+std::vector<tDictMsg*> msgs;
+
+
+tDictMsg* find(uint32_t msgid)
+{
+    for (uint32_t i = 0; i < msgs.size(); i++) if (msgs[i]->msgid == msgid) return msgs[i];
+    tDictMsg* m = (tDictMsg*)calloc(1, sizeof(tDictMsg));
+    m->msgid = msgid;
+    msgs.push_back(m);
+    return m;
+}
+
+
+uint8_t compressed_len(uint8_t* payload, uint8_t len)
+{
+uint8_t out[FASTMAVLINK_PAYLOAD_LEN_MAX + 1];
+uint8_t out_len;
+
+    if (!_fmavX_payload_compress(out, &out_len, payload, len)) return len;
+    return out_len;
+}
+
+
+void build(void)
+{
+    // histograms of the bytes at each position, the zero trimmed bytes are 0
+    for (uint32_t i = 0; i < stream.frames.size(); i++) {
+        uint8_t* buf = stream.Frame(i);
+        if (buf[0] != FASTMAVLINK_MAGIC_V2) continue;
+        tDictMsg* m = find(stream.frames[i].result.msgid);
+        uint8_t len = buf[1];
+        uint8_t max_len = stream.frames[i].result.payload_max_len;
+        if (max_len < len) max_len = len;
+        for (uint8_t n = 0; n < max_len; n++) m->hist[n][(n < len) ? buf[10 + n] : 0]++;
+        if (len > m->len) m->len = len;
+        m->num++;
+    }
+
+    for (uint32_t k = 0; k < msgs.size(); k++) {
+        tDictMsg* m = msgs[k];
+        for (uint8_t n = 0; n < m->len; n++) {
+            uint16_t best = 0;
+            for (uint16_t c = 1; c < 256; c++) if (m->hist[n][c] > m->hist[n][best]) best = c;
+            m->ref[n] = best;
+        }
+        m->ref_len = m->len;
+        while (m->ref_len > 0 && m->ref[m->ref_len - 1] == 0) m->ref_len--; // xor with 0 does nothing
+    }
+
+    // evaluate with the firmware's code
+    for (uint32_t i = 0; i < stream.frames.size(); i++) {
+        uint8_t* buf = stream.Frame(i);
+        if (buf[0] != FASTMAVLINK_MAGIC_V2) continue;
+        tDictMsg* m = find(stream.frames[i].result.msgid);
+        uint8_t len = buf[1];
+        uint8_t payload[FASTMAVLINK_PAYLOAD_LEN_MAX];
+
+        fmavx_dict_entry_t entry = { m->msgid, m->ref_len, m->ref };
+        _fmavX_dict_xor(payload, &buf[10], len, &entry);
+
+        m->bytes_raw += len;
+        m->bytes_x4 += compressed_len(&buf[10], len);
+        m->bytes_dict += compressed_len(payload, len);
+    }
+
+    std::sort(msgs.begin(), msgs.end(), [](const tDictMsg* a, const tDictMsg* b) { return a->msgid < b->msgid; });
+}
+
+
+bool taken(tDictMsg* m)
+{
+    if (!m->ref_len) return false;
+    return (m->bytes_dict * 100 <= m->bytes_x4 * (100 - MIN_GAIN_PERCENT));
+}
+
+
+bool write_header(const char* filename, const char* source)
+{
+FILE* fp = fopen(filename, "w");
+uint8_t num = 0;
+
+    if (!fp) return false;
+
+    fprintf(fp, "//*******************************************************\n");
+    fprintf(fp, "// Copyright (c) MLRS project\n");
+    fprintf(fp, "// GPL3\n");
+    fprintf(fp, "// https://www.gnu.org/licenses/gpl-3.0.de.html\n");
+    fprintf(fp, "// OlliW @ www.olliw.eu\n");
+    fprintf(fp, "//*******************************************************\n");
+    fprintf(fp, "// MavlinkX Dictionary\n");
+    fprintf(fp, "//*******************************************************\n");
+    fprintf(fp, "// generated by tools/host-tests/gen_mavlinkx_dict.cpp, do not edit\n");
+    fprintf(fp, "// from %s\n", source);
+    fprintf(fp, "// must be the same on Tx and Rx\n");
+    fprintf(fp, "//*******************************************************\n");
+    fprintf(fp, "#ifndef MAVLINKX_DICT_H\n");
+    fprintf(fp, "#define MAVLINKX_DICT_H\n");
+    fprintf(fp, "#pragma once\n\n\n");
+
+    for (uint32_t k = 0; k < msgs.size(); k++) {
+        tDictMsg* m = msgs[k];
+        if (!taken(m)) continue;
+        fprintf(fp, "const uint8_t mavlinkx_dict_%u[%u] = {", (unsigned)m->msgid, m->ref_len);
+        for (uint8_t n = 0; n < m->ref_len; n++) {
+            if (n % 16 == 0) fprintf(fp, "\n   ");
+            fprintf(fp, " 0x%02X,", m->ref[n]);
+        }
+        fprintf(fp, "\n};\n\n");
+        num++;
+    }
+
+    fprintf(fp, "\n#define MAVLINKX_DICT_NUM  %u\n\n", num);
+    fprintf(fp, "const fmavx_dict_entry_t mavlinkx_dict[MAVLINKX_DICT_NUM] = {\n");
+    for (uint32_t k = 0; k < msgs.size(); k++) {
+        tDictMsg* m = msgs[k];
+        if (!taken(m)) continue;
+        fprintf(fp, "    { %u, %u, mavlinkx_dict_%u },\n", (unsigned)m->msgid, m->ref_len, (unsigned)m->msgid);
+    }
+    fprintf(fp, "};\n\n\n");
+    fprintf(fp, "#endif // MAVLINKX_DICT_H\n");
+
+    fclose(fp);
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+const char* out = nullptr;
+const char* tlog_out = nullptr;
+uint32_t seconds = 600;
+uint32_t seed = 1;
+uint8_t tlog_num = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2)) {
+            if (!stream.ReadTlog(argv[i])) { printf("can't read %s\n", argv[i]); return 1; }
+            tlog_num++;
+            continue;
+        }
+        if (i + 1 >= argc) { printf("option %s needs a value\n", argv[i]); return 1; }
+        const char* s = argv[++i];
+        uint32_t v = strtoul(s, nullptr, 10);
+        if (!strcmp(argv[i - 1], "--out")) { out = s; }
+        else if (!strcmp(argv[i - 1], "--tlog-out")) { tlog_out = s; }
+        else if (!strcmp(argv[i - 1], "--seconds")) { seconds = v; }
+        else if (!strcmp(argv[i - 1], "--seed")) { seed = v; }
+        else { printf("unknown option %s\n", argv[i - 1]); return 1; }
+    }
+
+    char source[128];
+    if (!tlog_num) {
+        stream.MakeSynth("params", seconds, seed); // is telemetry and parameters
+        snprintf(source, sizeof(source), "synthetic telemetry and parameters, %u s, seed %u", (unsigned)seconds, (unsigned)seed);
+    } else {
+        if (stream.frames.empty()) { printf("no messages in the tlogs\n"); return 1; }
+        snprintf(source, sizeof(source), "%u tlogs", tlog_num);
+    }
+    if (tlog_out && !stream.WriteTlog(tlog_out)) { printf("can't write %s\n", tlog_out); return 1; }
+
+    build();
+
+    printf("gen_mavlinkx_dict, %s, %u msgs\n", source, (unsigned)stream.frames.size());
+    printf("  msgid    num   raw B    X4 B  dict+X4 B  taken\n");
+    uint32_t raw = 0, x4 = 0, dict = 0;
+    for (uint32_t k = 0; k < msgs.size(); k++) {
+        tDictMsg* m = msgs[k];
+        bool t = taken(m);
+        printf("  %5u %6u %7u %7u %10u  %s\n", (unsigned)m->msgid, (unsigned)m->num,
+            (unsigned)m->bytes_raw, (unsigned)m->bytes_x4, (unsigned)m->bytes_dict, (t) ? "yes" : "");
+        raw += m->bytes_raw;
+        x4 += m->bytes_x4;
+        dict += (t) ? m->bytes_dict : m->bytes_x4;
+    }
+    printf("  total payload  raw %u B, X4 %u B (%.1f%%), dict+X4 %u B (%.1f%%)\n",
+        (unsigned)raw, (unsigned)x4, 100.0 * x4 / raw, (unsigned)dict, 100.0 * dict / raw);
+
+    if (out) {
+        if (!write_header(out, source)) { printf("can't write %s\n", out); return 1; }
+        printf("  written to %s\n", out);
+    }
+
+    return 0;
+}
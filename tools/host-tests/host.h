@@ -0,0 +1,170 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Host Build
+//*******************************************************
+// Lets the Common headers, which do not depend on the HAL, fastmavlink or the sx12xx-lib, be
+// compiled with the host's g++. Each test or benchmark is one translation unit, which includes
+// this file first, and then the headers it exercises.
+//
+// The device is a SX1280 receiver with the simulated SX driver, unless the translation unit
+// sets HOST_IS_TRANSMITTER.
+//*******************************************************
+#ifndef HOST_H
+#define HOST_H
+#pragma once
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+
+#ifdef HOST_IS_TRANSMITTER
+  #define DEVICE_IS_TRANSMITTER
+#else
+  #define DEVICE_IS_RECEIVER
+#endif
+#define DEVICE_NAME "host"
+#define DEVICE_HAS_SX128x
+#define DEVICE_HAS_SX_SIM
+#define DEVICE_HAS_DIVERSITY
+#define FREQUENCY_BAND_2P4_GHZ
+
+
+#include "../../mLRS/Common/common_conf.h"
+#include "../../mLRS/Common/common_types.h"
+#include "../../mLRS/Common/setup_types.h"
+
+
+//-------------------------------------------------------
+// Time
+//-------------------------------------------------------
+// the tests run on a virtual clock, which they advance themselves
+
+uint32_t host_time_us;
+
+uint16_t micros(void) { return host_time_us; }
+volatile uint32_t millis32(void) { return host_time_us / 1000; }
+
+
+// for the benchmarks
+static inline uint64_t host_cycles(void)
+{
+#if defined __x86_64__ || defined __i386__
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+
+static inline double host_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+
+//-------------------------------------------------------
+// Globals
+//-------------------------------------------------------
+// these are otherwise provided by setup.h, the hal and common_types.cpp, which need the
+// stm32ll-lib
+
+tSetupMetaData SetupMetaData;
+tSetup Setup;
+tGlobalConfig Config;
+
+const rfpower_t rfpower_list[] = {
+    { .dbm = POWER_0_DBM, .mW = 1 },
+    { .dbm = POWER_10_DBM, .mW = 10 },
+};
+#define RFPOWER_LIST_NUM  sizeof(rfpower_list)/sizeof(rfpower_t)
+
+uint8_t rssi_u7_from_i8(int8_t rssi_i8)
+{
+    if (rssi_i8 == RSSI_INVALID) return RSSI_U7_INVALID;
+    if (rssi_i8 > RSSI_MAX) return RSSI_U7_MAX;
+    if (rssi_i8 < RSSI_MIN) return RSSI_U7_MIN;
+    return -rssi_i8;
+}
+
+int8_t rssi_i8_from_u7(uint8_t rssi_u7)
+{
+    if (rssi_u7 == RSSI_U7_INVALID) return RSSI_INVALID;
+    return -rssi_u7;
+}
+
+uint16_t version_to_u16(uint32_t version)
+{
+    return ((version / 10000) << 12) + (((version / 100) % 100) << 6) + (version % 100);
+}
+
+void strbufstrcpy(char* res, const char* src, uint16_t len)
+{
+    memset(res, '\0', len);
+    strncpy(res, src, len);
+}
+
+void strstrbufcpy(char* res, const char* src, uint16_t len)
+{
+    memset(res, '\0', len + 1);
+    strncpy(res, src, len);
+}
+
+
+//-------------------------------------------------------
+// SX Driver
+//-------------------------------------------------------
+
+// fhss.h needs the frequency registers of the sx12xx-lib, so sx12xx.h is replaced
+#define SX12XX_H
+#define SX1280_FREQ_XTAL_HZ             52000000
+#define SX1280_FREQ_GHZ_TO_REG(f_ghz)   (uint32_t)((double)f_ghz * 1.0E9 * (double)(1 << 18) / (double)SX1280_FREQ_XTAL_HZ)
+
+#include "../../mLRS/Common/sx-drivers/sxsim_driver.h"
+
+#define SX_DRIVER   SxSimDriver
+#define SX2_DRIVER  SxSimDriver2
+
+SX_DRIVER sx;
+SX2_DRIVER sx2;
+
+
+//-------------------------------------------------------
+// Checks
+//-------------------------------------------------------
+
+uint32_t host_checks_failed;
+
+#define CHECK(x) \
+    do { if (!(x)) { host_checks_failed++; printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); } } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { long long _a = (a), _b = (b); \
+        if (_a != _b) { host_checks_failed++; printf("%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, _a, _b); } \
+    } while (0)
+
+static inline int host_result(const char* name)
+{
+    if (host_checks_failed) {
+        printf("%s: FAILED (%u)\n", name, (unsigned)host_checks_failed);
+        return 1;
+    }
+    printf("%s: OK\n", name);
+    return 0;
+}
+
+
+#endif // HOST_H
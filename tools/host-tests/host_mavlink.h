@@ -0,0 +1,601 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Host MAVLink
+//*******************************************************
+// What of fastmavlink is needed by fmav_mavlinkx.h and mavlink_queue.h, so that MavlinkX and
+// the relay path can be compiled with the host's g++, and MAVLink streams from tlogs or
+// synthesized, for the benchmarks.
+//
+// The fastmavlink functions follow fastmavlink, but know only the messages in host_fmav_msgs.
+// A message not in it is taken with crc_extra = 0 and without targets, and fails the crc
+// check.
+//
+// The synthetic telemetry has the messages and rates as ArduPilot sends them, with the
+// fields filled from a simulated flight, so that the payloads change as in real logs.
+//*******************************************************
+#ifndef HOST_MAVLINK_H
+#define HOST_MAVLINK_H
+#pragma once
+
+
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+
+//-------------------------------------------------------
+// fastmavlink
+//-------------------------------------------------------
+
+#define FASTMAVLINK_FUNCTION_DECORATOR  static inline
+
+#define FASTMAVLINK_MAGIC_V1                  0xFE
+#define FASTMAVLINK_MAGIC_V2                  0xFD
+#define FASTMAVLINK_HEADER_V1_LEN             6
+#define FASTMAVLINK_HEADER_V2_LEN             10
+#define FASTMAVLINK_CHECKSUM_LEN              2
+#define FASTMAVLINK_SIGNATURE_LEN             13
+#define FASTMAVLINK_PAYLOAD_LEN_MAX           255
+#define FASTMAVLINK_FRAME_LEN_MAX             280
+#define FASTMAVLINK_INCOMPAT_FLAGS_SIGNED     0x01
+
+
+typedef enum {
+    FASTMAVLINK_PARSE_RESULT_NONE = 0,
+    FASTMAVLINK_PARSE_RESULT_HAS_HEADER,
+    FASTMAVLINK_PARSE_RESULT_OK,
+    FASTMAVLINK_PARSE_RESULT_LENGTH_ERROR,
+    FASTMAVLINK_PARSE_RESULT_CRC_ERROR,
+    FASTMAVLINK_PARSE_RESULT_SIGNATURE_ERROR,
+    FASTMAVLINK_PARSE_RESULT_MSGID_UNKNOWN,
+} fmav_parse_result_e;
+
+
+typedef enum {
+    FASTMAVLINK_PARSE_STATE_IDLE = 0,
+    FASTMAVLINK_PARSE_STATE_LEN,
+    FASTMAVLINK_PARSE_STATE_INCOMPAT_FLAGS,
+    FASTMAVLINK_PARSE_STATE_COMPAT_FLAGS,
+    FASTMAVLINK_PARSE_STATE_SEQ,
+    FASTMAVLINK_PARSE_STATE_SYSID,
+    FASTMAVLINK_PARSE_STATE_COMPID,
+    FASTMAVLINK_PARSE_STATE_MSGID_1,
+    FASTMAVLINK_PARSE_STATE_MSGID_2,
+    FASTMAVLINK_PARSE_STATE_MSGID_3,
+    FASTMAVLINK_PARSE_STATE_PAYLOAD,
+    FASTMAVLINK_PARSE_STATE_CHECKSUM_1,
+    FASTMAVLINK_PARSE_STATE_CHECKSUM_2,
+    FASTMAVLINK_PARSE_STATE_SIGNATURE,
+    FASTMAVLINK_FASTPARSE_STATE_FRAME,
+} fmav_parse_state_e;
+
+
+typedef struct
+{
+    uint8_t res;
+    uint16_t frame_len;
+    uint32_t msgid;
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t target_sysid;
+    uint8_t target_compid;
+    uint8_t crc_extra;
+    uint8_t payload_max_len;
+} fmav_result_t;
+
+
+typedef struct
+{
+    uint16_t rx_cnt;
+    uint16_t rx_header_len;
+    uint16_t rx_frame_len;
+    uint8_t rx_state;
+} fmav_status_t;
+
+
+typedef struct
+{
+    uint8_t magic;
+    uint8_t len;
+    uint8_t incompat_flags;
+    uint8_t compat_flags;
+    uint8_t seq;
+    uint8_t sysid;
+    uint8_t compid;
+    uint32_t msgid;
+    uint8_t payload[FASTMAVLINK_PAYLOAD_LEN_MAX];
+    uint16_t checksum;
+    uint8_t signature_a[FASTMAVLINK_SIGNATURE_LEN];
+    uint8_t crc_extra;
+    uint8_t payload_max_len;
+    uint8_t target_sysid;
+    uint8_t target_compid;
+} fmav_message_t;
+
+
+#define FASTMAVLINK_MSG_ID_HEARTBEAT                0
+#define FASTMAVLINK_MSG_ID_SYS_STATUS               1
+#define FASTMAVLINK_MSG_ID_SYSTEM_TIME              2
+#define FASTMAVLINK_MSG_ID_SET_MODE                 11
+#define FASTMAVLINK_MSG_ID_PARAM_VALUE              22
+#define FASTMAVLINK_MSG_ID_GPS_RAW_INT              24
+#define FASTMAVLINK_MSG_ID_RAW_IMU                  27
+#define FASTMAVLINK_MSG_ID_SCALED_PRESSURE          29
+#define FASTMAVLINK_MSG_ID_ATTITUDE                 30
+#define FASTMAVLINK_MSG_ID_ATTITUDE_QUATERNION      31
+#define FASTMAVLINK_MSG_ID_LOCAL_POSITION_NED       32
+#define FASTMAVLINK_MSG_ID_GLOBAL_POSITION_INT      33
+#define FASTMAVLINK_MSG_ID_SERVO_OUTPUT_RAW         36
+#define FASTMAVLINK_MSG_ID_MISSION_CURRENT          42
+#define FASTMAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT    62
+#define FASTMAVLINK_MSG_ID_RC_CHANNELS              65
+#define FASTMAVLINK_MSG_ID_MANUAL_CONTROL           69
+#define FASTMAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE     70
+#define FASTMAVLINK_MSG_ID_VFR_HUD                  74
+#define FASTMAVLINK_MSG_ID_COMMAND_INT              75
+#define FASTMAVLINK_MSG_ID_COMMAND_LONG             76
+#define FASTMAVLINK_MSG_ID_COMMAND_ACK              77
+#define FASTMAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL   110
+#define FASTMAVLINK_MSG_ID_TERRAIN_REPORT           136
+#define FASTMAVLINK_MSG_ID_BATTERY_STATUS           147
+#define FASTMAVLINK_MSG_ID_FENCE_STATUS             162
+#define FASTMAVLINK_MSG_ID_RANGEFINDER              173
+#define FASTMAVLINK_MSG_ID_RPM                      226
+#define FASTMAVLINK_MSG_ID_VIBRATION                241
+#define FASTMAVLINK_MSG_ID_EXTENDED_SYS_STATE       245
+#define FASTMAVLINK_MSG_ID_STATUSTEXT               253
+
+
+typedef struct
+{
+    uint32_t msgid;
+    uint8_t crc_extra;
+    uint8_t payload_max_len;
+    uint8_t target_sysid_ofs; // 0 if it has none
+    uint8_t target_compid_ofs;
+} tHostFmavMsg;
+
+const tHostFmavMsg host_fmav_msgs[] = {
+    { FASTMAVLINK_MSG_ID_HEARTBEAT, 50, 9, 0, 0 },
+    { FASTMAVLINK_MSG_ID_SYS_STATUS, 124, 43, 0, 0 },
+    { FASTMAVLINK_MSG_ID_SYSTEM_TIME, 137, 12, 0, 0 },
+    { FASTMAVLINK_MSG_ID_PARAM_VALUE, 220, 25, 0, 0 },
+    { FASTMAVLINK_MSG_ID_GPS_RAW_INT, 24, 52, 0, 0 },
+    { FASTMAVLINK_MSG_ID_ATTITUDE, 39, 28, 0, 0 },
+    { FASTMAVLINK_MSG_ID_GLOBAL_POSITION_INT, 104, 28, 0, 0 },
+    { FASTMAVLINK_MSG_ID_MISSION_CURRENT, 28, 18, 0, 0 },
+    { FASTMAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, 183, 26, 0, 0 },
+    { FASTMAVLINK_MSG_ID_RC_CHANNELS, 118, 42, 0, 0 },
+    { FASTMAVLINK_MSG_ID_VFR_HUD, 20, 20, 0, 0 },
+    { FASTMAVLINK_MSG_ID_COMMAND_LONG, 152, 33, 30, 31 },
+    { FASTMAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 84, 254, 1, 2 },
+    { FASTMAVLINK_MSG_ID_BATTERY_STATUS, 154, 54, 0, 0 },
+    { FASTMAVLINK_MSG_ID_VIBRATION, 90, 32, 0, 0 },
+    { FASTMAVLINK_MSG_ID_STATUSTEXT, 83, 54, 0, 0 },
+};
+
+
+const tHostFmavMsg* host_fmav_msg(uint32_t msgid)
+{
+    for (uint8_t i = 0; i < sizeof(host_fmav_msgs) / sizeof(tHostFmavMsg); i++) {
+        if (host_fmav_msgs[i].msgid == msgid) return &host_fmav_msgs[i];
+    }
+    return nullptr;
+}
+
+
+FASTMAVLINK_FUNCTION_DECORATOR void fmav_crc_accumulate(uint16_t* crc, uint8_t data)
+{
+    uint8_t tmp = data ^ (uint8_t)(*crc & 0xFF);
+    tmp ^= (tmp << 4);
+    *crc = (*crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4);
+}
+
+
+FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmav_crc_calculate(const uint8_t* buf, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--) fmav_crc_accumulate(&crc, *buf++);
+    return crc;
+}
+
+
+FASTMAVLINK_FUNCTION_DECORATOR void fmav_parse_reset(fmav_status_t* status)
+{
+    status->rx_cnt = 0;
+    status->rx_header_len = 0;
+    status->rx_frame_len = 0;
+    status->rx_state = FASTMAVLINK_PARSE_STATE_IDLE;
+}
+
+
+// fills the result from the frame buf, and checks its crc
+FASTMAVLINK_FUNCTION_DECORATOR uint8_t fmav_check_frame_buf(fmav_result_t* result, uint8_t* buf)
+{
+    uint8_t is_v1 = (buf[0] == FASTMAVLINK_MAGIC_V1);
+    uint8_t header_len = (is_v1) ? FASTMAVLINK_HEADER_V1_LEN : FASTMAVLINK_HEADER_V2_LEN;
+    uint8_t len = buf[1];
+
+    result->msgid = (is_v1) ? buf[5] : (uint32_t)buf[7] + ((uint32_t)buf[8] << 8) + ((uint32_t)buf[9] << 16);
+    result->sysid = (is_v1) ? buf[3] : buf[5];
+    result->compid = (is_v1) ? buf[4] : buf[6];
+    result->frame_len = header_len + len + FASTMAVLINK_CHECKSUM_LEN;
+    if (!is_v1 && (buf[2] & FASTMAVLINK_INCOMPAT_FLAGS_SIGNED)) result->frame_len += FASTMAVLINK_SIGNATURE_LEN;
+
+    const tHostFmavMsg* m = host_fmav_msg(result->msgid);
+    result->crc_extra = (m) ? m->crc_extra : 0;
+    result->payload_max_len = (m) ? m->payload_max_len : len;
+    result->target_sysid = 0; // is zero trimmed if the payload is too short
+    result->target_compid = 0;
+    if (m && m->target_sysid_ofs) {
+        if (m->target_sysid_ofs < len) result->target_sysid = buf[header_len + m->target_sysid_ofs];
+        if (m->target_compid_ofs < len) result->target_compid = buf[header_len + m->target_compid_ofs];
+    }
+
+    uint16_t crc = fmav_crc_calculate(&(buf[1]), header_len - 1 + len);
+    fmav_crc_accumulate(&crc, result->crc_extra);
+    uint16_t checksum = buf[header_len + len] + ((uint16_t)buf[header_len + len + 1] << 8);
+
+    result->res = (m && crc == checksum) ? FASTMAVLINK_PARSE_RESULT_OK : FASTMAVLINK_PARSE_RESULT_CRC_ERROR;
+    return result->res;
+}
+
+
+FASTMAVLINK_FUNCTION_DECORATOR uint8_t fmav_frame_buf_to_msg(fmav_message_t* msg, fmav_result_t* result, uint8_t* buf)
+{
+    if (result->res != FASTMAVLINK_PARSE_RESULT_OK) return 0;
+
+    msg->magic = buf[0];
+    msg->len = buf[1];
+    uint16_t pos;
+    if (msg->magic == FASTMAVLINK_MAGIC_V1) {
+        msg->incompat_flags = 0;
+        msg->compat_flags = 0;
+        msg->seq = buf[2];
+        pos = 3;
+    } else {
+        msg->incompat_flags = buf[2];
+        msg->compat_flags = buf[3];
+        msg->seq = buf[4];
+        pos = 5;
+    }
+    msg->sysid = buf[pos++];
+    msg->compid = buf[pos++];
+    msg->msgid = buf[pos++];
+    if (msg->magic == FASTMAVLINK_MAGIC_V2) {
+        msg->msgid += ((uint32_t)buf[pos++] << 8);
+        msg->msgid += ((uint32_t)buf[pos++] << 16);
+    }
+
+    msg->target_sysid = result->target_sysid;
+    msg->target_compid = result->target_compid;
+    msg->crc_extra = result->crc_extra;
+    msg->payload_max_len = result->payload_max_len;
+
+    memcpy(msg->payload, &(buf[pos]), msg->len);
+    if (msg->len < msg->payload_max_len) memset(&(msg->payload[msg->len]), 0, msg->payload_max_len - msg->len);
+    pos += msg->len;
+
+    msg->checksum = buf[pos] + ((uint16_t)buf[pos + 1] << 8);
+    pos += FASTMAVLINK_CHECKSUM_LEN;
+
+    if (msg->incompat_flags & FASTMAVLINK_INCOMPAT_FLAGS_SIGNED) {
+        memcpy(msg->signature_a, &(buf[pos]), FASTMAVLINK_SIGNATURE_LEN);
+    }
+    return 1;
+}
+
+
+FASTMAVLINK_FUNCTION_DECORATOR uint16_t fmav_msg_to_frame_buf(uint8_t* buf, fmav_message_t* msg)
+{
+    uint16_t pos;
+
+    buf[0] = msg->magic;
+    buf[1] = msg->len;
+    if (msg->magic == FASTMAVLINK_MAGIC_V1) {
+        buf[2] = msg->seq;
+        pos = 3;
+    } else {
+        buf[2] = msg->incompat_flags;
+        buf[3] = msg->compat_flags;
+        buf[4] = msg->seq;
+        pos = 5;
+    }
+    buf[pos++] = msg->sysid;
+    buf[pos++] = msg->compid;
+    buf[pos++] = (uint8_t)msg->msgid;
+    if (msg->magic == FASTMAVLINK_MAGIC_V2) {
+        buf[pos++] = (uint8_t)(msg->msgid >> 8);
+        buf[pos++] = (uint8_t)(msg->msgid >> 16);
+    }
+
+    memcpy(&(buf[pos]), msg->payload, msg->len);
+    pos += msg->len;
+
+    buf[pos++] = (uint8_t)msg->checksum;
+    buf[pos++] = (uint8_t)(msg->checksum >> 8);
+
+    if (msg->incompat_flags & FASTMAVLINK_INCOMPAT_FLAGS_SIGNED) {
+        memcpy(&(buf[pos]), msg->signature_a, FASTMAVLINK_SIGNATURE_LEN);
+        pos += FASTMAVLINK_SIGNATURE_LEN;
+    }
+    return pos;
+}
+
+
+//-------------------------------------------------------
+// Streams
+//-------------------------------------------------------
+
+typedef struct
+{
+    uint32_t t_us;
+    uint32_t pos; // in data
+    uint16_t len;
+    fmav_result_t result; // as the parser would have it
+} tHostMavlinkFrame;
+
+
+class tHostMavlinkStream
+{
+  public:
+    std::vector<tHostMavlinkFrame> frames;
+    std::vector<uint8_t> data;
+    uint32_t bytes;
+
+    uint8_t* Frame(uint32_t i) { return &data[frames[i].pos]; }
+
+    void Clear(void)
+    {
+        frames.clear();
+        data.clear();
+        bytes = 0;
+    }
+
+    void Add(uint32_t t_us, uint8_t* buf)
+    {
+        tHostMavlinkFrame f;
+        f.t_us = t_us;
+        f.pos = data.size();
+        fmav_check_frame_buf(&(f.result), buf);
+        f.result.res = FASTMAVLINK_PARSE_RESULT_OK; // also for messages we don't know
+        f.len = f.result.frame_len;
+        data.insert(data.end(), buf, buf + f.len);
+        frames.push_back(f);
+        bytes += f.len;
+    }
+
+    // a record is a 64 bit big endian time in us, followed by the frame
+    // only the MAVLink v2 messages not from a GCS (sysid 255) are taken
+    bool ReadTlog(const char* filename)
+    {
+        FILE* fp = fopen(filename, "rb");
+        uint8_t rec[8 + FASTMAVLINK_FRAME_LEN_MAX];
+        uint64_t t0_us = 0;
+        bool t0_set = false;
+        uint32_t t_offset_us = (frames.empty()) ? 0 : frames.back().t_us;
+
+        if (!fp) return false;
+
+        while (fread(rec, 1, 8 + 2, fp) == 8 + 2) {
+            if (rec[8] != FASTMAVLINK_MAGIC_V2 && rec[8] != FASTMAVLINK_MAGIC_V1) { // not in sync, search for the next record
+                fseek(fp, -(8 + 2 - 1), SEEK_CUR);
+                continue;
+            }
+            uint16_t len = (rec[8] == FASTMAVLINK_MAGIC_V2) ? 12 + rec[9] : 8 + rec[9];
+            if (fread(rec + 10, 1, len - 2, fp) != (size_t)(len - 2)) break;
+            if (rec[8] == FASTMAVLINK_MAGIC_V2 && (rec[10] & FASTMAVLINK_INCOMPAT_FLAGS_SIGNED)) {
+                if (fread(rec + 8 + len, 1, FASTMAVLINK_SIGNATURE_LEN, fp) != FASTMAVLINK_SIGNATURE_LEN) break;
+            }
+
+            uint64_t t_us = 0;
+            for (uint8_t n = 0; n < 8; n++) t_us = (t_us << 8) | rec[n];
+            if (!t0_set) { t0_us = t_us; t0_set = true; }
+
+            if (rec[8] != FASTMAVLINK_MAGIC_V2 || rec[8 + 5] == 255) continue;
+            Add(t_offset_us + (t_us - t0_us), rec + 8);
+        }
+
+        fclose(fp);
+        return true;
+    }
+
+    bool WriteTlog(const char* filename)
+    {
+        FILE* fp = fopen(filename, "wb");
+        if (!fp) return false;
+
+        for (uint32_t i = 0; i < frames.size(); i++) {
+            uint8_t t[8];
+            uint64_t t_us = frames[i].t_us;
+            for (uint8_t n = 0; n < 8; n++) t[n] = t_us >> (56 - 8 * n);
+            fwrite(t, 1, 8, fp);
+            fwrite(Frame(i), 1, frames[i].len, fp);
+        }
+
+        fclose(fp);
+        return true;
+    }
+
+    // telemetry: streams as ArduPilot sends them, about 1.3 kB/s
+    // params: telemetry, and 1000 PARAM_VALUE at 1 s
+    // ftp: telemetry, and 500 FILE_TRANSFER_PROTOCOL at 1 s
+    bool MakeSynth(const char* kind, uint32_t seconds, uint32_t seed);
+
+  private:
+    void add_synth(uint32_t t_us, uint32_t msgid);
+
+    uint8_t payload[FASTMAVLINK_PAYLOAD_LEN_MAX];
+    uint8_t seq;
+    uint32_t rnd_state;
+    uint32_t param_index;
+
+    uint32_t rnd(void)
+    {
+        rnd_state ^= rnd_state << 13;
+        rnd_state ^= rnd_state >> 17;
+        rnd_state ^= rnd_state << 5;
+        return rnd_state;
+    }
+
+    float noise(float a) { return a * ((int32_t)(rnd() % 2001) - 1000) / 1000.0f; }
+
+    void put_u8(uint8_t pos, uint8_t v) { payload[pos] = v; }
+    void put_u16(uint8_t pos, uint16_t v) { memcpy(&payload[pos], &v, 2); }
+    void put_u32(uint8_t pos, uint32_t v) { memcpy(&payload[pos], &v, 4); }
+    void put_u64(uint8_t pos, uint64_t v) { memcpy(&payload[pos], &v, 8); }
+    void put_f(uint8_t pos, float v) { memcpy(&payload[pos], &v, 4); }
+};
+
+
+// msgid, rate in Hz
+const uint16_t host_synth_telemetry[][2] = {
+    { FASTMAVLINK_MSG_ID_HEARTBEAT, 1 }, { FASTMAVLINK_MSG_ID_SYS_STATUS, 2 },
+    { FASTMAVLINK_MSG_ID_GPS_RAW_INT, 2 }, { FASTMAVLINK_MSG_ID_ATTITUDE, 10 },
+    { FASTMAVLINK_MSG_ID_GLOBAL_POSITION_INT, 5 }, { FASTMAVLINK_MSG_ID_VFR_HUD, 5 },
+    { FASTMAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, 2 }, { FASTMAVLINK_MSG_ID_RC_CHANNELS, 2 },
+    { FASTMAVLINK_MSG_ID_BATTERY_STATUS, 1 }, { FASTMAVLINK_MSG_ID_SYSTEM_TIME, 1 },
+    { FASTMAVLINK_MSG_ID_MISSION_CURRENT, 1 }, { FASTMAVLINK_MSG_ID_VIBRATION, 1 },
+};
+
+
+bool tHostMavlinkStream::MakeSynth(const char* kind, uint32_t seconds, uint32_t seed)
+{
+    if (strcmp(kind, "telemetry") && strcmp(kind, "params") && strcmp(kind, "ftp")) return false;
+
+    rnd_state = (seed) ? seed : 1;
+    seq = 0;
+    param_index = 0;
+
+    // the times at which the messages are send
+    std::vector<std::pair<uint32_t, uint32_t>> sched;
+    for (uint8_t i = 0; i < sizeof(host_synth_telemetry) / sizeof(host_synth_telemetry[0]); i++) {
+        uint32_t rate = host_synth_telemetry[i][1];
+        for (uint32_t n = 0; n < seconds * rate; n++) {
+            sched.push_back({ (n * 1000000) / rate + rnd() % 1000, host_synth_telemetry[i][0] });
+        }
+    }
+    if (!strcmp(kind, "params")) {
+        for (uint32_t n = 0; n < 1000; n++) sched.push_back({ 1000000 + n * 100, FASTMAVLINK_MSG_ID_PARAM_VALUE });
+    }
+    if (!strcmp(kind, "ftp")) {
+        for (uint32_t n = 0; n < 500; n++) sched.push_back({ 1000000 + n * 100, FASTMAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL });
+    }
+    std::stable_sort(sched.begin(), sched.end(),
+        [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) { return a.first < b.first; });
+
+    for (uint32_t i = 0; i < sched.size(); i++) add_synth(sched[i].first, sched[i].second);
+    return true;
+}
+
+
+// the vehicle flies circles of 100 m radius at 15 m/s, in 50 m height, and rolls and
+// pitches a bit, the battery drains
+void tHostMavlinkStream::add_synth(uint32_t t_us, uint32_t msgid)
+{
+    const tHostFmavMsg* m = host_fmav_msg(msgid);
+    if (!m) return;
+
+    float t = t_us * 1.0e-6f;
+    uint32_t t_ms = t_us / 1000;
+    float w = 0.15f; // rad/s
+    float yaw = fmodf(w * t, 6.2832f) - 3.1416f;
+    float roll = 0.35f + 0.05f * sinf(0.7f * t) + noise(0.002f);
+    float pitch = 0.03f * sinf(0.4f * t) + noise(0.002f);
+    int32_t lat = 473977418 + (int32_t)(100.0f * cosf(w * t) / 0.0111f);
+    int32_t lon = 85455939 + (int32_t)(100.0f * sinf(w * t) / 0.0075f);
+    float alt = 50.0f + 2.0f * sinf(0.1f * t);
+    uint16_t voltage = 12600 - (uint16_t)(t * 0.5f);
+
+    memset(payload, 0, sizeof(payload));
+
+    switch (msgid) {
+    case FASTMAVLINK_MSG_ID_HEARTBEAT:
+        put_u32(0, 10); put_u8(4, 1); put_u8(5, 3); put_u8(6, 0xD9); put_u8(7, 4); put_u8(8, 3);
+        break;
+    case FASTMAVLINK_MSG_ID_SYS_STATUS:
+        put_u32(0, 0x1320FC2F); put_u32(4, 0x1320FC2F); put_u32(8, 0x0320FC2F);
+        put_u16(12, 180 + rnd() % 40); put_u16(14, voltage); put_u16(16, 1450 + rnd() % 100);
+        put_u8(30, 100 - (uint8_t)(t / 60.0f));
+        break;
+    case FASTMAVLINK_MSG_ID_SYSTEM_TIME:
+        put_u64(0, 1700000000000000ULL + t_us); put_u32(8, t_ms);
+        break;
+    case FASTMAVLINK_MSG_ID_PARAM_VALUE: {
+        char id[17];
+        snprintf(id, sizeof(id), "PARAM_%u", (unsigned)param_index);
+        put_f(0, (float)(rnd() % 1000) / 10.0f); put_u16(4, 1000); put_u16(6, param_index);
+        memcpy(&payload[8], id, strlen(id)); put_u8(24, 9);
+        param_index++;
+        break; }
+    case FASTMAVLINK_MSG_ID_GPS_RAW_INT:
+        put_u64(0, (uint64_t)t_us + 123456); put_u32(8, lat); put_u32(12, lon); put_u32(16, (int32_t)(alt * 1000) + 488000);
+        put_u16(20, 121); put_u16(22, 200); put_u16(24, 1500 + rnd() % 20); put_u16(26, (uint16_t)((yaw + 3.1416f) * 5729.6f));
+        put_u8(28, 3); put_u8(29, 14);
+        break;
+    case FASTMAVLINK_MSG_ID_ATTITUDE:
+        put_u32(0, t_ms); put_f(4, roll); put_f(8, pitch); put_f(12, yaw);
+        put_f(16, noise(0.01f)); put_f(20, noise(0.01f)); put_f(24, w + noise(0.01f));
+        break;
+    case FASTMAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+        put_u32(0, t_ms); put_u32(4, lat); put_u32(8, lon); put_u32(12, (int32_t)(alt * 1000) + 488000);
+        put_u32(16, (int32_t)(alt * 1000)); put_u16(20, (int16_t)(-1500 * sinf(w * t))); put_u16(22, (int16_t)(1500 * cosf(w * t)));
+        put_u16(24, (int16_t)noise(20)); put_u16(26, (uint16_t)((yaw + 3.1416f) * 5729.6f));
+        break;
+    case FASTMAVLINK_MSG_ID_MISSION_CURRENT:
+        put_u16(0, 3);
+        break;
+    case FASTMAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT:
+        put_f(0, roll * 57.3f); put_f(4, pitch * 57.3f); put_f(8, noise(0.5f)); put_f(12, noise(0.3f));
+        put_f(16, noise(2.0f)); put_u16(20, (int16_t)(yaw * 57.3f)); put_u16(22, (int16_t)(yaw * 57.3f)); put_u16(24, 100);
+        break;
+    case FASTMAVLINK_MSG_ID_RC_CHANNELS:
+        put_u32(0, t_ms);
+        for (uint8_t n = 0; n < 16; n++) put_u16(4 + 2 * n, (n < 4) ? 1500 + (int16_t)noise(30) : 1000 + 500 * (n % 3));
+        put_u8(40, 16); put_u8(41, 200 + rnd() % 10);
+        break;
+    case FASTMAVLINK_MSG_ID_VFR_HUD:
+        put_f(0, 15.0f + noise(0.5f)); put_f(4, 15.0f + noise(0.3f)); put_f(8, alt); put_f(12, 0.2f * cosf(0.1f * t));
+        put_u16(16, (int16_t)((yaw + 3.1416f) * 57.3f)); put_u16(18, 45 + rnd() % 5);
+        break;
+    case FASTMAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+        put_u8(1, 1); put_u8(2, 1);
+        for (uint8_t n = 3; n < 254; n++) payload[n] = rnd();
+        break;
+    case FASTMAVLINK_MSG_ID_BATTERY_STATUS:
+        put_u32(0, (uint32_t)(t * 4.0f)); put_u32(4, -1); put_u16(8, 0x7FFF);
+        put_u16(10, voltage); for (uint8_t n = 1; n < 10; n++) put_u16(10 + 2 * n, 0xFFFF);
+        put_u16(30, 1450 + rnd() % 100); put_u8(35, 100 - (uint8_t)(t / 60.0f));
+        break;
+    case FASTMAVLINK_MSG_ID_VIBRATION:
+        put_u64(0, t_us); put_f(8, 2.0f + noise(0.5f)); put_f(12, 2.0f + noise(0.5f)); put_f(16, 4.0f + noise(1.0f));
+        break;
+    }
+
+    // zero trimming of v2
+    uint8_t len = m->payload_max_len;
+    while (len > 1 && payload[len - 1] == 0) len--;
+
+    uint8_t buf[FASTMAVLINK_FRAME_LEN_MAX];
+    buf[0] = FASTMAVLINK_MAGIC_V2;
+    buf[1] = len;
+    buf[2] = buf[3] = 0;
+    buf[4] = seq++;
+    buf[5] = 1;
+    buf[6] = 1;
+    buf[7] = msgid; buf[8] = msgid >> 8; buf[9] = msgid >> 16;
+    memcpy(&buf[10], payload, len);
+    uint16_t crc = fmav_crc_calculate(&buf[1], 9 + len);
+    fmav_crc_accumulate(&crc, m->crc_extra);
+    buf[10 + len] = crc;
+    buf[11 + len] = crc >> 8;
+
+    Add(t_us, buf);
+}
+
+
+#endif // HOST_MAVLINK_H
@@ -0,0 +1,568 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Link Simulation
+//*******************************************************
+// Steps the Tx and the Rx period by period over the simulated SX drivers and their channel
+// models, for each mode, and reports connect time, LQ and serial throughput. Each end has
+// its own connect state machine of link_connect.h, hop list of fhss.h, and ARQ of arq.h,
+// so it has to find the other end as the firmware does. The Rx has two antennas. The frames
+// are packed, checked, FEC decoded and combined by the firmware's frames.h.
+//
+// The order of things in a period follows doPreTransmit of mlrs-tx.cpp and the link states
+// and doPostReceive of mlrs-rx.cpp:
+// - Tx: evaluates the Rx frame of the last period, hops, and transmits
+// - Rx: evaluates the Tx frame, and transmits, or goes back to receive, possibly on the next
+//   channel if in listen
+// - Rx: in receive, hops if in sync or connected
+//
+// Serial data is a counting byte stream in both directions, at the baudrate, and is flushed
+// when not connected, as in the firmware. A byte which doesn't follow the one before counts as
+// a gap. In the middle of the run the link is cut for --outage ms, to measure the reconnect.
+//
+// What is not the firmware: the main loops with their hal, the clock, and the IRQ handling,
+// so the periods of the Tx and the Rx are aligned. Cmd frames, bind, rate adaption, fhss
+// adaption, downlink slots, rc data and MAVLink are not run. Frames are full length.
+//
+// usage: sim_link [--loss ppm] [--ber ppm] [--baud n] [--arq 0|1] [--outage ms]
+//                 [--seconds n] [--seed n]
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/frames.h"
+#include "../../mLRS/Common/fhss.h"
+#include "../../mLRS/Common/fhss.cpp"
+#include "../../mLRS/Common/arq.h"
+#include "../../mLRS/Common/link_connect.h"
+#include "../../mLRS/Common/libs/fifo.h"
+
+
+tRcCoding rc_coding;
+tLatencyTrace latency_trace;
+
+
+//-------------------------------------------------------
+// Medium
+//-------------------------------------------------------
+
+#define NODE_TX   0
+#define NODE_RX1  1
+#define NODE_RX2  2
+
+SxSimDriver tx_sx;
+
+
+class tLinkMedium : public tSxSimMedium
+{
+  public:
+    void Put(uint8_t node, uint32_t freq, uint8_t* data, uint8_t len) override
+    {
+        if (cut) return;
+        if (node == NODE_TX) {
+            sx.Deliver(freq, data, len);
+            sx2.Deliver(freq, data, len);
+        } else {
+            tx_sx.Deliver(freq, data, len);
+        }
+    }
+
+    bool cut;
+};
+
+tLinkMedium medium;
+tSxSimChannel channel_up1, channel_up2, channel_down;
+
+
+//-------------------------------------------------------
+// Serial
+//-------------------------------------------------------
+
+class tSimSerial
+{
+  public:
+    void Init(void)
+    {
+        in.Init();
+        cnt_in = 0;
+        cnt_out = 0;
+        bytes = 0;
+        gaps = 0;
+    }
+
+    // the counting stream comes in at the baudrate, what doesn't fit is not sent
+    void Fill(uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; i++) {
+            if (!in.Put(cnt_in)) break;
+            cnt_in++;
+        }
+    }
+
+    void Out(uint8_t* buf, uint8_t len)
+    {
+        for (uint8_t i = 0; i < len; i++) {
+            if (buf[i] != cnt_out) gaps++;
+            cnt_out = buf[i] + 1;
+        }
+        bytes += len;
+    }
+
+    FifoBase<uint8_t, 2048> in;
+    uint8_t cnt_in;
+    uint8_t cnt_out; // next expected byte
+    uint32_t bytes;
+    uint32_t gaps;
+};
+
+
+//-------------------------------------------------------
+// Tx
+//-------------------------------------------------------
+
+typedef struct
+{
+    uint32_t frames; // while connected
+    uint32_t valid;
+} tSimLinkStats;
+
+
+class tSimTx
+{
+  public:
+    void Init(void)
+    {
+        connect.Init();
+        fhss.Init(&Config.Fhss);
+        fhss.Start();
+        arq.Init();
+        arq.SetEnabled(arq_enabled);
+        serial.Init();
+        seq_no = 0;
+        received_ack = 0;
+        rx_status = RX_STATUS_NONE;
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    // as do_receive() and process_received_frame()
+    void Receive(void)
+    {
+        rx_status = RX_STATUS_NONE;
+        if (!tx_sx.GetAndClearIrqStatus(SX_IRQ_RX_DONE)) return;
+
+        tx_sx.ReadFrame((uint8_t*)&rxFrame, FRAME_TX_RX_LEN);
+        uint8_t res = check_rxframe(&rxFrame);
+        if (res != CHECK_OK && Config.UseFec && fec_decode_frame((uint8_t*)&rxFrame)) res = check_rxframe(&rxFrame);
+        rx_status = (res == CHECK_OK) ? RX_STATUS_VALID : RX_STATUS_INVALID;
+        if (res > CHECK_ERROR_SYNCWORD) return; // not for us, as nothing received
+
+        received_ack = (rx_status == RX_STATUS_VALID) ? rxFrame.status.ack : 0;
+        arq.SetReceived(rx_status == RX_STATUS_VALID);
+        if (rx_status != RX_STATUS_VALID) return;
+
+        uint8_t len = rxFrame.status.payload_len;
+        if (len && arq.IsDuplicate(rxFrame.status.seq_no)) return;
+        serial.Out(rxFrame.payload, len);
+    }
+
+    // as doPreTransmit
+    void PreTransmit(void)
+    {
+        tx_sx.SetToIdle();
+
+        bool valid_frame_received = (rx_status == RX_STATUS_VALID);
+        if (rx_status == RX_STATUS_NONE) { received_ack = 0; arq.SetReceived(false); }
+
+        if (connect.Connected()) {
+            stats.frames++;
+            if (valid_frame_received) stats.valid++;
+        }
+
+        if (valid_frame_received) connect.ValidFrame();
+
+        if (connect.Connected() && connect.TimedOut()) connect.Listen();
+
+        rx_status = RX_STATUS_NONE;
+    }
+
+    // LINK_STATE_TRANSMIT, as prepare_transmit_frame()
+    void Transmit(void)
+    {
+    tFrameStats frame_stats = {};
+    uint8_t payload_len = 0;
+
+        fhss.HopToNext();
+        tx_sx.SetRfFrequency(fhss.GetCurrFreq());
+
+        arq.HandleAck(received_ack);
+        if (connect.Connected()) {
+            if (arq.Pending()) {
+                payload_len = arq.GetPayload(txFrame.payload);
+            } else {
+                payload_len = serial.in.GetBuf(txFrame.payload, FRAME_TX_PAYLOAD_LEN_USABLE);
+                if (payload_len) seq_no++;
+                arq.PutPayload(txFrame.payload, payload_len);
+            }
+        } else {
+            serial.in.Init();
+        }
+
+        frame_stats.seq_no = seq_no;
+        frame_stats.ack = arq.Ack();
+        pack_txframe(&txFrame, &frame_stats, &rc, txFrame.payload, payload_len);
+        tx_sx.SendFrame((uint8_t*)&txFrame, FRAME_TX_RX_LEN);
+
+        tx_sx.SetToRx(); // LINK_STATE_RECEIVE
+    }
+
+    tLinkConnect connect;
+    tFhss fhss;
+    tArq arq;
+    bool arq_enabled;
+    tSimSerial serial; // in from the GCS, out to the GCS
+    tSimLinkStats stats;
+    tRcData rc;
+
+  private:
+    tTxFrame txFrame;
+    tRxFrame rxFrame;
+    uint8_t seq_no;
+    uint8_t received_ack;
+    uint8_t rx_status;
+};
+
+
+//-------------------------------------------------------
+// Rx
+//-------------------------------------------------------
+
+class tSimRx
+{
+  public:
+    void Init(void)
+    {
+        connect.Init();
+        fhss.Init(&Config.Fhss);
+        fhss.Start();
+        arq.Init();
+        arq.SetEnabled(arq_enabled);
+        serial.Init();
+        seq_no = 0;
+        received_ack = 0;
+        link_state = LINK_STATE_RECEIVE;
+        memset(&stats, 0, sizeof(stats));
+        fec_corrected = 0;
+        combined = 0;
+    }
+
+    // as do_receive() of the Rx
+    uint8_t receive(SxSimDriverBase* drv, tTxFrame* frame)
+    {
+        if (!drv->GetAndClearIrqStatus(SX_IRQ_RX_DONE)) return RX_STATUS_NONE;
+
+        drv->ReadFrame((uint8_t*)frame, FRAME_TX_RX_LEN);
+        uint8_t res = check_txframe(frame);
+        if (res != CHECK_OK && Config.UseFec && fec_decode_frame((uint8_t*)frame)) {
+            res = check_txframe(frame);
+            if (res == CHECK_OK) fec_corrected++;
+        }
+        if (res == CHECK_OK) return RX_STATUS_VALID;
+        if (res == CHECK_ERROR_CRC) return RX_STATUS_CRC1_VALID;
+        return (res > CHECK_ERROR_SYNCWORD) ? RX_STATUS_INVALID : RX_STATUS_NONE;
+    }
+
+    // as doPostReceive, with handle_receive() and process_received_frame()
+    void PostReceive(void)
+    {
+        if (link_state != LINK_STATE_RECEIVE_WAIT) return;
+
+        uint8_t rx1_status = receive(&sx, &txFrame);
+        uint8_t rx2_status = receive(&sx2, &txFrame2);
+        if ((rx1_status == RX_STATUS_INVALID || rx1_status == RX_STATUS_CRC1_VALID) &&
+            (rx2_status == RX_STATUS_INVALID || rx2_status == RX_STATUS_CRC1_VALID)) {
+            if (combine_txframes(&txFrame, &txFrame2)) {
+                rx1_status = RX_STATUS_VALID;
+                combined++;
+            }
+        }
+        bool frame_received = (rx1_status > RX_STATUS_NONE) || (rx2_status > RX_STATUS_NONE);
+        bool valid_frame_received = (rx1_status > RX_STATUS_INVALID) || (rx2_status > RX_STATUS_INVALID);
+        bool invalid_frame_received = frame_received && !valid_frame_received;
+
+        tTxFrame* frame = (rx1_status == RX_STATUS_VALID) ? &txFrame : &txFrame2;
+        bool valid = (rx1_status == RX_STATUS_VALID || rx2_status == RX_STATUS_VALID);
+        arq.SetReceived(valid);
+        received_ack = (valid) ? frame->status.ack : 0;
+        if (valid && connect.Connected()) {
+            uint8_t len = frame->status.payload_len;
+            if (!(len && arq.IsDuplicate(frame->status.seq_no))) serial.Out(frame->payload, len);
+        }
+
+        if (connect.Connected()) {
+            stats.frames++;
+            if (valid_frame_received) stats.valid++;
+        }
+
+        if (valid_frame_received) {
+            connect.ValidFrame();
+            link_state = LINK_STATE_TRANSMIT;
+        }
+
+        if (connect.IsInListen() && invalid_frame_received) {
+            link_state = LINK_STATE_RECEIVE;
+        }
+
+        if (connect.IsInListen()) {
+            if (connect.ListenHop()) {
+                fhss.HopToNext();
+                link_state = LINK_STATE_RECEIVE;
+            }
+        }
+
+        if (connect.IsSynced() && connect.TimedOut()) {
+            connect.Listen();
+            link_state = LINK_STATE_RECEIVE;
+        }
+
+        if (connect.IsSynced() && !valid_frame_received) {
+            link_state = LINK_STATE_TRANSMIT;
+        }
+
+        if (connect.IsSynced() || link_state == LINK_STATE_RECEIVE || link_state == LINK_STATE_TRANSMIT) {
+            sx.SetToIdle();
+            sx2.SetToIdle();
+        }
+    }
+
+    // LINK_STATE_TRANSMIT, as prepare_transmit_frame(), the Rx transmits on antenna 1
+    void Transmit(void)
+    {
+    tFrameStats frame_stats = {};
+    uint8_t payload_len = 0;
+
+        if (link_state != LINK_STATE_TRANSMIT) return;
+
+        arq.HandleAck(received_ack);
+        if (connect.Connected()) {
+            if (arq.Pending()) {
+                payload_len = arq.GetPayload(rxFrame.payload);
+            } else {
+                payload_len = serial.in.GetBuf(rxFrame.payload, FRAME_RX_PAYLOAD_LEN_USABLE);
+                if (payload_len) seq_no++;
+                arq.PutPayload(rxFrame.payload, payload_len);
+            }
+        } else {
+            serial.in.Init();
+        }
+
+        frame_stats.seq_no = seq_no;
+        frame_stats.ack = arq.Ack();
+        pack_rxframe(&rxFrame, &frame_stats, rxFrame.payload, payload_len);
+        sx.SendFrame((uint8_t*)&rxFrame, FRAME_TX_RX_LEN);
+
+        link_state = LINK_STATE_RECEIVE;
+    }
+
+    // LINK_STATE_RECEIVE
+    void Receive(void)
+    {
+        if (link_state != LINK_STATE_RECEIVE) return;
+
+        if (connect.IsSynced()) fhss.HopToNext();
+        sx.SetRfFrequency(fhss.GetCurrFreq());
+        sx2.SetRfFrequency(fhss.GetCurrFreq());
+        sx.SetToRx();
+        sx2.SetToRx();
+        link_state = LINK_STATE_RECEIVE_WAIT;
+    }
+
+    tLinkConnect connect;
+    tFhss fhss;
+    tArq arq;
+    bool arq_enabled;
+    tSimSerial serial; // in from the vehicle, out to the vehicle
+    tSimLinkStats stats;
+    uint32_t fec_corrected;
+    uint32_t combined;
+
+  private:
+    tTxFrame txFrame, txFrame2;
+    tRxFrame rxFrame;
+    uint8_t seq_no;
+    uint8_t received_ack;
+    uint8_t link_state;
+};
+
+
+tSimTx tx;
+tSimRx rx;
+
+
+//-------------------------------------------------------
+// Simulation
+//-------------------------------------------------------
+
+typedef struct
+{
+    const char* name;
+    uint8_t mode;
+    bool fec;
+} tSimMode;
+
+const tSimMode sim_modes[] = {
+    { "50 Hz", MODE_50HZ, false },
+    { "31 Hz", MODE_31HZ, false },
+    { "19 Hz", MODE_19HZ, false },
+    { "FLRC", MODE_FLRC_111HZ, false },
+    { "FLRC fec", MODE_FLRC_111HZ, true },
+};
+
+
+typedef struct
+{
+    uint32_t loss_ppm;
+    uint32_t ber_ppm;
+    uint32_t baud;
+    bool arq;
+    uint32_t outage_ms;
+    uint32_t seconds;
+    uint32_t seed;
+} tSimOptions;
+
+
+typedef struct
+{
+    uint32_t connect_ms; // until both are connected, 0 if never
+    uint32_t reconnect_ms; // after the outage
+    uint32_t disconnects;
+    uint32_t connected_ms;
+} tSimResult;
+
+
+void run_mode(const tSimMode* m, tSimOptions* opt, tSimResult* res)
+{
+tSxGlobalConfig gconfig = {};
+
+    memset(res, 0, sizeof(tSimResult));
+
+    Config = {};
+    Config.FrameSyncWord = 0x1234;
+    Config.UseFec = m->fec;
+    switch (m->mode) {
+    case MODE_50HZ: Config.frame_rate_ms = 20; Config.Fhss.Num = FHSS_NUM_BAND_2P4_GHZ; gconfig.LoraConfigIndex = 0; break;
+    case MODE_31HZ: Config.frame_rate_ms = 32; Config.Fhss.Num = FHSS_NUM_BAND_2P4_GHZ_31HZ_MODE; gconfig.LoraConfigIndex = 1; break;
+    case MODE_19HZ: Config.frame_rate_ms = 53; Config.Fhss.Num = FHSS_NUM_BAND_2P4_GHZ_19HZ_MODE; gconfig.LoraConfigIndex = 2; break;
+    case MODE_FLRC_111HZ: Config.frame_rate_ms = 9; Config.Fhss.Num = FHSS_NUM_BAND_2P4_GHZ; break;
+    }
+    gconfig.is_lora = (m->mode != MODE_FLRC_111HZ);
+    Config.Fhss.Seed = Config.FrameSyncWord;
+    Config.Fhss.FrequencyBand = SETUP_FREQUENCY_BAND_2P4_GHZ;
+    Config.Fhss.Ortho = ORTHO_NONE;
+    Config.Fhss.Except = EXCEPT_NONE;
+    Config.connect_tmo_systicks = CONNECT_TMO_MS; // a systick is 1 ms
+    Config.connect_listen_hop_cnt = (uint8_t)(1.5f * Config.Fhss.Num);
+
+    tSxSimChannelConfig up = { .seed = opt->seed, .loss_ppm = opt->loss_ppm, .ber_ppm = opt->ber_ppm, .rssi = -80, .snr = 5 };
+    tSxSimChannelConfig up2 = up;
+    up2.seed = opt->seed + 1;
+    tSxSimChannelConfig down = up;
+    down.seed = opt->seed + 100;
+    channel_up1.Init(&up);
+    channel_up2.Init(&up2);
+    channel_down.Init(&down);
+    medium.cut = false;
+
+    tx_sx.Init();
+    sx.Init();
+    sx2.Init();
+    tx_sx.SetMedium(&medium, &channel_down, NODE_TX, nullptr);
+    sx.SetMedium(&medium, &channel_up1, NODE_RX1, nullptr);
+    sx2.SetMedium(&medium, &channel_up2, NODE_RX2, nullptr);
+    tx_sx.StartUp(&gconfig);
+    sx.StartUp(&gconfig);
+    sx2.StartUp(&gconfig);
+
+    tx.arq_enabled = rx.arq_enabled = opt->arq;
+    tx.Init();
+    rx.Init();
+    for (uint8_t n = 0; n < RC_DATA_LEN; n++) tx.rc.ch[n] = 1024;
+
+    // the Tx starts somewhere in its hop list, the Rx has to find it
+    uint32_t start = (opt->seed * 7) % Config.Fhss.Num;
+    for (uint32_t n = 0; n < start; n++) tx.fhss.HopToNext();
+
+    uint32_t bytes_per_period = (opt->baud / 10) * Config.frame_rate_ms / 1000;
+    uint32_t t_ms = 0;
+    uint32_t outage_start_ms = (opt->seconds * 1000) / 2;
+    uint32_t outage_end_ms = outage_start_ms + opt->outage_ms;
+    bool was_connected = false;
+
+    host_time_us = 0;
+    while (t_ms < opt->seconds * 1000) {
+        medium.cut = (opt->outage_ms && t_ms >= outage_start_ms && t_ms < outage_end_ms);
+
+        tx.serial.Fill(bytes_per_period);
+        rx.serial.Fill(bytes_per_period);
+
+        tx.PreTransmit();
+        rx.Receive();
+        tx.Transmit();
+        rx.PostReceive();
+        rx.Transmit();
+        tx.Receive();
+        rx.Receive();
+
+        t_ms += Config.frame_rate_ms;
+        host_time_us += (uint32_t)Config.frame_rate_ms * 1000;
+        for (uint8_t n = 0; n < Config.frame_rate_ms; n++) {
+            tx.connect.Tick_ms();
+            rx.connect.Tick_ms();
+        }
+
+        bool connected = tx.connect.Connected() && rx.connect.Connected();
+        if (connected) res->connected_ms += Config.frame_rate_ms;
+        if (connected && !res->connect_ms) res->connect_ms = t_ms;
+        if (connected && t_ms > outage_end_ms && opt->outage_ms && !res->reconnect_ms) res->reconnect_ms = t_ms - outage_end_ms;
+        if (was_connected && !connected) res->disconnects++;
+        was_connected = connected;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+tSimOptions opt = { .loss_ppm = 0, .ber_ppm = 0, .baud = 57600, .arq = true, .outage_ms = 2000, .seconds = 60, .seed = 1 };
+
+    for (int i = 1; i < argc - 1; i += 2) {
+        uint32_t v = strtoul(argv[i + 1], nullptr, 10);
+        if (!strcmp(argv[i], "--loss")) { opt.loss_ppm = v; }
+        else if (!strcmp(argv[i], "--ber")) { opt.ber_ppm = v; }
+        else if (!strcmp(argv[i], "--baud")) { opt.baud = v; }
+        else if (!strcmp(argv[i], "--arq")) { opt.arq = (v > 0); }
+        else if (!strcmp(argv[i], "--outage")) { opt.outage_ms = v; }
+        else if (!strcmp(argv[i], "--seconds")) { opt.seconds = v; }
+        else if (!strcmp(argv[i], "--seed")) { opt.seed = v; }
+        else { printf("unknown option %s\n", argv[i]); return 1; }
+    }
+
+    printf("loss %u ppm, ber %u ppm, %u baud, arq %s, outage %u ms, %u s\n",
+        (unsigned)opt.loss_ppm, (unsigned)opt.ber_ppm, (unsigned)opt.baud, (opt.arq) ? "on" : "off",
+        (unsigned)opt.outage_ms, (unsigned)opt.seconds);
+    printf("mode      connect ms  reconnect ms  disc   LQ up  LQ down  fec up  combined  serial up B/s  gaps  serial down B/s  gaps\n");
+    for (uint8_t k = 0; k < ARRAY_LEN(sim_modes); k++) {
+        tSimResult res;
+        run_mode(&sim_modes[k], &opt, &res);
+        float connected_s = 1.0e-3f * ((res.connected_ms) ? res.connected_ms : 1);
+        printf("%-10s %9u  %12u  %4u  %5.1f%%  %6.1f%%  %6u  %8u  %13.0f  %4u  %15.0f  %4u\n",
+            sim_modes[k].name, (unsigned)res.connect_ms, (unsigned)res.reconnect_ms, (unsigned)res.disconnects,
+            100.0 * rx.stats.valid / ((rx.stats.frames) ? rx.stats.frames : 1),
+            100.0 * tx.stats.valid / ((tx.stats.frames) ? tx.stats.frames : 1),
+            (unsigned)rx.fec_corrected, (unsigned)rx.combined,
+            rx.serial.bytes / connected_s, (unsigned)rx.serial.gaps,
+            tx.serial.bytes / connected_s, (unsigned)tx.serial.gaps);
+    }
+
+    return 0;
+}
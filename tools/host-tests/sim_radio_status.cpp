@@ -0,0 +1,322 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// RADIO_STATUS Simulation
+//*******************************************************
+// The txbuf methods of mavlink_txbuf.h against a model of how ArduPilot and PX4 respond to
+// RADIO_STATUS, for each mode. Reports the queueing delay of the messages from serial in
+// to link out, and the throughput.
+//
+// The autopilot sends a set of streams, and from 10 s on a parameter download. Its
+// response to txbuf is as in design_decissions.h:
+// - ArduPilot: stream_slowdown_ms is added to each stream interval, and parameters are
+//   send only if txbuf > 50
+// - PX4: the stream and parameter rates are scaled by a rate multiplier
+//
+// The bytes go into a serial rx fifo of RX_SERIAL_RXBUFSIZE, a message which doesn't fit
+// is lost. Each frame takes out up to a full payload, frames are lost at random with 1 - LQ,
+// and the LQ is what the Tx reports. The RADIO_STATUS is seen by the autopilot immediately.
+//
+// usage: sim_radio_status [--lq percent] [--seconds n] [--seed n]
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/frames.h"
+#include "../../mLRS/Common/libs/fifo.h"
+#include "../../mLRS/CommonRx/mavlink_txbuf.h"
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+
+tRcCoding rc_coding;
+tLatencyTrace latency_trace;
+
+
+uint32_t rnd_state = 1;
+
+uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+
+//-------------------------------------------------------
+// Autopilot
+//-------------------------------------------------------
+
+typedef struct
+{
+    const char* name;
+    uint16_t len; // frame length, payload + 12
+    uint16_t interval_ms;
+} tSimStream;
+
+// as requested by a GCS with SRx = 10, about 2.4 kB/s
+const tSimStream sim_streams[] = {
+    { "ATTITUDE", 40, 100 },
+    { "GLOBAL_POSITION_INT", 40, 100 },
+    { "VFR_HUD", 32, 100 },
+    { "AHRS2", 36, 100 },
+    { "RC_CHANNELS", 54, 200 },
+    { "SERVO_OUTPUT_RAW", 49, 200 },
+    { "GPS_RAW_INT", 64, 200 },
+    { "SYS_STATUS", 43, 500 },
+    { "HEARTBEAT", 21, 1000 },
+};
+
+#define SIM_STREAMS_NUM       ARRAY_LEN(sim_streams)
+
+#define SIM_PARAM_LEN         37 // PARAM_VALUE
+#define SIM_PARAM_NUM         1000
+#define SIM_PARAM_INTERVAL_MS 20 // about a third of 57600 baud
+#define SIM_PARAM_START_MS    10000
+
+
+typedef enum {
+    SIM_AUTOPILOT_ARDUPILOT = 0,
+    SIM_AUTOPILOT_PX4,
+} SIM_AUTOPILOT_ENUM;
+
+
+class tSimAutopilot
+{
+  public:
+    void Init(uint8_t _type)
+    {
+        type = _type;
+        for (uint8_t i = 0; i < SIM_STREAMS_NUM; i++) stream_tlast_ms[i] = 0;
+        stream_slowdown_ms = 0;
+        rate_mult = 1.0f;
+        txbuf_last = 100;
+        param_tlast_ms = 0;
+        params_send = 0;
+    }
+
+    // returns the length of the message to send now, or 0
+    uint16_t Do(uint32_t tnow_ms, bool* is_param)
+    {
+        for (uint8_t i = 0; i < SIM_STREAMS_NUM; i++) {
+            if ((tnow_ms - stream_tlast_ms[i]) < interval_ms(sim_streams[i].interval_ms)) continue;
+            stream_tlast_ms[i] = tnow_ms;
+            *is_param = false;
+            return sim_streams[i].len;
+        }
+
+        if (tnow_ms < SIM_PARAM_START_MS || params_send >= SIM_PARAM_NUM) return 0;
+        if (type == SIM_AUTOPILOT_ARDUPILOT && txbuf_last <= 50) return 0;
+        if ((tnow_ms - param_tlast_ms) < interval_ms(SIM_PARAM_INTERVAL_MS)) return 0;
+        param_tlast_ms = tnow_ms;
+        params_send++;
+        *is_param = true;
+        return SIM_PARAM_LEN;
+    }
+
+    void RadioStatus(uint8_t txbuf)
+    {
+        txbuf_last = txbuf;
+
+        if (type == SIM_AUTOPILOT_ARDUPILOT) {
+            if (txbuf < 20) {
+                stream_slowdown_ms += 60;
+            } else if (txbuf < 50) {
+                stream_slowdown_ms += 20;
+            } else if (txbuf > 95 && stream_slowdown_ms > 200) {
+                stream_slowdown_ms -= 40;
+            } else if (txbuf > 90 && stream_slowdown_ms > 0) {
+                stream_slowdown_ms -= 20;
+            }
+            if (stream_slowdown_ms > 2000) stream_slowdown_ms = 2000;
+        } else {
+            if (txbuf < 25) {
+                rate_mult *= 0.8f;
+            } else if (txbuf < 35) {
+                rate_mult *= 0.975f;
+            } else if (txbuf > 50) {
+                rate_mult *= 1.025f;
+            }
+            if (rate_mult < 0.05f) rate_mult = 0.05f;
+            if (rate_mult > 1.0f) rate_mult = 1.0f;
+        }
+    }
+
+    uint32_t params_send;
+
+  private:
+    uint32_t interval_ms(uint32_t nominal_ms)
+    {
+        if (type == SIM_AUTOPILOT_ARDUPILOT) return nominal_ms + stream_slowdown_ms;
+        return nominal_ms / rate_mult;
+    }
+
+    uint8_t type;
+    uint32_t stream_tlast_ms[SIM_STREAMS_NUM];
+    int32_t stream_slowdown_ms;
+    float rate_mult;
+    uint8_t txbuf_last;
+    uint32_t param_tlast_ms;
+};
+
+
+//-------------------------------------------------------
+// Simulation
+//-------------------------------------------------------
+
+typedef struct
+{
+    const char* name;
+    uint8_t mode;
+    uint16_t frame_rate_ms;
+} tSimMode;
+
+const tSimMode sim_modes[] = {
+    { "50 Hz", MODE_50HZ, 20 },
+    { "31 Hz", MODE_31HZ, 32 },
+    { "19 Hz", MODE_19HZ, 53 },
+};
+
+
+typedef struct
+{
+    const char* name;
+    uint8_t autopilot;
+    uint8_t method;
+} tSimCase;
+
+const tSimCase sim_cases[] = {
+    { "ArduPilot ardupilot", SIM_AUTOPILOT_ARDUPILOT, RX_SEND_RADIO_STATUS_METHOD_ARDUPILOT_1 },
+    { "ArduPilot model", SIM_AUTOPILOT_ARDUPILOT, RX_SEND_RADIO_STATUS_METHOD_MODEL },
+    { "PX4 px4", SIM_AUTOPILOT_PX4, RX_SEND_RADIO_STATUS_METHOD_PX4 },
+    { "PX4 model", SIM_AUTOPILOT_PX4, RX_SEND_RADIO_STATUS_METHOD_MODEL },
+};
+
+
+typedef struct
+{
+    uint32_t capacity; // bytes/s
+    uint32_t bytes_taken;
+    uint32_t bytes_lost;
+    uint32_t queue_max;
+    uint32_t delay_p50_ms;
+    uint32_t delay_p99_ms;
+    uint32_t delay_max_ms;
+    uint32_t params_done_ms; // 0 if not done
+} tSimResult;
+
+
+typedef struct
+{
+    uint32_t end; // the message is taken out when this many bytes were taken
+    uint32_t t_ms;
+    bool is_param;
+} tSimMsg;
+
+
+FifoBase<uint8_t, RX_SERIAL_RXBUFSIZE> serial_rx_fifo;
+tTxBufControl txbuf_control;
+tSimAutopilot autopilot;
+
+
+void run_case(const tSimMode* m, const tSimCase* c, uint8_t lq, uint32_t seconds, tSimResult* res)
+{
+std::deque<tSimMsg> msgs;
+std::vector<uint32_t> delays;
+uint8_t buf[RX_SERIAL_RXBUFSIZE];
+uint32_t bytes_put = 0, params_taken = 0;
+
+    memset(res, 0, sizeof(tSimResult));
+
+    Config = {};
+    Config.UseFec = false;
+    Config.frame_rate_ms = m->frame_rate_ms;
+    res->capacity = ((uint32_t)1000 * FRAME_RX_PAYLOAD_LEN_USABLE * lq) / (100 * Config.frame_rate_ms);
+
+    host_time_us = 0;
+    serial_rx_fifo.Init();
+    txbuf_control.Init(millis32());
+    autopilot.Init(c->autopilot);
+
+    for (uint32_t tnow_ms = 0; tnow_ms < seconds * 1000; tnow_ms++) {
+        host_time_us = tnow_ms * 1000;
+
+        // autopilot -> serial in
+        bool is_param;
+        uint16_t len;
+        while ((len = autopilot.Do(tnow_ms, &is_param)) > 0) {
+            if (!serial_rx_fifo.HasSpace(len)) { res->bytes_lost += len; continue; }
+            serial_rx_fifo.PutBuf(buf, len);
+            bytes_put += len;
+            msgs.push_back({ bytes_put, tnow_ms, is_param });
+        }
+        if (serial_rx_fifo.Available() > res->queue_max) res->queue_max = serial_rx_fifo.Available();
+
+        // link out
+        if ((tnow_ms % Config.frame_rate_ms) == 0 && (rnd() % 100) < lq) {
+            len = serial_rx_fifo.GetBuf(buf, FRAME_RX_PAYLOAD_LEN_USABLE);
+            txbuf_control.BytesTaken(len);
+            res->bytes_taken += len;
+            while (!msgs.empty() && msgs.front().end <= res->bytes_taken) {
+                delays.push_back(tnow_ms - msgs.front().t_ms);
+                if (msgs.front().is_param && ++params_taken == SIM_PARAM_NUM) res->params_done_ms = tnow_ms;
+                msgs.pop_front();
+            }
+        }
+
+        // as in MavlinkBase::Do()
+        if (txbuf_control.Do(c->method, tnow_ms, serial_rx_fifo.Available(), lq)) {
+            autopilot.RadioStatus(txbuf_control.Get());
+        }
+    }
+
+    if (delays.empty()) return;
+    std::sort(delays.begin(), delays.end());
+    res->delay_p50_ms = delays[delays.size() / 2];
+    res->delay_p99_ms = delays[(delays.size() * 99) / 100];
+    res->delay_max_ms = delays.back();
+}
+
+
+int main(int argc, char* argv[])
+{
+uint8_t lqs[2] = { 100, 70 };
+uint8_t lqs_num = 2;
+uint32_t seconds = 60;
+
+    for (int i = 1; i < argc - 1; i += 2) {
+        uint32_t v = strtoul(argv[i + 1], nullptr, 10);
+        if (!strcmp(argv[i], "--lq")) { lqs[0] = (v > 100) ? 100 : v; lqs_num = 1; }
+        else if (!strcmp(argv[i], "--seconds")) { seconds = v; }
+        else if (!strcmp(argv[i], "--seed")) { rnd_state = (v) ? v : 1; }
+        else { printf("unknown option %s\n", argv[i]); return 1; }
+    }
+
+    uint32_t streams_rate = 0;
+    for (uint8_t i = 0; i < SIM_STREAMS_NUM; i++) streams_rate += (sim_streams[i].len * 1000) / sim_streams[i].interval_ms;
+
+    printf("streams %u B/s, %u params from %u s on, %u s\n",
+        (unsigned)streams_rate, SIM_PARAM_NUM, SIM_PARAM_START_MS / 1000, (unsigned)seconds);
+    for (uint8_t l = 0; l < lqs_num; l++) {
+        printf("LQ %u%%\n", lqs[l]);
+        printf("mode   autopilot method     capacity B/s  taken B/s  usage  lost B  queue max  delay p50  p99 ms  max ms  params done s\n");
+        for (uint8_t k = 0; k < ARRAY_LEN(sim_modes); k++) {
+            for (uint8_t j = 0; j < ARRAY_LEN(sim_cases); j++) {
+                tSimResult res;
+                run_case(&sim_modes[k], &sim_cases[j], lqs[l], seconds, &res);
+                printf("%-6s %-26s %6u  %9.0f  %4.0f%%  %6u  %9u  %9u  %6u  %6u",
+                    sim_modes[k].name, sim_cases[j].name, (unsigned)res.capacity,
+                    (double)res.bytes_taken / seconds, (100.0 * res.bytes_taken) / (seconds * res.capacity),
+                    (unsigned)res.bytes_lost, (unsigned)res.queue_max,
+                    (unsigned)res.delay_p50_ms, (unsigned)res.delay_p99_ms, (unsigned)res.delay_max_ms);
+                if (res.params_done_ms) printf("  %13.1f\n", res.params_done_ms / 1000.0); else printf("  %13s\n", "-");
+            }
+        }
+    }
+
+    return 0;
+}
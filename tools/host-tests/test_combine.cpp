@@ -0,0 +1,118 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Test Frame Combining
+//*******************************************************
+// combine_txframes() and combine_rxframes() of frames.h. Copies with errors at different
+// positions must be recovered, and the rate of wrongly accepted frames is measured for copies
+// which can't be recovered.
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/frames.h"
+
+
+tRcCoding rc_coding;
+tLatencyTrace latency_trace;
+
+
+uint32_t rnd_state = 1;
+
+uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+
+void pack_random_txframe(tTxFrame* frame)
+{
+tFrameStats frame_stats = {};
+tRcData rc;
+uint8_t payload[FRAME_TX_PAYLOAD_LEN];
+
+    for (uint8_t n = 0; n < RC_DATA_LEN; n++) rc.ch[n] = rnd() % 2048;
+    for (uint8_t n = 0; n < FRAME_TX_PAYLOAD_LEN; n++) payload[n] = rnd();
+    frame_stats.seq_no = rnd();
+    pack_txframe(frame, &frame_stats, &rc, payload, FRAME_TX_PAYLOAD_LEN);
+}
+
+
+// errors in the first and in the second half of the frame, as by two bursts
+void test_recover(void)
+{
+tTxFrame frame_org, frame, frame2;
+tRxFrame rxframe_org, rxframe, rxframe2;
+tFrameStats frame_stats = {};
+uint8_t payload[FRAME_RX_PAYLOAD_LEN];
+
+    for (uint32_t i = 0; i < 10000; i++) {
+        pack_random_txframe(&frame_org);
+        memcpy(&frame, &frame_org, FRAME_TX_RX_LEN);
+        memcpy(&frame2, &frame_org, FRAME_TX_RX_LEN);
+        uint8_t pos = rnd() % (FRAME_TX_RX_LEN / 2 - 4);
+        uint8_t pos2 = FRAME_TX_RX_LEN / 2 + rnd() % (FRAME_TX_RX_LEN / 2 - 4);
+        for (uint8_t k = 0; k < 3; k++) ((uint8_t*)&frame)[pos + k] ^= 1 + rnd() % 255;
+        ((uint8_t*)&frame)[pos2 + 3] ^= 1 + rnd() % 255; // frame has two runs
+        ((uint8_t*)&frame2)[pos2] ^= 1 + rnd() % 255;
+        CHECK(check_txframe(&frame) != CHECK_OK);
+        CHECK(check_txframe(&frame2) != CHECK_OK);
+        CHECK(combine_txframes(&frame, &frame2));
+        CHECK(!memcmp(&frame, &frame_org, FRAME_TX_RX_LEN));
+
+        for (uint8_t n = 0; n < FRAME_RX_PAYLOAD_LEN; n++) payload[n] = rnd();
+        pack_rxframe(&rxframe_org, &frame_stats, payload, FRAME_RX_PAYLOAD_LEN);
+        memcpy(&rxframe, &rxframe_org, FRAME_TX_RX_LEN);
+        memcpy(&rxframe2, &rxframe_org, FRAME_TX_RX_LEN);
+        ((uint8_t*)&rxframe)[pos] ^= 1 + rnd() % 255;
+        ((uint8_t*)&rxframe2)[pos2] ^= 1 + rnd() % 255;
+        CHECK(combine_rxframes(&rxframe, &rxframe2));
+        CHECK(!memcmp(&rxframe, &rxframe_org, FRAME_TX_RX_LEN));
+    }
+}
+
+
+// both copies have errors at the same position, so no mix is the original frame
+void test_false_accept(void)
+{
+tTxFrame frame_org, frame, frame2;
+uint32_t attempts = 0, accepted = 0;
+
+    for (uint32_t i = 0; i < 1000000; i++) {
+        pack_random_txframe(&frame_org);
+        memcpy(&frame, &frame_org, FRAME_TX_RX_LEN);
+        memcpy(&frame2, &frame_org, FRAME_TX_RX_LEN);
+        uint8_t runs = 2 + i % (FRAME_COMBINE_RUNS_MAX - 1);
+        uint8_t common = rnd() % FRAME_TX_RX_LEN;
+        ((uint8_t*)&frame)[common] ^= 1 + rnd() % 255;
+        ((uint8_t*)&frame2)[common] ^= 1 + rnd() % 255;
+        for (uint8_t r = 0; r < runs; r++) {
+            uint8_t pos = (r * FRAME_TX_RX_LEN) / runs + rnd() % (FRAME_TX_RX_LEN / runs - FRAME_COMBINE_RUNS_GAP - 1);
+            if (rnd() & 1) ((uint8_t*)&frame)[pos] ^= 1 + rnd() % 255; else ((uint8_t*)&frame2)[pos] ^= 1 + rnd() % 255;
+        }
+        if (check_txframe(&frame) == CHECK_OK || check_txframe(&frame2) == CHECK_OK) continue;
+        attempts++;
+        if (combine_txframes(&frame, &frame2)) accepted++;
+    }
+
+    double rate = (double)accepted / attempts;
+    printf("  unrecoverable copies: %u of %u accepted, %.1e\n", (unsigned)accepted, (unsigned)attempts, rate);
+    // each of the at most 2^runs - 2 checks passes with 2^-16
+    CHECK(rate < (double)((1 << FRAME_COMBINE_RUNS_MAX) - 2) / 65536.0);
+}
+
+
+int main(void)
+{
+    Config.FrameSyncWord = 0x1234;
+
+    test_recover();
+    test_false_accept();
+
+    return host_result("test_combine");
+}
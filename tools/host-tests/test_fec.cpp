@@ -0,0 +1,191 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Test FEC
+//*******************************************************
+// Reed-Solomon encoder and decoder of fec.h, and the frames with fec of frames.h.
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/frames.h"
+
+
+tRcCoding rc_coding;
+tLatencyTrace latency_trace;
+
+
+uint32_t rnd_state = 1;
+
+uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+
+// corrupts num different bytes, each with a non-zero error
+void corrupt(uint8_t* buf, uint8_t len, uint8_t num)
+{
+uint8_t pos[16];
+
+    for (uint8_t k = 0; k < num; k++) {
+        bool again;
+        do {
+            pos[k] = rnd() % len;
+            again = false;
+            for (uint8_t i = 0; i < k; i++) if (pos[i] == pos[k]) again = true;
+        } while (again);
+        buf[pos[k]] ^= 1 + rnd() % 255;
+    }
+}
+
+
+void test_codeword(void)
+{
+uint8_t cw[FRAME_TX_RX_LEN], cw_org[FRAME_TX_RX_LEN];
+uint8_t parity[FEC_PARITY_LEN];
+
+    for (uint32_t i = 0; i < 20000; i++) {
+        uint8_t len = FEC_PARITY_LEN + 1 + rnd() % (FRAME_TX_RX_LEN - FEC_PARITY_LEN);
+        for (uint8_t n = 0; n < len - FEC_PARITY_LEN; n++) cw_org[n] = rnd();
+        memset(parity, 0, FEC_PARITY_LEN);
+        fec_rs_encode(parity, cw_org, len - FEC_PARITY_LEN);
+        memcpy(&(cw_org[len - FEC_PARITY_LEN]), parity, FEC_PARITY_LEN);
+
+        memcpy(cw, cw_org, len);
+        CHECK(fec_rs_decode(cw, len));
+        CHECK(!memcmp(cw, cw_org, len));
+
+        uint8_t errors = 1 + i % (FEC_PARITY_LEN / 2);
+        corrupt(cw, len, errors);
+        CHECK(fec_rs_decode(cw, len));
+        CHECK(!memcmp(cw, cw_org, len));
+    }
+}
+
+
+void test_txframe(void)
+{
+tTxFrame frame, frame_org;
+tFrameStats frame_stats = {};
+tRcData rc;
+uint8_t payload[FRAME_TX_PAYLOAD_LEN];
+uint32_t corrected = 0, rejected = 0, wrong = 0;
+
+    Config.UseFec = true;
+    Config.UseShortFrames = false;
+
+    for (uint8_t n = 0; n < RC_DATA_LEN; n++) rc.ch[n] = rnd() % 2048;
+
+    for (uint32_t i = 0; i < 20000; i++) {
+        uint8_t len = rnd() % (FRAME_TX_PAYLOAD_LEN_USABLE + 1);
+        for (uint8_t n = 0; n < len; n++) payload[n] = rnd();
+        frame_stats.seq_no = i;
+        pack_txframe(&frame_org, &frame_stats, &rc, payload, len);
+        CHECK_EQ(check_txframe(&frame_org), CHECK_OK);
+
+        // up to 4 byte errors anywhere are corrected
+        memcpy(&frame, &frame_org, FRAME_TX_RX_LEN);
+        corrupt((uint8_t*)&frame, FRAME_TX_RX_LEN, 1 + i % (FEC_PARITY_LEN / 2));
+        CHECK(fec_decode_frame((uint8_t*)&frame));
+        CHECK_EQ(check_txframe(&frame), CHECK_OK);
+        CHECK(!memcmp(&frame, &frame_org, FRAME_TX_RX_LEN - FEC_PARITY_LEN - 2)); // parity is not restored
+
+        // more are either rejected or caught by the crc
+        memcpy(&frame, &frame_org, FRAME_TX_RX_LEN);
+        corrupt((uint8_t*)&frame, FRAME_TX_RX_LEN, 5 + i % 3);
+        if (fec_decode_frame((uint8_t*)&frame) && check_txframe(&frame) == CHECK_OK) {
+            if (memcmp(&frame, &frame_org, FRAME_TX_RX_LEN - FEC_PARITY_LEN - 2)) wrong++; else corrected++;
+        } else {
+            rejected++;
+        }
+    }
+    CHECK_EQ(wrong, 0);
+    printf("  tx frames, 5-7 errors: %u corrected, %u rejected\n", (unsigned)corrected, (unsigned)rejected);
+}
+
+
+void test_rxframe(void)
+{
+tRxFrame frame, frame_org;
+tFrameStats frame_stats = {};
+uint8_t payload[FRAME_RX_PAYLOAD_LEN];
+
+    Config.UseFec = true;
+    Config.UseShortFrames = false;
+
+    for (uint32_t i = 0; i < 20000; i++) {
+        uint8_t len = rnd() % (FRAME_RX_PAYLOAD_LEN_USABLE + 1);
+        for (uint8_t n = 0; n < len; n++) payload[n] = rnd();
+        frame_stats.seq_no = i;
+        pack_rxframe(&frame_org, &frame_stats, payload, len);
+        CHECK_EQ(check_rxframe(&frame_org), CHECK_OK);
+
+        memcpy(&frame, &frame_org, FRAME_TX_RX_LEN);
+        corrupt((uint8_t*)&frame, FRAME_TX_RX_LEN, 1 + i % (FEC_PARITY_LEN / 2));
+        CHECK(fec_decode_frame((uint8_t*)&frame));
+        CHECK_EQ(check_rxframe(&frame), CHECK_OK);
+        CHECK(!memcmp(&frame, &frame_org, FRAME_TX_RX_LEN - FEC_PARITY_LEN - 2));
+    }
+}
+
+
+void test_cmdframes(void)
+{
+tTxFrame txframe;
+tRxFrame rxframe;
+tFrameStats frame_stats = {};
+tRcData rc = {};
+uint8_t payload[FRAME_RX_PAYLOAD_LEN];
+
+    // cmd frames use the full payload and carry no parity, the crc covers all
+    Config.UseFec = true;
+    Config.UseShortFrames = false;
+    for (uint8_t n = 0; n < FRAME_RX_PAYLOAD_LEN; n++) payload[n] = rnd();
+
+    _pack_txframe_w_type(&txframe, FRAME_TYPE_TX_RX_CMD, &frame_stats, &rc, payload, FRAME_TX_PAYLOAD_LEN);
+    CHECK_EQ(check_txframe(&txframe), CHECK_OK);
+    txframe.payload[FRAME_TX_PAYLOAD_LEN - 1] ^= 0x01;
+    CHECK_EQ(check_txframe(&txframe), CHECK_ERROR_CRC);
+
+    _pack_rxframe_w_type(&rxframe, FRAME_TYPE_TX_RX_CMD, &frame_stats, payload, FRAME_RX_PAYLOAD_LEN);
+    CHECK_EQ(check_rxframe(&rxframe), CHECK_OK);
+    rxframe.payload[FRAME_RX_PAYLOAD_LEN - 1] ^= 0x01;
+    CHECK_EQ(check_rxframe(&rxframe), CHECK_ERROR_CRC);
+}
+
+
+void test_nofec(void)
+{
+tRxFrame frame;
+tFrameStats frame_stats = {};
+uint8_t payload[FRAME_RX_PAYLOAD_LEN];
+
+    Config.UseFec = false;
+    Config.UseShortFrames = false;
+    for (uint8_t n = 0; n < FRAME_RX_PAYLOAD_LEN; n++) payload[n] = rnd();
+
+    pack_rxframe(&frame, &frame_stats, payload, FRAME_RX_PAYLOAD_LEN);
+    CHECK_EQ(check_rxframe(&frame), CHECK_OK);
+    frame.payload[FRAME_RX_PAYLOAD_LEN - 1] ^= 0x80; // all of the payload is covered
+    CHECK_EQ(check_rxframe(&frame), CHECK_ERROR_CRC);
+}
+
+
+int main(void)
+{
+    Config.FrameSyncWord = 0x1234;
+
+    test_codeword();
+    test_txframe();
+    test_rxframe();
+    test_cmdframes();
+    test_nofec();
+
+    return host_result("test_fec");
+}
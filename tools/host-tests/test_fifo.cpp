@@ -0,0 +1,219 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Test FIFO
+//*******************************************************
+// FifoBase of fifo.h. Random operations are checked against a reference model, and a
+// producer and a consumer thread check the single-producer single-consumer use. The latter
+// relies on the host being x86, where, like on the single core mcu, the compiler barrier is
+// all which is needed.
+//*******************************************************
+
+#include "host.h"
+#include "../../mLRS/Common/libs/fifo.h"
+#include <deque>
+#include <thread>
+
+
+uint32_t rnd_state = 1;
+
+uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+
+#define SIZE  64
+
+FifoBase<uint8_t, SIZE> fifo;
+
+
+void test_basics(void)
+{
+uint8_t buf[SIZE];
+
+    fifo.Init();
+    CHECK_EQ(fifo.Available(), 0);
+    CHECK_EQ(fifo.Free(), SIZE - 1);
+    CHECK_EQ(fifo.Get(), 0);
+    CHECK_EQ(fifo.GetBuf(buf, 10), 0);
+
+    // one element is kept free
+    for (uint16_t n = 0; n < SIZE - 1; n++) CHECK(fifo.Put(n));
+    CHECK(!fifo.Put(0xFF));
+    CHECK(!fifo.HasSpace(1));
+    CHECK_EQ(fifo.Available(), SIZE - 1);
+    for (uint16_t n = 0; n < SIZE - 1; n++) CHECK_EQ(fifo.Peek(n), n);
+    for (uint16_t n = 0; n < SIZE - 1; n++) CHECK_EQ(fifo.Get(), n);
+    CHECK_EQ(fifo.Available(), 0);
+
+    // PutBuf is clipped to the free space, and wraps around
+    fifo.Init();
+    for (uint16_t n = 0; n < SIZE; n++) buf[n] = n;
+    CHECK_EQ(fifo.PutBuf(buf, 40), 40);
+    fifo.Consume(40);
+    CHECK_EQ(fifo.PutBuf(buf, SIZE), SIZE - 1);
+    CHECK_EQ(fifo.Available(), SIZE - 1);
+    uint8_t out[SIZE];
+    CHECK_EQ(fifo.PeekBuf(out, SIZE), SIZE - 1);
+    CHECK(!memcmp(out, buf, SIZE - 1));
+    CHECK_EQ(fifo.Available(), SIZE - 1);
+    CHECK_EQ(fifo.GetBuf(out, SIZE), SIZE - 1);
+    CHECK(!memcmp(out, buf, SIZE - 1));
+
+    // the spans are contiguous and end at the end of the buffer
+    uint16_t len;
+    fifo.Init();
+    fifo.PutBuf(buf, 50);
+    fifo.Consume(50);
+    uint8_t* w = fifo.WriteSpan(&len);
+    CHECK_EQ(len, SIZE - 50);
+    memset(w, 0xAA, len);
+    fifo.Commit(len);
+    w = fifo.WriteSpan(&len);
+    CHECK_EQ(len, 50 - 1);
+    memset(w, 0xBB, 10);
+    fifo.Commit(10);
+    uint8_t* r = fifo.ReadSpan(&len);
+    CHECK_EQ(len, SIZE - 50);
+    CHECK_EQ(r[0], 0xAA);
+    fifo.Consume(len);
+    r = fifo.ReadSpan(&len);
+    CHECK_EQ(len, 10);
+    CHECK_EQ(r[9], 0xBB);
+
+    // Consume is clipped, Flush empties
+    fifo.Consume(100);
+    CHECK_EQ(fifo.Available(), 0);
+    fifo.PutBuf(buf, 20);
+    fifo.Flush();
+    CHECK_EQ(fifo.Available(), 0);
+    CHECK_EQ(fifo.Free(), SIZE - 1);
+}
+
+
+void test_random(void)
+{
+std::deque<uint8_t> ref;
+uint8_t buf[2 * SIZE], out[2 * SIZE];
+uint8_t cnt = 0;
+
+    fifo.Init();
+    for (uint32_t i = 0; i < 1000000; i++) {
+        uint16_t len = rnd() % (SIZE + 8);
+        switch (rnd() % 7) {
+        case 0: {
+            bool ok = fifo.Put(cnt);
+            CHECK_EQ(ok, ref.size() < SIZE - 1);
+            if (ok) ref.push_back(cnt++);
+            } break;
+        case 1: {
+            for (uint16_t n = 0; n < len; n++) buf[n] = cnt + n;
+            uint16_t num = fifo.PutBuf(buf, len);
+            CHECK_EQ(num, (len < SIZE - 1 - ref.size()) ? len : SIZE - 1 - ref.size());
+            for (uint16_t n = 0; n < num; n++) ref.push_back(cnt++);
+            } break;
+        case 2: {
+            uint16_t span;
+            uint8_t* w = fifo.WriteSpan(&span);
+            if (len > span) len = span;
+            for (uint16_t n = 0; n < len; n++) { w[n] = cnt; ref.push_back(cnt++); }
+            fifo.Commit(len);
+            } break;
+        case 3: {
+            uint8_t c = fifo.Get();
+            if (ref.empty()) { CHECK_EQ(c, 0); break; }
+            CHECK_EQ(c, ref.front());
+            ref.pop_front();
+            } break;
+        case 4: {
+            uint16_t num = fifo.GetBuf(out, len);
+            CHECK_EQ(num, (len < ref.size()) ? len : ref.size());
+            for (uint16_t n = 0; n < num; n++) { CHECK_EQ(out[n], ref.front()); ref.pop_front(); }
+            } break;
+        case 5: {
+            uint16_t span;
+            uint8_t* r = fifo.ReadSpan(&span);
+            if (len > span) len = span;
+            for (uint16_t n = 0; n < len; n++) { CHECK_EQ(r[n], ref.front()); ref.pop_front(); }
+            fifo.Consume(len);
+            } break;
+        case 6: {
+            uint16_t offset = rnd() % SIZE;
+            CHECK_EQ(fifo.Peek(offset), (offset < ref.size()) ? ref[offset] : 0);
+            } break;
+        }
+        CHECK_EQ(fifo.Available(), ref.size());
+        CHECK_EQ(fifo.Free(), SIZE - 1 - ref.size());
+        if (host_checks_failed) return;
+    }
+}
+
+
+// the producer writes a counting sequence, the consumer checks it
+void test_threads(void)
+{
+const uint32_t total = 20000000;
+uint32_t errors = 0;
+
+    fifo.Init();
+
+    std::thread producer([&]() {
+        uint8_t buf[SIZE];
+        uint8_t cnt = 0;
+        uint32_t i = 0, k = 0;
+        while (i < total) {
+            if (k++ & 1) {
+                if (fifo.Put(cnt)) { cnt++; i++; } else { std::this_thread::yield(); }
+            } else {
+                uint16_t len = 1 + (k % (SIZE / 2));
+                if (len > total - i) len = total - i;
+                for (uint16_t n = 0; n < len; n++) buf[n] = cnt + n;
+                uint16_t num = fifo.PutBuf(buf, len);
+                if (!num) std::this_thread::yield();
+                cnt += num;
+                i += num;
+            }
+        }
+    });
+
+    std::thread consumer([&]() {
+        uint8_t buf[SIZE];
+        uint8_t cnt = 0;
+        uint32_t i = 0, k = 0;
+        while (i < total) {
+            if (k++ & 1) {
+                if (!fifo.Available()) { std::this_thread::yield(); continue; }
+                if (fifo.Get() != cnt) errors++;
+                cnt++; i++;
+            } else {
+                uint16_t num = fifo.GetBuf(buf, 1 + (k % (SIZE / 2)));
+                if (!num) std::this_thread::yield();
+                for (uint16_t n = 0; n < num; n++) if (buf[n] != (uint8_t)(cnt + n)) errors++;
+                cnt += num;
+                i += num;
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    CHECK_EQ(errors, 0);
+    CHECK_EQ(fifo.Available(), 0);
+}
+
+
+int main(void)
+{
+    test_basics();
+    test_random();
+    test_threads();
+
+    return host_result("test_fifo");
+}
@@ -0,0 +1,66 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Test MAVLink Filter
+//*******************************************************
+// tMavlinkFilter of mavlink_filter.h, with a rule table for each action. The filter uses
+// only the ids of fmav_result_t, so these are given here, fastmavlink is not needed.
+//*******************************************************
+
+#include "host.h"
+
+typedef struct
+{
+    uint32_t msgid;
+    uint8_t sysid;
+    uint8_t compid;
+    uint16_t frame_len;
+} fmav_result_t;
+
+#define MAVLINK_FILTER_RULES \
+    { 100, 0, 0, MAVLINK_FILTER_DROP, 0 }, \
+    { 101, 1, 0, MAVLINK_FILTER_DECIMATE, 4 }, \
+    { 102, 0, 0, MAVLINK_FILTER_RATE, 5 },
+
+#include "../../mLRS/CommonRx/mavlink_filter.h"
+
+
+tMavlinkFilter filter;
+
+
+uint32_t count_passed(uint32_t msgid, uint8_t sysid, uint32_t num, uint32_t dt_ms)
+{
+fmav_result_t result = { msgid, sysid, 1, 20 };
+uint32_t passed = 0;
+
+    for (uint32_t i = 0; i < num; i++) {
+        if (filter.Pass(&result, millis32())) passed++;
+        host_time_us += dt_ms * 1000;
+    }
+    return passed;
+}
+
+
+int main(void)
+{
+    filter.Init();
+
+    // no rule, or the rule's sysid doesn't match
+    CHECK_EQ(count_passed(1, 1, 100, 1), 100);
+    CHECK_EQ(count_passed(101, 2, 100, 1), 100);
+
+    CHECK_EQ(count_passed(100, 1, 100, 1), 0);
+    CHECK_EQ(count_passed(101, 1, 100, 1), 25);
+
+    // 5 per second, plus the initial burst of 5, at 100 Hz for 10 s, the last is at 9.99 s
+    CHECK_EQ(count_passed(102, 1, 1000, 10), 5 + 49);
+
+    // after a pause the bucket is full again, but not more
+    host_time_us += 10000000;
+    CHECK_EQ(count_passed(102, 1, 10, 1), 5);
+
+    return host_result("test_mavlink_filter");
+}
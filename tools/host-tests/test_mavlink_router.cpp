@@ -0,0 +1,114 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Test MAVLink Router
+//*******************************************************
+// tMavlinkRouter of mavlink_router.h, with a GCS which is connected via two ports and a
+// component on a third port. The router uses only the ids of fmav_result_t and the header
+// in the port's buf, so these are given here, fastmavlink is not needed.
+//*******************************************************
+
+#include "host.h"
+
+typedef struct
+{
+    uint32_t msgid;
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t target_sysid;
+    uint8_t target_compid;
+    uint16_t frame_len;
+} fmav_result_t;
+
+typedef struct {} fmav_status_t;
+
+#define FASTMAVLINK_MAGIC_V2  0xFD
+
+#include "../../mLRS/CommonTx/mavlink_router.h"
+
+
+tSerialBase ser[3];
+tMavlinkRouter router;
+
+
+// puts a message from sysid/compid into port i's buf, as the parser would
+bool msg_in(uint8_t i, uint8_t sysid, uint8_t compid, uint8_t seq)
+{
+tMavlinkRouterPort* p = router.Port(i);
+
+    p->result = {};
+    p->result.msgid = 0; // HEARTBEAT
+    p->result.sysid = sysid;
+    p->result.compid = compid;
+    p->result.frame_len = 12 + 9;
+    memset(p->buf, 0, sizeof(p->buf));
+    p->buf[0] = FASTMAVLINK_MAGIC_V2;
+    p->buf[1] = 9;
+    p->buf[4] = seq;
+    p->buf[10 + 9] = sysid ^ seq; // crc
+    return router.HandleMsgIn(i, millis32());
+}
+
+
+uint8_t target_mask(uint8_t target_sysid, uint8_t target_compid, uint8_t from)
+{
+fmav_result_t result = {};
+
+    result.target_sysid = target_sysid;
+    result.target_compid = target_compid;
+    return router.TargetMask(&result, from, millis32());
+}
+
+
+int main(void)
+{
+    host_time_us = 1000;
+
+    router.Init();
+    for (uint8_t i = 0; i < 3; i++) router.AddPort(&ser[i], i == 0);
+    CHECK_EQ(router.PortNum(), 3);
+    CHECK_EQ(router.ActiveMask(millis32()), 0x01); // only the primary
+
+    // nothing learned, to all
+    CHECK_EQ(target_mask(255, 190, UINT8_MAX), 0);
+
+    // the GCS 255/190 on ports 0 and 1, the copy on port 1 is dropped, but is learned
+    CHECK(msg_in(0, 255, 190, 1));
+    CHECK(!msg_in(1, 255, 190, 1));
+    CHECK_EQ(router.duplicates_dropped, 1);
+    CHECK_EQ(router.ActiveMask(millis32()), 0x03);
+    CHECK_EQ(target_mask(255, 190, UINT8_MAX), 0x03);
+    CHECK_EQ(target_mask(255, 0, UINT8_MAX), 0x03);
+
+    // a component 1/100 on port 2
+    CHECK(msg_in(2, 1, 100, 1));
+    CHECK_EQ(target_mask(1, 100, UINT8_MAX), 0x04);
+    CHECK_EQ(target_mask(1, 100, 2), 0); // not back to where it came from
+    CHECK_EQ(target_mask(255, 190, 2), 0x03);
+    CHECK_EQ(target_mask(255, 190, 0), 0x02);
+    CHECK_EQ(target_mask(255, 1, UINT8_MAX), 0); // unknown component
+
+    // the GCS is seen only on port 1 from now on, the route via port 0 expires, although
+    // port 0 is the primary and stays active
+    for (uint8_t n = 2; n < 10; n++) {
+        host_time_us += 1000000;
+        CHECK(msg_in(1, 255, 190, n));
+        CHECK(msg_in(2, 1, 100, n));
+    }
+    CHECK_EQ(router.ActiveMask(millis32()), 0x07);
+    CHECK_EQ(target_mask(255, 190, UINT8_MAX), 0x02);
+    CHECK_EQ(target_mask(1, 100, UINT8_MAX), 0x04);
+
+    // nothing from port 2 anymore, it goes inactive
+    for (uint8_t n = 10; n < 20; n++) {
+        host_time_us += 1000000;
+        CHECK(msg_in(1, 255, 190, n));
+    }
+    CHECK_EQ(router.ActiveMask(millis32()), 0x03);
+    CHECK_EQ(target_mask(1, 100, UINT8_MAX), 0);
+
+    return host_result("test_mavlink_router");
+}
@@ -0,0 +1,166 @@
+//*******************************************************
+// Copyright (c) MLRS project
+// GPL3
+// https://www.gnu.org/licenses/gpl-3.0.de.html
+// OlliW @ www.olliw.eu
+//*******************************************************
+// Test Rc Data Delta Coding
+//*******************************************************
+// tRcCoding of rc_coding.h, with the Tx end doing Encode and HandleAck, and the Rx end
+// doing Decode or DecodeRc1 and Ack, as in the firmware. Stick traces are send with
+// uplink frame losses, crc1 only frames, and downlink losses, which lose the ack.
+//
+// A shadow Rx end decodes every frame, it has thus the values as the Tx coded them. The
+// Rx end must have either these or hold its values, and must never fail to decode a frame.
+// When the sticks are still, it must catch up with the Tx's values.
+//*******************************************************
+
+#include <math.h>
+#include "host.h"
+#include "../../mLRS/Common/rc_coding.h"
+
+
+uint32_t rnd_state = 1;
+
+uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+bool chance(float p) { return (rnd() % 10000) < p * 10000.0f; }
+
+
+//-------------------------------------------------------
+// Stick traces
+//-------------------------------------------------------
+
+typedef enum {
+    TRACE_SLOW = 0, // slow sticks, small changes per frame
+    TRACE_FAST,     // fast sticks and jumps, the changes don't fit into the bits
+    TRACE_NUM,
+} TRACE_ENUM;
+
+const char* trace_str[TRACE_NUM] = { "slow", "fast" };
+
+
+int32_t clip(int32_t v) { return (v < 0) ? 0 : ((v > 2047) ? 2047 : v); }
+
+// frame k, 50 Hz, the sticks stand still from frame still on
+void trace_rc(tRcData* rc, uint8_t trace, uint32_t k, uint32_t still)
+{
+    if (k > still) k = still;
+    float t = k * 0.02f;
+    float a = (trace == TRACE_FAST) ? 900.0f : 200.0f;
+    float f = (trace == TRACE_FAST) ? 3.0f : 0.3f;
+
+    for (uint8_t n = 0; n < 12; n++) {
+        rc->ch[n] = clip(1024 + a * sinf(6.2832f * f * (1.0f + 0.2f * n) * t + n));
+    }
+    if (trace == TRACE_FAST && (k / 25) % 2) { // a knob which jumps
+        rc->ch[7] = 1024 + 700 * (((k / 50) % 2) ? 1 : -1);
+    }
+    for (uint8_t n = 12; n < 16; n++) { // switches
+        uint8_t pos = ((k / (40 + 30 * n)) + n) % 3;
+        rc->ch[n] = (pos == 0) ? 0 : ((pos == 1) ? 1024 : 2047);
+    }
+}
+
+
+//-------------------------------------------------------
+// Link
+//-------------------------------------------------------
+
+typedef struct {
+    uint32_t frames;
+    uint32_t lost;
+    uint32_t crc1;
+    uint32_t decoded;
+    uint32_t keyframes;
+    uint32_t err_sum;
+} tStats;
+
+
+void run(uint8_t trace, float loss, float crc1_loss, float ack_loss)
+{
+tRcCoding tx, rx, shadow;
+tTxFrame frame;
+tRcData rc_in, rc_rx, rc_shadow, rc_before;
+tStats s = {};
+
+    tx.Init();
+    rx.Init();
+    shadow.Init();
+    memset(&frame, 0, sizeof(frame));
+    memset(&rc_rx, 0, sizeof(rc_rx));
+    memset(&rc_shadow, 0, sizeof(rc_shadow));
+
+    const uint32_t still = 3000;
+    const uint32_t num = still + 100;
+
+    for (uint32_t k = 0; k < num; k++) {
+        trace_rc(&rc_in, trace, k, still);
+
+        // Tx
+        tx.Encode(&frame, &rc_in);
+        s.frames++;
+        tFrameRcDataDelta1 rc1;
+        memcpy(&rc1, &(frame.rc1), sizeof(rc1));
+        if (rc1.ref == 0) s.keyframes++;
+
+        bool ok = shadow.Decode(&rc_shadow, &frame);
+        CHECK(ok);
+
+        // Rx
+        memcpy(&rc_before, &rc_rx, sizeof(tRcData));
+        ok = false;
+        if (chance(loss)) {
+            s.lost++;
+        } else
+        if (chance(crc1_loss)) {
+            rx.DecodeRc1(&rc_rx, &frame);
+            s.crc1++;
+        } else {
+            ok = rx.Decode(&rc_rx, &frame);
+            CHECK(ok); // the Tx refers only to frames which the Rx acknowledged
+            if (ok) s.decoded++;
+        }
+
+        // channels 1-4 are as send, or held if the frame was lost
+        for (uint8_t n = 0; n < 4; n++) {
+            if (rc_rx.ch[n] != rc_in.ch[n]) CHECK_EQ(rc_rx.ch[n], rc_before.ch[n]);
+        }
+        // channels 5-16 are as the Tx coded them if decoded, else held
+        for (uint8_t n = 4; n < 16; n++) {
+            CHECK_EQ(rc_rx.ch[n], (ok) ? rc_shadow.ch[n] : rc_before.ch[n]);
+        }
+        for (uint8_t n = 4; n < 16; n++) s.err_sum += abs((int)rc_rx.ch[n] - (int)rc_in.ch[n]);
+
+        // Rx -> Tx
+        bool ack = rx.Ack();
+        tx.HandleAck(ack && !chance(ack_loss));
+    }
+
+    // the sticks are still since 100 frames, the Rx must have caught up
+    for (uint8_t n = 0; n < 16; n++) CHECK_EQ(rc_rx.ch[n], rc_in.ch[n]);
+
+    printf("  %s, loss %.2f crc1 %.2f ack loss %.2f: %u decoded, %u keyframes, mean error %.1f\n",
+        trace_str[trace], loss, crc1_loss, ack_loss,
+        (unsigned)s.decoded, (unsigned)s.keyframes, (float)s.err_sum / (s.frames * 12));
+}
+
+
+int main(void)
+{
+    for (uint8_t trace = 0; trace < TRACE_NUM; trace++) {
+        run(trace, 0.0f, 0.0f, 0.0f);
+        run(trace, 0.1f, 0.0f, 0.0f);
+        run(trace, 0.0f, 0.0f, 0.3f);
+        run(trace, 0.2f, 0.05f, 0.2f);
+        run(trace, 0.5f, 0.1f, 0.5f);
+    }
+
+    return host_result("test_rc_coding");
+}